@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "Compression_p.h"
+
+#include <string.h>
+
+#include <vector>
+
+TUIWIDGETS_NS_START
+
+namespace Private {
+
+static const int minMatchLength = 4;
+static const int hashBits = 14;
+
+static inline quint32 read32(const char *p) {
+    quint32 value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline quint32 hash4(const char *p) {
+    return (read32(p) * 2654435761u) >> (32 - hashBits);
+}
+
+void appendVarint(QByteArray *output, quint64 value) {
+    char buffer[10];
+    int len = 0;
+    while (value >= 0x80) {
+        buffer[len++] = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buffer[len++] = static_cast<char>(value);
+    output->append(buffer, len);
+}
+
+bool readVarint(const char **pos, const char *end, quint64 *value) {
+    quint64 result = 0;
+    int shift = 0;
+    const char *p = *pos;
+    while (p < end && shift < 64) {
+        const unsigned char byte = static_cast<unsigned char>(*p++);
+        result |= static_cast<quint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *pos = p;
+            *value = result;
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+QByteArray lzCompress(const char *data, int size) {
+    QByteArray output;
+    output.reserve(size / 2 + 16);
+
+    // positions + 1 of the last occurrence of each hashed 4 byte sequence, 0 means none.
+    std::vector<int> table(1 << hashBits, 0);
+
+    int literalStart = 0;
+    int pos = 0;
+    while (pos + minMatchLength <= size) {
+        const quint32 h = hash4(data + pos);
+        const int candidate = table[h] - 1;
+        table[h] = pos + 1;
+        if (candidate >= 0 && read32(data + candidate) == read32(data + pos)) {
+            int length = minMatchLength;
+            while (pos + length < size && data[candidate + length] == data[pos + length]) {
+                ++length;
+            }
+            appendVarint(&output, static_cast<quint64>(pos - literalStart));
+            output.append(data + literalStart, pos - literalStart);
+            appendVarint(&output, static_cast<quint64>(length - minMatchLength));
+            appendVarint(&output, static_cast<quint64>(pos - candidate));
+            // Only index the start of the match, indexing every position costs more than it gains here.
+            pos += length;
+            literalStart = pos;
+        } else {
+            ++pos;
+        }
+    }
+    appendVarint(&output, static_cast<quint64>(size - literalStart));
+    output.append(data + literalStart, size - literalStart);
+    return output;
+}
+
+bool lzDecompress(const char *data, int size, int decompressedSize, QByteArray *output) {
+    output->resize(decompressedSize);
+    char *out = output->data();
+    int outPos = 0;
+    const char *pos = data;
+    const char *end = data + size;
+
+    while (pos < end) {
+        quint64 literals;
+        if (!readVarint(&pos, end, &literals)
+                || literals > static_cast<quint64>(end - pos)
+                || literals > static_cast<quint64>(decompressedSize - outPos)) {
+            return false;
+        }
+        memcpy(out + outPos, pos, literals);
+        pos += literals;
+        outPos += static_cast<int>(literals);
+        if (pos == end) {
+            break;
+        }
+
+        quint64 length;
+        quint64 offset;
+        if (!readVarint(&pos, end, &length) || !readVarint(&pos, end, &offset)) {
+            return false;
+        }
+        length += minMatchLength;
+        if (offset == 0 || offset > static_cast<quint64>(outPos)
+                || length > static_cast<quint64>(decompressedSize - outPos)) {
+            return false;
+        }
+        // Matches may overlap with the output they produce, so copy byte by byte.
+        const char *source = out + outPos - offset;
+        char *destination = out + outPos;
+        for (quint64 i = 0; i < length; i++) {
+            destination[i] = source[i];
+        }
+        outPos += static_cast<int>(length);
+    }
+    return outPos == decompressedSize;
+}
+
+}
+
+TUIWIDGETS_NS_END
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_COMPRESSION_P_INCLUDED
+#define TUIWIDGETS_COMPRESSION_P_INCLUDED
+
+#include <QByteArray>
+
+#include <Tui/tuiwidgets_internal.h>
+
+TUIWIDGETS_NS_START
+
+namespace Private {
+
+    // Simple byte oriented LZ77 compression. It is tuned for speed and the highly repetitive data of serialized
+    // terminal contents, not for compression ratio.
+    //
+    // The compressed data is a sequence of blocks. Each block is a varint count of literal bytes followed by the
+    // literal bytes and, unless the block ends the data, a varint match length (minus minimal match length) and a
+    // varint match offset counted back from the current output position.
+    QByteArray lzCompress(const char *data, int size);
+    bool lzDecompress(const char *data, int size, int decompressedSize, QByteArray *output);
+
+    void appendVarint(QByteArray *output, quint64 value);
+    bool readVarint(const char **pos, const char *end, quint64 *value);
+
+    // Bounds checked reading of varint based serialization formats. All functions return false if the data is
+    // truncated or a value is out of range.
+    class ByteReader {
+    public:
+        ByteReader(const char *data, int size) : pos(data), end(data + size) {}
+
+        bool varint(quint64 *value) {
+            return readVarint(&pos, end, value);
+        }
+
+        bool varintInt(int *value, int limit) {
+            quint64 tmp;
+            if (limit < 0 || !varint(&tmp) || tmp > static_cast<quint64>(limit)) {
+                return false;
+            }
+            *value = static_cast<int>(tmp);
+            return true;
+        }
+
+        bool varintUInt(unsigned int *value) {
+            quint64 tmp;
+            if (!varint(&tmp) || tmp > 0xffffffffu) {
+                return false;
+            }
+            *value = static_cast<unsigned int>(tmp);
+            return true;
+        }
+
+        bool byte(unsigned char *value) {
+            if (pos == end) {
+                return false;
+            }
+            *value = static_cast<unsigned char>(*pos++);
+            return true;
+        }
+
+        bool bytes(QByteArray *value) {
+            int length;
+            if (!varintInt(&length, static_cast<int>(end - pos))) {
+                return false;
+            }
+            *value = QByteArray(pos, length);
+            pos += length;
+            return true;
+        }
+
+        bool atEnd() const {
+            return pos == end;
+        }
+
+        const char *position() const {
+            return pos;
+        }
+
+        int remaining() const {
+            return static_cast<int>(end - pos);
+        }
+
+    private:
+        const char *pos;
+        const char *end;
+    };
+
+}
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_COMPRESSION_P_INCLUDED
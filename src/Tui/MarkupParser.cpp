@@ -4,6 +4,7 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 
@@ -16,48 +17,41 @@ static uint qHash(const std::u32string &key, uint seed) noexcept {
 #include <QSet>
 #include <QDebug>
 
+#include <Tui/Utils_p.h>
+
 TUIWIDGETS_NS_START
 
 namespace Private {
 
-MarkupTokenizer::MarkupTokenizer(QString markup)
+MarkupTokenizer::MarkupTokenizer(QString markup) : text(markup)
 {
-    text.reserve(markup.size());
-    bool cr = false;
-    for (auto it = markup.constBegin(); it != markup.constEnd(); it++) {
-        char32_t ch = it->unicode();
-        if (cr) {
-            text.push_back(0xa);
-            if (ch == 0xa) {
-                continue;
-            }
-            cr = false;
-        }
-        if (it->isLowSurrogate()) {
+    // Only validate here, the tokenizer decodes surrogates and normalizes line breaks while reading.
+    const QChar *const data = text.constData();
+    const int size = size2int(text.size());
+    textSize = size;
+    for (int i = 0; i < size; i++) {
+        char32_t ch = data[i].unicode();
+        if (data[i].isLowSurrogate()) {
             _isError = true;
-            break;
-        } else if (it->isHighSurrogate()) {
-            it++;
-            if (it != markup.constEnd() && it->isLowSurrogate()) {
-                ch = static_cast<char32_t>(QChar::surrogateToUcs4(ch, it->unicode()));
+        } else if (data[i].isHighSurrogate()) {
+            if (i + 1 < size && data[i + 1].isLowSurrogate()) {
+                ch = static_cast<char32_t>(QChar::surrogateToUcs4(data[i], data[i + 1]));
+                if (!isAllowedCodepoint(ch)) {
+                    _isError = true;
+                } else {
+                    ++i;
+                }
             } else {
                 _isError = true;
-                break;
             }
-        }
-        if (!isAllowedCodepoint(ch)) {
+        } else if (!isAllowedCodepoint(ch)) {
             _isError = true;
-            break;
         }
-        if (ch == 0xd) {
-            cr = true;
-        } else {
-            text.push_back(ch);
+        if (_isError) {
+            textSize = i;
+            break;
         }
     }
-    if (cr && !_isError) {
-        text.push_back(0xa);
-    }
 }
 
 bool MarkupTokenizer::isAllowedCodepoint(char32_t ch)
@@ -79,54 +73,124 @@ bool MarkupTokenizer::isAllowedCodepoint(char32_t ch)
     return true;
 }
 
-void MarkupTokenizer::storeAttribute()
-{
-    tagAttributes[attrName] = attrValue;
-    attrName.clear();
-    attrValue.clear();
+// Returns the code point starting at pos and advances pos past it. CR and CR LF are returned as LF.
+// Requires pos < textSize.
+char32_t MarkupTokenizer::readChar(int &pos) const {
+    const QChar *const data = text.constData();
+    const QChar ch = data[pos];
+    ++pos;
+    if (ch.unicode() == 0xd) {
+        if (pos < textSize && data[pos].unicode() == 0xa) {
+            ++pos;
+        }
+        return 0xa;
+    }
+    if (ch.isHighSurrogate()) {
+        // validated in the constructor to be followed by a low surrogate
+        const QChar low = data[pos];
+        ++pos;
+        return static_cast<char32_t>(QChar::surrogateToUcs4(ch, low));
+    }
+    return ch.unicode();
 }
 
-static uint32_t hash_fnv1a(const unsigned char *text) {
-    uint32_t hash = 2166136261;
-    for (; *text; ++text) {
-            hash = hash ^ *text;
-            hash = hash * 16777619;
+static void appendChar(QString &str, char32_t ch) {
+    if (QChar::requiresSurrogates(ch)) {
+        str.append(QChar(QChar::highSurrogate(ch)));
+        str.append(QChar(QChar::lowSurrogate(ch)));
+    } else {
+        str.append(QChar(static_cast<ushort>(ch)));
     }
-    return hash;
+}
+
+// Ends the attribute name that is currently read. Returns false if the current tag already has an attribute
+// with that name.
+bool MarkupTokenizer::finishAttributeName() {
+    attrNameEnd = size2int(attributeText.size());
+    const QChar *const data = attributeText.constData();
+    const int nameSize = attrNameEnd - attrNameStart;
+    for (const AttributeSpan &attribute: tagAttributes) {
+        if (attribute.nameSize == nameSize
+                && std::equal(data + attribute.nameStart, data + attribute.nameStart + nameSize,
+                              data + attrNameStart)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MarkupTokenizer::storeAttribute()
+{
+    const int end = size2int(attributeText.size());
+    tagAttributes.push_back(AttributeSpan{attrNameStart, attrNameEnd - attrNameStart, attrNameEnd, end - attrNameEnd});
+    attrNameStart = end;
+    attrNameEnd = end;
 }
 
 namespace {
     struct EntitiesEntry {
         uint8_t len;
-        uint8_t has_next;
         uint16_t strpool_offset;
         char32_t data[2];
     };
 
     #include "entities.inc"
+
+    constexpr uint32_t fnv1aStep(uint32_t hash, char ch) {
+        return (hash ^ static_cast<unsigned char>(ch)) * 16777619;
+    }
+
+    // Lookup in the minimal perfect hash table generated by entities.inc.gen.py. Every name hashes to exactly
+    // one candidate entry.
+    constexpr const EntitiesEntry *findEntity(const char *name, int len) {
+        uint32_t bucketHash = entitiesBucketBasis;
+        uint32_t slotHash = entitiesSlotBasis;
+        for (int i = 0; i < len; i++) {
+            bucketHash = fnv1aStep(bucketHash, name[i]);
+            slotHash = fnv1aStep(slotHash, name[i]);
+        }
+        const EntitiesEntry &entry
+                = entitiesEntries[(slotHash + entitiesDisplacements[bucketHash % entitiesBuckets]) % entitiesSize];
+        if (entry.len != len) {
+            return nullptr;
+        }
+        for (int i = 0; i < len; i++) {
+            if (entitiesStringpool[entry.strpool_offset + i] != name[i]) {
+                return nullptr;
+            }
+        }
+        return &entry;
+    }
+
+    static_assert(findEntity("amp", 3) && findEntity("amp", 3)->data[0] == '&', "entity table broken");
+    static_assert(findEntity("NotEqualTilde", 13) && findEntity("NotEqualTilde", 13)->data[1] == 824,
+                  "entity table broken");
+    static_assert(!findEntity("am", 2), "entity table broken");
 }
 
-std::u32string MarkupTokenizer::tryTokenizeCharRef(char32_t additionalAllowedChar) {
-    if (nextInputChar >= text.size()) {
-        return {};
+// Returns the number of code points (0 to 2) stored in result.
+int MarkupTokenizer::tryTokenizeCharRef(char32_t additionalAllowedChar, char32_t *result) {
+    if (nextInputChar >= textSize) {
+        return 0;
     }
-    char32_t ch1 = text[nextInputChar];
+    int peekChar = nextInputChar;
+    const char32_t ch1 = readChar(peekChar);
     if (ch1 == 9 || ch1 == 0xa || ch1 == 0xc || ch1 == ' ' || ch1 == '<' || ch1 == '&'
             || (additionalAllowedChar && ch1 == additionalAllowedChar)) {
-        return {};
+        return 0;
     } else if (ch1 == '#') {
-        unsigned int peekChar = nextInputChar + 1;
         bool hex = false;
-        if (peekChar < text.size()) {
-            char32_t ch = text[peekChar];
+        if (peekChar < textSize) {
+            const char16_t ch = text.constData()[peekChar].unicode();
             if (ch == 'x' || ch == 'X') {
                 hex = true;
                 ++peekChar;
             }
         }
         char32_t chEncoded = 0;
-        while (peekChar < text.size()) {
-            char32_t ch = text[peekChar];
+        bool terminated = false;
+        while (peekChar < textSize) {
+            const char32_t ch = readChar(peekChar);
             if (ch >= '0' && ch <= '9') {
                 chEncoded *= hex ? 16 : 10;
                 chEncoded += ch - '0';
@@ -137,67 +201,62 @@ std::u32string MarkupTokenizer::tryTokenizeCharRef(char32_t additionalAllowedCha
                 chEncoded *= hex ? 16 : 10;
                 chEncoded += ch - 'A' + 10;
             } else if (ch == ';') {
+                terminated = true;
                 break;
             } else {
                 _isError = true;
-                return {};
+                return 0;
             }
-            ++peekChar;
         }
-        if (peekChar < text.size()) {
+        if (terminated) {
             if (!isAllowedCodepoint(chEncoded) || chEncoded == 0 || chEncoded == 0xd
                 || (chEncoded >= 0xD800 && chEncoded <= 0xDFFF) || chEncoded > 0x10FFFF) {
                 _isError = true;
-                return {};
+                return 0;
             }
-            nextInputChar = peekChar + 1;
-            std::u32string ret;
-            ret.push_back(chEncoded);
-            return ret;
+            nextInputChar = peekChar;
+            result[0] = chEncoded;
+            return 1;
         } else {
             _isError = true;
-            return {};
+            return 0;
         }
     } else {
         // Note: Needs to be fixed for spec compliance.
-        unsigned int peekChar = nextInputChar;
-        std::string entityName;
-        while (peekChar < text.size()) {
-            char32_t ch = text[peekChar];
+        peekChar = nextInputChar;
+        // Names longer than the longest entity are still scanned, but can never match.
+        char entityName[entitiesMaxNameLength];
+        int entityNameSize = 0;
+        while (peekChar < textSize) {
+            const char32_t ch = readChar(peekChar);
             if ((ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')) {
-                entityName.push_back(ch);
-                peekChar++;
+                if (entityNameSize < entitiesMaxNameLength) {
+                    entityName[entityNameSize] = static_cast<char>(ch);
+                }
+                ++entityNameSize;
             } else if (ch == ';') {
-                const int hash = hash_fnv1a(reinterpret_cast<const unsigned char*>(entityName.c_str())) % entitiesSize;
-                int entryIdx = entitiesHashtbl[hash];
-                while (true) {
-                    const EntitiesEntry& entry = entitiesEntries[entryIdx];
-                    if (entry.len == entityName.size()) {
-                        if (memcmp(entityName.c_str(), entitiesStringpool + entry.strpool_offset, entry.len) == 0) {
-                            // match found
-                            nextInputChar = peekChar + 1;
-                            std::u32string ret;
-                            if (entry.data[1] == 0) {
-                                // one code point
-                                return std::u32string(entry.data, 1);
-                            } else {
-                                return std::u32string(entry.data, 2);
-                            }
-                            return ret;
-                        }
-                    }
-                    if (!entry.has_next) {
-                        _isError = true;
-                        return {};
-                    }
-                    entryIdx++;
+                const EntitiesEntry *entry = nullptr;
+                if (entityNameSize <= entitiesMaxNameLength) {
+                    entry = findEntity(entityName, entityNameSize);
                 }
+                if (!entry) {
+                    _isError = true;
+                    return 0;
+                }
+                nextInputChar = peekChar;
+                result[0] = entry->data[0];
+                if (entry->data[1] == 0) {
+                    // one code point
+                    return 1;
+                }
+                result[1] = entry->data[1];
+                return 2;
             } else {
-                return {};
+                return 0;
             }
         }
         _isError = true;
-        return {};
+        return 0;
     }
 }
 
@@ -215,13 +274,13 @@ void MarkupTokenizer::getToken() {
         _isError = true;
         return;
     }
-    if (pendingChars.size()) {
+    if (hasPendingChar) {
         currentToken = TT_Char;
-        currentChar = pendingChars.front();
-        pendingChars.pop();
+        currentChar = pendingChar;
+        hasPendingChar = false;
         return;
     }
-    if (nextInputChar >= text.size() && currentToken != TT_EOF) {
+    if (nextInputChar >= textSize && currentToken != TT_EOF) {
         currentToken = TT_EOF;
         return;
     }
@@ -230,21 +289,23 @@ void MarkupTokenizer::getToken() {
         if (_isError) {
             return;
         }
-        if (nextInputChar >= text.size()) {
+        if (nextInputChar >= textSize) {
             _isError = true;
             return;
         }
-        char32_t ch = text[nextInputChar];
-        ++nextInputChar;
+        const int charStart = nextInputChar;
+        const char32_t ch = readChar(nextInputChar);
         switch (tokMode) {
             case T_Data: {
                 if (ch == '&') {
-                    std::u32string tmp = tryTokenizeCharRef(0);
-                    if (tmp.size()) {
+                    char32_t charRef[2];
+                    const int charRefSize = tryTokenizeCharRef(0, charRef);
+                    if (charRefSize) {
                         currentToken = TT_Char;
-                        currentChar = tmp[0];
-                        for (unsigned i = 1; i < tmp.size(); i++) {
-                            pendingChars.push(tmp[i]);
+                        currentChar = charRef[0];
+                        if (charRefSize == 2) {
+                            hasPendingChar = true;
+                            pendingChar = charRef[1];
                         }
                     } else {
                         currentToken = TT_Char;
@@ -252,6 +313,8 @@ void MarkupTokenizer::getToken() {
                     }
                 } else if (ch == '<') {
                     tagAttributes.clear();
+                    // resize instead of clear to keep the allocation
+                    attributeText.resize(0);
                     tagName.clear();
                     tokMode = T_TagOpen;
                 } else if (ch == 0) {
@@ -322,38 +385,40 @@ void MarkupTokenizer::getToken() {
                     }
                 } else if (ch >= 'A' && ch <= 'Z') {
                     tokMode = T_AttrName;
-                    attrName.push_back(ch + 0x20);
+                    attrNameStart = size2int(attributeText.size());
+                    appendChar(attributeText, ch + 0x20);
                 } else if (ch == 0) {
                     _isError = true;
                 } else if (ch == '"' || ch == '\'' || ch == '<' || ch == '=') {
                     _isError = true;
                 } else {
                     tokMode = T_AttrName;
-                    attrName.push_back(ch);
+                    attrNameStart = size2int(attributeText.size());
+                    appendChar(attributeText, ch);
                 }
                 } break;
             case T_AttrName: {
                 if (ch == 9 || ch == 0xa || ch == 0xc || ch == ' ') {
-                    if (tagAttributes.count(attrName)) {
+                    if (!finishAttributeName()) {
                         _isError = true;
                     } else {
                         tokMode = T_AfterAttrName;
                     }
                 } else if (ch == '/') {
-                    if (tagAttributes.count(attrName)) {
+                    if (!finishAttributeName()) {
                         _isError = true;
                     } else {
                         storeAttribute();
                         tokMode = T_TagSelfClose;
                     }
                 } else if (ch == '=') {
-                    if (tagAttributes.count(attrName)) {
+                    if (!finishAttributeName()) {
                         _isError = true;
                     } else {
                         tokMode = T_BeforeAttrValue;
                     }
                 } else if (ch == '>') {
-                    if (tagAttributes.count(attrName)) {
+                    if (!finishAttributeName()) {
                         _isError = true;
                     } else {
                         storeAttribute();
@@ -365,13 +430,13 @@ void MarkupTokenizer::getToken() {
                         }
                     }
                 } else if (ch >= 'A' && ch <= 'Z') {
-                    attrName.push_back(ch + 0x20);
+                    appendChar(attributeText, ch + 0x20);
                 } else if (ch == 0) {
                     _isError = true;
                 } else if (ch == '"' || ch == '\'' || ch == '<') {
                     _isError = true;
                 } else {
-                    attrName.push_back(ch);
+                    appendChar(attributeText, ch);
                 }
                 } break;
             case T_AfterAttrName: {
@@ -393,7 +458,7 @@ void MarkupTokenizer::getToken() {
                 } else if (ch >= 'A' && ch <= 'Z') {
                     storeAttribute();
                     tokMode = T_AttrName;
-                    attrName.push_back(ch + 0x20);
+                    appendChar(attributeText, ch + 0x20);
                 } else if (ch == 0) {
                     _isError = true;
                 } else if (ch == '"' || ch == '\'' || ch == '<') {
@@ -401,7 +466,7 @@ void MarkupTokenizer::getToken() {
                 } else {
                     storeAttribute();
                     tokMode = T_AttrName;
-                    attrName.push_back(ch);
+                    appendChar(attributeText, ch);
                 }
                 } break;
             case T_BeforeAttrValue: {
@@ -411,7 +476,7 @@ void MarkupTokenizer::getToken() {
                     tokMode = T_AttrValueDblQuoted;
                 } else if (ch == '&') {
                     tokMode = T_AttrValueUnquoted;
-                    --nextInputChar;
+                    nextInputChar = charStart;
                 } else if (ch == '\'') {
                     tokMode = T_AttrValueSingleQuoted;
                 } else if (ch == 0) {
@@ -421,7 +486,7 @@ void MarkupTokenizer::getToken() {
                 } else if (ch == '<' || ch == '=' || ch == '`') {
                     _isError = true;
                 } else {
-                    attrValue.push_back(ch);
+                    appendChar(attributeText, ch);
                     tokMode = T_AttrValueUnquoted;
                 }
                 } break;
@@ -430,16 +495,19 @@ void MarkupTokenizer::getToken() {
                     storeAttribute();
                     tokMode = T_AfterAttrValueQuoted;
                 } else if (ch == '&') {
-                    std::u32string tmp = tryTokenizeCharRef('"');
-                    if (tmp.size()) {
-                        attrValue.append(tmp);
+                    char32_t charRef[2];
+                    const int charRefSize = tryTokenizeCharRef('"', charRef);
+                    if (charRefSize) {
+                        for (int i = 0; i < charRefSize; i++) {
+                            appendChar(attributeText, charRef[i]);
+                        }
                     } else if (!_isError) {
-                        attrValue.push_back(ch);
+                        appendChar(attributeText, ch);
                     }
                 } else if (ch == 0) {
                     _isError = true;
                 } else {
-                    attrValue.push_back(ch);
+                    appendChar(attributeText, ch);
                 }
                 } break;
             case T_AttrValueSingleQuoted: {
@@ -447,16 +515,19 @@ void MarkupTokenizer::getToken() {
                     storeAttribute();
                     tokMode = T_AfterAttrValueQuoted;
                 } else if (ch == '&') {
-                    std::u32string tmp = tryTokenizeCharRef('\'');
-                    if (tmp.size()) {
-                        attrValue.append(tmp);
+                    char32_t charRef[2];
+                    const int charRefSize = tryTokenizeCharRef('\'', charRef);
+                    if (charRefSize) {
+                        for (int i = 0; i < charRefSize; i++) {
+                            appendChar(attributeText, charRef[i]);
+                        }
                     } else if (!_isError) {
-                        attrValue.push_back(ch);
+                        appendChar(attributeText, ch);
                     }
                 } else if (ch == 0) {
                     _isError = true;
                 } else {
-                    attrValue.push_back(ch);
+                    appendChar(attributeText, ch);
                 }
                 } break;
             case T_AttrValueUnquoted: {
@@ -464,11 +535,14 @@ void MarkupTokenizer::getToken() {
                     storeAttribute();
                     tokMode = T_BeforeAttrName;
                 } else if (ch == '&') {
-                    std::u32string tmp = tryTokenizeCharRef('>');
-                    if (tmp.size()) {
-                        attrValue.append(tmp);
+                    char32_t charRef[2];
+                    const int charRefSize = tryTokenizeCharRef('>', charRef);
+                    if (charRefSize) {
+                        for (int i = 0; i < charRefSize; i++) {
+                            appendChar(attributeText, charRef[i]);
+                        }
                     } else if (!_isError) {
-                        attrValue.push_back(ch);
+                        appendChar(attributeText, ch);
                     }
                 } else if (ch == '>') {
                     storeAttribute();
@@ -479,7 +553,7 @@ void MarkupTokenizer::getToken() {
                 } else if (ch == '"' || ch == '\'' || ch == '<' || ch == '=' || ch == '`') {
                     _isError = true;
                 } else {
-                    attrValue.push_back(ch);
+                    appendChar(attributeText, ch);
                 }
                 } break;
             case T_AfterAttrValueQuoted: {
@@ -617,8 +691,10 @@ void MarkupParserBase::emitCurrentTokenizerElement() {
     eventType = E_ElementBegin;
     eventTagStart = QString::fromStdU32String(t.tagName);
     eventAttributes.clear();
-    for (auto nameAndValue : t.tagAttributes) {
-        eventAttributes[QString::fromStdU32String(nameAndValue.first)] = QString::fromStdU32String(nameAndValue.second);
+    const QChar *const attributeData = t.attributeText.constData();
+    for (const MarkupTokenizer::AttributeSpan &attribute : t.tagAttributes) {
+        eventAttributes.insert(QString(attributeData + attribute.nameStart, attribute.nameSize),
+                               QString(attributeData + attribute.valueStart, attribute.valueSize));
     }
 }
 
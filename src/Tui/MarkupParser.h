@@ -3,8 +3,7 @@
 #ifndef TUIWIDGETS_PRIVATE_MARKUPPARSER_INCLUDED
 #define TUIWIDGETS_PRIVATE_MARKUPPARSER_INCLUDED
 
-#include <map>
-#include <queue>
+#include <string>
 #include <vector>
 
 #include <QList>
@@ -39,10 +38,20 @@ class MarkupTokenizer {
 
     bool _isError = false;
 
+    struct AttributeSpan {
+        int nameStart;
+        int nameSize;
+        int valueStart;
+        int valueSize;
+    };
+
     TokenType currentToken = TT_Invalid;
     char32_t currentChar;
     std::u32string tagName;
-    std::map<std::u32string, std::u32string> tagAttributes;
+    // Attributes of the current tag as spans into attributeText. Both are reused from tag to tag to avoid
+    // allocations.
+    std::vector<AttributeSpan> tagAttributes;
+    QString attributeText;
 
     enum TokMode {
         T_Data,
@@ -63,11 +72,15 @@ class MarkupTokenizer {
 
 private:
     bool isAllowedCodepoint(char32_t ch);
+    char32_t readChar(int &pos) const;
+    bool finishAttributeName();
     void storeAttribute();
-    std::u32string tryTokenizeCharRef(char32_t additionalAllowedChar);
+    int tryTokenizeCharRef(char32_t additionalAllowedChar, char32_t *result);
 
 private:
-    std::queue<char32_t> pendingChars;
+    // Entities expand to at most two code points, so at most one char is pending.
+    bool hasPendingChar = false;
+    char32_t pendingChar;
     bool selfClosingMustAck = false;
 
     // Valid when tokMode in [T_TagName, T_TagSelfClose, T_BeforeAttrName, T_AttrName, T_AfterAttrName,
@@ -75,12 +88,16 @@ class MarkupTokenizer {
     bool isOpen;
     // Valid when tokMode in [T_AttrName, T_AfterAttrName, T_BeforeAttrValue, T_AttrValueDblQuoted, T_AttrValueUnquoted,
     // T_AttrValueSingleQuoted]
-    std::u32string attrName;
-    // Valid when tokMode in [T_AttrValueDblQuoted, T_AttrValueUnquoted, T_AttrValueSingleQuoted]
-    std::u32string attrValue;
-
-    uint nextInputChar = 0;
-    std::u32string text;
+    int attrNameStart = 0;
+    // Valid when tokMode in [T_AfterAttrName, T_BeforeAttrValue, T_AttrValueDblQuoted, T_AttrValueUnquoted,
+    // T_AttrValueSingleQuoted], the value is appended to attributeText from here.
+    int attrNameEnd = 0;
+
+    // Index of the next UTF-16 code unit in text
+    int nextInputChar = 0;
+    QString text;
+    // Length of the valid prefix of text, everything from an invalid code point onwards is ignored.
+    int textSize = 0;
 };
 
 
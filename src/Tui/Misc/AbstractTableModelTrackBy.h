@@ -3,9 +3,12 @@
 #ifndef TUIWIDGETS_MISC_ABSTRACTTABLEMODELTRACKBY_INCLUDED
 #define TUIWIDGETS_MISC_ABSTRACTTABLEMODELTRACKBY_INCLUDED
 
+#include <algorithm>
+#include <vector>
+
 #include <QAbstractListModel>
+#include <QHash>
 #include <QMap>
-#include <QSet>
 #include <QVector>
 
 #include <Tui/tuiwidgets_internal.h>
@@ -39,8 +42,7 @@ class AbstractTableModelTrackBy : public QAbstractTableModel {
     Qt::ItemFlags flags(const QModelIndex &index) const override;
 
 private:
-    void updateRow(int idx, const Row &row);
-    int findRowByKey(const KEY &key);
+    bool updateRow(int idx, const Row &row);
     static bool isVariantExactlyEqual(const QVariant &a, const QVariant &b);
 
 private:
@@ -55,61 +57,133 @@ AbstractTableModelTrackBy<KEY>::AbstractTableModelTrackBy(int columns) : _column
 template<typename KEY>
 void AbstractTableModelTrackBy<KEY>::setData(const QVector<AbstractTableModelTrackBy::Row> &data) {
 
-    QSet<KEY> nextKeys;
-    for (const auto& row: data) {
+    // position of each key in the new data
+    QHash<KEY, int> nextPositions;
+    nextPositions.reserve(data.size());
+    for (int i = 0; i < data.size(); i++) {
+        const auto& row = data[i];
         if (row.columns.size() != _columns) {
             qWarning("AbstractItemModelTrackBy::setData: Columns count does not match. This is not supported");
             return;
         }
 
-        if (nextKeys.contains(row.key)) {
+        if (nextPositions.contains(row.key)) {
             qWarning("AbstractItemModelTrackBy::setData: duplicate key in new data. This is not supported");
             return;
         }
-        nextKeys.insert(row.key);
+        nextPositions.insert(row.key, i);
     }
 
     if (_data.size() == 0) {
-        beginInsertRows(QModelIndex(), 0, data.size() - 1);
-        _data = data;
-        endInsertRows();
+        if (data.size()) {
+            beginInsertRows(QModelIndex(), 0, data.size() - 1);
+            _data = data;
+            endInsertRows();
+        }
         return;
     }
 
-    // remove all rows that are no longer needed
-    for (int i = 0; i < _data.size(); i++) {
-        if (!nextKeys.contains(_data[i].key)) {
-            // TODO batch if next row also needs to be removed
-            beginRemoveRows(QModelIndex(), i, i);
-            _data.removeAt(i);
-            endRemoveRows();
+    // remove all rows that are no longer needed, adjacent rows are removed together. Starting from the end
+    // keeps the indices of the rows not yet visited valid.
+    for (int i = _data.size() - 1; i >= 0; i--) {
+        if (nextPositions.contains(_data[i].key)) {
+            continue;
+        }
+        const int last = i;
+        while (i > 0 && !nextPositions.contains(_data[i - 1].key)) {
             --i;
         }
+        beginRemoveRows(QModelIndex(), i, last);
+        _data.erase(_data.begin() + i, _data.begin() + last + 1);
+        endRemoveRows();
     }
 
     // reorder and add rows
-    QSet<KEY> inListKeys;
-    for (const auto& row: _data) {
-        inListKeys.insert(row.key);
+    //
+    // Rows before i are in their final place. The remaining rows of the old data follow in their previous relative
+    // order. Their current position is found using a fenwick tree over their previous positions that counts the
+    // remaining rows.
+    QHash<KEY, int> previousPositions;
+    previousPositions.reserve(_data.size());
+    for (int i = 0; i < _data.size(); i++) {
+        previousPositions.insert(_data[i].key, i);
     }
 
+    std::vector<int> remainingTree(_data.size() + 1, 0);
+    for (int i = 1; i <= _data.size(); i++) {
+        remainingTree[i] += 1;
+        const int parent = i + (i & -i);
+        if (parent <= _data.size()) {
+            remainingTree[parent] += remainingTree[i];
+        }
+    }
+    // number of remaining rows with a previous position before previousPosition
+    auto remainingBefore = [&remainingTree](int previousPosition) {
+        int count = 0;
+        for (int i = previousPosition; i > 0; i -= i & -i) {
+            count += remainingTree[i];
+        }
+        return count;
+    };
+    auto markPlaced = [&remainingTree](int previousPosition) {
+        for (int i = previousPosition + 1; i < static_cast<int>(remainingTree.size()); i += i & -i) {
+            remainingTree[i] -= 1;
+        }
+    };
+
+    // changed rows are reported in blocks of adjacent rows
+    int changedFirst = -1;
+    int changedLast = -1;
+    auto flushChanged = [&] {
+        if (changedFirst != -1) {
+            dataChanged(index(changedFirst, 0), index(changedLast, _columns - 1));
+            changedFirst = -1;
+        }
+    };
+
     int i = 0;
-    for (const auto& row: data) {
-        if (i < _data.size() && _data[i].key == row.key) {
-            updateRow(i, row);
-        } else if (inListKeys.contains(row.key)) {
-            int j = findRowByKey(row.key);
-            beginMoveRows(QModelIndex(), j, j, QModelIndex(), i);
-            _data.move(j, i);
-            endMoveRows();
-            updateRow(i, row);
-        } else {
-            beginInsertRows(QModelIndex(), i, i);
-            _data.insert(i, row);
+    while (i < data.size()) {
+        const auto previous = previousPositions.find(data[i].key);
+        if (previous == previousPositions.end()) {
+            int last = i;
+            while (last + 1 < data.size() && !previousPositions.contains(data[last + 1].key)) {
+                ++last;
+            }
+            beginInsertRows(QModelIndex(), i, last);
+            _data.insert(i, last - i + 1, Row());
+            std::copy(data.begin() + i, data.begin() + last + 1, _data.begin() + i);
             endInsertRows();
+            i = last + 1;
+            continue;
+        }
+
+        const int current = i + remainingBefore(*previous);
+        int count = 1;
+        if (current != i) {
+            // rows that follow in the same order in the old data are moved together
+            while (i + count < data.size() && current + count < _data.size()
+                   && _data[current + count].key == data[i + count].key) {
+                ++count;
+            }
+            beginMoveRows(QModelIndex(), current, current + count - 1, QModelIndex(), i);
+            std::rotate(_data.begin() + i, _data.begin() + current, _data.begin() + current + count);
+            endMoveRows();
         }
-        ++i;
+
+        for (int j = i; j < i + count; j++) {
+            markPlaced(previousPositions.value(data[j].key));
+            if (updateRow(j, data[j])) {
+                if (changedFirst != -1 && changedLast + 1 == j) {
+                    changedLast = j;
+                } else {
+                    flushChanged();
+                    changedFirst = changedLast = j;
+                }
+            }
+        }
+        i += count;
     }
+    flushChanged();
 }
 
 template<typename KEY>
@@ -183,26 +257,33 @@ Qt::ItemFlags AbstractTableModelTrackBy<KEY>::flags(const QModelIndex &index) co
 }
 
 template<typename KEY>
-void AbstractTableModelTrackBy<KEY>::updateRow(int idx, const AbstractTableModelTrackBy<KEY>::Row &row) {
+bool AbstractTableModelTrackBy<KEY>::updateRow(int idx, const AbstractTableModelTrackBy<KEY>::Row &row) {
     auto& currentRow = _data[idx];
+    if (currentRow.columns.isSharedWith(row.columns)) {
+        return false;
+    }
     bool changed = false;
-    for (int i = 0; i < _columns; i++) {
-        const auto roles = currentRow.columns[i].keys();
-        if (roles != row.columns[i].keys()) {
+    for (int i = 0; i < _columns && !changed; i++) {
+        const auto& currentColumn = currentRow.columns[i];
+        const auto& column = row.columns[i];
+        if (currentColumn.isSharedWith(column)) {
+            continue;
+        }
+        if (currentColumn.size() != column.size()) {
             changed = true;
             break;
         }
-        for (const auto& role: roles) {
-            if (!isVariantExactlyEqual(currentRow.columns[i][role], row.columns[i][role])) {
+        for (auto currentIt = currentColumn.cbegin(), it = column.cbegin(); currentIt != currentColumn.cend();
+             ++currentIt, ++it) {
+            if (currentIt.key() != it.key() || !isVariantExactlyEqual(currentIt.value(), it.value())) {
                 changed = true;
                 break;
             }
         }
     }
-    if (changed) {
-        currentRow.columns = row.columns;
-        dataChanged(index(idx, 0), index(idx, _columns - 1));
-    }
+    // Also take the data if nothing changed, so the next update with the same (shared) data can skip comparing.
+    currentRow.columns = row.columns;
+    return changed;
 }
 
 template<typename KEY>
@@ -211,17 +292,6 @@ bool AbstractTableModelTrackBy<KEY>::isVariantExactlyEqual(const QVariant &a, co
     return a == b;
 }
 
-template<typename KEY>
-int AbstractTableModelTrackBy<KEY>::findRowByKey(const KEY &key) {
-    for (int i = 0; i < _data.size(); i++) {
-        if (_data[i].key == key) {
-            return i;
-        }
-    }
-    // Maybe assert instead?
-    throw std::runtime_error("AbstractItemModelTrackBy::findRowByKey called on non existing key.");
-}
-
 }
 
 TUIWIDGETS_NS_END
@@ -1,55 +1,385 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #include "SurrogateEscape.h"
+#include "SurrogateEscape_p.h"
 
-#include <QTextCodec>
+#include <string.h>
+
+#include <algorithm>
+
+#include <Tui/Utils_p.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TUIWIDGETS_SURROGATEESCAPE_X86
+#include <immintrin.h>
+#endif
 
 TUIWIDGETS_NS_START
 
-namespace Misc {
+namespace Private {
 
-QString SurrogateEscape::decode(const QByteArray &data) {
-    return decode(data.constData(), data.length());
-}
+namespace SurrogateEscapeKernels {
 
-QString SurrogateEscape::decode(const char *data, int len) {
-    QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
-    QTextCodec *codec = QTextCodec::codecForName("UTF-8");
-    QString text = codec->toUnicode(data, len, &state);
-    if (state.invalidChars > 0 || state.remainingChars > 0) {
-        // contains invalid utf8, use slowpath for surrogate escape
-        text = QStringLiteral("");
-        for (int i = 0; i < len; i++) {
-            int first_byte = (unsigned char)data[i];
-
-            // one code point at a time
-
-            int size;
-            if (0xf0 == (0xf8 & first_byte)) {
-                size = 4;
-            } else if (0xe0 == (0xf0 & first_byte)) {
-                size = 3;
-            } else if (0xc0 == (0xe0 & first_byte)) {
-                size = 2;
-            } else {
-                size = 1;
+namespace {
+
+    // The kernels only differ in how runs of ASCII are converted. Everything else is handled by the common
+    // code below one code point at a time.
+
+    struct ScalarAscii {
+        // Converts a prefix of ASCII bytes in `data` and returns its length. Might write to `output` beyond the
+        // returned length (but not beyond `len`).
+        static int decodeAscii(const unsigned char *data, int len, char16_t *output) {
+            int i = 0;
+            while (i + 8 <= len) {
+                quint64 block;
+                memcpy(&block, data + i, 8);
+                if (block & 0x8080808080808080ull) {
+                    break;
+                }
+                for (int j = 0; j < 8; j++) {
+                    output[i + j] = data[i + j];
+                }
+                i += 8;
             }
+            while (i < len && data[i] < 0x80) {
+                output[i] = data[i];
+                i++;
+            }
+            return i;
+        }
+
+        // Converts a prefix of ASCII code units in `str` and returns its length. Might write to `output` beyond the
+        // returned length (but not beyond `len`).
+        static int encodeAscii(const char16_t *str, int len, char *output) {
+            int i = 0;
+            while (i < len && str[i] < 0x80) {
+                output[i] = static_cast<char>(str[i]);
+                i++;
+            }
+            return i;
+        }
+    };
+
+#ifdef TUIWIDGETS_SURROGATEESCAPE_X86
+    struct Sse2Ascii {
+        __attribute__((target("sse2")))
+        static int decodeAscii(const unsigned char *data, int len, char16_t *output) {
+            const __m128i zero = _mm_setzero_si128();
+            int i = 0;
+            while (i + 16 <= len) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_unpacklo_epi8(chunk, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 8), _mm_unpackhi_epi8(chunk, zero));
+                const unsigned nonAscii = static_cast<unsigned>(_mm_movemask_epi8(chunk));
+                if (nonAscii) {
+                    return i + __builtin_ctz(nonAscii);
+                }
+                i += 16;
+            }
+            return i + ScalarAscii::decodeAscii(data + i, len - i, output + i);
+        }
 
-            if (i + size > len) {
-                text.append((QChar)(0xdc00 + (unsigned char)data[i]));
-                continue;
+        __attribute__((target("sse2")))
+        static int encodeAscii(const char16_t *str, int len, char *output) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i nonAsciiBits = _mm_set1_epi16(static_cast<short>(0xff80));
+            int i = 0;
+            while (i + 16 <= len) {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i + 8));
+                // _mm_packus_epi16 saturates, which is harmless because only the ASCII prefix is used.
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(a, b));
+                const unsigned asciiA = static_cast<unsigned>(
+                            _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(a, nonAsciiBits), zero)));
+                const unsigned asciiB = static_cast<unsigned>(
+                            _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(b, nonAsciiBits), zero)));
+                const unsigned nonAscii = ~(asciiA | (asciiB << 16));
+                if (nonAscii) {
+                    // two mask bits per code unit
+                    return i + __builtin_ctz(nonAscii) / 2;
+                }
+                i += 16;
             }
+            return i + ScalarAscii::encodeAscii(str + i, len - i, output + i);
+        }
+    };
 
-            QTextCodec::ConverterState state2(QTextCodec::IgnoreHeader);
-            QString tmp = codec->toUnicode(data + i, size, &state2);
-            if (state2.invalidChars) {
-                text.append((QChar)(0xdc00 + (unsigned char)data[i]));
-                continue;
-            } else {
-                text += tmp;
-                i += size - 1;
+    struct Avx2Ascii {
+        __attribute__((target("avx2")))
+        static int decodeAscii(const unsigned char *data, int len, char16_t *output) {
+            int i = 0;
+            while (i + 32 <= len) {
+                const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i),
+                                    _mm256_cvtepu8_epi16(_mm256_castsi256_si128(chunk)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i + 16),
+                                    _mm256_cvtepu8_epi16(_mm256_extracti128_si256(chunk, 1)));
+                const unsigned nonAscii = static_cast<unsigned>(_mm256_movemask_epi8(chunk));
+                if (nonAscii) {
+                    return i + __builtin_ctz(nonAscii);
+                }
+                i += 32;
             }
+            return i + Sse2Ascii::decodeAscii(data + i, len - i, output + i);
         }
+
+        __attribute__((target("avx2")))
+        static int encodeAscii(const char16_t *str, int len, char *output) {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i nonAsciiBits = _mm256_set1_epi16(static_cast<short>(0xff80));
+            int i = 0;
+            while (i + 32 <= len) {
+                const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i));
+                const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i + 16));
+                // _mm256_packus_epi16 works per 128 bit lane, so the 64 bit blocks need to be put back in order.
+                const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), packed);
+                const unsigned asciiA = static_cast<unsigned>(
+                            _mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(a, nonAsciiBits), zero)));
+                const unsigned asciiB = static_cast<unsigned>(
+                            _mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(b, nonAsciiBits), zero)));
+                if (~asciiA) {
+                    return i + __builtin_ctz(~asciiA) / 2;
+                }
+                if (~asciiB) {
+                    return i + 16 + __builtin_ctz(~asciiB) / 2;
+                }
+                i += 32;
+            }
+            return i + Sse2Ascii::encodeAscii(str + i, len - i, output + i);
+        }
+    };
+#endif
+
+    // Strict UTF-8 decoding (no overlong forms, no surrogates, nothing above U+10FFFF) of one code point starting at
+    // a non ASCII byte. Bytes that don't start a valid sequence are escaped one byte at a time.
+    inline void decodeNonAscii(const unsigned char *data, int len, int &i, char16_t *output, int &o) {
+        const unsigned char firstByte = data[i];
+
+        int size;
+        char32_t codePoint;
+        char32_t minimum;
+        if ((firstByte & 0xe0) == 0xc0) {
+            size = 2;
+            codePoint = firstByte & 0x1f;
+            minimum = 0x80;
+        } else if ((firstByte & 0xf0) == 0xe0) {
+            size = 3;
+            codePoint = firstByte & 0x0f;
+            minimum = 0x800;
+        } else if ((firstByte & 0xf8) == 0xf0) {
+            size = 4;
+            codePoint = firstByte & 0x07;
+            minimum = 0x10000;
+        } else {
+            output[o++] = static_cast<char16_t>(0xdc00 + firstByte);
+            i += 1;
+            return;
+        }
+
+        if (i + size > len) {
+            output[o++] = static_cast<char16_t>(0xdc00 + firstByte);
+            i += 1;
+            return;
+        }
+
+        for (int j = 1; j < size; j++) {
+            const unsigned char continuation = data[i + j];
+            if ((continuation & 0xc0) != 0x80) {
+                output[o++] = static_cast<char16_t>(0xdc00 + firstByte);
+                i += 1;
+                return;
+            }
+            codePoint = (codePoint << 6) | (continuation & 0x3f);
+        }
+
+        if (codePoint < minimum || (codePoint >= 0xd800 && codePoint <= 0xdfff) || codePoint > 0x10ffff) {
+            output[o++] = static_cast<char16_t>(0xdc00 + firstByte);
+            i += 1;
+            return;
+        }
+
+        if (codePoint >= 0x10000) {
+            output[o++] = static_cast<char16_t>(0xd800 + ((codePoint - 0x10000) >> 10));
+            output[o++] = static_cast<char16_t>(0xdc00 + (codePoint & 0x3ff));
+        } else {
+            output[o++] = static_cast<char16_t>(codePoint);
+        }
+        i += size;
+    }
+
+    inline void encodeNonAscii(const char16_t *str, int len, int &i, char *output, int &o) {
+        const char16_t ch = str[i];
+
+        if (ch < 0x800) {
+            output[o++] = static_cast<char>(0xc0 | (ch >> 6));
+            output[o++] = static_cast<char>(0x80 | (ch & 0x3f));
+            i += 1;
+        } else if (ch < 0xd800 || ch > 0xdfff) {
+            output[o++] = static_cast<char>(0xe0 | (ch >> 12));
+            output[o++] = static_cast<char>(0x80 | ((ch >> 6) & 0x3f));
+            output[o++] = static_cast<char>(0x80 | (ch & 0x3f));
+            i += 1;
+        } else if (ch < 0xdc00 && i + 1 < len && str[i + 1] >= 0xdc00 && str[i + 1] <= 0xdfff) {
+            const char32_t codePoint = 0x10000 + ((static_cast<char32_t>(ch) - 0xd800) << 10) + (str[i + 1] - 0xdc00);
+            output[o++] = static_cast<char>(0xf0 | (codePoint >> 18));
+            output[o++] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+            output[o++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+            output[o++] = static_cast<char>(0x80 | (codePoint & 0x3f));
+            i += 2;
+        } else if ((ch & 0xff80) == 0xdc80) {
+            // surrogate escape
+            output[o++] = static_cast<char>(ch & 0xff);
+            i += 1;
+        } else {
+            // invalid, output is utf-8, so use U+FFFD REPLACEMENT CHARACTER for conversion error.
+            output[o++] = '\357';
+            output[o++] = '\277';
+            output[o++] = '\275';
+            i += 1;
+        }
+    }
+
+    template <typename Ascii>
+    int decodeWith(const char *input, int len, char16_t *output) {
+        const unsigned char *data = reinterpret_cast<const unsigned char*>(input);
+        int i = 0;
+        int o = 0;
+        while (i < len) {
+            const int asciiLen = Ascii::decodeAscii(data + i, len - i, output + o);
+            i += asciiLen;
+            o += asciiLen;
+
+            // Convert all following non ASCII code points before switching back to the ASCII kernel.
+            while (i < len && data[i] >= 0x80) {
+                decodeNonAscii(data, len, i, output, o);
+            }
+        }
+        return o;
+    }
+
+    template <typename Ascii>
+    int encodeWith(const char16_t *str, int len, char *output) {
+        int i = 0;
+        int o = 0;
+        while (i < len) {
+            const int asciiLen = Ascii::encodeAscii(str + i, len - i, output + o);
+            i += asciiLen;
+            o += asciiLen;
+
+            while (i < len && str[i] >= 0x80) {
+                encodeNonAscii(str, len, i, output, o);
+            }
+        }
+        return o;
+    }
+
+}
+
+bool isSupported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+#ifdef TUIWIDGETS_SURROGATEESCAPE_X86
+        case Kernel::SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case Kernel::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#else
+        case Kernel::SSE2:
+        case Kernel::AVX2:
+            return false;
+#endif
+    }
+    return false;
+}
+
+Kernel selected() {
+    static const Kernel kernel = [] {
+        if (isSupported(Kernel::AVX2)) {
+            return Kernel::AVX2;
+        } else if (isSupported(Kernel::SSE2)) {
+            return Kernel::SSE2;
+        }
+        return Kernel::Scalar;
+    }();
+    return kernel;
+}
+
+int decode(Kernel kernel, const char *data, int len, char16_t *output) {
+    switch (kernel) {
+#ifdef TUIWIDGETS_SURROGATEESCAPE_X86
+        case Kernel::AVX2:
+            return decodeWith<Avx2Ascii>(data, len, output);
+        case Kernel::SSE2:
+            return decodeWith<Sse2Ascii>(data, len, output);
+#else
+        case Kernel::AVX2:
+        case Kernel::SSE2:
+#endif
+        case Kernel::Scalar:
+            break;
+    }
+    return decodeWith<ScalarAscii>(data, len, output);
+}
+
+int encodeAscii(Kernel kernel, const char16_t *str, int len, char *output) {
+    switch (kernel) {
+#ifdef TUIWIDGETS_SURROGATEESCAPE_X86
+        case Kernel::AVX2:
+            return Avx2Ascii::encodeAscii(str, len, output);
+        case Kernel::SSE2:
+            return Sse2Ascii::encodeAscii(str, len, output);
+#else
+        case Kernel::AVX2:
+        case Kernel::SSE2:
+#endif
+        case Kernel::Scalar:
+            break;
+    }
+    return ScalarAscii::encodeAscii(str, len, output);
+}
+
+int encode(Kernel kernel, const char16_t *str, int len, char *output) {
+    switch (kernel) {
+#ifdef TUIWIDGETS_SURROGATEESCAPE_X86
+        case Kernel::AVX2:
+            return encodeWith<Avx2Ascii>(str, len, output);
+        case Kernel::SSE2:
+            return encodeWith<Sse2Ascii>(str, len, output);
+#else
+        case Kernel::AVX2:
+        case Kernel::SSE2:
+#endif
+        case Kernel::Scalar:
+            break;
+    }
+    return encodeWith<ScalarAscii>(str, len, output);
+}
+
+}
+
+}
+
+namespace Misc {
+
+QString SurrogateEscape::decode(const QByteArray &data) {
+    return decode(data.constData(), data.length());
+}
+
+QString SurrogateEscape::decode(const char *data, int len) {
+    // Every byte of input results in at most one code unit of output.
+    QString text;
+    text.resize(len);
+    const int written = Private::SurrogateEscapeKernels::decode(Private::SurrogateEscapeKernels::selected(),
+                                                                data, len,
+                                                                reinterpret_cast<char16_t*>(text.data()));
+    text.resize(written);
+    if (written < len / 2) {
+        // mostly multi byte sequences, don't waste memory in long lived strings
+        text.squeeze();
     }
     return text;
 }
@@ -59,37 +389,37 @@ QByteArray SurrogateEscape::encode(const QString &str) {
 }
 
 QByteArray SurrogateEscape::encode(const QChar *str, int len) {
+    const char16_t *input = reinterpret_cast<const char16_t*>(str);
+    const auto kernel = Private::SurrogateEscapeKernels::selected();
+
+    // Most text is mostly ASCII, so start with one byte per code unit. That is exact for pure ASCII input.
     QByteArray data;
-    QTextCodec *codec = QTextCodec::codecForName("UTF-8");
-    QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
-    data = codec->fromUnicode(str, len, &state);
-
-    if (state.invalidChars || state.remainingChars) {
-        // contains invalid utf16, use slowpath for surrogate escape and other invalid code
-        data.resize(0);
-        for (int i = 0; i < len; i++) {
-            QChar ch = str[i];
-            if (ch.isSurrogate()) {
-                if (ch.isHighSurrogate() && i + 1 < len && str[i + 1].isLowSurrogate()) {
-                    data += codec->fromUnicode(str + i, 2);
-                    i++;
-                } else {
-                    if ((ch.unicode() & 0xff80) == 0xdc80) { // surrogate escape
-                        data.append((char)ch.unicode() & 0xff);
-                    } else { // invalid
-                        // output is utf-8, so use U+FFFD REPLACEMENT CHARACTER for conversion error.
-                        data.append("\357\277\275", 3);
-                    }
-                }
-            } else {
-                data += codec->fromUnicode(str + i, 1);
-            }
+    data.resize(len);
+    int i = Private::SurrogateEscapeKernels::encodeAscii(kernel, input, len, data.data());
+    int o = i;
+
+    // Every code unit results in at most 3 bytes of output. Convert the rest in pieces to avoid reserving 3 times
+    // the input size upfront.
+    while (i < len) {
+        int pieceLen = std::min(len - i, 16384);
+        if (i + pieceLen < len && str[i + pieceLen - 1].isHighSurrogate()) {
+            // keep surrogate pairs together
+            pieceLen += 1;
+        }
+        if (o + 3 * pieceLen > data.size()) {
+            data.resize(std::max(o + 3 * pieceLen, size2int(data.size() + data.size() / 2)));
         }
+        o += Private::SurrogateEscapeKernels::encode(kernel, input + i, pieceLen, data.data() + o);
+        i += pieceLen;
     }
 
+    data.resize(o);
+    if (o < data.capacity() / 2) {
+        data.squeeze();
+    }
     return data;
-
 }
+
 }
 
 TUIWIDGETS_NS_END
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_MISC_SURROGATEESCAPE_P_INCLUDED
+#define TUIWIDGETS_MISC_SURROGATEESCAPE_P_INCLUDED
+
+#include <Tui/tuiwidgets_internal.h>
+
+TUIWIDGETS_NS_START
+
+namespace Private {
+
+namespace SurrogateEscapeKernels {
+    enum class Kernel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    bool isSupported(Kernel kernel);
+    // The best supported kernel for the cpu the process runs on.
+    Kernel selected();
+
+    // `output` must have space for `len` code units. Returns the count of code units written.
+    int decode(Kernel kernel, const char *data, int len, char16_t *output);
+    // Converts only the ASCII prefix of `str`. `output` must have space for `len` bytes. Returns the length of
+    // the prefix.
+    int encodeAscii(Kernel kernel, const char16_t *str, int len, char *output);
+    // `output` must have space for 3 * `len` bytes. Returns the count of bytes written.
+    int encode(Kernel kernel, const char16_t *str, int len, char *output);
+}
+
+}
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_MISC_SURROGATEESCAPE_P_INCLUDED
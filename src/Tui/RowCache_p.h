@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_ROWCACHE_P_INCLUDED
+#define TUIWIDGETS_ROWCACHE_P_INCLUDED
+
+#include <algorithm>
+#include <utility>
+
+#include <QHash>
+
+#include <Tui/tuiwidgets_internal.h>
+
+TUIWIDGETS_NS_START
+
+// Per row data of an item view as needed for painting, keyed by row. Entries are kept valid by the model change
+// handlers of the view, so repainting does not need to query the model for rows that did not change.
+template <typename Row>
+class RowCache {
+public:
+    using iterator = typename QHash<int, Row>::iterator;
+
+    // The cache is trimmed to the rows around the visible area when it grows beyond this.
+    static constexpr int minRows = 256;
+
+public:
+    iterator find(int row) {
+        return rows.find(row);
+    }
+
+    iterator end() {
+        return rows.end();
+    }
+
+    iterator insert(int row, Row entry) {
+        return rows.insert(row, std::move(entry));
+    }
+
+    int size() const {
+        return rows.size();
+    }
+
+    void clear() {
+        rows.clear();
+    }
+
+    // Calls f for the cached entries of the rows first to last.
+    template <typename F>
+    void forEachInRange(int first, int last, F f) {
+        if (last - first + 1 > rows.size()) {
+            for (auto it = rows.begin(); it != rows.end(); ++it) {
+                if (it.key() >= first && it.key() <= last) {
+                    f(*it);
+                }
+            }
+        } else {
+            for (int row = first; row <= last; row++) {
+                auto it = rows.find(row);
+                if (it != rows.end()) {
+                    f(*it);
+                }
+            }
+        }
+    }
+
+    void removeRange(int first, int last) {
+        if (last - first + 1 > rows.size()) {
+            for (auto it = rows.begin(); it != rows.end();) {
+                if (it.key() >= first && it.key() <= last) {
+                    it = rows.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        } else {
+            for (int row = first; row <= last; row++) {
+                rows.remove(row);
+            }
+        }
+    }
+
+    // Moves entries for rows starting at first by delta rows.
+    void shift(int first, int delta) {
+        QHash<int, Row> shifted;
+        shifted.reserve(rows.size());
+        for (auto it = rows.begin(); it != rows.end(); ++it) {
+            if (it.key() >= first) {
+                shifted.insert(it.key() + delta, std::move(it.value()));
+            } else {
+                shifted.insert(it.key(), std::move(it.value()));
+            }
+        }
+        rows.swap(shifted);
+    }
+
+    // Keeps a page above and below the visible rows for scrolling. Rows before fixedRows are always displayed and
+    // thus always kept.
+    void trim(int firstVisibleRow, int visibleRows, int fixedRows = 0) {
+        if (rows.size() <= std::max(minRows, 4 * (fixedRows + visibleRows))) {
+            return;
+        }
+        const int keepFirst = firstVisibleRow - visibleRows;
+        const int keepLast = firstVisibleRow + 2 * visibleRows;
+        for (auto it = rows.begin(); it != rows.end();) {
+            if (it.key() >= fixedRows && (it.key() < keepFirst || it.key() > keepLast)) {
+                it = rows.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+private:
+    QHash<int, Row> rows;
+};
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_ROWCACHE_P_INCLUDED
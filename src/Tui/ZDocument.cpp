@@ -3,6 +3,9 @@
 #include <Tui/ZDocument.h>
 #include <Tui/ZDocument_p.h>
 
+#include <algorithm>
+
+#include <QThreadPool>
 #include <QTimer>
 
 #include <Tui/Utils_p.h>
@@ -32,7 +35,7 @@ const ZDocumentPrivate *ZDocumentPrivate::get(const ZDocument *doc) {
 ZDocument::ZDocument(QObject *parent) : QObject(parent), tuiwidgets_pimpl_ptr(std::make_unique<ZDocumentPrivate>(this)) {
     auto *const p = tuiwidgets_impl();
 
-    p->lines.append(LineData());
+    p->lines.append({QString(), p->lineRevisionCounter++, nullptr});
     p->initalUndoStep(0, 0);
 }
 
@@ -63,7 +66,7 @@ ZDocument::~ZDocument() {
 void ZDocument::reset() {
     auto *const p = tuiwidgets_impl();
     p->lines.clear();
-    p->lines.append(LineData());
+    p->lines.append({QString(), p->lineRevisionCounter++, nullptr});
 
     for (ZDocumentLineMarkerPrivate *marker = p->lineMarkerList.first; marker; marker = marker->markersList.next) {
         marker->pub()->setLine(0);
@@ -149,7 +152,7 @@ bool ZDocument::readFrom(QIODevice *file, ZDocumentCursor::Position initialPosit
                 // Some kind of error
                 // do some minimal recovery to avoid getting in a state that will just crash.
                 if (p->lines.isEmpty()) {
-                    p->lines.append(LineData());
+                    p->lines.append({QString(), p->lineRevisionCounter++, nullptr});
                 }
                 p->initalUndoStep(initialPosition.codeUnit, initialPosition.line);
                 return false;
@@ -168,11 +171,11 @@ bool ZDocument::readFrom(QIODevice *file, ZDocumentCursor::Position initialPosit
         }
 
         QString text = Misc::SurrogateEscape::decode(lineBuf.constData(), lineBytes);
-        p->lines.append({text, 0, nullptr});
+        p->lines.append({text, p->lineRevisionCounter++, nullptr});
     }
 
     if (p->lines.isEmpty()) {
-        p->lines.append({QStringLiteral(""), 0, nullptr});
+        p->lines.append({QStringLiteral(""), p->lineRevisionCounter++, nullptr});
         p->newlineAfterLastLineMissing = true;
     }
 
@@ -230,11 +233,11 @@ void ZDocument::setText(const QString &text, ZDocumentCursor::Position initialPo
     p->lines.clear();
 
     if (text.isEmpty()) {
-        p->lines.append({QStringLiteral(""), 0, nullptr});
+        p->lines.append({QStringLiteral(""), p->lineRevisionCounter++, nullptr});
         p->newlineAfterLastLineMissing = true;
     } else {
         for (QString line: text.split(QLatin1Char('\n'))) {
-            p->lines.append({line, 0, nullptr});
+            p->lines.append({line, p->lineRevisionCounter++, nullptr});
         }
 
         p->newlineAfterLastLineMissing = true;
@@ -328,6 +331,7 @@ ZDocumentSnapshot ZDocument::snapshot() const {
     ZDocumentSnapshot ret;
     auto *const retP = ZDocumentSnapshotPrivate::get(&ret);
     retP->lines = p->lines;
+    retP->newlineAfterLastLineMissing = p->newlineAfterLastLineMissing;
     retP->revision = *p->revision;
     retP->revisionShared = p->revision;
     return ret;
@@ -372,31 +376,27 @@ void ZDocument::clearCollapseUndoStep() {
 }
 
 void ZDocument::sortLines(int first, int last, ZDocumentCursor *cursorForUndoStep) {
+    sortLines(first, last, cursorForUndoStep, SortByCodeUnits);
+}
+
+void ZDocument::sortLines(int first, int last, ZDocumentCursor *cursorForUndoStep, SortMode mode) {
     auto *const p = tuiwidgets_impl();
     p->prepareModification(cursorForUndoStep->position());
 
     // We need to capture how lines got reordered to also adjust the cursor and line markers in the same pattern.
     // Basically this is std::stable_sort(_lines.begin() + first, _lines.begin() + last) but also capturing the reordering
 
-    std::vector<int> reorderBuffer;
-    reorderBuffer.resize(last - first);
-    for (int i = 0; i < last - first; i++) {
-        reorderBuffer[i] = first + i;
-    }
-
-    std::stable_sort(reorderBuffer.begin(), reorderBuffer.end(), [&](int lhs, int rhs) {
-        return p->lines[lhs].chars < p->lines[rhs].chars;
-    });
+    const std::vector<int> reorderBuffer = p->sortedLineOrder(first, last, mode, QThreadPool::globalInstance());
 
     std::vector<LineData> tmp;
     tmp.resize(last - first);
     for (int i = 0; i < last - first; i++) {
-        tmp[i] = p->lines[first + i];
+        tmp[i] = std::move(p->lines[first + i]);
     }
 
     // Apply reorderBuffer to _lines
     for (int i = 0; i < last - first; i++) {
-        p->lines[first + i] = tmp[reorderBuffer[i] - first];
+        p->lines[first + i] = std::move(tmp[reorderBuffer[i] - first]);
     }
 
     std::vector<int> reorderBufferInverted;
@@ -1350,9 +1350,129 @@ void ZDocumentPrivate::removeLines(ZDocumentCursor *cursor, int start, int count
     noteContentsChange();
 }
 
+namespace {
+    // Maps `pos` through `edits` (sorted by line and codeUnitStart, not overlapping). This matches applying each edit
+    // as removal followed by insertion: Positions in or at the end of a removed range move to its start and positions
+    // at the insertion point move behind the inserted text, unless they are the end of a selection.
+    ZDocumentCursor::Position mapPositionThroughLineEdits(const QVector<LineEdit> &edits,
+                                                         ZDocumentCursor::Position pos, bool selectionEnd) {
+        auto it = std::lower_bound(edits.begin(), edits.end(), pos.line, [](const LineEdit &edit, int line) {
+            return edit.line < line;
+        });
+        int shift = 0;
+        for (; it != edits.end() && it->line == pos.line; ++it) {
+            if (it->codeUnitStart + it->codeUnits < pos.codeUnit) {
+                shift += size2int(it->text.size()) - it->codeUnits;
+            } else if (it->codeUnitStart <= pos.codeUnit) {
+                return {it->codeUnitStart + shift + (selectionEnd ? 0 : size2int(it->text.size())), pos.line};
+            } else {
+                break;
+            }
+        }
+        return {pos.codeUnit + shift, pos.line};
+    }
+
+    void mapUndoCursorsThroughLineEdits(const QVector<LineEdit> &edits,
+                                        QVector<ZDocumentPrivate::UndoCursor> &cursors) {
+        for (ZDocumentPrivate::UndoCursor &cur: cursors) {
+            const bool anchorBefore = cur.anchor < cur.position;
+            const ZDocumentCursor::Position anchor = mapPositionThroughLineEdits(edits, cur.anchor,
+                                                                                 cur.hasSelection() && !anchorBefore);
+            const ZDocumentCursor::Position position = mapPositionThroughLineEdits(edits, cur.position,
+                                                                                   cur.hasSelection() && anchorBefore);
+            if (anchor != cur.anchor) {
+                cur.anchor = anchor;
+                cur.anchorUpdated = true;
+            }
+            if (position != cur.position) {
+                cur.position = position;
+                cur.positionUpdated = true;
+            }
+        }
+    }
+}
+
+// Applies all edits in one pass. Cursors are adjusted once for all edits instead of once per edit.
+// `edits` must be sorted by line and codeUnitStart and must not overlap.
+void ZDocumentPrivate::editLines(const QVector<LineEdit> &edits) {
+    // The same edits in reverse, in coordinates after the edits are applied.
+    QVector<LineEdit> inverted;
+    inverted.reserve(edits.size());
+
+    for (int i = 0; i < edits.size();) {
+        const int line = edits[i].line;
+        const QString &chars = lines[line].chars;
+        QString result;
+        int pos = 0;
+        int shift = 0;
+        for (; i < edits.size() && edits[i].line == line; i++) {
+            const LineEdit &edit = edits[i];
+            result.append(chars.constData() + pos, edit.codeUnitStart - pos);
+            inverted.append({line, edit.codeUnitStart + shift, size2int(edit.text.size()),
+                             chars.mid(edit.codeUnitStart, edit.codeUnits)});
+            result.append(edit.text);
+            shift += size2int(edit.text.size()) - edit.codeUnits;
+            pos = edit.codeUnitStart + edit.codeUnits;
+        }
+        result.append(chars.constData() + pos, size2int(chars.size()) - pos);
+        lines[line].chars = std::move(result);
+        lines[line].revision = lineRevisionCounter++;
+    }
+
+    for (ZDocumentCursorPrivate *curP = cursorList.first; curP; curP = curP->markersList.next) {
+        ZDocumentCursor *cur = curP->pub();
+
+        const ZDocumentCursor::Position anchor = cur->anchor();
+        const ZDocumentCursor::Position position = cur->position();
+        const bool hasSelection = anchor != position;
+        const bool anchorBefore = anchor < position;
+
+        const ZDocumentCursor::Position newAnchor = mapPositionThroughLineEdits(edits, anchor,
+                                                                                hasSelection && !anchorBefore);
+        const ZDocumentCursor::Position newPosition = mapPositionThroughLineEdits(edits, position,
+                                                                                  hasSelection && anchorBefore);
+
+        if (newAnchor != anchor) {
+            cur->setAnchorPosition(newAnchor);
+        }
+        if (newPosition != position) {
+            cur->setPosition(newPosition, true);
+        } else if (newAnchor != anchor) {
+            cur->setPositionPreservingVerticalMovementColumn(position, true);
+        }
+    }
+
+    debugConsistencyCheck(nullptr);
+
+    auto redoTransform = [edits](QVector<UndoCursor> &cursors, QVector<UndoLineMarker>&) {
+        mapUndoCursorsThroughLineEdits(edits, cursors);
+    };
+
+    auto undoTransform = [inverted](QVector<UndoCursor> &cursors, QVector<UndoLineMarker>&) {
+        mapUndoCursorsThroughLineEdits(inverted, cursors);
+    };
+
+    pendingUpdateStep.value().redoCursorAdjustments.push_back(redoTransform);
+    pendingUpdateStep.value().undoCursorAdjustments.prepend(undoTransform);
+
+    noteContentsChange();
+}
+
+void ZDocumentPrivate::applyLineEdits(ZDocumentCursor *cursor, const QVector<LineEdit> &edits, bool collapsable,
+                                      bool collapse) {
+    if (edits.isEmpty()) {
+        return;
+    }
+
+    auto undoGroup = startUndoGroup(cursor);
+    prepareModification(cursor->position());
+    editLines(edits);
+    saveUndoStep(cursor->position(), collapsable, collapse);
+}
+
 void ZDocumentPrivate::splitLine(ZDocumentCursor *cursor, ZDocumentCursor::Position pos) {
     lines[pos.line].revision = lineRevisionCounter++;
-    lines.insert(pos.line + 1, {lines[pos.line].chars.mid(pos.codeUnit), 0, nullptr});
+    lines.insert(pos.line + 1, {lines[pos.line].chars.mid(pos.codeUnit), lineRevisionCounter++, nullptr});
     lines[pos.line].chars.resize(pos.codeUnit);
 
     for (ZDocumentLineMarkerPrivate *marker = lineMarkerList.first; marker; marker = marker->markersList.next) {
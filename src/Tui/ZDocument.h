@@ -114,6 +114,13 @@ class TUIWIDGETS_EXPORT ZDocument : public QObject {
 
     using FindFlags = QFlags<FindFlag>;
 
+    enum SortMode : int {
+        SortByCodeUnits = 0,
+        SortCaseInsensitive = 1,
+        SortNumeric = 2,
+        SortLocaleAware = 3,
+    };
+
 public:
     explicit ZDocument(QObject *parent=nullptr);
     ~ZDocument() override;
@@ -149,7 +156,14 @@ class TUIWIDGETS_EXPORT ZDocument : public QObject {
 
     void clearCollapseUndoStep();
 
+    bool followFile(const QString &filename);
+    void stopFollowing();
+    bool isFollowing() const;
+    void setFollowMaxLines(int maxLines);
+    int followMaxLines() const;
+
     void sortLines(int first, int last, ZDocumentCursor *cursorForUndoStep);
+    void sortLines(int first, int last, ZDocumentCursor *cursorForUndoStep, SortMode mode);
     void moveLine(int from, int to, ZDocumentCursor *cursorForUndoStep);
     void debugConsistencyCheck(const ZDocumentCursor *exclude=nullptr) const;
 
@@ -9,6 +9,12 @@
 
 TUIWIDGETS_NS_START
 
+namespace {
+    // Code units layouted around the cursor for word movement. Movement that does not end inside falls back to the
+    // layout of the whole line.
+    constexpr int wordMovementLayoutWindow = 256;
+}
+
 ZDocumentCursorPrivate::ZDocumentCursorPrivate(ZDocumentCursor *pub, ZDocumentPrivate *doc,
                                                std::function<ZTextLayout(int line, bool wrappingAllowed)> createTextLayout)
     : doc(doc), createTextLayout(createTextLayout), pub_ptr(pub)
@@ -20,6 +26,10 @@ ZDocumentCursorPrivate::~ZDocumentCursorPrivate() {
     doc->unregisterTextCursor(this);
 }
 
+ZDocumentCursorPrivate *ZDocumentCursorPrivate::get(ZDocumentCursor *cursor) {
+    return cursor->tuiwidgets_impl();
+}
+
 
 ZDocumentCursor::ZDocumentCursor(ZDocument *doc,
                                  std::function<ZTextLayout(int line, bool wrappingAllowed)> createTextLayout)
@@ -33,6 +43,7 @@ ZDocumentCursor::ZDocumentCursor(const ZDocumentCursor &other)
 {
     auto *const p = tuiwidgets_impl();
     auto *const otherP = other.tuiwidgets_impl();
+    p->createTextLayoutWindow = otherP->createTextLayoutWindow;
     p->cursorCodeUnit = otherP->cursorCodeUnit;
     p->cursorLine = otherP->cursorLine;
     p->anchorCodeUnit = otherP->anchorCodeUnit;
@@ -54,6 +65,7 @@ ZDocumentCursor &ZDocumentCursor::operator=(const ZDocumentCursor &other) {
     }
 
     p->createTextLayout = otherP->createTextLayout;
+    p->createTextLayoutWindow = otherP->createTextLayoutWindow;
 
     if (p->cursorCodeUnit != otherP->cursorCodeUnit
         || p->cursorLine != otherP->cursorLine
@@ -100,7 +112,7 @@ void ZDocumentCursor::insertText(const QString &text) {
         p->scheduleChangeSignal();
     }
 
-    ZTextLayout lay = p->createTextLayout(p->cursorLine, true);
+    ZTextLayout lay = p->textLayoutForCodeUnits(p->cursorLine, true, p->cursorCodeUnit, p->cursorCodeUnit + 1);
     p->updateVerticalMovementColumn(lay);
 
     if (text.size()) {
@@ -125,11 +137,19 @@ void ZDocumentCursor::overwriteText(const QString &text, int clusterCount) {
         }
         const auto [currentCodeUnit, currentLine] = position();
         if (currentCodeUnit < p->doc->lines[currentLine].chars.size()) {
-            ZTextLayout lay = p->createTextLayout(p->cursorLine, false);
+            ZTextLayout lay = p->textLayoutForCodeUnits(currentLine, false, currentCodeUnit,
+                                                        currentCodeUnit + clusterCount);
             const Position start = {currentCodeUnit, currentLine};
-            Position end = {currentCodeUnit, currentLine};
-            for (int i = 0; i < clusterCount; i++) {
-                end = {lay.nextCursorPosition(end.codeUnit, ZTextLayout::SkipCharacters), end.line};
+            auto clustersEnd = [&] (const ZTextLayout &lay) {
+                Position end = {currentCodeUnit, currentLine};
+                for (int i = 0; i < clusterCount; i++) {
+                    end = {lay.nextCursorPosition(end.codeUnit, ZTextLayout::SkipCharacters), end.line};
+                }
+                return end;
+            };
+            Position end = clustersEnd(lay);
+            if (!ZDocumentCursorPrivate::layoutCovers(lay, end.codeUnit)) {
+                end = clustersEnd(p->createTextLayout(currentLine, false));
             }
             p->doc->removeFromLine(this, start.line, start.codeUnit, end.codeUnit - start.codeUnit);
         }
@@ -257,9 +277,13 @@ void ZDocumentCursor::moveCharacterLeft(bool extendSelection) {
     auto *const p = tuiwidgets_impl();
     const auto [currentCodeUnit, currentLine] = position();
     if (currentCodeUnit) {
-        ZTextLayout lay = p->createTextLayout(p->cursorLine, false);
-        setPosition({lay.previousCursorPosition(currentCodeUnit, ZTextLayout::SkipCharacters), currentLine},
-                    extendSelection);
+        ZTextLayout lay = p->textLayoutForCodeUnits(currentLine, false, currentCodeUnit - 1, currentCodeUnit);
+        int codeUnit = lay.previousCursorPosition(currentCodeUnit, ZTextLayout::SkipCharacters);
+        if (!ZDocumentCursorPrivate::layoutCovers(lay, codeUnit)) {
+            codeUnit = p->createTextLayout(currentLine, false).previousCursorPosition(currentCodeUnit,
+                                                                                      ZTextLayout::SkipCharacters);
+        }
+        setPosition({codeUnit, currentLine}, extendSelection);
     } else if (currentLine > 0) {
         setPosition({size2int(p->doc->lines[currentLine - 1].chars.size()), currentLine - 1}, extendSelection);
     } else {
@@ -272,9 +296,13 @@ void ZDocumentCursor::moveCharacterRight(bool extendSelection) {
     auto *const p = tuiwidgets_impl();
     const auto [currentCodeUnit, currentLine] = position();
     if (currentCodeUnit < p->doc->lines[currentLine].chars.size()) {
-        ZTextLayout lay = p->createTextLayout(p->cursorLine, false);
-        setPosition({lay.nextCursorPosition(currentCodeUnit, ZTextLayout::SkipCharacters), currentLine},
-                    extendSelection);
+        ZTextLayout lay = p->textLayoutForCodeUnits(currentLine, false, currentCodeUnit, currentCodeUnit + 1);
+        int codeUnit = lay.nextCursorPosition(currentCodeUnit, ZTextLayout::SkipCharacters);
+        if (!ZDocumentCursorPrivate::layoutCovers(lay, codeUnit)) {
+            codeUnit = p->createTextLayout(currentLine, false).nextCursorPosition(currentCodeUnit,
+                                                                                  ZTextLayout::SkipCharacters);
+        }
+        setPosition({codeUnit, currentLine}, extendSelection);
     } else if (currentLine + 1 < p->doc->lines.size()) {
         setPosition({0, currentLine + 1}, extendSelection);
     } else {
@@ -287,9 +315,15 @@ void ZDocumentCursor::moveWordLeft(bool extendSelection) {
     auto *const p = tuiwidgets_impl();
     const auto [currentCodeUnit, currentLine] = position();
     if (currentCodeUnit) {
-        ZTextLayout lay = p->createTextLayout(p->cursorLine, false);
-        setPosition({lay.previousCursorPosition(currentCodeUnit, ZTextLayout::SkipWords), currentLine},
-                    extendSelection);
+        ZTextLayout lay = p->textLayoutForCodeUnits(currentLine, false,
+                                                    std::max(0, currentCodeUnit - wordMovementLayoutWindow),
+                                                    currentCodeUnit);
+        int codeUnit = lay.previousCursorPosition(currentCodeUnit, ZTextLayout::SkipWords);
+        if (!ZDocumentCursorPrivate::layoutCovers(lay, codeUnit)) {
+            codeUnit = p->createTextLayout(currentLine, false).previousCursorPosition(currentCodeUnit,
+                                                                                      ZTextLayout::SkipWords);
+        }
+        setPosition({codeUnit, currentLine}, extendSelection);
     } else if (currentLine > 0) {
         setPosition({size2int(p->doc->lines[currentLine - 1].chars.size()), currentLine - 1}, extendSelection);
     } else {
@@ -302,9 +336,14 @@ void ZDocumentCursor::moveWordRight(bool extendSelection) {
     auto *const p = tuiwidgets_impl();
     const auto [currentCodeUnit, currentLine] = position();
     if (currentCodeUnit < p->doc->lines[currentLine].chars.size()) {
-        ZTextLayout lay = p->createTextLayout(p->cursorLine, false);
-        setPosition({lay.nextCursorPosition(currentCodeUnit, ZTextLayout::SkipWords), currentLine},
-                    extendSelection);
+        ZTextLayout lay = p->textLayoutForCodeUnits(currentLine, false, currentCodeUnit,
+                                                    currentCodeUnit + wordMovementLayoutWindow);
+        int codeUnit = lay.nextCursorPosition(currentCodeUnit, ZTextLayout::SkipWords);
+        if (!ZDocumentCursorPrivate::layoutCovers(lay, codeUnit)) {
+            codeUnit = p->createTextLayout(currentLine, false).nextCursorPosition(currentCodeUnit,
+                                                                                  ZTextLayout::SkipWords);
+        }
+        setPosition({codeUnit, currentLine}, extendSelection);
     } else if (currentLine + 1 < p->doc->lines.size()) {
         setPosition({0, currentLine + 1}, extendSelection);
     } else {
@@ -317,7 +356,7 @@ void ZDocumentCursor::moveUp(bool extendSelection) {
     auto *const p = tuiwidgets_impl();
     const auto [currentCodeUnit, currentLine] = position();
 
-    ZTextLayout layStarting = p->createTextLayout(currentLine, true);
+    ZTextLayout layStarting = p->textLayoutForCodeUnits(currentLine, true, currentCodeUnit, currentCodeUnit + 1);
     ZTextLineRef lineStarting = layStarting.lineForTextPosition(currentCodeUnit);
 
     if (lineStarting.lineNumber() > 0) {
@@ -333,7 +372,8 @@ void ZDocumentCursor::moveUp(bool extendSelection) {
     }
 
     if (currentLine > 0) {
-        ZTextLayout lay = p->createTextLayout(currentLine - 1, true);
+        ZTextLayout lay = p->textLayoutForColumns(currentLine - 1, true, p->verticalMovementColumn,
+                                                  p->verticalMovementColumn + 1);
         ZTextLineRef la = lay.lineAt(lay.lineCount() - 1);
         setPositionPreservingVerticalMovementColumn({la.xToCursor(p->verticalMovementColumn), currentLine - 1},
                                                     extendSelection);
@@ -346,7 +386,7 @@ void ZDocumentCursor::moveDown(bool extendSelection) {
     auto *const p = tuiwidgets_impl();
     const auto [currentCodeUnit, currentLine] = position();
 
-    ZTextLayout layStarting = p->createTextLayout(currentLine, true);
+    ZTextLayout layStarting = p->textLayoutForCodeUnits(currentLine, true, currentCodeUnit, currentCodeUnit + 1);
     ZTextLineRef lineStarting = layStarting.lineForTextPosition(currentCodeUnit);
 
     if (lineStarting.lineNumber() + 1 < layStarting.lineCount()) {
@@ -362,7 +402,8 @@ void ZDocumentCursor::moveDown(bool extendSelection) {
     }
 
     if (currentLine < p->doc->lines.size() - 1) {
-        ZTextLayout lay = p->createTextLayout(currentLine + 1, true);
+        ZTextLayout lay = p->textLayoutForColumns(currentLine + 1, true, p->verticalMovementColumn,
+                                                  p->verticalMovementColumn + 1);
         ZTextLineRef la = lay.lineAt(0);
         setPositionPreservingVerticalMovementColumn({la.xToCursor(p->verticalMovementColumn), currentLine + 1},
                                                     extendSelection);
@@ -415,7 +456,7 @@ ZDocumentCursor::Position ZDocumentCursor::position() const {
 void ZDocumentCursor::setPosition(ZDocumentCursor::Position pos, bool extendSelection) {
     auto *const p = tuiwidgets_impl();
     setPositionPreservingVerticalMovementColumn(pos, extendSelection);
-    ZTextLayout lay = p->createTextLayout(p->cursorLine, true);
+    ZTextLayout lay = p->textLayoutForCodeUnits(p->cursorLine, true, p->cursorCodeUnit, p->cursorCodeUnit + 1);
     p->updateVerticalMovementColumn(lay);
 }
 
@@ -426,7 +467,7 @@ void ZDocumentCursor::setPositionPreservingVerticalMovementColumn(ZDocumentCurso
 
     // We are not allowed to jump between characters. Therefore, we go once to the left and again to the right.
     if (cursorCodeUnit > 0) {
-        ZTextLayout lay = p->createTextLayout(cursorLine, false);
+        ZTextLayout lay = p->textLayoutForCodeUnits(cursorLine, false, cursorCodeUnit - 1, cursorCodeUnit);
         cursorCodeUnit = lay.previousCursorPosition(cursorCodeUnit, ZTextLayout::SkipCharacters);
         cursorCodeUnit = lay.nextCursorPosition(cursorCodeUnit, ZTextLayout::SkipCharacters);
     }
@@ -456,7 +497,7 @@ void ZDocumentCursor::setAnchorPosition(ZDocumentCursor::Position pos) {
 
     // We are not allowed to jump between characters. Therefore, we go once to the left and again to the right.
     if (anchorCodeUnit > 0) {
-        ZTextLayout lay = p->createTextLayout(anchorLine, false);
+        ZTextLayout lay = p->textLayoutForCodeUnits(anchorLine, false, anchorCodeUnit - 1, anchorCodeUnit);
         anchorCodeUnit = lay.previousCursorPosition(anchorCodeUnit, ZTextLayout::SkipCharacters);
         anchorCodeUnit = lay.nextCursorPosition(anchorCodeUnit, ZTextLayout::SkipCharacters);
     }
@@ -527,6 +568,30 @@ void ZDocumentCursorPrivate::updateVerticalMovementColumn(const ZTextLayout &lay
     verticalMovementColumn = tlr.cursorToX(cursorCodeUnit, ZTextLayout::Leading);
 }
 
+ZTextLayout ZDocumentCursorPrivate::textLayoutForCodeUnits(int line, bool wrappingAllowed, int start, int end) {
+    if (createTextLayoutWindow) {
+        return createTextLayoutWindow(line, wrappingAllowed, false, start, end);
+    }
+    return createTextLayout(line, wrappingAllowed);
+}
+
+ZTextLayout ZDocumentCursorPrivate::textLayoutForColumns(int line, bool wrappingAllowed, int start, int end) {
+    if (createTextLayoutWindow) {
+        return createTextLayoutWindow(line, wrappingAllowed, true, start, end);
+    }
+    return createTextLayout(line, wrappingAllowed);
+}
+
+bool ZDocumentCursorPrivate::layoutCovers(const ZTextLayout &lay, int pos) {
+    if (lay.lineCount() != 1) {
+        return true;
+    }
+    // Partial layouts start and end at cluster boundaries, positions found by movement inside them are valid up to
+    // and including these boundaries. Movement that left the layouted part ends outside of it.
+    const ZTextLineRef line = lay.lineAt(0);
+    return pos >= line.textStart() && pos <= line.textStart() + line.textLength();
+}
+
 void ZDocumentCursorPrivate::scheduleChangeSignal() {
     changed = true;
     doc->scheduleChangeSignals();
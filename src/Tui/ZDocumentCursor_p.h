@@ -18,10 +18,20 @@ class ZDocumentCursorPrivate {
                            std::function<ZTextLayout(int line, bool wrappingAllowed)> createTextLayout);
     ~ZDocumentCursorPrivate();
 
+public:
+    static ZDocumentCursorPrivate *get(ZDocumentCursor *cursor);
+
 public:
     void updateVerticalMovementColumn(const ZTextLayout &layoutForCursorLine);
     void scheduleChangeSignal();
 
+    // Layout of line that only needs to be valid for the code units (or columns) in [start, end).
+    ZTextLayout textLayoutForCodeUnits(int line, bool wrappingAllowed, int start, int end);
+    ZTextLayout textLayoutForColumns(int line, bool wrappingAllowed, int start, int end);
+    // Returns false if lay only covers a part of its line and pos is outside of that part. Cursor movement results
+    // outside of that part are not valid and need to be computed again with the layout of the whole line.
+    static bool layoutCovers(const ZTextLayout &lay, int pos);
+
 public:
     int cursorCodeUnit = 0;
     int cursorLine = 0;
@@ -31,6 +41,10 @@ class ZDocumentCursorPrivate {
 
     ZDocumentPrivate *doc;
     std::function<ZTextLayout(int line, bool wrappingAllowed)> createTextLayout;
+    // Optional, set by widgets that can layout a part of a long line without layouting everything before it
+    // (ZTextEdit). Returns a layout of line that is valid for the code units (or columns if byColumn is set) in
+    // [start, end) and the clusters containing them, or a layout of the whole line like createTextLayout.
+    std::function<ZTextLayout(int line, bool wrappingAllowed, bool byColumn, int start, int end)> createTextLayoutWindow;
 
 public: // For use by Document
     ListNode<ZDocumentCursorPrivate> markersList;
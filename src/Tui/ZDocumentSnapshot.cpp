@@ -3,8 +3,92 @@
 #include <Tui/ZDocumentSnapshot.h>
 #include <Tui/ZDocumentSnapshot_p.h>
 
+#include <QFutureInterface>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
+
+#include <Tui/Misc/SurrogateEscape.h>
+
 TUIWIDGETS_NS_START
 
+namespace {
+    // Lines are collected into chunks of about this many code units before encoding and writing, so that
+    // large documents are written with few large write calls instead of one or two per line.
+    constexpr int saveChunkCodeUnits = 512 * 1024;
+
+    class SaveOnThread : public QRunnable {
+    public:
+        void run() override {
+            if (promise.isCanceled()) {
+                promise.reportFinished();
+                return;
+            }
+
+            promise.reportResult(save());
+            promise.reportFinished();
+        }
+
+    private:
+        bool save() {
+            const auto *const p = ZDocumentSnapshotPrivate::get(&snap);
+            const int lineCount = p->lines.size();
+
+            promise.setProgressRange(0, lineCount);
+            promise.setProgressValue(0);
+
+            // QSaveFile writes into a temporary file and only replaces the target file on commit, so a failed or
+            // canceled save never leaves a truncated file behind.
+            QSaveFile file(filename);
+            if (!file.open(QIODevice::WriteOnly)) {
+                return false;
+            }
+
+            const QString newline = crLfMode ? QStringLiteral("\r\n") : QStringLiteral("\n");
+
+            QString chunk;
+            chunk.reserve(saveChunkCodeUnits + 1024);
+
+            int i = 0;
+            while (i < lineCount) {
+                chunk.resize(0);
+                while (i < lineCount && chunk.size() < saveChunkCodeUnits) {
+                    chunk += p->lines[i].chars;
+                    if (i + 1 == lineCount && p->newlineAfterLastLineMissing) {
+                        // omit newline
+                    } else {
+                        chunk += newline;
+                    }
+                    i++;
+                }
+
+                // Each line apart from the last is terminated by a newline, so joining lines can not create new
+                // surrogate pairs and encoding the whole chunk yields the same bytes as encoding line by line.
+                const QByteArray converted = Misc::SurrogateEscape::encode(chunk);
+                if (file.write(converted) != converted.size()) {
+                    file.cancelWriting();
+                    return false;
+                }
+
+                promise.setProgressValue(i);
+
+                if (promise.isCanceled()) {
+                    file.cancelWriting();
+                    return false;
+                }
+            }
+
+            return file.commit();
+        }
+
+    public:
+        QFutureInterface<bool> promise;
+        ZDocumentSnapshot snap;
+        QString filename;
+        bool crLfMode = false;
+    };
+}
+
 ZDocumentSnapshotPrivate *ZDocumentSnapshotPrivate::get(ZDocumentSnapshot *doc) {
     return doc->tuiwidgets_impl();
 }
@@ -48,6 +132,10 @@ std::shared_ptr<ZDocumentLineUserData> ZDocumentSnapshot::lineUserData(int line)
     return tuiwidgets_impl()->lines[line].userData;
 }
 
+bool ZDocumentSnapshot::newlineAfterLastLineMissing() const {
+    return tuiwidgets_impl()->newlineAfterLastLineMissing;
+}
+
 unsigned ZDocumentSnapshot::revision() const {
     return tuiwidgets_impl()->revision;
 }
@@ -56,4 +144,27 @@ bool ZDocumentSnapshot::isUpToDate() const {
     return tuiwidgets_impl()->revision == tuiwidgets_impl()->revisionShared->load(std::memory_order_relaxed);
 }
 
+QFuture<bool> ZDocumentSnapshot::writeToFileAsync(const QString &filename, bool crLfMode) const {
+    return writeToFileAsyncWithPool(QThreadPool::globalInstance(), 0, filename, crLfMode);
+}
+
+QFuture<bool> ZDocumentSnapshot::writeToFileAsyncWithPool(QThreadPool *pool, int priority,
+                                                          const QString &filename, bool crLfMode) const {
+    QFutureInterface<bool> promise;
+
+    QFuture<bool> future = promise.future();
+
+    promise.reportStarted();
+
+    SaveOnThread *runnable = new SaveOnThread();
+    runnable->snap = *this;
+    runnable->filename = filename;
+    runnable->crLfMode = crLfMode;
+    runnable->promise = std::move(promise);
+
+    pool->start(runnable, priority);
+
+    return future;
+}
+
 TUIWIDGETS_NS_END
@@ -5,6 +5,7 @@
 
 #include <memory>
 
+#include <QFuture>
 #include <QVector>
 
 #include <Tui/ZDocument.h>
@@ -29,9 +30,15 @@ class TUIWIDGETS_EXPORT ZDocumentSnapshot {
     unsigned lineRevision(int line) const;
     std::shared_ptr<ZDocumentLineUserData> lineUserData(int line) const;
 
+    bool newlineAfterLastLineMissing() const;
+
     unsigned revision() const;
     bool isUpToDate() const;
 
+    QFuture<bool> writeToFileAsync(const QString &filename, bool crLfMode = false) const;
+    QFuture<bool> writeToFileAsyncWithPool(QThreadPool *pool, int priority,
+                                           const QString &filename, bool crLfMode = false) const;
+
 private:
     TUIWIDGETS_DECLARE_PRIVATE(ZDocumentSnapshot)
     std::shared_ptr<ZDocumentSnapshotPrivate> tuiwidgets_pimpl_ptr;
@@ -15,6 +15,7 @@ class ZDocumentSnapshotPrivate {
 public:
     unsigned revision = -1;
     QVector<LineData> lines;
+    bool newlineAfterLastLineMissing = false;
     std::shared_ptr<std::atomic<unsigned>> revisionShared;
 };
 
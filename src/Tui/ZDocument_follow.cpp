@@ -0,0 +1,366 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZDocument.h>
+#include <Tui/ZDocument_p.h>
+
+#include <algorithm>
+#include <string.h>
+
+#include <sys/stat.h>
+
+#include <QFileInfo>
+#include <QTimer>
+
+#include <Tui/Misc/SurrogateEscape.h>
+#include <Tui/ZDocumentCursor_p.h>
+#include <Tui/ZDocumentLineMarker.h>
+#include <Tui/ZDocumentLineMarker_p.h>
+
+#include <Tui/Utils_p.h>
+
+TUIWIDGETS_NS_START
+
+
+namespace {
+    // Upper limit of data read per event loop iteration. When catching up with a quickly growing file, reading
+    // continues in the next iteration so the application stays responsive.
+    constexpr qint64 followChunkBytes = 4 * 1024 * 1024;
+
+    // Interval to retry reading while an undo group is open.
+    constexpr int followRetryIntervalMs = 50;
+
+    // Number of bytes before the read position compared on each read to detect rewritten files.
+    constexpr qint64 followTailBytes = 64;
+}
+
+bool ZDocument::followFile(const QString &filename) {
+    auto *const p = tuiwidgets_impl();
+    stopFollowing();
+
+    auto follow = std::make_unique<ZDocumentFollowState>();
+    follow->file.setFileName(filename);
+    if (!follow->file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    if (!readFrom(&follow->file)) {
+        return false;
+    }
+
+    p->follow = std::move(follow);
+    p->followUpdateFileIdentity();
+    p->followRememberTail();
+
+    bool changed = false;
+
+    // The last line is only added to the document when it is complete.
+    if (p->newlineAfterLastLineMissing && (p->lines.size() > 1 || p->lines[0].chars.size())) {
+        p->follow->partialLine = Misc::SurrogateEscape::encode(p->lines.last().chars);
+        // avoid copying all lines, the undo history is recreated below anyway.
+        p->undoSteps.clear();
+        if (p->lines.size() == 1) {
+            p->lines[0].chars.clear();
+            p->lines[0].revision = p->lineRevisionCounter++;
+        } else {
+            p->lines.removeLast();
+            p->newlineAfterLastLineMissing = false;
+        }
+        // readFrom moved all cursors and line markers to the first line, so they are still valid.
+        changed = true;
+    }
+
+    // The line ending mode of readFrom is based on complete lines only.
+    p->follow->lineEndingKnown = !p->newlineAfterLastLineMissing;
+
+    if (p->followMaxLines > 0 && p->lines.size() > p->followMaxLines) {
+        p->undoSteps.clear();
+        p->followDropLinesFromTop();
+        changed = true;
+    }
+
+    if (changed) {
+        p->initalUndoStep(0, 0);
+        debugConsistencyCheck(nullptr);
+        p->noteContentsChange();
+    }
+
+    // Watching the directory too allows to pick up the file again after it was replaced, e.g. by log rotation.
+    p->follow->watcher.addPath(filename);
+    p->follow->watcher.addPath(QFileInfo(filename).absolutePath());
+    QObject::connect(&p->follow->watcher, &QFileSystemWatcher::fileChanged, this, [p] {
+        p->followScheduleRead();
+    });
+    QObject::connect(&p->follow->watcher, &QFileSystemWatcher::directoryChanged, this, [p] {
+        p->followScheduleRead();
+    });
+
+    return true;
+}
+
+void ZDocument::stopFollowing() {
+    auto *const p = tuiwidgets_impl();
+    p->follow.reset();
+}
+
+bool ZDocument::isFollowing() const {
+    auto *const p = tuiwidgets_impl();
+    return p->follow != nullptr;
+}
+
+void ZDocument::setFollowMaxLines(int maxLines) {
+    auto *const p = tuiwidgets_impl();
+    p->followMaxLines = std::max(0, maxLines);
+
+    if (p->follow && p->followMaxLines > 0 && p->lines.size() > p->followMaxLines
+            && !p->groupUndo && !p->pendingUpdateStep) {
+        p->undoSteps.clear();
+        p->followDropLinesFromTop();
+        p->initalUndoStep(0, 0);
+        debugConsistencyCheck(nullptr);
+        p->noteContentsChange();
+    }
+}
+
+int ZDocument::followMaxLines() const {
+    auto *const p = tuiwidgets_impl();
+    return p->followMaxLines;
+}
+
+void ZDocumentPrivate::followScheduleRead() {
+    if (!follow || follow->readScheduled) {
+        return;
+    }
+    follow->readScheduled = true;
+    // File change notifications often come in bursts, this reads once for all pending notifications.
+    QTimer::singleShot(0, pub(), [this] {
+        if (follow) {
+            follow->readScheduled = false;
+            followRead();
+        }
+    });
+}
+
+void ZDocumentPrivate::followRead() {
+    if (groupUndo || pendingUpdateStep) {
+        // Appending restarts the undo history, which can not be done while an undo group is open.
+        follow->readScheduled = true;
+        QTimer::singleShot(followRetryIntervalMs, pub(), [this] {
+            if (follow) {
+                follow->readScheduled = false;
+                followRead();
+            }
+        });
+        return;
+    }
+
+    // Data of an incomplete last line is kept when the file is replaced or truncated, so whatever is written
+    // next continues that line.
+    const QString filename = follow->file.fileName();
+    struct stat st;
+    if (stat(QFile::encodeName(filename).constData(), &st) == 0) {
+        if (static_cast<quint64>(st.st_dev) != follow->device || static_cast<quint64>(st.st_ino) != follow->inode) {
+            // The file name now refers to a different file. Take what was written to the old file, then continue
+            // with the new file from its start.
+            if (follow->file.isOpen()) {
+                followIngest(follow->file.readAll());
+                follow->file.close();
+            }
+            follow->tail.clear();
+            if (!follow->file.open(QIODevice::ReadOnly)) {
+                // retried on the next change notification
+                follow->device = 0;
+                follow->inode = 0;
+                return;
+            }
+            followUpdateFileIdentity();
+        } else if (follow->file.isOpen() && followFileWasTruncated(static_cast<qint64>(st.st_size))) {
+            // The file was truncated (and maybe has grown again since), continue from its start.
+            follow->file.seek(0);
+            follow->tail.clear();
+        }
+
+        // QFileSystemWatcher drops files that are removed or replaced.
+        if (!follow->watcher.files().contains(filename)) {
+            follow->watcher.addPath(filename);
+        }
+    }
+
+    if (!follow->file.isOpen()) {
+        return;
+    }
+
+    const QByteArray data = follow->file.read(followChunkBytes);
+    if (data.size() == followChunkBytes) {
+        followScheduleRead();
+    }
+    if (data.size()) {
+        follow->tail = (follow->tail + data).right(followTailBytes);
+    }
+    followIngest(data);
+}
+
+bool ZDocumentPrivate::followFileWasTruncated(qint64 size) {
+    const qint64 pos = follow->file.pos();
+    if (size < pos) {
+        return true;
+    }
+    if (follow->tail.isEmpty()) {
+        return false;
+    }
+    // Truncating and writing more than before between two reads keeps the size above the read position,
+    // but the bytes before it most likely differ.
+    if (!follow->file.seek(pos - follow->tail.size())) {
+        return true;
+    }
+    const QByteArray current = follow->file.read(follow->tail.size());
+    follow->file.seek(pos);
+    return current != follow->tail;
+}
+
+void ZDocumentPrivate::followRememberTail() {
+    const qint64 pos = follow->file.pos();
+    const qint64 size = std::min(pos, followTailBytes);
+    follow->tail.clear();
+    if (size > 0 && follow->file.seek(pos - size)) {
+        follow->tail = follow->file.read(size);
+    }
+    follow->file.seek(pos);
+}
+
+void ZDocumentPrivate::followUpdateFileIdentity() {
+    struct stat st;
+    if (fstat(follow->file.handle(), &st) == 0) {
+        follow->device = static_cast<quint64>(st.st_dev);
+        follow->inode = static_cast<quint64>(st.st_ino);
+    } else {
+        follow->device = 0;
+        follow->inode = 0;
+    }
+}
+
+void ZDocumentPrivate::followIngest(const QByteArray &data) {
+    if (data.isEmpty()) {
+        return;
+    }
+
+    follow->partialLine += data;
+    const int lastNewline = size2int(follow->partialLine.lastIndexOf('\n'));
+    if (lastNewline < 0) {
+        return;
+    }
+    followAppendLines(follow->partialLine.constData(), lastNewline + 1);
+    follow->partialLine.remove(0, lastNewline + 1);
+}
+
+// Appends the lines in data, which ends with a line break.
+// This does not create an undo step, instead the undo history is restarted.
+void ZDocumentPrivate::followAppendLines(const char *data, int size) {
+    if (size == 0) {
+        return;
+    }
+
+    // Release the undo history's reference to the lines first, otherwise appending would copy all lines.
+    undoSteps.clear();
+
+    // Same line ending detection as in readFrom: CRLF mode only if all lines end with \r\n.
+    bool allLinesCrLf = true;
+    for (int start = 0; start < size && allLinesCrLf;) {
+        const char *newline = static_cast<const char*>(memchr(data + start, '\n', size - start));
+        const int end = newline ? static_cast<int>(newline - data) : size;
+        allLinesCrLf = end > start && data[end - 1] == '\r';
+        start = end + 1;
+    }
+    if (!follow->lineEndingKnown) {
+        follow->lineEndingKnown = true;
+        pub()->setCrLfMode(allLinesCrLf);
+    } else if (crLfMode && !allLinesCrLf) {
+        // Not all lines end with \r\n anymore, put the \r back into the existing lines.
+        const int completeLines = size2int(lines.size()) - (newlineAfterLastLineMissing ? 1 : 0);
+        for (int i = 0; i < completeLines; i++) {
+            lines[i].chars.append(QLatin1Char('\r'));
+            lines[i].revision = lineRevisionCounter++;
+        }
+        pub()->setCrLfMode(false);
+    }
+
+    const bool wasEmpty = lines.size() == 1 && newlineAfterLastLineMissing && lines[0].chars.isEmpty();
+
+    // Cursors without selection at the end of the document follow the appended lines.
+    const ZDocumentCursor::Position oldEnd = {size2int(lines.last().chars.size()), size2int(lines.size()) - 1};
+    QVector<ZDocumentCursor*> followingCursors;
+    for (ZDocumentCursorPrivate *curP = cursorList.first; curP; curP = curP->markersList.next) {
+        ZDocumentCursor *cur = curP->pub();
+        if (!cur->hasSelection() && cur->position() == oldEnd) {
+            followingCursors.append(cur);
+        }
+    }
+
+    if (wasEmpty) {
+        lines.clear();
+    }
+
+    lines.reserve(lines.size() + size2int(std::count(data, data + size, '\n')) + 1);
+
+    int start = 0;
+    while (start < size) {
+        const char *newline = static_cast<const char*>(memchr(data + start, '\n', size - start));
+        const int end = newline ? static_cast<int>(newline - data) : size;
+        int lineBytes = end - start;
+        if (crLfMode && lineBytes > 0 && data[end - 1] == '\r') {
+            --lineBytes;
+        }
+
+        LineData line;
+        line.chars = Misc::SurrogateEscape::decode(data + start, lineBytes);
+        line.revision = lineRevisionCounter++;
+        lines.append(std::move(line));
+
+        start = end + 1;
+    }
+    newlineAfterLastLineMissing = false;
+
+    followDropLinesFromTop();
+
+    const ZDocumentCursor::Position newEnd = {size2int(lines.last().chars.size()), size2int(lines.size()) - 1};
+    for (ZDocumentCursor *cur: followingCursors) {
+        cur->setPosition(newEnd);
+    }
+
+    initalUndoStep(newEnd.codeUnit, newEnd.line);
+
+    pub()->debugConsistencyCheck(nullptr);
+
+    noteContentsChange();
+}
+
+void ZDocumentPrivate::followDropLinesFromTop() {
+    if (followMaxLines <= 0 || lines.size() <= followMaxLines) {
+        return;
+    }
+
+    const int count = size2int(lines.size()) - followMaxLines;
+    lines.remove(0, count);
+
+    for (ZDocumentLineMarkerPrivate *marker = lineMarkerList.first; marker; marker = marker->markersList.next) {
+        marker->pub()->setLine(std::max(0, marker->pub()->line() - count));
+    }
+
+    for (ZDocumentCursorPrivate *curP = cursorList.first; curP; curP = curP->markersList.next) {
+        ZDocumentCursor *cur = curP->pub();
+
+        const auto [anchorCodeUnit, anchorLine] = cur->anchor();
+        if (anchorLine >= count) {
+            cur->setAnchorPosition({anchorCodeUnit, anchorLine - count});
+        } else {
+            cur->setAnchorPosition({0, 0});
+        }
+
+        const auto [cursorCodeUnit, cursorLine] = cur->position();
+        if (cursorLine >= count) {
+            cur->setPositionPreservingVerticalMovementColumn({cursorCodeUnit, cursorLine - count}, true);
+        } else {
+            cur->setPositionPreservingVerticalMovementColumn({0, 0}, true);
+        }
+    }
+}
+
+TUIWIDGETS_NS_END
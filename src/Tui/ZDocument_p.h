@@ -5,8 +5,13 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
+#include <QByteArray>
+#include <QFile>
+#include <QFileSystemWatcher>
 #include <QString>
+#include <QThreadPool>
 #include <QVector>
 
 #include <Tui/ListNode_p.h>
@@ -28,6 +33,15 @@ struct LineData {
     std::shared_ptr<ZDocumentLineUserData> userData;
 };
 
+// Replaces `codeUnits` code units starting at `codeUnitStart` in `line` with `text`.
+// `text` must not contain line breaks.
+struct LineEdit {
+    int line = 0;
+    int codeUnitStart = 0;
+    int codeUnits = 0;
+    QString text;
+};
+
 class ZDocumentFindAsyncResultPrivate {
 public:
     ZDocumentFindAsyncResultPrivate();
@@ -61,6 +75,22 @@ class ZDocumentUndoGroupPrivate {
     bool _closed = false;
 };
 
+class ZDocumentFollowState {
+public:
+    QFile file;
+    // identity of the open file, to detect that the file name now refers to a different file
+    quint64 device = 0;
+    quint64 inode = 0;
+    QFileSystemWatcher watcher;
+    // bytes after the last complete line
+    QByteArray partialLine;
+    // the last bytes read, to detect that the file was truncated and has grown again since the last read
+    QByteArray tail;
+    // false until the first complete line was seen, the line ending mode is detected from it
+    bool lineEndingKnown = false;
+    bool readScheduled = false;
+};
+
 class ZDocumentPrivate {
 public:
     struct UndoCursor {
@@ -110,6 +140,9 @@ class ZDocumentPrivate {
     void removeLines(ZDocumentCursor *cursor, int start, int count);
     void splitLine(ZDocumentCursor *cursor, ZDocumentCursor::Position pos);
     void mergeLines(ZDocumentCursor *cursor, int line);
+    void editLines(const QVector<LineEdit> &edits);
+    void applyLineEdits(ZDocumentCursor *cursor, const QVector<LineEdit> &edits, bool collapsable=false,
+                        bool collapse=false);
     void saveUndoStep(ZDocumentCursor::Position cursorPosition, bool collapsable=false, bool collapse=false);
     void prepareModification(ZDocumentCursor::Position cursorPosition);
     void registerTextCursor(ZDocumentCursorPrivate *cursor);
@@ -131,6 +164,17 @@ class ZDocumentPrivate {
     void initalUndoStep(int endCodeUnit, int endLine);
     void noteContentsChange();
     void emitModifedSignals();
+    std::vector<int> sortedLineOrder(int first, int last, ZDocument::SortMode mode, QThreadPool *pool) const;
+
+public: // follow mode
+    void followScheduleRead();
+    void followRead();
+    void followUpdateFileIdentity();
+    bool followFileWasTruncated(qint64 size);
+    void followRememberTail();
+    void followIngest(const QByteArray &data);
+    void followAppendLines(const char *data, int size);
+    void followDropLinesFromTop();
 
 public:
     QString filename;
@@ -161,6 +205,9 @@ class ZDocumentPrivate {
     std::shared_ptr<std::atomic<unsigned>> revision = std::make_shared<std::atomic<unsigned>>(0);
     int lineRevisionCounter = 0;
 
+    std::unique_ptr<ZDocumentFollowState> follow;
+    int followMaxLines = 0;
+
     ZDocument *pub_ptr;
 
     TUIWIDGETS_DECLARE_PUBLIC(ZDocument)
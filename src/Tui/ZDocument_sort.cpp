@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZDocument.h>
+#include <Tui/ZDocument_p.h>
+
+#include <algorithm>
+#include <optional>
+
+#include <QCollator>
+#include <QCollatorSortKey>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <Tui/Utils_p.h>
+
+TUIWIDGETS_NS_START
+
+
+namespace {
+    // Ranges smaller than this are sorted on the calling thread. Below this the overhead of dispatching to the
+    // thread pool and merging is higher than what can be gained by sorting in parallel.
+    constexpr int minLinesPerChunk = 16384;
+
+    template <typename F>
+    class ChunkRunnable : public QRunnable {
+    public:
+        ChunkRunnable(F &fn, int chunk, QSemaphore &done) : fn(fn), chunk(chunk), done(done) {}
+
+    public:
+        void run() override {
+            fn(chunk);
+            done.release();
+        }
+
+    private:
+        F &fn;
+        int chunk;
+        QSemaphore &done;
+    };
+
+    // Runs fn(0) ... fn(count - 1) on pool and the calling thread and waits for all of them to finish.
+    template <typename F>
+    void runChunks(QThreadPool *pool, int count, F fn) {
+        if (count <= 1) {
+            if (count == 1) {
+                fn(0);
+            }
+            return;
+        }
+        QSemaphore done;
+        for (int i = 1; i < count; i++) {
+            pool->start(new ChunkRunnable<F>(fn, i, done));
+        }
+        fn(0);
+        done.acquire(count - 1);
+    }
+
+    // Stable merge sort. Each chunk is sorted with std::stable_sort in parallel, then chunks are merged pairwise
+    // with std::merge (which prefers the left range on ties and thus keeps the result stable).
+    template <typename Compare>
+    void parallelStableSort(QThreadPool *pool, std::vector<int> &data, Compare comp) {
+        const int size = size2int(data.size());
+        const int chunks = std::min(std::max(1, pool->maxThreadCount()), size / minLinesPerChunk);
+        if (chunks <= 1) {
+            std::stable_sort(data.begin(), data.end(), comp);
+            return;
+        }
+
+        std::vector<int> bounds;
+        bounds.resize(chunks + 1);
+        for (int i = 0; i <= chunks; i++) {
+            bounds[i] = static_cast<int>(static_cast<qint64>(size) * i / chunks);
+        }
+
+        runChunks(pool, chunks, [&](int chunk) {
+            std::stable_sort(data.begin() + bounds[chunk], data.begin() + bounds[chunk + 1], comp);
+        });
+
+        std::vector<int> buffer;
+        buffer.resize(size);
+        std::vector<int> *src = &data;
+        std::vector<int> *dst = &buffer;
+
+        for (int width = 1; width < chunks; width *= 2) {
+            const int pairs = (chunks + 2 * width - 1) / (2 * width);
+            runChunks(pool, pairs, [&](int pair) {
+                const int lo = bounds[2 * pair * width];
+                const int mid = bounds[std::min(2 * pair * width + width, chunks)];
+                const int hi = bounds[std::min(2 * pair * width + 2 * width, chunks)];
+                std::merge(src->begin() + lo, src->begin() + mid, src->begin() + mid, src->begin() + hi,
+                           dst->begin() + lo, comp);
+            });
+            std::swap(src, dst);
+        }
+
+        if (src != &data) {
+            data.swap(buffer);
+        }
+    }
+
+    // Like `sort -n`: optional leading blanks, optional sign, digits with optional decimal fraction.
+    // Lines not starting with a number are treated as 0.
+    double numericKey(const QString &line) {
+        const QChar *it = line.constData();
+        const QChar *const end = it + line.size();
+
+        while (it != end && (*it == QLatin1Char(' ') || *it == QLatin1Char('\t'))) {
+            ++it;
+        }
+
+        bool negative = false;
+        if (it != end && (*it == QLatin1Char('-') || *it == QLatin1Char('+'))) {
+            negative = *it == QLatin1Char('-');
+            ++it;
+        }
+
+        double value = 0;
+        while (it != end && it->unicode() >= '0' && it->unicode() <= '9') {
+            value = value * 10 + (it->unicode() - '0');
+            ++it;
+        }
+
+        if (it != end && *it == QLatin1Char('.')) {
+            ++it;
+            double scale = 0.1;
+            while (it != end && it->unicode() >= '0' && it->unicode() <= '9') {
+                value += (it->unicode() - '0') * scale;
+                scale /= 10;
+                ++it;
+            }
+        }
+
+        return negative ? -value : value;
+    }
+}
+
+// Returns the line indices in [first, last) in sorted order.
+std::vector<int> ZDocumentPrivate::sortedLineOrder(int first, int last, ZDocument::SortMode mode,
+                                                   QThreadPool *pool) const {
+    const int count = last - first;
+
+    std::vector<int> order;
+    order.resize(count);
+    for (int i = 0; i < count; i++) {
+        order[i] = first + i;
+    }
+
+    // Keys are extracted once per line, spread across the same chunks that are later used for sorting.
+    const int keyChunks = std::min(std::max(1, pool->maxThreadCount()), std::max(1, count / minLinesPerChunk));
+    auto forEachLineParallel = [&](auto fn) {
+        runChunks(pool, keyChunks, [&](int chunk) {
+            const int chunkStart = static_cast<int>(static_cast<qint64>(count) * chunk / keyChunks);
+            const int chunkEnd = static_cast<int>(static_cast<qint64>(count) * (chunk + 1) / keyChunks);
+            fn(chunkStart, chunkEnd);
+        });
+    };
+
+    // Only const access to lines here, the vector is usually shared with the undo steps and must not detach
+    // from the worker threads.
+    const QVector<LineData> &constLines = lines;
+
+    switch (mode) {
+        case ZDocument::SortCaseInsensitive: {
+            std::vector<QString> keys;
+            keys.resize(count);
+            forEachLineParallel([&](int chunkStart, int chunkEnd) {
+                for (int i = chunkStart; i < chunkEnd; i++) {
+                    keys[i] = constLines[first + i].chars.toCaseFolded();
+                }
+            });
+            parallelStableSort(pool, order, [&](int lhs, int rhs) {
+                return keys[lhs - first] < keys[rhs - first];
+            });
+            break;
+        }
+        case ZDocument::SortNumeric: {
+            std::vector<double> keys;
+            keys.resize(count);
+            forEachLineParallel([&](int chunkStart, int chunkEnd) {
+                for (int i = chunkStart; i < chunkEnd; i++) {
+                    keys[i] = numericKey(constLines[first + i].chars);
+                }
+            });
+            parallelStableSort(pool, order, [&](int lhs, int rhs) {
+                return keys[lhs - first] < keys[rhs - first];
+            });
+            break;
+        }
+        case ZDocument::SortLocaleAware: {
+            // QCollatorSortKey is not default constructible
+            std::vector<std::optional<QCollatorSortKey>> keys;
+            keys.resize(count);
+            forEachLineParallel([&](int chunkStart, int chunkEnd) {
+                // QCollator instances must not be shared across threads
+                QCollator collator;
+                for (int i = chunkStart; i < chunkEnd; i++) {
+                    keys[i].emplace(collator.sortKey(constLines[first + i].chars));
+                }
+            });
+            parallelStableSort(pool, order, [&](int lhs, int rhs) {
+                return keys[lhs - first]->compare(*keys[rhs - first]) < 0;
+            });
+            break;
+        }
+        case ZDocument::SortByCodeUnits:
+        default:
+            parallelStableSort(pool, order, [&](int lhs, int rhs) {
+                return constLines[lhs].chars < constLines[rhs].chars;
+            });
+            break;
+    }
+
+    return order;
+}
+
+TUIWIDGETS_NS_END
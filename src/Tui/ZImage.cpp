@@ -5,6 +5,9 @@
 
 #include <termpaint_image.h>
 
+#include <QFile>
+#include <QRect>
+
 #include <Tui/ZColor.h>
 
 #include "ZPainter_p.h"
@@ -21,8 +24,13 @@ ZImage::ZImage(QSharedDataPointer<ZImageData> pimpl) : tuiwidgets_pimpl_ptr(pimp
 }
 
 std::unique_ptr<ZImage> ZImage::fromFile(const ZTerminal *terminal, const QString &fileName) {
-    termpaint_surface *surface = termpaint_image_load(ZTerminalPrivate::get(terminal)->terminal,
-                                                      fileName.toUtf8().data());
+    termpaint_surface *surface = nullptr;
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly) && ZImageData::isBinaryFormat(file.peek(4))) {
+        surface = ZImageData::loadBinary(ZTerminalPrivate::get(terminal)->terminal, file.readAll());
+    } else {
+        surface = termpaint_image_load(ZTerminalPrivate::get(terminal)->terminal, fileName.toUtf8().data());
+    }
     if (!surface) {
         return nullptr;
     }
@@ -31,8 +39,13 @@ std::unique_ptr<ZImage> ZImage::fromFile(const ZTerminal *terminal, const QStrin
 }
 
 std::unique_ptr<ZImage> ZImage::fromByteArray(const ZTerminal *terminal, QByteArray data) {
-    termpaint_surface *surface = termpaint_image_load_from_buffer(ZTerminalPrivate::get(terminal)->terminal,
-                                                                  data.data(), data.size());
+    termpaint_surface *surface = nullptr;
+    if (ZImageData::isBinaryFormat(data)) {
+        surface = ZImageData::loadBinary(ZTerminalPrivate::get(terminal)->terminal, data);
+    } else {
+        surface = termpaint_image_load_from_buffer(ZTerminalPrivate::get(terminal)->terminal,
+                                                   data.data(), data.size());
+    }
     if (!surface) {
         return nullptr;
     }
@@ -62,7 +75,8 @@ ZImage &ZImage::operator=(const ZImage &other) {
 ZImage &ZImage::operator=(ZImage &&other) {
     // ignore hasPainters() because using outstanding painter from the moved from object is
     // undefined anyway.
-    tuiwidgets_pimpl_ptr = other.tuiwidgets_pimpl_ptr;
+    // Swap instead of sharing, so painting on this image later does not need to copy the surface.
+    tuiwidgets_pimpl_ptr.swap(other.tuiwidgets_pimpl_ptr);
     return *this;
 }
 
@@ -71,7 +85,12 @@ ZImage::~ZImage() {
 
 bool ZImage::operator==(const ZImage &other) const {
     auto *const p = tuiwidgets_pimpl_ptr.data();
-    return termpaint_surface_same_contents(p->surface, other.tuiwidgets_pimpl_ptr.data()->surface);
+    auto *const otherP = other.tuiwidgets_pimpl_ptr.data();
+    if (p->surface == otherP->surface && p->offsetX == otherP->offsetX && p->offsetY == otherP->offsetY
+            && p->width == otherP->width && p->height == otherP->height) {
+        return true;
+    }
+    return termpaint_surface_same_contents(p->wholeImageSurface().get(), otherP->wholeImageSurface().get());
 }
 
 bool ZImage::operator!=(const ZImage &other) const {
@@ -84,27 +103,55 @@ void ZImage::swap(ZImage &other) {
 
 int ZImage::width() const {
     auto *const p = tuiwidgets_pimpl_ptr.data();
-    return termpaint_surface_width(p->surface);
+    return p->width;
 }
 
 int ZImage::height() const {
     auto *const p = tuiwidgets_pimpl_ptr.data();
-    return termpaint_surface_height(p->surface);
+    return p->height;
 }
 
 QSize ZImage::size() const {
     return { width(), height() };
 }
 
+ZImage ZImage::subImage(int x, int y, int width, int height) const {
+    auto *const p = tuiwidgets_pimpl_ptr.constData();
+    const QRect rect = QRect(x, y, width, height) & QRect(0, 0, p->width, p->height);
+
+    auto *view = new ZImageData(p->terminal, p->storage);
+    view->offsetX = p->offsetX + rect.x();
+    view->offsetY = p->offsetY + rect.y();
+    view->width = rect.width();
+    view->height = rect.height();
+    if (p->hasPainters()) {
+        // outstanding painters could still change the shared surface
+        view->detachSurface();
+    }
+    return ZImage(QSharedDataPointer<ZImageData>(view));
+}
+
 bool ZImage::save(const QString &fileName) const {
-    auto *surface = tuiwidgets_pimpl_ptr->surface;
-    return termpaint_image_save(surface, fileName.toUtf8().data());
+    const std::shared_ptr<termpaint_surface> surface = tuiwidgets_pimpl_ptr->wholeImageSurface();
+    return termpaint_image_save(surface.get(), fileName.toUtf8().data());
+}
+
+bool ZImage::save(const QString &fileName, Format format) const {
+    if (format == Format::Termpaint) {
+        return save(fileName);
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    const QByteArray data = tuiwidgets_pimpl_ptr->saveBinary(format == Format::BinaryCompressed);
+    return file.write(data) == data.size() && file.flush();
 }
 
 QByteArray ZImage::saveToByteArray() const {
     QByteArray ret;
-    auto *surface = tuiwidgets_pimpl_ptr->surface;
-    char *data = termpaint_image_save_alloc_buffer(surface);
+    const std::shared_ptr<termpaint_surface> surface = tuiwidgets_pimpl_ptr->wholeImageSurface();
+    char *data = termpaint_image_save_alloc_buffer(surface.get());
     if (data) {
         ret = data;
         termpaint_image_save_dealloc_buffer(data);
@@ -113,48 +160,70 @@ QByteArray ZImage::saveToByteArray() const {
 
 }
 
+QByteArray ZImage::saveToByteArray(Format format) const {
+    if (format == Format::Termpaint) {
+        return saveToByteArray();
+    }
+    return tuiwidgets_pimpl_ptr->saveBinary(format == Format::BinaryCompressed);
+}
+
 QString ZImage::peekText(int x, int y, int *left, int *right) const {
-    auto *surface = tuiwidgets_pimpl_ptr->surface;
+    auto *const p = tuiwidgets_pimpl_ptr.constData();
+    const bool inside = p->mapToSurface(&x, &y);
     int len;
-    const char *data = termpaint_surface_peek_text(surface, x, y, &len, left, right);
+    const char *data = termpaint_surface_peek_text(p->surface, x, y, &len, left, right);
+    if (inside) {
+        if (left) {
+            *left -= p->offsetX;
+        }
+        if (right) {
+            *right -= p->offsetX;
+        }
+    }
     return QString::fromUtf8(data, len);
 }
 
 ZColor ZImage::peekForground(int x, int y) const {
-    auto *surface = tuiwidgets_pimpl_ptr->surface;
+    auto *const p = tuiwidgets_pimpl_ptr.constData();
+    p->mapToSurface(&x, &y);
     ZColor color;
-    color.val = termpaint_surface_peek_fg_color(surface, x, y);
+    color.val = termpaint_surface_peek_fg_color(p->surface, x, y);
     return color;
 }
 
 ZColor ZImage::peekBackground(int x, int y) const {
-    auto *surface = tuiwidgets_pimpl_ptr->surface;
+    auto *const p = tuiwidgets_pimpl_ptr.constData();
+    p->mapToSurface(&x, &y);
     ZColor color;
-    color.val = termpaint_surface_peek_bg_color(surface, x, y);
+    color.val = termpaint_surface_peek_bg_color(p->surface, x, y);
     return color;
 }
 
 ZColor ZImage::peekDecoration(int x, int y) const {
-    auto *surface = tuiwidgets_pimpl_ptr->surface;
+    auto *const p = tuiwidgets_pimpl_ptr.constData();
+    p->mapToSurface(&x, &y);
     ZColor color;
-    color.val = termpaint_surface_peek_deco_color(surface, x, y);
+    color.val = termpaint_surface_peek_deco_color(p->surface, x, y);
     return color;
 }
 
 bool ZImage::peekSoftwrapMarker(int x, int y) const {
-    auto *surface = tuiwidgets_pimpl_ptr->surface;
-    return termpaint_surface_peek_softwrap_marker(surface, x, y);
+    auto *const p = tuiwidgets_pimpl_ptr.constData();
+    p->mapToSurface(&x, &y);
+    return termpaint_surface_peek_softwrap_marker(p->surface, x, y);
 }
 
 ZTextAttributes ZImage::peekAttributes(int x, int y) const {
-    auto *surface = tuiwidgets_pimpl_ptr->surface;
-    return (ZTextAttributes)termpaint_surface_peek_style(surface, x, y);
+    auto *const p = tuiwidgets_pimpl_ptr.constData();
+    p->mapToSurface(&x, &y);
+    return (ZTextAttributes)termpaint_surface_peek_style(p->surface, x, y);
 }
 
 ZPainter ZImage::painter() {
     auto *const p = tuiwidgets_pimpl_ptr.data();
     std::shared_ptr<char> token = p->hasPainter.lock();
     if (!token) {
+        p->detachSurface();
         token = std::make_shared<char>(1);
         p->hasPainter = token;
     }
@@ -164,47 +233,95 @@ ZPainter ZImage::painter() {
                                                       token));
 }
 
+static std::shared_ptr<termpaint_surface> adoptSurface(termpaint_surface *surface) {
+    return std::shared_ptr<termpaint_surface>(surface, termpaint_surface_free);
+}
+
+static termpaint_surface *copySurfaceRect(termpaint_terminal *terminal, termpaint_surface *source,
+                                          int x, int y, int width, int height) {
+    termpaint_surface *surface = termpaint_terminal_new_surface(terminal, width, height);
+    termpaint_surface_copy_rect(source, x, y, width, height,
+                                surface, 0, 0, TERMPAINT_COPY_NO_TILE, TERMPAINT_COPY_NO_TILE);
+    return surface;
+}
+
 ZImageData::ZImageData(termpaint_terminal *terminal, int width, int height)
-    : terminal(terminal)
+    : terminal(terminal), width(width), height(height)
 {
     surface = termpaint_terminal_new_surface(terminal,
                                              width,
                                              height);
+    storage = adoptSurface(surface);
 }
 
 ZImageData::ZImageData(termpaint_terminal *terminal, termpaint_surface *surface)
-    : terminal(terminal), surface(surface) {
+    : terminal(terminal), surface(surface), storage(adoptSurface(surface)),
+      width(termpaint_surface_width(surface)), height(termpaint_surface_height(surface))
+{
 }
 
-ZImageData::ZImageData(const ZImageData &other)
-    : QSharedData (other), terminal(other.terminal)
+ZImageData::ZImageData(termpaint_terminal *terminal, std::shared_ptr<termpaint_surface> storage)
+    : terminal(terminal), surface(storage.get()), storage(std::move(storage)),
+      width(termpaint_surface_width(surface)), height(termpaint_surface_height(surface))
 {
-    int width = termpaint_surface_width(other.surface);
-    int height = termpaint_surface_height(other.surface);
+}
 
-    surface = termpaint_terminal_new_surface(terminal,
-                                             width,
-                                             height);
-    termpaint_surface_copy_rect(other.surface, 0, 0, width, height,
-                                surface, 0, 0, TERMPAINT_COPY_NO_TILE, TERMPAINT_COPY_NO_TILE);
+ZImageData::ZImageData(const ZImageData &other)
+    : QSharedData (other), terminal(other.terminal), width(other.width), height(other.height)
+{
+    surface = copySurfaceRect(terminal, other.surface, other.offsetX, other.offsetY, width, height);
+    storage = adoptSurface(surface);
 }
 
 ZImageData &ZImageData::operator=(const ZImageData &other) {
-    termpaint_surface_free(surface);
     hasPainter.reset();
-    int width = termpaint_surface_width(other.surface);
-    int height = termpaint_surface_height(other.surface);
     terminal = other.terminal;
-    surface = termpaint_terminal_new_surface(terminal,
-                                             width,
-                                             height);
-    termpaint_surface_copy_rect(other.surface, 0, 0, width, height,
-                                surface, 0, 0, TERMPAINT_COPY_NO_TILE, TERMPAINT_COPY_NO_TILE);
+    width = other.width;
+    height = other.height;
+    offsetX = 0;
+    offsetY = 0;
+    surface = copySurfaceRect(terminal, other.surface, other.offsetX, other.offsetY, width, height);
+    storage = adoptSurface(surface);
     return *this;
 }
 
 ZImageData::~ZImageData() {
-    termpaint_surface_free(surface);
+}
+
+bool ZImageData::isView() const {
+    return offsetX != 0 || offsetY != 0
+            || width != termpaint_surface_width(surface) || height != termpaint_surface_height(surface);
+}
+
+void ZImageData::detachSurface() {
+    if (storage.use_count() == 1 && !isView()) {
+        return;
+    }
+    surface = copySurfaceRect(terminal, surface, offsetX, offsetY, width, height);
+    storage = adoptSurface(surface);
+    offsetX = 0;
+    offsetY = 0;
+}
+
+bool ZImageData::mapToSurface(int *x, int *y) const {
+    if (*x < 0 || *y < 0 || *x >= width || *y >= height) {
+        // Coordinates outside of a view must not reveal the rest of the surface.
+        if (isView()) {
+            *x = -1;
+            *y = -1;
+        }
+        return false;
+    }
+    *x += offsetX;
+    *y += offsetY;
+    return true;
+}
+
+std::shared_ptr<termpaint_surface> ZImageData::wholeImageSurface() const {
+    if (!isView()) {
+        return storage;
+    }
+    return adoptSurface(copySurfaceRect(terminal, surface, offsetX, offsetY, width, height));
 }
 
 ZImage ZImageData::createForTesting(termpaint_terminal *terminal, int width, int height) {
@@ -21,6 +21,13 @@ class ZColor;
 class ZImageData;
 
 class TUIWIDGETS_EXPORT ZImage {
+public:
+    enum class Format {
+        Termpaint,
+        Binary,
+        BinaryCompressed
+    };
+
 public:
     ZImage(const ZTerminal *terminal, int width, int height);
     TUIWIDGETS_NODISCARD("return value contains loaded image")
@@ -43,8 +50,12 @@ class TUIWIDGETS_EXPORT ZImage {
     int height() const;
     QSize size() const;
 
+    ZImage subImage(int x, int y, int width, int height) const;
+
     bool save(const QString &fileName) const;
+    bool save(const QString &fileName, Format format) const;
     QByteArray saveToByteArray() const;
+    QByteArray saveToByteArray(Format format) const;
 
     QString peekText(int x, int y, int *left, int *right) const;
     ZColor peekForground(int x, int y) const;
@@ -0,0 +1,358 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "ZImage.h"
+#include "ZImage_p.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "Compression_p.h"
+
+TUIWIDGETS_NS_START
+
+// Binary image format
+//
+// Header:
+//   4 bytes magic "\x89TZI", 1 byte version (1), 1 byte flags (bit 0: body is compressed),
+//   varint width, varint height, if compressed: varint size of the uncompressed body.
+// Body:
+//   text table: varint count, then for each entry varint length and the UTF-8 encoded cluster
+//   attribute table: varint count, then for each entry varint fg, bg, deco and style, one byte patch flags
+//     (bit 0: has patch, bit 1: optimize) and if a patch is present varint length and bytes of setup and cleanup
+//   cell table: varint count, then for each entry varint text index, varint attribute index, varint cluster width
+//     and one byte flags (bit 0: softwrap marker)
+//   cells: runs of varint count and varint cell table index, covering all clusters in row major order.
+//
+// All varints are unsigned LEB128. Tables are built from the distinct values in the image, so a typical terminal
+// frame needs only a few dozen entries and large areas of the same cells compress to a single run.
+
+static const char binaryMagic[] = "\x89TZI";
+static const int binaryMagicSize = 4;
+static const unsigned char binaryVersion = 1;
+static const unsigned char binaryFlagCompressed = 1;
+// smallest encoded size of entries in the attribute and cell tables
+static const int minAttributeEntrySize = 5;
+static const int minCellEntrySize = 4;
+
+namespace {
+    class Interner {
+    public:
+        int intern(const QByteArray &entry) {
+            auto it = index.constFind(entry);
+            if (it != index.constEnd()) {
+                return it.value();
+            }
+            const int id = index.size();
+            index.insert(entry, id);
+            table.append(entry);
+            return id;
+        }
+
+        void appendTo(QByteArray *output) const {
+            Private::appendVarint(output, static_cast<quint64>(table.size()));
+            for (const QByteArray &entry : table) {
+                output->append(entry);
+            }
+        }
+
+    private:
+        QHash<QByteArray, int> index;
+        QVector<QByteArray> table;
+    };
+
+}
+
+static void appendBytes(QByteArray *output, const char *data, int length) {
+    Private::appendVarint(output, static_cast<quint64>(length));
+    output->append(data, length);
+}
+
+void ZImageData::appendAttributes(QByteArray *output, termpaint_surface *surface, int x, int y) {
+    Private::appendVarint(output, termpaint_surface_peek_fg_color(surface, x, y));
+    Private::appendVarint(output, termpaint_surface_peek_bg_color(surface, x, y));
+    Private::appendVarint(output, termpaint_surface_peek_deco_color(surface, x, y));
+    Private::appendVarint(output, static_cast<quint64>(termpaint_surface_peek_style(surface, x, y)));
+    const char *setup = nullptr;
+    const char *cleanup = nullptr;
+    bool optimize = false;
+    termpaint_surface_peek_patch(surface, x, y, &setup, &cleanup, &optimize);
+    if (setup && cleanup) {
+        output->append(static_cast<char>(optimize ? 3 : 1));
+        appendBytes(output, setup, static_cast<int>(strlen(setup)));
+        appendBytes(output, cleanup, static_cast<int>(strlen(cleanup)));
+    } else {
+        output->append(static_cast<char>(0));
+    }
+}
+
+termpaint_attr *ZImageData::readAttributes(Private::ByteReader *reader) {
+    unsigned int fg, bg, deco, style;
+    unsigned char patchFlags;
+    if (!reader->varintUInt(&fg) || !reader->varintUInt(&bg) || !reader->varintUInt(&deco)
+            || !reader->varintUInt(&style) || !reader->byte(&patchFlags)) {
+        return nullptr;
+    }
+    QByteArray setup;
+    QByteArray cleanup;
+    if ((patchFlags & 1) && (!reader->bytes(&setup) || !reader->bytes(&cleanup))) {
+        return nullptr;
+    }
+    termpaint_attr *attr = termpaint_attr_new(fg, bg);
+    termpaint_attr_set_deco(attr, deco);
+    termpaint_attr_set_style(attr, static_cast<int>(style));
+    if (patchFlags & 1) {
+        termpaint_attr_set_patch(attr, patchFlags & 2, setup.constData(), cleanup.constData());
+    }
+    return attr;
+}
+
+void ZImageData::BinaryTables::clear() {
+    texts.clear();
+    attrs.clear();
+    cells.clear();
+}
+
+bool ZImageData::BinaryTables::readTextTable(Private::ByteReader *reader, int maxEntries) {
+    int count;
+    if (!reader->varintInt(&count, std::min(maxEntries, reader->remaining()))) {
+        return false;
+    }
+    texts.reserve(texts.size() + count);
+    for (int i = 0; i < count; i++) {
+        BinaryTextEntry text;
+        if (!reader->bytes(&text.utf8)) {
+            return false;
+        }
+        const QVector<uint> codePoints = QString::fromUtf8(text.utf8).toUcs4();
+        if (codePoints.size() == 1) {
+            text.codePoint = static_cast<int>(codePoints[0]);
+        }
+        texts.append(text);
+    }
+    return true;
+}
+
+bool ZImageData::BinaryTables::readAttributeTable(Private::ByteReader *reader, int maxEntries) {
+    int count;
+    if (!reader->varintInt(&count, std::min(maxEntries, reader->remaining() / minAttributeEntrySize))) {
+        return false;
+    }
+    attrs.reserve(attrs.size() + static_cast<size_t>(count));
+    for (int i = 0; i < count; i++) {
+        termpaint_attr *attr = ZImageData::readAttributes(reader);
+        if (!attr) {
+            return false;
+        }
+        attrs.emplace_back(attr, termpaint_attr_free);
+    }
+    return true;
+}
+
+bool ZImageData::BinaryTables::readCellTable(Private::ByteReader *reader, int maxEntries) {
+    int count;
+    if (!reader->varintInt(&count, std::min(maxEntries, reader->remaining() / minCellEntrySize))) {
+        return false;
+    }
+    cells.reserve(cells.size() + count);
+    for (int i = 0; i < count; i++) {
+        BinaryCellEntry cell;
+        unsigned char flags;
+        if (!reader->varintInt(&cell.text, texts.size() - 1)
+                || !reader->varintInt(&cell.attr, static_cast<int>(attrs.size()) - 1)
+                || !reader->varintInt(&cell.width, 2) || cell.width < 1 || !reader->byte(&flags)) {
+            return false;
+        }
+        cell.softwrap = flags & 1;
+        cells.append(cell);
+    }
+    return true;
+}
+
+bool ZImageData::BinaryTables::writeRun(termpaint_surface *surface, int width, int height, int *x, int *y,
+                                        int cellIndex, int count, bool replaceSoftwrapMarkers) const {
+    const BinaryCellEntry &cell = cells[cellIndex];
+    const BinaryTextEntry &text = texts[cell.text];
+    termpaint_attr *attr = attrs[static_cast<size_t>(cell.attr)].get();
+    const bool setSoftwrapMarkers = cell.softwrap || replaceSoftwrapMarkers;
+    while (count) {
+        if (*y >= height || width == 0) {
+            return false;
+        }
+        if (cell.width == 1 && text.codePoint != -1) {
+            // Runs of single width characters are written a row at a time.
+            const int n = std::min(count, width - *x);
+            termpaint_surface_clear_rect_with_attr_char(surface, *x, *y, n, 1, attr, text.codePoint);
+            if (setSoftwrapMarkers) {
+                for (int i = 0; i < n; i++) {
+                    termpaint_surface_set_softwrap_marker(surface, *x + i, *y, cell.softwrap);
+                }
+            }
+            *x += n;
+            count -= n;
+        } else {
+            if (*x + cell.width > width) {
+                return false;
+            }
+            termpaint_surface_write_with_len_attr(surface, *x, *y, text.utf8.constData(), text.utf8.size(), attr);
+            if (setSoftwrapMarkers) {
+                termpaint_surface_set_softwrap_marker(surface, *x, *y, cell.softwrap);
+            }
+            *x += cell.width;
+            count -= 1;
+        }
+        if (*x == width) {
+            *x = 0;
+            ++*y;
+        }
+    }
+    return true;
+}
+
+bool ZImageData::isBinaryFormat(const QByteArray &data) {
+    return data.size() >= binaryMagicSize && memcmp(data.constData(), binaryMagic, binaryMagicSize) == 0;
+}
+
+QByteArray ZImageData::saveBinary(bool compress) const {
+    const std::shared_ptr<termpaint_surface> whole = wholeImageSurface();
+    termpaint_surface *const surface = whole.get();
+
+    Interner texts;
+    Interner attrs;
+    Interner kinds;
+    QByteArray cells;
+    QByteArray entry;
+
+    int runKind = -1;
+    quint64 runLength = 0;
+    auto flushRun = [&] {
+        if (runLength) {
+            Private::appendVarint(&cells, runLength);
+            Private::appendVarint(&cells, static_cast<quint64>(runKind));
+        }
+    };
+
+    for (int y = 0; y < height; y++) {
+        int x = 0;
+        while (x < width) {
+            int len, left, right;
+            const char *text = termpaint_surface_peek_text(surface, x, y, &len, &left, &right);
+            const int clusterWidth = std::max(1, std::min(right, width - 1) - x + 1);
+
+            entry.clear();
+            appendBytes(&entry, text, len);
+            const int textIndex = texts.intern(entry);
+
+            entry.clear();
+            appendAttributes(&entry, surface, x, y);
+            const int attrIndex = attrs.intern(entry);
+
+            entry.clear();
+            Private::appendVarint(&entry, static_cast<quint64>(textIndex));
+            Private::appendVarint(&entry, static_cast<quint64>(attrIndex));
+            Private::appendVarint(&entry, static_cast<quint64>(clusterWidth));
+            entry.append(static_cast<char>(termpaint_surface_peek_softwrap_marker(surface, x, y) ? 1 : 0));
+            const int kind = kinds.intern(entry);
+
+            if (kind == runKind) {
+                ++runLength;
+            } else {
+                flushRun();
+                runKind = kind;
+                runLength = 1;
+            }
+            x += clusterWidth;
+        }
+    }
+    flushRun();
+
+    QByteArray body;
+    texts.appendTo(&body);
+    attrs.appendTo(&body);
+    kinds.appendTo(&body);
+    body.append(cells);
+
+    QByteArray result;
+    result.append(binaryMagic, binaryMagicSize);
+    result.append(static_cast<char>(binaryVersion));
+    result.append(static_cast<char>(compress ? binaryFlagCompressed : 0));
+    Private::appendVarint(&result, static_cast<quint64>(width));
+    Private::appendVarint(&result, static_cast<quint64>(height));
+    if (compress) {
+        Private::appendVarint(&result, static_cast<quint64>(body.size()));
+        result.append(Private::lzCompress(body.constData(), body.size()));
+    } else {
+        result.append(body);
+    }
+    return result;
+}
+
+termpaint_surface *ZImageData::loadBinary(termpaint_terminal *terminal, const QByteArray &data) {
+    if (!isBinaryFormat(data) || data.size() < binaryMagicSize + 2) {
+        return nullptr;
+    }
+    const unsigned char version = static_cast<unsigned char>(data[binaryMagicSize]);
+    const unsigned char flags = static_cast<unsigned char>(data[binaryMagicSize + 1]);
+    if (version != binaryVersion || (flags & ~binaryFlagCompressed)) {
+        return nullptr;
+    }
+
+    // Limits keep corrupted input from allocating unreasonable amounts of memory.
+    const int maxDimension = 1 << 14;
+    const int maxCells = 1 << 24;
+    const int maxBodySize = 1 << 28;
+    Private::ByteReader header(data.constData() + binaryMagicSize + 2, data.size() - binaryMagicSize - 2);
+    int width;
+    int height;
+    if (!header.varintInt(&width, maxDimension) || !header.varintInt(&height, maxDimension)
+            || width * height > maxCells) {
+        return nullptr;
+    }
+
+    QByteArray decompressed;
+    const char *bodyData = header.position();
+    int bodySize = header.remaining();
+    if (flags & binaryFlagCompressed) {
+        int decompressedSize;
+        if (!header.varintInt(&decompressedSize, maxBodySize)
+                || !Private::lzDecompress(header.position(), header.remaining(), decompressedSize, &decompressed)) {
+            return nullptr;
+        }
+        bodyData = decompressed.constData();
+        bodySize = decompressed.size();
+    }
+    Private::ByteReader body(bodyData, bodySize);
+
+    const int cellCount = width * height;
+    BinaryTables tables;
+    if (!tables.readTextTable(&body, cellCount) || !tables.readAttributeTable(&body, cellCount)
+            || !tables.readCellTable(&body, cellCount)) {
+        return nullptr;
+    }
+
+    termpaint_surface *surface = termpaint_terminal_new_surface(terminal, width, height);
+    int x = 0;
+    int y = 0;
+    bool ok = true;
+    while (ok && !body.atEnd()) {
+        int count;
+        int cellIndex;
+        if (!body.varintInt(&count, cellCount) || count < 1 || !body.varintInt(&cellIndex, tables.cells.size() - 1)
+                || !tables.writeRun(surface, width, height, &x, &y, cellIndex, count, false)) {
+            ok = false;
+        }
+    }
+    if (!ok || (width && y != height)) {
+        termpaint_surface_free(surface);
+        return nullptr;
+    }
+    return surface;
+}
+
+TUIWIDGETS_NS_END
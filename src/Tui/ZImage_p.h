@@ -3,10 +3,16 @@
 #ifndef TUIWIDGETS_ZIMAGE_P_INCLUDED
 #define TUIWIDGETS_ZIMAGE_P_INCLUDED
 
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
 #include <QSharedData>
+#include <QVector>
 
 #include <termpaint.h>
 
+#include <Tui/Compression_p.h>
 #include <Tui/ZImage.h>
 
 #include <Tui/tuiwidgets_internal.h>
@@ -14,9 +20,47 @@
 TUIWIDGETS_NS_START
 
 class ZImageData : public QSharedData {
+public:
+    struct BinaryTextEntry {
+        QByteArray utf8;
+        // Code point for clusters that consist of a single code point, -1 otherwise.
+        int codePoint = -1;
+    };
+
+    struct BinaryCellEntry {
+        int text;
+        int attr;
+        int width;
+        bool softwrap;
+    };
+
+    // Text, attribute and cell tables of the binary image format and terminal recordings. Reading appends to the
+    // tables, as frames of a recording add to the tables of the previous frames.
+    class BinaryTables {
+    public:
+        void clear();
+        // Each reads a varint count and that many entries. Tables only contain distinct values of cells, so
+        // maxEntries is the number of cells the entries are used for. The count is also bounded by the remaining
+        // data, so a small, highly compressed input can't allocate huge tables.
+        bool readTextTable(Private::ByteReader *reader, int maxEntries);
+        bool readAttributeTable(Private::ByteReader *reader, int maxEntries);
+        bool readCellTable(Private::ByteReader *reader, int maxEntries);
+        // Writes count clusters of the cell entry in row major order starting at *x, *y and advances them. Returns
+        // false if the clusters don't fit. With replaceSoftwrapMarkers markers are also cleared, for surfaces that
+        // contain a previous frame.
+        bool writeRun(termpaint_surface *surface, int width, int height, int *x, int *y, int cellIndex, int count,
+                      bool replaceSoftwrapMarkers) const;
+
+    public:
+        QVector<BinaryTextEntry> texts;
+        std::vector<std::unique_ptr<termpaint_attr, void(*)(termpaint_attr*)>> attrs;
+        QVector<BinaryCellEntry> cells;
+    };
+
 public:
     ZImageData(termpaint_terminal *terminal, int width, int height);
     ZImageData(termpaint_terminal *terminal, termpaint_surface *surface);
+    ZImageData(termpaint_terminal *terminal, std::shared_ptr<termpaint_surface> storage);
     ZImageData(const ZImageData& other);
     ZImageData(ZImageData&& other) = delete;
     ZImageData& operator=(const ZImageData& other);
@@ -25,6 +69,18 @@ class ZImageData : public QSharedData {
 
 public:
     bool hasPainters() const { return !hasPainter.expired(); };
+    bool isView() const;
+    void detachSurface();
+    bool mapToSurface(int *x, int *y) const;
+    std::shared_ptr<termpaint_surface> wholeImageSurface() const;
+    QByteArray saveBinary(bool compress) const;
+
+    // Serialization of cell attributes, shared by the binary image format and terminal recordings.
+    static void appendAttributes(QByteArray *output, termpaint_surface *surface, int x, int y);
+    static termpaint_attr *readAttributes(Private::ByteReader *reader);
+
+    static bool isBinaryFormat(const QByteArray &data);
+    static termpaint_surface *loadBinary(termpaint_terminal *terminal, const QByteArray &data);
 
     // back door
     static ZImageData *get(ZImage *image) { return image->tuiwidgets_pimpl_ptr.data(); }
@@ -35,6 +91,13 @@ class ZImageData : public QSharedData {
     std::weak_ptr<char> hasPainter;
     termpaint_terminal *terminal;
     termpaint_surface *surface;
+    // Owns surface. Sub-image views share the surface until one of the images sharing it is painted on.
+    std::shared_ptr<termpaint_surface> storage;
+    // Part of surface that is visible as this image.
+    int offsetX = 0;
+    int offsetY = 0;
+    int width = 0;
+    int height = 0;
 };
 
 TUIWIDGETS_NS_END
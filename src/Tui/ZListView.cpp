@@ -4,8 +4,10 @@
 #include "ZListView_p.h"
 
 #include <QStringListModel>
+#include <QTimer>
 
 #include <Tui/ZTerminal.h>
+#include <Tui/ZTerminal_p.h>
 
 TUIWIDGETS_NS_START
 
@@ -15,6 +17,52 @@ ZListViewPrivate::ZListViewPrivate(ZWidget *pub) : ZWidgetPrivate(pub) {
 ZListViewPrivate::~ZListViewPrivate() {
 }
 
+const ZListViewPrivate::CachedRow &ZListViewPrivate::cachedRow(int row) {
+    auto it = rowCache.find(row);
+    if (it != rowCache.end()) {
+        return *it;
+    }
+
+    const QModelIndex idx = model->index(row, 0);
+    CachedRow entry;
+    entry.leftDecoration = idx.data(LeftDecorationRole).toString();
+    const QVariant leftDecorationFg = idx.data(LeftDecorationFgRole);
+    if (leftDecorationFg.canConvert<ZColor>()) {
+        entry.leftDecorationFg = leftDecorationFg.value<ZColor>();
+    }
+    const QVariant leftDecorationBg = idx.data(LeftDecorationBgRole);
+    if (leftDecorationBg.canConvert<ZColor>()) {
+        entry.leftDecorationBg = leftDecorationBg.value<ZColor>();
+    }
+
+    const int leftDecorationSpace = idx.data(LeftDecorationSpaceRole).toInt();
+    if (leftDecorationSpace > 0) {
+        entry.text = QStringLiteral(" ").repeated(leftDecorationSpace) + idx.data().toString();
+    } else {
+        entry.text = idx.data().toString();
+    }
+
+    return *rowCache.insert(row, std::move(entry));
+}
+
+void ZListViewPrivate::fetchMoreIfNeeded(int visibleRows) {
+    if (!model || fetchMoreScheduled) {
+        return;
+    }
+    // Start fetching when less than a page of rows is left below the visible rows.
+    if (scrollPosition + 2 * visibleRows < model->rowCount() || !model->canFetchMore(QModelIndex())) {
+        return;
+    }
+    // Fetching usually inserts rows, so it must not be done while painting.
+    fetchMoreScheduled = true;
+    QTimer::singleShot(0, pub(), [this] {
+        fetchMoreScheduled = false;
+        if (model && model->canFetchMore(QModelIndex())) {
+            model->fetchMore(QModelIndex());
+        }
+    });
+}
+
 ZListView::ZListView(ZWidget *parent) : ZWidget(parent, std::make_unique<ZListViewPrivate>(this)) {
     setFocusPolicy(StrongFocus);
     setSizePolicyV(SizePolicy::Expanding);
@@ -160,6 +208,7 @@ void ZListView::detachModel() {
         p->selectionModel = nullptr;
     }
     disconnect(p->model, nullptr, this, nullptr);
+    p->rowCache.clear();
     if (p->model == p->allocatedModel) {
         delete p->model;
         p->allocatedModel = nullptr;
@@ -207,16 +256,46 @@ void ZListView::attachModel() {
         p->selectionModel = nullptr;
         p->lastSelectedRow = 0;
         p->scrollPosition = 0;
+        p->rowCache.clear();
+    });
+
+    auto clearCacheHandler = [this, handler] {
+        auto *const p = tuiwidgets_impl();
+        p->rowCache.clear();
+        handler();
+    };
+
+    connect(p->model, &QAbstractItemModel::columnsInserted, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::columnsMoved, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::columnsRemoved, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::dataChanged, this,
+            [this, handler](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        auto *const p = tuiwidgets_impl();
+        if (!topLeft.parent().isValid()) {
+            p->rowCache.removeRange(topLeft.row(), bottomRight.row());
+        }
+        handler();
+    });
+    connect(p->model, &QAbstractItemModel::layoutChanged, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::modelReset, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::rowsInserted, this,
+            [this, handler](const QModelIndex &parent, int first, int last) {
+        auto *const p = tuiwidgets_impl();
+        if (!parent.isValid()) {
+            p->rowCache.shift(first, last - first + 1);
+        }
+        handler();
+    });
+    connect(p->model, &QAbstractItemModel::rowsMoved, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::rowsRemoved, this,
+            [this, handler](const QModelIndex &parent, int first, int last) {
+        auto *const p = tuiwidgets_impl();
+        if (!parent.isValid()) {
+            p->rowCache.removeRange(first, last);
+            p->rowCache.shift(last + 1, -(last - first + 1));
+        }
+        handler();
     });
-    connect(p->model, &QAbstractItemModel::columnsInserted, this, handler);
-    connect(p->model, &QAbstractItemModel::columnsMoved, this, handler);
-    connect(p->model, &QAbstractItemModel::columnsRemoved, this, handler);
-    connect(p->model, &QAbstractItemModel::dataChanged, this, handler);
-    connect(p->model, &QAbstractItemModel::layoutChanged, this, handler);
-    connect(p->model, &QAbstractItemModel::modelReset, this, handler);
-    connect(p->model, &QAbstractItemModel::rowsInserted, this, handler);
-    connect(p->model, &QAbstractItemModel::rowsMoved, this, handler);
-    connect(p->model, &QAbstractItemModel::rowsRemoved, this, handler);
 }
 
 void ZListView::paintEvent(ZPaintEvent *event) {
@@ -228,6 +307,14 @@ void ZListView::paintEvent(ZPaintEvent *event) {
     auto *painter = event->painter();
     auto *term = terminal();
 
+    if (term && p->lastPaintedScrollPosition != -1 && p->lastPaintedScrollPosition != p->scrollPosition
+            && p->lastPaintedGeometry == geometry()) {
+        ZTerminalPrivate::get(term)->hintVerticalScroll({mapToTerminal({0, 0}), geometry().size()},
+                                                        p->scrollPosition - p->lastPaintedScrollPosition);
+    }
+    p->lastPaintedScrollPosition = p->scrollPosition;
+    p->lastPaintedGeometry = geometry();
+
     if (isEnabled()) {
         baseStyle = {getColor("dataview.fg"), getColor("dataview.bg")};
         selectedStyle = {getColor("dataview.selected.fg"), getColor("dataview.selected.bg")};
@@ -243,14 +330,18 @@ void ZListView::paintEvent(ZPaintEvent *event) {
 
     ZPainter clippedPainter = painter->translateAndClip(1, 0, geometry().width() - 2, geometry().height());
 
+    const bool focused = term && isAncestorOf(term->focusWidget());
+    const QModelIndex current = p->selectionModel ? p->selectionModel->currentIndex() : QModelIndex();
+
     const int size = p->model->rowCount();
-    for (int i = 0; i < std::min(size - p->scrollPosition, geometry().height()); i++) {
+    const int visibleRows = geometry().height();
+    for (int i = 0; i < std::min(size - p->scrollPosition, visibleRows); i++) {
         const QModelIndex idx = p->model->index(i + p->scrollPosition, 0);
-        const QString itemString = idx.data().toString();
+        const ZListViewPrivate::CachedRow &cached = p->cachedRow(i + p->scrollPosition);
 
         ZTextStyle effectiveStyle;
         if (p->selectionModel && p->selectionModel->isSelected(idx)) {
-            if (term && isAncestorOf(term->focusWidget())) {
+            if (focused) {
                 effectiveStyle = selectedStyleFocus;
             } else {
                 effectiveStyle = selectedStyle;
@@ -260,30 +351,23 @@ void ZListView::paintEvent(ZPaintEvent *event) {
         }
         p->styledText.setBaseStyle(effectiveStyle);
 
-        QString itemLeftDecoration = idx.data(LeftDecorationRole).toString();
-        ZColor itemLeftDecorationFg = effectiveStyle.foregroundColor();
-        if (idx.data(LeftDecorationFgRole).canConvert<ZColor>()) {
-            itemLeftDecorationFg = idx.data(LeftDecorationFgRole).value<ZColor>();
-        }
+        const ZColor itemLeftDecorationFg = cached.leftDecorationFg.value_or(effectiveStyle.foregroundColor());
+        const ZColor itemLeftDecorationBg = cached.leftDecorationBg.value_or(effectiveStyle.backgroundColor());
 
-        ZColor itemLeftDecorationBg = effectiveStyle.backgroundColor();
-        if (idx.data(LeftDecorationBgRole).canConvert<ZColor>()) {
-            itemLeftDecorationBg = idx.data(LeftDecorationBgRole).value<ZColor>();
+        int leftDecorationWidth = 0;
+        if (!cached.leftDecoration.isEmpty()) {
+            leftDecorationWidth = term->textMetrics().sizeInColumns(cached.leftDecoration);
         }
-
-        int leftDecorationWidth = term->textMetrics().sizeInColumns(itemLeftDecoration);
         if (leftDecorationWidth) {
-            clippedPainter.writeWithColors(0, i, itemLeftDecoration, itemLeftDecorationFg, itemLeftDecorationBg);
+            clippedPainter.writeWithColors(0, i, cached.leftDecoration, itemLeftDecorationFg, itemLeftDecorationBg);
         }
 
-        int itemLeftDecorationSpace = idx.data(LeftDecorationSpaceRole).toInt();
-
-        p->styledText.setText(QStringLiteral(" ").repeated(itemLeftDecorationSpace) + itemString);
+        p->styledText.setText(cached.text);
 
         p->styledText.write(painter, 1 + leftDecorationWidth, i, geometry().width() - 2 - leftDecorationWidth);
 
-        if (p->selectionModel && p->selectionModel->currentIndex() == idx) {
-            if (term && isAncestorOf(term->focusWidget()) && isEnabled()) {
+        if (current == idx) {
+            if (focused && isEnabled()) {
                 painter->writeWithColors(geometry().width()-1, i, QStringLiteral("«"),
                                          effectiveStyle.foregroundColor(),
                                          effectiveStyle.backgroundColor());
@@ -300,6 +384,9 @@ void ZListView::paintEvent(ZPaintEvent *event) {
             }
         }
     }
+
+    p->rowCache.trim(p->scrollPosition, visibleRows);
+    p->fetchMoreIfNeeded(visibleRows);
 }
 
 void ZListView::keyEvent(ZKeyEvent *event) {
@@ -5,8 +5,12 @@
 
 #include <Tui/ZListView.h>
 
+#include <optional>
+
 #include <QPointer>
 
+#include <Tui/RowCache_p.h>
+#include <Tui/ZColor.h>
 #include <Tui/ZStyledTextLine.h>
 #include <Tui/ZWidget_p.h>
 
@@ -19,13 +23,31 @@ class ZListViewPrivate : public ZWidgetPrivate {
     ZListViewPrivate(ZWidget *pub);
     ~ZListViewPrivate() override;
 
+public:
+    // Model data of a row as needed for painting
+    struct CachedRow {
+        QString text;
+        QString leftDecoration;
+        std::optional<ZColor> leftDecorationFg;
+        std::optional<ZColor> leftDecorationBg;
+    };
+
+public:
+    const CachedRow &cachedRow(int row);
+    void fetchMoreIfNeeded(int visibleRows);
+
 public:
     ZStyledTextLine styledText;
     QAbstractItemModel *model = nullptr;
     QPointer<QItemSelectionModel> selectionModel;
     int lastSelectedRow = 0;
     int scrollPosition = 0;
+    // scroll position and geometry of the last paint, to hint the terminal about scrolled rows
+    int lastPaintedScrollPosition = -1;
+    QRect lastPaintedGeometry;
     QAbstractItemModel *allocatedModel = nullptr;
+    RowCache<CachedRow> rowCache;
+    bool fetchMoreScheduled = false;
 
     TUIWIDGETS_DECLARE_PUBLIC(ZListView)
 };
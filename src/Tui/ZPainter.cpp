@@ -4,7 +4,6 @@
 #include <Tui/ZPainter_p.h>
 
 #include <QRect>
-#include <QTextCodec>
 
 #include <Tui/ZColor.h>
 #include <Tui/ZImage_p.h>
@@ -13,6 +12,8 @@
 #include <Tui/ZTextMetrics_p.h>
 #include <Tui/ZWidget.h>
 
+#include <Tui/Utils_p.h>
+
 TUIWIDGETS_NS_START
 
 static_assert ((int)ZTilingMode::NoTiling == TERMPAINT_COPY_NO_TILE);
@@ -23,6 +24,51 @@ namespace {
     int toTermPaintColor(ZColor color) {
         return color.nativeValue();
     }
+
+    // Strings up to this size (in UTF-16 code units) are encoded without allocating.
+    constexpr int utf8StackBufferCodeUnits = 256;
+
+    // Encodes like QString::toUtf8, unpaired surrogates are replaced by '?'.
+    // out needs space for 3 bytes per code unit.
+    int encodeUtf8(const QChar *string, int size, char *out) {
+        char *dst = out;
+        for (int i = 0; i < size; i++) {
+            const char16_t ch = string[i].unicode();
+            if (ch < 0x80) {
+                *dst++ = static_cast<char>(ch);
+            } else if (ch < 0x800) {
+                *dst++ = static_cast<char>(0xc0 | (ch >> 6));
+                *dst++ = static_cast<char>(0x80 | (ch & 0x3f));
+            } else if (QChar::isHighSurrogate(ch) && i + 1 < size && QChar::isLowSurrogate(string[i + 1].unicode())) {
+                const char32_t ch32 = QChar::surrogateToUcs4(ch, string[i + 1].unicode());
+                ++i;
+                *dst++ = static_cast<char>(0xf0 | (ch32 >> 18));
+                *dst++ = static_cast<char>(0x80 | ((ch32 >> 12) & 0x3f));
+                *dst++ = static_cast<char>(0x80 | ((ch32 >> 6) & 0x3f));
+                *dst++ = static_cast<char>(0x80 | (ch32 & 0x3f));
+            } else if (QChar::isSurrogate(ch)) {
+                *dst++ = '?';
+            } else {
+                *dst++ = static_cast<char>(0xe0 | (ch >> 12));
+                *dst++ = static_cast<char>(0x80 | ((ch >> 6) & 0x3f));
+                *dst++ = static_cast<char>(0x80 | (ch & 0x3f));
+            }
+        }
+        return static_cast<int>(dst - out);
+    }
+
+    // Calls fn with the UTF-8 encoded string. Short strings (the common case when painting) are encoded into
+    // a buffer on the stack.
+    template <typename F>
+    void withUtf8(const QChar *string, int size, F fn) {
+        if (size <= utf8StackBufferCodeUnits) {
+            char buffer[utf8StackBufferCodeUnits * 3];
+            fn(buffer, encodeUtf8(string, size, buffer));
+        } else {
+            QByteArray buffer(size * 3, Qt::Uninitialized);
+            fn(buffer.data(), encodeUtf8(string, size, buffer.data()));
+        }
+    }
 }
 
 ZPainterPrivate::ZPainterPrivate(termpaint_surface *surface, int width, int height, std::shared_ptr<char> token)
@@ -75,8 +121,7 @@ ZPainter ZPainter::translateAndClip(int x, int y, int width, int height) {
 }
 
 void ZPainter::writeWithColors(int x, int y, const QString &string, ZColor fg, ZColor bg) {
-    auto utf8 = string.toUtf8();
-    writeWithColors(x, y, utf8.data(), utf8.size(), fg, bg);
+    writeWithColors(x, y, string.constData(), size2int(string.size()), fg, bg);
 }
 
 void ZPainter::writeWithColors(int x, int y, const char *stringUtf8, int utf8CodeUnits, ZColor fg, ZColor bg) {
@@ -95,18 +140,17 @@ void ZPainter::writeWithColors(int x, int y, const char *stringUtf8, int utf8Cod
 }
 
 void ZPainter::writeWithColors(int x, int y, const QChar *string, int size, ZColor fg, ZColor bg) {
-    QByteArray utf8 = QTextCodec::codecForMib(106)->fromUnicode(string, size);
-    writeWithColors(x, y, utf8.data(), utf8.size(), fg, bg);
+    withUtf8(string, size, [&](const char *utf8, int utf8Size) {
+        writeWithColors(x, y, utf8, utf8Size, fg, bg);
+    });
 }
 
 void ZPainter::writeWithColors(int x, int y, const char16_t *string, int size, ZColor fg, ZColor bg) {
-    QByteArray utf8 = QTextCodec::codecForMib(106)->fromUnicode(reinterpret_cast<const QChar*>(string), size);
-    writeWithColors(x, y, utf8.data(), utf8.size(), fg, bg);
+    writeWithColors(x, y, reinterpret_cast<const QChar*>(string), size, fg, bg);
 }
 
 void ZPainter::writeWithAttributes(int x, int y, const QString &string, ZColor fg, ZColor bg, ZTextAttributes attr) {
-    auto utf8 = string.toUtf8();
-    writeWithAttributes(x, y, utf8.data(), utf8.size(), fg, bg, attr);
+    writeWithAttributes(x, y, string.constData(), size2int(string.size()), fg, bg, attr);
 }
 
 void ZPainter::writeWithAttributes(int x, int y, const char *stringUtf8, int utf8CodeUnits, ZColor fg, ZColor bg, ZTextAttributes attr) {
@@ -128,13 +172,13 @@ void ZPainter::writeWithAttributes(int x, int y, const char *stringUtf8, int utf
 }
 
 void ZPainter::writeWithAttributes(int x, int y, const QChar *string, int size, ZColor fg, ZColor bg, ZTextAttributes attr) {
-    QByteArray utf8 = QTextCodec::codecForMib(106)->fromUnicode(string, size);
-    writeWithAttributes(x, y, utf8.data(), utf8.size(), fg, bg, attr);
+    withUtf8(string, size, [&](const char *utf8, int utf8Size) {
+        writeWithAttributes(x, y, utf8, utf8Size, fg, bg, attr);
+    });
 }
 
 void ZPainter::writeWithAttributes(int x, int y, const char16_t *string, int size, ZColor fg, ZColor bg, ZTextAttributes attr) {
-    QByteArray utf8 = QTextCodec::codecForMib(106)->fromUnicode(reinterpret_cast<const QChar*>(string), size);
-    writeWithAttributes(x, y, utf8.data(), utf8.size(), fg, bg, attr);
+    writeWithAttributes(x, y, reinterpret_cast<const QChar*>(string), size, fg, bg, attr);
 }
 
 void ZPainter::clear(ZColor fg, ZColor bg, ZTextAttributes attr) {
@@ -216,6 +260,7 @@ void ZPainter::drawImageWithTiling(int x, int y,
                                    const ZImage &sourceImage, int sourceX, int sourceY, int width, int height,
                                    ZTilingMode tileLeft, ZTilingMode tileRight) {
     auto *const pimpl = tuiwidgets_impl();
+    const ZImageData *const source = ZImageData::get(&sourceImage);
 
     x += pimpl->offsetX;
     y += pimpl->offsetY;
@@ -227,6 +272,24 @@ void ZPainter::drawImageWithTiling(int x, int y,
         height = sourceImage.height();
     }
 
+    if (source->isView()) {
+        // Clip to the view, the rest of the underlying surface is not part of the image.
+        if (sourceX < 0) {
+            width += sourceX;
+            x -= sourceX;
+            sourceX = 0;
+        }
+        if (sourceY < 0) {
+            height += sourceY;
+            y -= sourceY;
+            sourceY = 0;
+        }
+        width = std::min(source->width - sourceX, width);
+        height = std::min(source->height - sourceY, height);
+        sourceX += source->offsetX;
+        sourceY += source->offsetY;
+    }
+
     if (x < 0) {
         width += x;
         sourceX -= x;
@@ -245,7 +308,7 @@ void ZPainter::drawImageWithTiling(int x, int y,
         return;
     }
 
-    termpaint_surface_copy_rect(ZImageData::get(&sourceImage)->surface, sourceX, sourceY, width, height,
+    termpaint_surface_copy_rect(source->surface, sourceX, sourceY, width, height,
                                 pimpl->surface, pimpl->x + x, pimpl->y + y,
                                 static_cast<int>(tileLeft), static_cast<int>(tileRight));
 }
@@ -342,405 +342,414 @@ void ZPalette::setDefaultRules(ZPalette &p) {
 }
 
 ZPalette ZPalette::classic() {
-    ZPalette p;
-    p.setColors({
-        { "root.bg", Colors::black},
-        { "root.fg", {0x80, 0x80, 0x80}},
-
-        { "menu.bg", Colors::lightGray},
-        { "menu.fg", Colors::black},
-        { "menu.disabled.bg", Colors::lightGray},
-        { "menu.disabled.fg", Colors::darkGray},
-        { "menu.shortcut.bg", Colors::lightGray},
-        { "menu.shortcut.fg", Colors::red},
-        { "menu.selected.bg", Colors::green},
-        { "menu.selected.fg", Colors::black},
-        { "menu.selected.disabled.bg", Colors::green},
-        { "menu.selected.disabled.fg", Colors::darkGray},
-        { "menu.selected.shortcut.bg", Colors::green},
-        { "menu.selected.shortcut.fg", Colors::red},
-
-        { "window.default.bg", Colors::blue},
-        { "window.default.frame.focused.fg", Colors::brightWhite},
-        { "window.default.frame.focused.control.fg", Colors::brightGreen},
-        { "window.default.frame.unfocused.fg", Colors::lightGray},
-        { "window.default.scrollbar.fg", Colors::blue},
-        { "window.default.scrollbar.bg", { 0, 0x55, 0xaa}},
-        { "window.default.scrollbar.control.fg", Colors::blue},
-        { "window.default.scrollbar.control.bg", Colors::cyan},
-        { "window.default.text.fg", Colors::brightYellow},
-        { "window.default.text.bg", Colors::blue},
-        { "window.default.text.selected.fg", Colors::blue},
-        { "window.default.text.selected.bg", Colors::lightGray},
-        { "window.default.control.bg", Colors::blue},
-        { "window.default.control.fg", Colors::lightGray},
-        { "window.default.control.focused.bg", Colors::blue},
-        { "window.default.control.focused.fg", Colors::brightWhite},
-        { "window.default.control.disabled.bg", Colors::blue},
-        { "window.default.control.disabled.fg", Colors::black},
-        { "window.default.control.shortcut.bg", Colors::blue},
-        { "window.default.control.shortcut.fg", Colors::brightYellow},
-        { "window.default.dataview.bg", Colors::cyan},
-        { "window.default.dataview.fg", Colors::black},
-        { "window.default.dataview.selected.bg", Colors::cyan},
-        { "window.default.dataview.selected.fg", Colors::brightYellow},
-        { "window.default.dataview.selected.focused.bg", Colors::green},
-        { "window.default.dataview.selected.focused.fg", Colors::brightWhite},
-        { "window.default.dataview.disabled.bg", Colors::lightGray},
-        { "window.default.dataview.disabled.fg", Colors::darkGray},
-        { "window.default.dataview.disabled.selected.bg", Colors::lightGray},
-        { "window.default.dataview.disabled.selected.fg", Colors::brightWhite},
-        { "window.default.button.bg", Colors::green},
-        { "window.default.button.fg", Colors::black},
-        { "window.default.button.default.bg", Colors::green},
-        { "window.default.button.default.fg", Colors::brightCyan},
-        { "window.default.button.focused.bg", Colors::green},
-        { "window.default.button.focused.fg", Colors::brightWhite},
-        { "window.default.button.disabled.bg", Colors::lightGray},
-        { "window.default.button.disabled.fg", Colors::darkGray},
-        { "window.default.button.shortcut.bg", Colors::green},
-        { "window.default.button.shortcut.fg", Colors::brightYellow},
-        { "window.default.lineedit.bg", Colors::lightGray},
-        { "window.default.lineedit.fg", Colors::black},
-        { "window.default.lineedit.focused.bg", Colors::lightGray},
-        { "window.default.lineedit.focused.fg", Colors::brightWhite},
-        { "window.default.lineedit.disabled.bg", Colors::darkGray},
-        { "window.default.lineedit.disabled.fg", Colors::lightGray},
-        { "window.default.textedit.bg", Colors::lightGray},
-        { "window.default.textedit.fg", Colors::black},
-        { "window.default.textedit.focused.bg", Colors::lightGray},
-        { "window.default.textedit.focused.fg", Colors::brightWhite},
-        { "window.default.textedit.disabled.bg", Colors::darkGray},
-        { "window.default.textedit.disabled.fg", Colors::lightGray},
-        { "window.default.textedit.selected.bg", Colors::brightWhite},
-        { "window.default.textedit.selected.fg", Colors::darkGray},
-        { "window.default.textedit.linenumber.bg", Colors::darkGray},
-        { "window.default.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-        { "window.default.textedit.focused.linenumber.bg", Colors::darkGray},
-        { "window.default.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-
-        { "window.gray.bg", Colors::lightGray},
-        { "window.gray.frame.focused.fg", Colors::brightWhite},
-        { "window.gray.frame.focused.control.fg", Colors::brightGreen},
-        { "window.gray.frame.unfocused.fg", Colors::black},
-        { "window.gray.scrollbar.fg", Colors::cyan},
-        { "window.gray.scrollbar.bg", Colors::blue},
-        { "window.gray.scrollbar.control.fg", Colors::cyan},
-        { "window.gray.scrollbar.control.bg", Colors::blue},
-        { "window.gray.text.fg", Colors::lightGray},
-        { "window.gray.text.bg", Colors::black},
-        { "window.gray.text.selected.fg", Colors::lightGray},
-        { "window.gray.text.selected.bg", Colors::brightWhite},
-        { "window.gray.control.bg", Colors::lightGray},
-        { "window.gray.control.fg", Colors::black},
-        { "window.gray.control.focused.bg", Colors::lightGray},
-        { "window.gray.control.focused.fg", Colors::brightWhite},
-        { "window.gray.control.disabled.bg", Colors::lightGray},
-        { "window.gray.control.disabled.fg", Colors::darkGray},
-        { "window.gray.control.shortcut.bg", Colors::lightGray},
-        { "window.gray.control.shortcut.fg", Colors::brightYellow},
-        { "window.gray.dataview.bg", Colors::cyan},
-        { "window.gray.dataview.fg", Colors::black},
-        { "window.gray.dataview.selected.bg", Colors::cyan},
-        { "window.gray.dataview.selected.fg", Colors::brightYellow},
-        { "window.gray.dataview.selected.focused.bg", Colors::green},
-        { "window.gray.dataview.selected.focused.fg", Colors::brightWhite},
-        { "window.gray.dataview.disabled.bg", Colors::darkGray},
-        { "window.gray.dataview.disabled.fg", Colors::lightGray},
-        { "window.gray.dataview.disabled.selected.bg", Colors::darkGray},
-        { "window.gray.dataview.disabled.selected.fg", Colors::brightWhite},
-        { "window.gray.button.bg", Colors::green},
-        { "window.gray.button.fg", Colors::black},
-        { "window.gray.button.default.bg", Colors::green},
-        { "window.gray.button.default.fg", Colors::brightCyan},
-        { "window.gray.button.focused.bg", Colors::green},
-        { "window.gray.button.focused.fg", Colors::brightWhite},
-        { "window.gray.button.disabled.bg", Colors::lightGray},
-        { "window.gray.button.disabled.fg", Colors::darkGray},
-        { "window.gray.button.shortcut.bg", Colors::green},
-        { "window.gray.button.shortcut.fg", Colors::brightYellow},
-        { "window.gray.lineedit.bg", Colors::blue},
-        { "window.gray.lineedit.fg", Colors::brightWhite},
-        { "window.gray.lineedit.focused.bg", Colors::green},
-        { "window.gray.lineedit.focused.fg", Colors::brightWhite},
-        { "window.gray.lineedit.disabled.bg", Colors::darkGray},
-        { "window.gray.lineedit.disabled.fg", Colors::lightGray},
-        { "window.gray.textedit.bg", Colors::blue},
-        { "window.gray.textedit.fg", Colors::brightWhite},
-        { "window.gray.textedit.focused.bg", Colors::green},
-        { "window.gray.textedit.focused.fg", Colors::brightWhite},
-        { "window.gray.textedit.disabled.bg", Colors::darkGray},
-        { "window.gray.textedit.disabled.fg", Colors::lightGray},
-        { "window.gray.textedit.selected.bg", Colors::brightWhite},
-        { "window.gray.textedit.selected.fg", Colors::darkGray},
-        { "window.gray.textedit.linenumber.bg", { 0, 0, 0x80}},
-        { "window.gray.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-        { "window.gray.textedit.focused.linenumber.bg", { 0, 0x80, 0}},
-        { "window.gray.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-
-        { "window.cyan.bg", Colors::cyan},
-        { "window.cyan.frame.focused.fg", Colors::brightWhite},
-        { "window.cyan.frame.focused.control.fg", Colors::brightGreen},
-        { "window.cyan.frame.unfocused.fg", Colors::lightGray},
-        { "window.cyan.scrollbar.fg", Colors::cyan},
-        { "window.cyan.scrollbar.bg", Colors::blue},
-        { "window.cyan.scrollbar.control.fg", Colors::cyan},
-        { "window.cyan.scrollbar.control.bg", Colors::blue},
-        { "window.cyan.text.fg", Colors::black},
-        { "window.cyan.text.bg", Colors::cyan},
-        { "window.cyan.text.selected.fg", Colors::brightWhite},
-        { "window.cyan.text.selected.bg", Colors::cyan},
-        { "window.cyan.control.bg", Colors::cyan},
-        { "window.cyan.control.fg", Colors::black},
-        { "window.cyan.control.focused.bg", Colors::cyan},
-        { "window.cyan.control.focused.fg", Colors::brightWhite},
-        { "window.cyan.control.disabled.bg", Colors::cyan},
-        { "window.cyan.control.disabled.fg", Colors::darkGray},
-        { "window.cyan.control.shortcut.bg", Colors::cyan},
-        { "window.cyan.control.shortcut.fg", Colors::brightYellow},
-        { "window.cyan.dataview.bg", Colors::brightBlue},
-        { "window.cyan.dataview.fg", Colors::black},
-        { "window.cyan.dataview.selected.bg", Colors::brightBlue},
-        { "window.cyan.dataview.selected.fg", Colors::brightYellow},
-        { "window.cyan.dataview.selected.focused.bg", Colors::green},
-        { "window.cyan.dataview.selected.focused.fg", Colors::brightWhite},
-        { "window.cyan.dataview.disabled.bg", Colors::lightGray},
-        { "window.cyan.dataview.disabled.fg", Colors::black},
-        { "window.cyan.dataview.disabled.selected.bg", Colors::lightGray},
-        { "window.cyan.dataview.disabled.selected.fg", Colors::brightWhite},
-        { "window.cyan.button.bg", Colors::green},
-        { "window.cyan.button.fg", Colors::black},
-        { "window.cyan.button.default.bg", Colors::green},
-        { "window.cyan.button.default.fg", Colors::brightCyan},
-        { "window.cyan.button.focused.bg", Colors::green},
-        { "window.cyan.button.focused.fg", Colors::brightWhite},
-        { "window.cyan.button.disabled.bg", Colors::lightGray},
-        { "window.cyan.button.disabled.fg", Colors::darkGray},
-        { "window.cyan.button.shortcut.bg", Colors::green},
-        { "window.cyan.button.shortcut.fg", Colors::brightYellow},
-        { "window.cyan.lineedit.bg", Colors::blue},
-        { "window.cyan.lineedit.fg", Colors::brightWhite},
-        { "window.cyan.lineedit.focused.bg", Colors::green},
-        { "window.cyan.lineedit.focused.fg", Colors::brightWhite},
-        { "window.cyan.lineedit.disabled.bg", Colors::darkGray},
-        { "window.cyan.lineedit.disabled.fg", Colors::lightGray},
-        { "window.cyan.textedit.bg", Colors::blue},
-        { "window.cyan.textedit.fg", Colors::brightWhite},
-        { "window.cyan.textedit.focused.bg", Colors::green},
-        { "window.cyan.textedit.focused.fg", Colors::brightWhite},
-        { "window.cyan.textedit.disabled.bg", Colors::darkGray},
-        { "window.cyan.textedit.disabled.fg", Colors::lightGray},
-        { "window.cyan.textedit.selected.bg", Colors::brightWhite},
-        { "window.cyan.textedit.selected.fg", Colors::darkGray},
-        { "window.cyan.textedit.linenumber.bg", { 0, 0, 0x80}},
-        { "window.cyan.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-        { "window.cyan.textedit.focused.linenumber.bg", { 0, 0x80, 0}},
-        { "window.cyan.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-    });
-
-    setDefaultRules(p);
-    return p;
+    // Built only once, copies share the color and rule data as it is implicitly shared. This avoids rebuilding the
+    // palette for every root widget, e.g. when hosting many terminal sessions in one process.
+    static const ZPalette palette = [] {
+        ZPalette p;
+        p.setColors({
+            { "root.bg", Colors::black},
+            { "root.fg", {0x80, 0x80, 0x80}},
+
+            { "menu.bg", Colors::lightGray},
+            { "menu.fg", Colors::black},
+            { "menu.disabled.bg", Colors::lightGray},
+            { "menu.disabled.fg", Colors::darkGray},
+            { "menu.shortcut.bg", Colors::lightGray},
+            { "menu.shortcut.fg", Colors::red},
+            { "menu.selected.bg", Colors::green},
+            { "menu.selected.fg", Colors::black},
+            { "menu.selected.disabled.bg", Colors::green},
+            { "menu.selected.disabled.fg", Colors::darkGray},
+            { "menu.selected.shortcut.bg", Colors::green},
+            { "menu.selected.shortcut.fg", Colors::red},
+
+            { "window.default.bg", Colors::blue},
+            { "window.default.frame.focused.fg", Colors::brightWhite},
+            { "window.default.frame.focused.control.fg", Colors::brightGreen},
+            { "window.default.frame.unfocused.fg", Colors::lightGray},
+            { "window.default.scrollbar.fg", Colors::blue},
+            { "window.default.scrollbar.bg", { 0, 0x55, 0xaa}},
+            { "window.default.scrollbar.control.fg", Colors::blue},
+            { "window.default.scrollbar.control.bg", Colors::cyan},
+            { "window.default.text.fg", Colors::brightYellow},
+            { "window.default.text.bg", Colors::blue},
+            { "window.default.text.selected.fg", Colors::blue},
+            { "window.default.text.selected.bg", Colors::lightGray},
+            { "window.default.control.bg", Colors::blue},
+            { "window.default.control.fg", Colors::lightGray},
+            { "window.default.control.focused.bg", Colors::blue},
+            { "window.default.control.focused.fg", Colors::brightWhite},
+            { "window.default.control.disabled.bg", Colors::blue},
+            { "window.default.control.disabled.fg", Colors::black},
+            { "window.default.control.shortcut.bg", Colors::blue},
+            { "window.default.control.shortcut.fg", Colors::brightYellow},
+            { "window.default.dataview.bg", Colors::cyan},
+            { "window.default.dataview.fg", Colors::black},
+            { "window.default.dataview.selected.bg", Colors::cyan},
+            { "window.default.dataview.selected.fg", Colors::brightYellow},
+            { "window.default.dataview.selected.focused.bg", Colors::green},
+            { "window.default.dataview.selected.focused.fg", Colors::brightWhite},
+            { "window.default.dataview.disabled.bg", Colors::lightGray},
+            { "window.default.dataview.disabled.fg", Colors::darkGray},
+            { "window.default.dataview.disabled.selected.bg", Colors::lightGray},
+            { "window.default.dataview.disabled.selected.fg", Colors::brightWhite},
+            { "window.default.button.bg", Colors::green},
+            { "window.default.button.fg", Colors::black},
+            { "window.default.button.default.bg", Colors::green},
+            { "window.default.button.default.fg", Colors::brightCyan},
+            { "window.default.button.focused.bg", Colors::green},
+            { "window.default.button.focused.fg", Colors::brightWhite},
+            { "window.default.button.disabled.bg", Colors::lightGray},
+            { "window.default.button.disabled.fg", Colors::darkGray},
+            { "window.default.button.shortcut.bg", Colors::green},
+            { "window.default.button.shortcut.fg", Colors::brightYellow},
+            { "window.default.lineedit.bg", Colors::lightGray},
+            { "window.default.lineedit.fg", Colors::black},
+            { "window.default.lineedit.focused.bg", Colors::lightGray},
+            { "window.default.lineedit.focused.fg", Colors::brightWhite},
+            { "window.default.lineedit.disabled.bg", Colors::darkGray},
+            { "window.default.lineedit.disabled.fg", Colors::lightGray},
+            { "window.default.textedit.bg", Colors::lightGray},
+            { "window.default.textedit.fg", Colors::black},
+            { "window.default.textedit.focused.bg", Colors::lightGray},
+            { "window.default.textedit.focused.fg", Colors::brightWhite},
+            { "window.default.textedit.disabled.bg", Colors::darkGray},
+            { "window.default.textedit.disabled.fg", Colors::lightGray},
+            { "window.default.textedit.selected.bg", Colors::brightWhite},
+            { "window.default.textedit.selected.fg", Colors::darkGray},
+            { "window.default.textedit.linenumber.bg", Colors::darkGray},
+            { "window.default.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+            { "window.default.textedit.focused.linenumber.bg", Colors::darkGray},
+            { "window.default.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+
+            { "window.gray.bg", Colors::lightGray},
+            { "window.gray.frame.focused.fg", Colors::brightWhite},
+            { "window.gray.frame.focused.control.fg", Colors::brightGreen},
+            { "window.gray.frame.unfocused.fg", Colors::black},
+            { "window.gray.scrollbar.fg", Colors::cyan},
+            { "window.gray.scrollbar.bg", Colors::blue},
+            { "window.gray.scrollbar.control.fg", Colors::cyan},
+            { "window.gray.scrollbar.control.bg", Colors::blue},
+            { "window.gray.text.fg", Colors::lightGray},
+            { "window.gray.text.bg", Colors::black},
+            { "window.gray.text.selected.fg", Colors::lightGray},
+            { "window.gray.text.selected.bg", Colors::brightWhite},
+            { "window.gray.control.bg", Colors::lightGray},
+            { "window.gray.control.fg", Colors::black},
+            { "window.gray.control.focused.bg", Colors::lightGray},
+            { "window.gray.control.focused.fg", Colors::brightWhite},
+            { "window.gray.control.disabled.bg", Colors::lightGray},
+            { "window.gray.control.disabled.fg", Colors::darkGray},
+            { "window.gray.control.shortcut.bg", Colors::lightGray},
+            { "window.gray.control.shortcut.fg", Colors::brightYellow},
+            { "window.gray.dataview.bg", Colors::cyan},
+            { "window.gray.dataview.fg", Colors::black},
+            { "window.gray.dataview.selected.bg", Colors::cyan},
+            { "window.gray.dataview.selected.fg", Colors::brightYellow},
+            { "window.gray.dataview.selected.focused.bg", Colors::green},
+            { "window.gray.dataview.selected.focused.fg", Colors::brightWhite},
+            { "window.gray.dataview.disabled.bg", Colors::darkGray},
+            { "window.gray.dataview.disabled.fg", Colors::lightGray},
+            { "window.gray.dataview.disabled.selected.bg", Colors::darkGray},
+            { "window.gray.dataview.disabled.selected.fg", Colors::brightWhite},
+            { "window.gray.button.bg", Colors::green},
+            { "window.gray.button.fg", Colors::black},
+            { "window.gray.button.default.bg", Colors::green},
+            { "window.gray.button.default.fg", Colors::brightCyan},
+            { "window.gray.button.focused.bg", Colors::green},
+            { "window.gray.button.focused.fg", Colors::brightWhite},
+            { "window.gray.button.disabled.bg", Colors::lightGray},
+            { "window.gray.button.disabled.fg", Colors::darkGray},
+            { "window.gray.button.shortcut.bg", Colors::green},
+            { "window.gray.button.shortcut.fg", Colors::brightYellow},
+            { "window.gray.lineedit.bg", Colors::blue},
+            { "window.gray.lineedit.fg", Colors::brightWhite},
+            { "window.gray.lineedit.focused.bg", Colors::green},
+            { "window.gray.lineedit.focused.fg", Colors::brightWhite},
+            { "window.gray.lineedit.disabled.bg", Colors::darkGray},
+            { "window.gray.lineedit.disabled.fg", Colors::lightGray},
+            { "window.gray.textedit.bg", Colors::blue},
+            { "window.gray.textedit.fg", Colors::brightWhite},
+            { "window.gray.textedit.focused.bg", Colors::green},
+            { "window.gray.textedit.focused.fg", Colors::brightWhite},
+            { "window.gray.textedit.disabled.bg", Colors::darkGray},
+            { "window.gray.textedit.disabled.fg", Colors::lightGray},
+            { "window.gray.textedit.selected.bg", Colors::brightWhite},
+            { "window.gray.textedit.selected.fg", Colors::darkGray},
+            { "window.gray.textedit.linenumber.bg", { 0, 0, 0x80}},
+            { "window.gray.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+            { "window.gray.textedit.focused.linenumber.bg", { 0, 0x80, 0}},
+            { "window.gray.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+
+            { "window.cyan.bg", Colors::cyan},
+            { "window.cyan.frame.focused.fg", Colors::brightWhite},
+            { "window.cyan.frame.focused.control.fg", Colors::brightGreen},
+            { "window.cyan.frame.unfocused.fg", Colors::lightGray},
+            { "window.cyan.scrollbar.fg", Colors::cyan},
+            { "window.cyan.scrollbar.bg", Colors::blue},
+            { "window.cyan.scrollbar.control.fg", Colors::cyan},
+            { "window.cyan.scrollbar.control.bg", Colors::blue},
+            { "window.cyan.text.fg", Colors::black},
+            { "window.cyan.text.bg", Colors::cyan},
+            { "window.cyan.text.selected.fg", Colors::brightWhite},
+            { "window.cyan.text.selected.bg", Colors::cyan},
+            { "window.cyan.control.bg", Colors::cyan},
+            { "window.cyan.control.fg", Colors::black},
+            { "window.cyan.control.focused.bg", Colors::cyan},
+            { "window.cyan.control.focused.fg", Colors::brightWhite},
+            { "window.cyan.control.disabled.bg", Colors::cyan},
+            { "window.cyan.control.disabled.fg", Colors::darkGray},
+            { "window.cyan.control.shortcut.bg", Colors::cyan},
+            { "window.cyan.control.shortcut.fg", Colors::brightYellow},
+            { "window.cyan.dataview.bg", Colors::brightBlue},
+            { "window.cyan.dataview.fg", Colors::black},
+            { "window.cyan.dataview.selected.bg", Colors::brightBlue},
+            { "window.cyan.dataview.selected.fg", Colors::brightYellow},
+            { "window.cyan.dataview.selected.focused.bg", Colors::green},
+            { "window.cyan.dataview.selected.focused.fg", Colors::brightWhite},
+            { "window.cyan.dataview.disabled.bg", Colors::lightGray},
+            { "window.cyan.dataview.disabled.fg", Colors::black},
+            { "window.cyan.dataview.disabled.selected.bg", Colors::lightGray},
+            { "window.cyan.dataview.disabled.selected.fg", Colors::brightWhite},
+            { "window.cyan.button.bg", Colors::green},
+            { "window.cyan.button.fg", Colors::black},
+            { "window.cyan.button.default.bg", Colors::green},
+            { "window.cyan.button.default.fg", Colors::brightCyan},
+            { "window.cyan.button.focused.bg", Colors::green},
+            { "window.cyan.button.focused.fg", Colors::brightWhite},
+            { "window.cyan.button.disabled.bg", Colors::lightGray},
+            { "window.cyan.button.disabled.fg", Colors::darkGray},
+            { "window.cyan.button.shortcut.bg", Colors::green},
+            { "window.cyan.button.shortcut.fg", Colors::brightYellow},
+            { "window.cyan.lineedit.bg", Colors::blue},
+            { "window.cyan.lineedit.fg", Colors::brightWhite},
+            { "window.cyan.lineedit.focused.bg", Colors::green},
+            { "window.cyan.lineedit.focused.fg", Colors::brightWhite},
+            { "window.cyan.lineedit.disabled.bg", Colors::darkGray},
+            { "window.cyan.lineedit.disabled.fg", Colors::lightGray},
+            { "window.cyan.textedit.bg", Colors::blue},
+            { "window.cyan.textedit.fg", Colors::brightWhite},
+            { "window.cyan.textedit.focused.bg", Colors::green},
+            { "window.cyan.textedit.focused.fg", Colors::brightWhite},
+            { "window.cyan.textedit.disabled.bg", Colors::darkGray},
+            { "window.cyan.textedit.disabled.fg", Colors::lightGray},
+            { "window.cyan.textedit.selected.bg", Colors::brightWhite},
+            { "window.cyan.textedit.selected.fg", Colors::darkGray},
+            { "window.cyan.textedit.linenumber.bg", { 0, 0, 0x80}},
+            { "window.cyan.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+            { "window.cyan.textedit.focused.linenumber.bg", { 0, 0x80, 0}},
+            { "window.cyan.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+        });
+
+        setDefaultRules(p);
+        return p;
+    }();
+    return palette;
 }
 
 ZPalette ZPalette::black() {
-    ZPalette p;
-    p.setColors({
-        { "root.bg", Colors::black},
-        { "root.fg", {0x80, 0x80, 0x80}},
-
-        { "menu.bg", Colors::lightGray},
-        { "menu.fg", Colors::black},
-        { "menu.disabled.bg", Colors::lightGray},
-        { "menu.disabled.fg", Colors::darkGray},
-        { "menu.shortcut.bg", Colors::lightGray},
-        { "menu.shortcut.fg", Colors::red},
-        { "menu.selected.bg", Colors::green},
-        { "menu.selected.fg", Colors::black},
-        { "menu.selected.disabled.bg", Colors::green},
-        { "menu.selected.disabled.fg", Colors::darkGray},
-        { "menu.selected.shortcut.bg", Colors::green},
-        { "menu.selected.shortcut.fg", Colors::red},
-
-        { "window.default.bg", Colors::black},
-        { "window.default.frame.focused.fg", Colors::brightWhite},
-        { "window.default.frame.focused.control.fg", Colors::brightGreen},
-        { "window.default.frame.unfocused.fg", Colors::lightGray},
-        { "window.default.scrollbar.fg", Colors::black},
-        { "window.default.scrollbar.bg", { 0, 0x55, 0xaa}},
-        { "window.default.scrollbar.control.fg", Colors::brightWhite},
-        { "window.default.scrollbar.control.bg", Colors::darkGray},
-        { "window.default.text.fg", Colors::brightYellow},
-        { "window.default.text.bg", Colors::black},
-        { "window.default.text.selected.fg", Colors::black},
-        { "window.default.text.selected.bg", Colors::lightGray},
-        { "window.default.control.bg", Colors::black},
-        { "window.default.control.fg", Colors::lightGray},
-        { "window.default.control.focused.bg", Colors::black},
-        { "window.default.control.focused.fg", Colors::brightWhite},
-        { "window.default.control.disabled.bg", Colors::black},
-        { "window.default.control.disabled.fg", Colors::darkGray},
-        { "window.default.control.shortcut.bg", Colors::black},
-        { "window.default.control.shortcut.fg", Colors::brightYellow},
-        { "window.default.dataview.bg", Colors::brightWhite},
-        { "window.default.dataview.fg", Colors::darkGray},
-        { "window.default.dataview.selected.bg", Colors::brightWhite},
-        { "window.default.dataview.selected.fg", Colors::black},
-        { "window.default.dataview.selected.focused.bg", Colors::brightGreen},
-        { "window.default.dataview.selected.focused.fg", Colors::black},
-        { "window.default.dataview.disabled.bg", Colors::lightGray},
-        { "window.default.dataview.disabled.fg", Colors::darkGray},
-        { "window.default.dataview.disabled.selected.bg", Colors::lightGray},
-        { "window.default.dataview.disabled.selected.fg", Colors::brightWhite},
-        { "window.default.button.bg", Colors::green},
-        { "window.default.button.fg", Colors::black},
-        { "window.default.button.default.bg", Colors::green},
-        { "window.default.button.default.fg", Colors::brightCyan},
-        { "window.default.button.focused.bg", Colors::green},
-        { "window.default.button.focused.fg", Colors::brightWhite},
-        { "window.default.button.disabled.bg", Colors::lightGray},
-        { "window.default.button.disabled.fg", Colors::darkGray},
-        { "window.default.button.shortcut.bg", Colors::green},
-        { "window.default.button.shortcut.fg", Colors::brightYellow},
-        { "window.default.lineedit.bg", Colors::lightGray},
-        { "window.default.lineedit.fg", Colors::black},
-        { "window.default.lineedit.focused.bg", Colors::lightGray},
-        { "window.default.lineedit.focused.fg", Colors::brightWhite},
-        { "window.default.lineedit.disabled.bg", Colors::darkGray},
-        { "window.default.lineedit.disabled.fg", Colors::lightGray},
-        { "window.default.textedit.bg", Colors::lightGray},
-        { "window.default.textedit.fg", Colors::black},
-        { "window.default.textedit.focused.bg", Colors::lightGray},
-        { "window.default.textedit.focused.fg", Colors::brightWhite},
-        { "window.default.textedit.disabled.bg", Colors::darkGray},
-        { "window.default.textedit.disabled.fg", Colors::lightGray},
-        { "window.default.textedit.selected.bg", Colors::brightWhite},
-        { "window.default.textedit.selected.fg", Colors::darkGray},
-        { "window.default.textedit.linenumber.bg", { 0x22, 0x22, 0x22}},
-        { "window.default.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-        { "window.default.textedit.focused.linenumber.bg", { 0x22, 0x22, 0x22}},
-        { "window.default.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-
-        { "window.gray.bg", Colors::lightGray},
-        { "window.gray.frame.focused.fg", Colors::brightWhite},
-        { "window.gray.frame.focused.control.fg", Colors::brightGreen},
-        { "window.gray.frame.unfocused.fg", Colors::black},
-        { "window.gray.scrollbar.fg", Colors::cyan},
-        { "window.gray.scrollbar.bg", Colors::black},
-        { "window.gray.scrollbar.control.fg", Colors::cyan},
-        { "window.gray.scrollbar.control.bg", Colors::black},
-        { "window.gray.text.fg", Colors::lightGray},
-        { "window.gray.text.bg", Colors::black},
-        { "window.gray.text.selected.fg", Colors::lightGray},
-        { "window.gray.text.selected.bg", Colors::brightWhite},
-        { "window.gray.control.bg", Colors::lightGray},
-        { "window.gray.control.fg", Colors::black},
-        { "window.gray.control.focused.bg", Colors::lightGray},
-        { "window.gray.control.focused.fg", Colors::brightWhite},
-        { "window.gray.control.disabled.bg", Colors::lightGray},
-        { "window.gray.control.disabled.fg", Colors::darkGray},
-        { "window.gray.control.shortcut.bg", Colors::lightGray},
-        { "window.gray.control.shortcut.fg", Colors::brightYellow},
-        { "window.gray.dataview.bg", Colors::brightWhite},
-        { "window.gray.dataview.fg", Colors::darkGray},
-        { "window.gray.dataview.selected.bg", Colors::brightWhite},
-        { "window.gray.dataview.selected.fg", Colors::black},
-        { "window.gray.dataview.selected.focused.bg", Colors::brightGreen},
-        { "window.gray.dataview.selected.focused.fg", Colors::black},
-        { "window.gray.dataview.disabled.bg", Colors::darkGray},
-        { "window.gray.dataview.disabled.fg", Colors::lightGray},
-        { "window.gray.dataview.disabled.selected.bg", Colors::darkGray},
-        { "window.gray.dataview.disabled.selected.fg", Colors::brightWhite},
-        { "window.gray.button.bg", Colors::green},
-        { "window.gray.button.fg", Colors::black},
-        { "window.gray.button.default.bg", Colors::green},
-        { "window.gray.button.default.fg", Colors::brightCyan},
-        { "window.gray.button.focused.bg", Colors::green},
-        { "window.gray.button.focused.fg", Colors::brightWhite},
-        { "window.gray.button.disabled.bg", Colors::lightGray},
-        { "window.gray.button.disabled.fg", Colors::darkGray},
-        { "window.gray.button.shortcut.bg", Colors::green},
-        { "window.gray.button.shortcut.fg", Colors::brightYellow},
-        { "window.gray.lineedit.bg", Colors::black},
-        { "window.gray.lineedit.fg", Colors::brightWhite},
-        { "window.gray.lineedit.focused.bg", Colors::green},
-        { "window.gray.lineedit.focused.fg", Colors::brightWhite},
-        { "window.gray.lineedit.disabled.bg", Colors::darkGray},
-        { "window.gray.lineedit.disabled.fg", Colors::lightGray},
-        { "window.gray.textedit.bg", Colors::black},
-        { "window.gray.textedit.fg", Colors::brightWhite},
-        { "window.gray.textedit.focused.bg", Colors::green},
-        { "window.gray.textedit.focused.fg", Colors::brightWhite},
-        { "window.gray.textedit.disabled.bg", Colors::darkGray},
-        { "window.gray.textedit.disabled.fg", Colors::lightGray},
-        { "window.gray.textedit.selected.bg", Colors::brightWhite},
-        { "window.gray.textedit.selected.fg", Colors::darkGray},
-        { "window.gray.textedit.linenumber.bg", { 0x22, 0x22, 0x22}},
-        { "window.gray.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-        { "window.gray.textedit.focused.linenumber.bg", { 0, 0x80, 0}},
-        { "window.gray.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-
-        { "window.cyan.bg", Colors::cyan},
-        { "window.cyan.frame.focused.fg", Colors::brightWhite},
-        { "window.cyan.frame.focused.control.fg", Colors::brightGreen},
-        { "window.cyan.frame.unfocused.fg", Colors::lightGray},
-        { "window.cyan.scrollbar.fg", Colors::cyan},
-        { "window.cyan.scrollbar.bg", Colors::black},
-        { "window.cyan.scrollbar.control.fg", Colors::cyan},
-        { "window.cyan.scrollbar.control.bg", Colors::black},
-        { "window.cyan.text.fg", Colors::black},
-        { "window.cyan.text.bg", Colors::cyan},
-        { "window.cyan.text.selected.fg", Colors::brightWhite},
-        { "window.cyan.text.selected.bg", Colors::cyan},
-        { "window.cyan.control.bg", Colors::cyan},
-        { "window.cyan.control.fg", Colors::black},
-        { "window.cyan.control.focused.bg", Colors::cyan},
-        { "window.cyan.control.focused.fg", Colors::brightWhite},
-        { "window.cyan.control.disabled.bg", Colors::cyan},
-        { "window.cyan.control.disabled.fg", Colors::darkGray},
-        { "window.cyan.control.shortcut.bg", Colors::cyan},
-        { "window.cyan.control.shortcut.fg", Colors::brightYellow},
-        { "window.cyan.dataview.bg", Colors::blue},
-        { "window.cyan.dataview.fg", Colors::black},
-        { "window.cyan.dataview.selected.bg", Colors::blue},
-        { "window.cyan.dataview.selected.fg", Colors::brightYellow},
-        { "window.cyan.dataview.selected.focused.bg", Colors::green},
-        { "window.cyan.dataview.selected.focused.fg", Colors::brightWhite},
-        { "window.cyan.dataview.disabled.bg", Colors::lightGray},
-        { "window.cyan.dataview.disabled.fg", Colors::black},
-        { "window.cyan.dataview.disabled.selected.bg", Colors::lightGray},
-        { "window.cyan.dataview.disabled.selected.fg", Colors::brightWhite},
-        { "window.cyan.button.bg", Colors::green},
-        { "window.cyan.button.fg", Colors::black},
-        { "window.cyan.button.default.bg", Colors::green},
-        { "window.cyan.button.default.fg", Colors::brightCyan},
-        { "window.cyan.button.focused.bg", Colors::green},
-        { "window.cyan.button.focused.fg", Colors::brightWhite},
-        { "window.cyan.button.disabled.bg", Colors::lightGray},
-        { "window.cyan.button.disabled.fg", Colors::darkGray},
-        { "window.cyan.button.shortcut.bg", Colors::green},
-        { "window.cyan.button.shortcut.fg", Colors::brightYellow},
-        { "window.cyan.lineedit.bg", Colors::black},
-        { "window.cyan.lineedit.fg", Colors::brightWhite},
-        { "window.cyan.lineedit.focused.bg", Colors::green},
-        { "window.cyan.lineedit.focused.fg", Colors::brightWhite},
-        { "window.cyan.lineedit.disabled.bg", Colors::darkGray},
-        { "window.cyan.lineedit.disabled.fg", Colors::lightGray},
-        { "window.cyan.textedit.bg", Colors::black},
-        { "window.cyan.textedit.fg", Colors::brightWhite},
-        { "window.cyan.textedit.focused.bg", Colors::green},
-        { "window.cyan.textedit.focused.fg", Colors::brightWhite},
-        { "window.cyan.textedit.disabled.bg", Colors::darkGray},
-        { "window.cyan.textedit.disabled.fg", Colors::lightGray},
-        { "window.cyan.textedit.selected.bg", Colors::brightWhite},
-        { "window.cyan.textedit.selected.fg", Colors::darkGray},
-        { "window.cyan.textedit.linenumber.bg", { 0x22, 0x22, 0x22}},
-        { "window.cyan.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-        { "window.cyan.textedit.focused.linenumber.bg", { 0,    0x80,    0}},
-        { "window.cyan.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
-    });
-
-    setDefaultRules(p);
-    return p;
+    // Built only once, see classic().
+    static const ZPalette palette = [] {
+        ZPalette p;
+        p.setColors({
+            { "root.bg", Colors::black},
+            { "root.fg", {0x80, 0x80, 0x80}},
+
+            { "menu.bg", Colors::lightGray},
+            { "menu.fg", Colors::black},
+            { "menu.disabled.bg", Colors::lightGray},
+            { "menu.disabled.fg", Colors::darkGray},
+            { "menu.shortcut.bg", Colors::lightGray},
+            { "menu.shortcut.fg", Colors::red},
+            { "menu.selected.bg", Colors::green},
+            { "menu.selected.fg", Colors::black},
+            { "menu.selected.disabled.bg", Colors::green},
+            { "menu.selected.disabled.fg", Colors::darkGray},
+            { "menu.selected.shortcut.bg", Colors::green},
+            { "menu.selected.shortcut.fg", Colors::red},
+
+            { "window.default.bg", Colors::black},
+            { "window.default.frame.focused.fg", Colors::brightWhite},
+            { "window.default.frame.focused.control.fg", Colors::brightGreen},
+            { "window.default.frame.unfocused.fg", Colors::lightGray},
+            { "window.default.scrollbar.fg", Colors::black},
+            { "window.default.scrollbar.bg", { 0, 0x55, 0xaa}},
+            { "window.default.scrollbar.control.fg", Colors::brightWhite},
+            { "window.default.scrollbar.control.bg", Colors::darkGray},
+            { "window.default.text.fg", Colors::brightYellow},
+            { "window.default.text.bg", Colors::black},
+            { "window.default.text.selected.fg", Colors::black},
+            { "window.default.text.selected.bg", Colors::lightGray},
+            { "window.default.control.bg", Colors::black},
+            { "window.default.control.fg", Colors::lightGray},
+            { "window.default.control.focused.bg", Colors::black},
+            { "window.default.control.focused.fg", Colors::brightWhite},
+            { "window.default.control.disabled.bg", Colors::black},
+            { "window.default.control.disabled.fg", Colors::darkGray},
+            { "window.default.control.shortcut.bg", Colors::black},
+            { "window.default.control.shortcut.fg", Colors::brightYellow},
+            { "window.default.dataview.bg", Colors::brightWhite},
+            { "window.default.dataview.fg", Colors::darkGray},
+            { "window.default.dataview.selected.bg", Colors::brightWhite},
+            { "window.default.dataview.selected.fg", Colors::black},
+            { "window.default.dataview.selected.focused.bg", Colors::brightGreen},
+            { "window.default.dataview.selected.focused.fg", Colors::black},
+            { "window.default.dataview.disabled.bg", Colors::lightGray},
+            { "window.default.dataview.disabled.fg", Colors::darkGray},
+            { "window.default.dataview.disabled.selected.bg", Colors::lightGray},
+            { "window.default.dataview.disabled.selected.fg", Colors::brightWhite},
+            { "window.default.button.bg", Colors::green},
+            { "window.default.button.fg", Colors::black},
+            { "window.default.button.default.bg", Colors::green},
+            { "window.default.button.default.fg", Colors::brightCyan},
+            { "window.default.button.focused.bg", Colors::green},
+            { "window.default.button.focused.fg", Colors::brightWhite},
+            { "window.default.button.disabled.bg", Colors::lightGray},
+            { "window.default.button.disabled.fg", Colors::darkGray},
+            { "window.default.button.shortcut.bg", Colors::green},
+            { "window.default.button.shortcut.fg", Colors::brightYellow},
+            { "window.default.lineedit.bg", Colors::lightGray},
+            { "window.default.lineedit.fg", Colors::black},
+            { "window.default.lineedit.focused.bg", Colors::lightGray},
+            { "window.default.lineedit.focused.fg", Colors::brightWhite},
+            { "window.default.lineedit.disabled.bg", Colors::darkGray},
+            { "window.default.lineedit.disabled.fg", Colors::lightGray},
+            { "window.default.textedit.bg", Colors::lightGray},
+            { "window.default.textedit.fg", Colors::black},
+            { "window.default.textedit.focused.bg", Colors::lightGray},
+            { "window.default.textedit.focused.fg", Colors::brightWhite},
+            { "window.default.textedit.disabled.bg", Colors::darkGray},
+            { "window.default.textedit.disabled.fg", Colors::lightGray},
+            { "window.default.textedit.selected.bg", Colors::brightWhite},
+            { "window.default.textedit.selected.fg", Colors::darkGray},
+            { "window.default.textedit.linenumber.bg", { 0x22, 0x22, 0x22}},
+            { "window.default.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+            { "window.default.textedit.focused.linenumber.bg", { 0x22, 0x22, 0x22}},
+            { "window.default.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+
+            { "window.gray.bg", Colors::lightGray},
+            { "window.gray.frame.focused.fg", Colors::brightWhite},
+            { "window.gray.frame.focused.control.fg", Colors::brightGreen},
+            { "window.gray.frame.unfocused.fg", Colors::black},
+            { "window.gray.scrollbar.fg", Colors::cyan},
+            { "window.gray.scrollbar.bg", Colors::black},
+            { "window.gray.scrollbar.control.fg", Colors::cyan},
+            { "window.gray.scrollbar.control.bg", Colors::black},
+            { "window.gray.text.fg", Colors::lightGray},
+            { "window.gray.text.bg", Colors::black},
+            { "window.gray.text.selected.fg", Colors::lightGray},
+            { "window.gray.text.selected.bg", Colors::brightWhite},
+            { "window.gray.control.bg", Colors::lightGray},
+            { "window.gray.control.fg", Colors::black},
+            { "window.gray.control.focused.bg", Colors::lightGray},
+            { "window.gray.control.focused.fg", Colors::brightWhite},
+            { "window.gray.control.disabled.bg", Colors::lightGray},
+            { "window.gray.control.disabled.fg", Colors::darkGray},
+            { "window.gray.control.shortcut.bg", Colors::lightGray},
+            { "window.gray.control.shortcut.fg", Colors::brightYellow},
+            { "window.gray.dataview.bg", Colors::brightWhite},
+            { "window.gray.dataview.fg", Colors::darkGray},
+            { "window.gray.dataview.selected.bg", Colors::brightWhite},
+            { "window.gray.dataview.selected.fg", Colors::black},
+            { "window.gray.dataview.selected.focused.bg", Colors::brightGreen},
+            { "window.gray.dataview.selected.focused.fg", Colors::black},
+            { "window.gray.dataview.disabled.bg", Colors::darkGray},
+            { "window.gray.dataview.disabled.fg", Colors::lightGray},
+            { "window.gray.dataview.disabled.selected.bg", Colors::darkGray},
+            { "window.gray.dataview.disabled.selected.fg", Colors::brightWhite},
+            { "window.gray.button.bg", Colors::green},
+            { "window.gray.button.fg", Colors::black},
+            { "window.gray.button.default.bg", Colors::green},
+            { "window.gray.button.default.fg", Colors::brightCyan},
+            { "window.gray.button.focused.bg", Colors::green},
+            { "window.gray.button.focused.fg", Colors::brightWhite},
+            { "window.gray.button.disabled.bg", Colors::lightGray},
+            { "window.gray.button.disabled.fg", Colors::darkGray},
+            { "window.gray.button.shortcut.bg", Colors::green},
+            { "window.gray.button.shortcut.fg", Colors::brightYellow},
+            { "window.gray.lineedit.bg", Colors::black},
+            { "window.gray.lineedit.fg", Colors::brightWhite},
+            { "window.gray.lineedit.focused.bg", Colors::green},
+            { "window.gray.lineedit.focused.fg", Colors::brightWhite},
+            { "window.gray.lineedit.disabled.bg", Colors::darkGray},
+            { "window.gray.lineedit.disabled.fg", Colors::lightGray},
+            { "window.gray.textedit.bg", Colors::black},
+            { "window.gray.textedit.fg", Colors::brightWhite},
+            { "window.gray.textedit.focused.bg", Colors::green},
+            { "window.gray.textedit.focused.fg", Colors::brightWhite},
+            { "window.gray.textedit.disabled.bg", Colors::darkGray},
+            { "window.gray.textedit.disabled.fg", Colors::lightGray},
+            { "window.gray.textedit.selected.bg", Colors::brightWhite},
+            { "window.gray.textedit.selected.fg", Colors::darkGray},
+            { "window.gray.textedit.linenumber.bg", { 0x22, 0x22, 0x22}},
+            { "window.gray.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+            { "window.gray.textedit.focused.linenumber.bg", { 0, 0x80, 0}},
+            { "window.gray.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+
+            { "window.cyan.bg", Colors::cyan},
+            { "window.cyan.frame.focused.fg", Colors::brightWhite},
+            { "window.cyan.frame.focused.control.fg", Colors::brightGreen},
+            { "window.cyan.frame.unfocused.fg", Colors::lightGray},
+            { "window.cyan.scrollbar.fg", Colors::cyan},
+            { "window.cyan.scrollbar.bg", Colors::black},
+            { "window.cyan.scrollbar.control.fg", Colors::cyan},
+            { "window.cyan.scrollbar.control.bg", Colors::black},
+            { "window.cyan.text.fg", Colors::black},
+            { "window.cyan.text.bg", Colors::cyan},
+            { "window.cyan.text.selected.fg", Colors::brightWhite},
+            { "window.cyan.text.selected.bg", Colors::cyan},
+            { "window.cyan.control.bg", Colors::cyan},
+            { "window.cyan.control.fg", Colors::black},
+            { "window.cyan.control.focused.bg", Colors::cyan},
+            { "window.cyan.control.focused.fg", Colors::brightWhite},
+            { "window.cyan.control.disabled.bg", Colors::cyan},
+            { "window.cyan.control.disabled.fg", Colors::darkGray},
+            { "window.cyan.control.shortcut.bg", Colors::cyan},
+            { "window.cyan.control.shortcut.fg", Colors::brightYellow},
+            { "window.cyan.dataview.bg", Colors::blue},
+            { "window.cyan.dataview.fg", Colors::black},
+            { "window.cyan.dataview.selected.bg", Colors::blue},
+            { "window.cyan.dataview.selected.fg", Colors::brightYellow},
+            { "window.cyan.dataview.selected.focused.bg", Colors::green},
+            { "window.cyan.dataview.selected.focused.fg", Colors::brightWhite},
+            { "window.cyan.dataview.disabled.bg", Colors::lightGray},
+            { "window.cyan.dataview.disabled.fg", Colors::black},
+            { "window.cyan.dataview.disabled.selected.bg", Colors::lightGray},
+            { "window.cyan.dataview.disabled.selected.fg", Colors::brightWhite},
+            { "window.cyan.button.bg", Colors::green},
+            { "window.cyan.button.fg", Colors::black},
+            { "window.cyan.button.default.bg", Colors::green},
+            { "window.cyan.button.default.fg", Colors::brightCyan},
+            { "window.cyan.button.focused.bg", Colors::green},
+            { "window.cyan.button.focused.fg", Colors::brightWhite},
+            { "window.cyan.button.disabled.bg", Colors::lightGray},
+            { "window.cyan.button.disabled.fg", Colors::darkGray},
+            { "window.cyan.button.shortcut.bg", Colors::green},
+            { "window.cyan.button.shortcut.fg", Colors::brightYellow},
+            { "window.cyan.lineedit.bg", Colors::black},
+            { "window.cyan.lineedit.fg", Colors::brightWhite},
+            { "window.cyan.lineedit.focused.bg", Colors::green},
+            { "window.cyan.lineedit.focused.fg", Colors::brightWhite},
+            { "window.cyan.lineedit.disabled.bg", Colors::darkGray},
+            { "window.cyan.lineedit.disabled.fg", Colors::lightGray},
+            { "window.cyan.textedit.bg", Colors::black},
+            { "window.cyan.textedit.fg", Colors::brightWhite},
+            { "window.cyan.textedit.focused.bg", Colors::green},
+            { "window.cyan.textedit.focused.fg", Colors::brightWhite},
+            { "window.cyan.textedit.disabled.bg", Colors::darkGray},
+            { "window.cyan.textedit.disabled.fg", Colors::lightGray},
+            { "window.cyan.textedit.selected.bg", Colors::brightWhite},
+            { "window.cyan.textedit.selected.fg", Colors::darkGray},
+            { "window.cyan.textedit.linenumber.bg", { 0x22, 0x22, 0x22}},
+            { "window.cyan.textedit.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+            { "window.cyan.textedit.focused.linenumber.bg", { 0,    0x80,    0}},
+            { "window.cyan.textedit.focused.linenumber.fg", { 0xdd, 0xdd, 0xdd}},
+        });
+
+        setDefaultRules(p);
+        return p;
+    }();
+    return palette;
 }
 
 TUIWIDGETS_NS_END
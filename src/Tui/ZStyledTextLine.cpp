@@ -3,12 +3,72 @@
 #include "ZStyledTextLine.h"
 #include "ZStyledTextLine_p.h"
 
+#include <list>
+#include <utility>
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
 #include <Tui/MarkupParser.h>
 
 #include <Tui/Utils_p.h>
 
 TUIWIDGETS_NS_START
 
+namespace {
+    // Markup is usually static (menu items, labels, ...) and repainted often, so parsed results are kept in
+    // a process wide least recently used cache.
+    constexpr int markupCacheEntries = 1024;
+    // Longer markup is not cached, to bound the memory used by the cache.
+    constexpr int markupCacheMaxLength = 4096;
+
+    class MarkupCache {
+    public:
+        using Entry = std::pair<QString, std::shared_ptr<const ZStyledTextLinePrivate::ParsedMarkup>>;
+
+        QMutex mutex;
+        std::list<Entry> entries; // most recently used first
+        QHash<QString, std::list<Entry>::iterator> index;
+    };
+
+    MarkupCache &markupCache() {
+        static MarkupCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const ZStyledTextLinePrivate::ParsedMarkup> cachedParseMarkup(const QString &markup) {
+        if (markup.size() > markupCacheMaxLength) {
+            return ZStyledTextLinePrivate::parseMarkup(markup);
+        }
+
+        MarkupCache &cache = markupCache();
+        {
+            QMutexLocker locker(&cache.mutex);
+            auto it = cache.index.find(markup);
+            if (it != cache.index.end()) {
+                cache.entries.splice(cache.entries.begin(), cache.entries, *it);
+                return (*it)->second;
+            }
+        }
+
+        // Parse without holding the lock, if another thread parses the same markup concurrently the result is
+        // just inserted twice.
+        auto parsed = ZStyledTextLinePrivate::parseMarkup(markup);
+
+        QMutexLocker locker(&cache.mutex);
+        if (!cache.index.contains(markup)) {
+            cache.entries.emplace_front(markup, parsed);
+            cache.index.insert(markup, cache.entries.begin());
+            if (size2int(cache.entries.size()) > markupCacheEntries) {
+                cache.index.remove(cache.entries.back().first);
+                cache.entries.pop_back();
+            }
+        }
+        return parsed;
+    }
+}
+
 ZStyledTextLine::ZStyledTextLine() = default;
 
 ZStyledTextLine::ZStyledTextLine(const ZStyledTextLine&) = default;
@@ -20,8 +80,12 @@ ZStyledTextLine &ZStyledTextLine::operator=(ZStyledTextLine&&) = default;
 
 void ZStyledTextLine::setMarkup(const QString &markup) {
     auto *const p = tuiwidgets_impl();
+    if (p->markup == markup && p->text.isEmpty()) {
+        return;
+    }
     p->markup = markup;
     p->text.clear();
+    p->parsedMarkup.reset();
     p->cached = false;
 }
 
@@ -32,8 +96,12 @@ QString ZStyledTextLine::markup() const {
 
 void ZStyledTextLine::setText(const QString &text) {
     auto *const p = tuiwidgets_impl();
+    if (p->text == text && p->markup.isEmpty()) {
+        return;
+    }
     p->markup.clear();
     p->text = text;
+    p->parsedMarkup.reset();
     p->cached = false;
 }
 
@@ -79,25 +147,28 @@ void ZStyledTextLine::write(ZPainter *painter, int x, int y, int width) const {
     ZTextMetrics textMetrics = painter->textMetrics();
     x = 0;
     localPainter.clear(p->baseStyle.foregroundColor(), p->baseStyle.backgroundColor(), p->baseStyle.attributes());
+    // segments are written directly from textFromMarkup without copying
+    const QChar *const text = p->textFromMarkup.constData();
     int lastIdx = 0;
     for (int i = 0; i < p->styles.size(); i++) {
         if (lastIdx != p->styles[i].startIndex) {
-            QString part = p->textFromMarkup.mid(lastIdx, p->styles[i].startIndex - lastIdx);
+            const int partSize = p->styles[i].startIndex - lastIdx;
             localPainter.writeWithAttributes(x, 0,
-                                             part,
+                                             text + lastIdx, partSize,
                                              p->styles[i - 1].style.foregroundColor(), p->styles[i - 1].style.backgroundColor(),
                                              p->styles[i - 1].style.attributes());
-            x += textMetrics.sizeInColumns(part);
+            x += textMetrics.sizeInColumns(text + lastIdx, partSize);
             lastIdx = p->styles[i].startIndex;
         }
     }
     if (lastIdx != p->textFromMarkup.size()) {
         localPainter.writeWithAttributes(x, 0,
-                                         p->textFromMarkup.mid(lastIdx, p->textFromMarkup.size() - lastIdx),
+                                         text + lastIdx, size2int(p->textFromMarkup.size()) - lastIdx,
                                          p->styles.last().style.foregroundColor(), p->styles.last().style.backgroundColor(),
                                          p->styles.last().style.attributes());
     }
 }
+
 bool ZStyledTextLine::hasParsingError() const {
     auto *const p = tuiwidgets_impl();
     p->ensureCache();
@@ -114,81 +185,26 @@ void ZStyledTextLinePrivate::ensureCache() const {
     if (!cached) {
         cached = true;
         parsingError = false;
-        textFromMarkup.clear();
         styles.clear();
         mnemonic.clear();
 
         if (markup.size()) {
-            QString maybeMnemonic;
-            bool inMElement = false;
-            QVector<ZTextStyle> stack;
-            stack.append(baseStyle);
-
-            using Private::MarkupParser;
-
-            MarkupParser p(markup);
-
-            bool done = false;
-            bool error = false;
-            while (!done && !error) {
-                p.nextEvent();
-                p.visit(overload(
-                    [&](const MarkupParser::Error&) {
-                        //qDebug() << "error";
-                        error = true;
-                    },
-                    [&](const MarkupParser::ElementBegin &ev) {
-                        //qDebug() << "begin" << ev.name() << ev.attributes();
-                        stack.append(stack.last());
-                        if (ev.name() == QStringLiteral("m")) {
-                            if (inMElement) {
-                                error = true;
-                            }
-                            inMElement = true;
-                            stack.last() = mnemonicStyle;
-                        }
-                    },
-                    [&](const MarkupParser::ElementEnd &ev) {
-                        //qDebug() << "end" << ev.name();
-                        stack.removeLast();
-                        if (ev.name() == QStringLiteral("m")) {
-                            inMElement = false;
-                        }
-                    },
-                    [&](const MarkupParser::CharEvent &ev) {
-                        //qDebug() << "char" << ev.asString();
-                        if (styles.isEmpty()) {
-                            styles.append({size2int(textFromMarkup.size()), stack.last()});
-                        } else {
-                            if (styles.last().style != stack.last()) {
-                                styles.append({size2int(textFromMarkup.size()), stack.last()});
-                            }
-                        }
-                        textFromMarkup.append(ev.asString());
-                        if (inMElement) {
-                            maybeMnemonic.append(ev.asString());
-                        }
-                    },
-                    [&](const MarkupParser::DocumentEnd&) {
-                        //qDebug() << "the end";
-                        done = true;
-                    }
-                ));
+            if (!parsedMarkup) {
+                parsedMarkup = cachedParseMarkup(markup);
             }
-            if (error) {
-                textFromMarkup.clear();
-                styles.clear();
-                textFromMarkup = QStringLiteral("Error parsing");
+
+            textFromMarkup = parsedMarkup->text;
+            if (parsedMarkup->parsingError) {
                 styles.append({0, ZTextStyle({0xff, 0, 0}, {0, 0, 0})});
                 parsingError = true;
             } else {
-                if (maybeMnemonic.size() == 1) {
-                    mnemonic = maybeMnemonic;
-                } else if (maybeMnemonic.size() == 2
-                           && QChar::isHighSurrogate(maybeMnemonic[0].unicode())
-                           && QChar::isLowSurrogate(maybeMnemonic[1].unicode())) {
-                    mnemonic = maybeMnemonic;
+                for (const ParsedMarkup::Span &span: parsedMarkup->spans) {
+                    const ZTextStyle &style = span.mnemonic ? mnemonicStyle : baseStyle;
+                    if (styles.isEmpty() || styles.last().style != style) {
+                        styles.append({span.startIndex, style});
+                    }
                 }
+                mnemonic = parsedMarkup->mnemonic;
             }
         } else {
             styles.append({0, baseStyle});
@@ -197,4 +213,72 @@ void ZStyledTextLinePrivate::ensureCache() const {
     }
 }
 
+std::shared_ptr<const ZStyledTextLinePrivate::ParsedMarkup> ZStyledTextLinePrivate::parseMarkup(const QString &markup) {
+    auto result = std::make_shared<ParsedMarkup>();
+
+    QString maybeMnemonic;
+    bool inMElement = false;
+    // true for elements with mnemonic style
+    QVector<bool> stack;
+    stack.append(false);
+
+    using Private::MarkupParser;
+
+    MarkupParser p(markup);
+
+    bool done = false;
+    bool error = false;
+    while (!done && !error) {
+        p.nextEvent();
+        p.visit(overload(
+            [&](const MarkupParser::Error&) {
+                error = true;
+            },
+            [&](const MarkupParser::ElementBegin &ev) {
+                stack.append(stack.last());
+                if (ev.name() == QStringLiteral("m")) {
+                    if (inMElement) {
+                        error = true;
+                    }
+                    inMElement = true;
+                    stack.last() = true;
+                }
+            },
+            [&](const MarkupParser::ElementEnd &ev) {
+                stack.removeLast();
+                if (ev.name() == QStringLiteral("m")) {
+                    inMElement = false;
+                }
+            },
+            [&](const MarkupParser::CharEvent &ev) {
+                if (result->spans.isEmpty() || result->spans.last().mnemonic != stack.last()) {
+                    result->spans.append({size2int(result->text.size()), stack.last()});
+                }
+                result->text.append(ev.asString());
+                if (inMElement) {
+                    maybeMnemonic.append(ev.asString());
+                }
+            },
+            [&](const MarkupParser::DocumentEnd&) {
+                done = true;
+            }
+        ));
+    }
+    if (error) {
+        result->text = QStringLiteral("Error parsing");
+        result->spans.clear();
+        result->parsingError = true;
+    } else {
+        if (maybeMnemonic.size() == 1) {
+            result->mnemonic = maybeMnemonic;
+        } else if (maybeMnemonic.size() == 2
+                   && QChar::isHighSurrogate(maybeMnemonic[0].unicode())
+                   && QChar::isLowSurrogate(maybeMnemonic[1].unicode())) {
+            result->mnemonic = maybeMnemonic;
+        }
+    }
+
+    return result;
+}
+
 TUIWIDGETS_NS_END
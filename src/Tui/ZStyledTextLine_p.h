@@ -3,6 +3,8 @@
 #ifndef TUIWIDGETS_ZSTYLEDTEXTLINE_P_INCLUDED
 #define TUIWIDGETS_ZSTYLEDTEXTLINE_P_INCLUDED
 
+#include <memory>
+
 #include <QVector>
 
 #include <Tui/ZStyledTextLine.h>
@@ -16,8 +18,24 @@ class ZStyledTextLinePrivate {
     ZStyledTextLinePrivate();
     virtual ~ZStyledTextLinePrivate();
 
+    // Result of parsing markup. This does not depend on the styles, so it can be shared between all instances
+    // with the same markup.
+    class ParsedMarkup {
+    public:
+        struct Span {
+            int startIndex;
+            bool mnemonic;
+        };
+
+        QString text;
+        QVector<Span> spans;
+        QString mnemonic;
+        bool parsingError = false;
+    };
+
 public:
     void ensureCache() const;
+    static std::shared_ptr<const ParsedMarkup> parseMarkup(const QString &markup);
 
 public:
     QString markup;
@@ -31,6 +49,7 @@ class ZStyledTextLinePrivate {
     };
 
     mutable bool cached = false;
+    mutable std::shared_ptr<const ParsedMarkup> parsedMarkup; // for markup, independent of cached
     mutable QString textFromMarkup;
     mutable QVector<StylePos> styles;
     mutable QString mnemonic;
@@ -17,27 +17,40 @@ static QList<QString> &ZSymbol_reverse() {
     static QList<QString> data;
     return data;
 }
+static std::mutex &ZSymbol_mutex() {
+    static std::mutex mut;
+    return mut;
+}
 
 QString ZSymbol::toString() const {
     if (id == 0) {
         return QStringLiteral("");
     }
+    std::lock_guard<std::mutex> g(ZSymbol_mutex());
     return ZSymbol_reverse().at(id - 1);
 }
 
 int ZSymbol::lookup(QString str, bool create) {
     static int max = 0;
-    static std::mutex mut;
+    // Symbols are often looked up from strings while painting. With terminals in multiple threads each thread
+    // keeps its own cache of known symbols, so lookups don't contend on the mutex.
+    thread_local QHash<QString, int> threadCache;
 
     if (str.isEmpty()) {
         return 0;
     }
 
-    std::lock_guard<std::mutex> g(mut);
+    auto cached = threadCache.constFind(str);
+    if (cached != threadCache.constEnd()) {
+        return cached.value();
+    }
+
+    std::lock_guard<std::mutex> g(ZSymbol_mutex());
 
     auto &table = ZSymbol_table();
     auto it = table.find(str);
     if (it != table.end()) {
+        threadCache.insert(str, it.value());
         return it.value();
     }
 
@@ -45,6 +58,7 @@ int ZSymbol::lookup(QString str, bool create) {
         ++max;
         table.insert(str, max);
         ZSymbol_reverse().append(str);
+        threadCache.insert(str, max);
         return max;
     }
 
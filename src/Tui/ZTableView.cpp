@@ -0,0 +1,666 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "ZTableView.h"
+#include "ZTableView_p.h"
+
+#include <algorithm>
+
+#include <Tui/ZPainter.h>
+#include <Tui/ZTerminal.h>
+#include <Tui/ZTextStyle.h>
+
+TUIWIDGETS_NS_START
+
+namespace {
+    // Number of rows (spread over the whole model) used to determine the initial width of a column.
+    constexpr int columnSampleRows = 64;
+    constexpr int maxAutoColumnWidth = 40;
+}
+
+ZTableViewPrivate::ZTableViewPrivate(ZWidget *pub) : ZWidgetPrivate(pub) {
+}
+
+ZTableViewPrivate::~ZTableViewPrivate() {
+}
+
+int ZTableViewPrivate::headerHeight() const {
+    return (headerVisible && model && model->columnCount() > 0) ? 1 : 0;
+}
+
+int ZTableViewPrivate::effectiveFixedRows() const {
+    if (!model) {
+        return 0;
+    }
+    return std::min(fixedRowCount, model->rowCount());
+}
+
+int ZTableViewPrivate::bodyHeight() const {
+    return std::max(0, pub()->geometry().height() - headerHeight() - effectiveFixedRows());
+}
+
+int ZTableViewPrivate::maxScrollPosition() const {
+    if (!model) {
+        return 0;
+    }
+    return std::max(0, model->rowCount() - effectiveFixedRows() - bodyHeight());
+}
+
+// Returns the row displayed in the line (not counting the header line) or -1 if the line is empty.
+int ZTableViewPrivate::rowAtLine(int line) const {
+    const int fixedRows = effectiveFixedRows();
+    if (line < fixedRows) {
+        return line;
+    }
+    const int row = fixedRows + scrollPosition + (line - fixedRows);
+    return row < model->rowCount() ? row : -1;
+}
+
+bool ZTableViewPrivate::isAnyRowVisible(int first, int last) const {
+    const int fixedRows = effectiveFixedRows();
+    if (first < fixedRows) {
+        return true;
+    }
+    const int bodyFirst = fixedRows + scrollPosition;
+    const int bodyLast = bodyFirst + bodyHeight() - 1;
+    return last >= bodyFirst && first <= bodyLast;
+}
+
+void ZTableViewPrivate::scrollToRow(int row) {
+    const int fixedRows = effectiveFixedRows();
+    const int visibleRows = bodyHeight();
+    if (row >= fixedRows && visibleRows > 0) {
+        row -= fixedRows;
+        if (row < scrollPosition) {
+            scrollPosition = row;
+        } else if (row >= scrollPosition + visibleRows) {
+            scrollPosition = row - visibleRows + 1;
+        }
+    }
+    scrollPosition = std::max(0, std::min(scrollPosition, maxScrollPosition()));
+}
+
+const ZTableViewPrivate::CachedCell &ZTableViewPrivate::cachedCell(int row, int column, const ZTextMetrics &metrics) {
+    auto it = rowCache.find(row);
+    if (it == rowCache.end()) {
+        it = rowCache.insert(row, CachedRow());
+        it->cells.resize(model->columnCount());
+    }
+    CachedCell &cell = it->cells[column];
+    if (cell.width < 0) {
+        cell.text = model->index(row, column).data().toString();
+        cell.width = metrics.sizeInColumns(cell.text);
+        growColumnWidth(column, cell.width);
+    }
+    return cell;
+}
+
+const QString &ZTableViewPrivate::headerText(int column) {
+    if (!headerCacheValid) {
+        const int columns = model->columnCount();
+        headerCache.resize(columns);
+        for (int i = 0; i < columns; i++) {
+            headerCache[i] = model->headerData(i, Qt::Horizontal).toString();
+        }
+        headerCacheValid = true;
+    }
+    return headerCache[column];
+}
+
+int ZTableViewPrivate::columnWidth(int column, const ZTextMetrics &metrics) {
+    auto explicitWidth = explicitColumnWidths.find(column);
+    if (explicitWidth != explicitColumnWidths.end()) {
+        return *explicitWidth;
+    }
+    if (autoColumnWidths[column] < 0) {
+        measureColumn(column, metrics);
+    }
+    return autoColumnWidths[column];
+}
+
+void ZTableViewPrivate::measureColumn(int column, const ZTextMetrics &metrics) {
+    int width = 1;
+    if (headerVisible) {
+        width = std::max(width, metrics.sizeInColumns(headerText(column)));
+    }
+    // Only a sample of the rows is measured here, other rows widen the column when they are displayed.
+    const int rows = model->rowCount();
+    const int step = std::max(1, rows / columnSampleRows);
+    for (int row = 0; row < rows && width < maxAutoColumnWidth; row += step) {
+        width = std::max(width, metrics.sizeInColumns(model->index(row, column).data().toString()));
+    }
+    autoColumnWidths[column] = std::min(width, maxAutoColumnWidth);
+}
+
+void ZTableViewPrivate::growColumnWidth(int column, int width) {
+    // Columns that are not measured yet will see this cell when sampling, if it is in the sampled rows.
+    if (autoColumnWidths[column] < 0 || explicitColumnWidths.contains(column)) {
+        return;
+    }
+    width = std::min(width, maxAutoColumnWidth);
+    if (width > autoColumnWidths[column]) {
+        autoColumnWidths[column] = width;
+        columnWidthsGrew = true;
+    }
+}
+
+QVector<ZTableViewPrivate::VisibleColumn> ZTableViewPrivate::layoutColumns(const ZTextMetrics &metrics) {
+    QVector<VisibleColumn> result;
+    const int columns = model->columnCount();
+    const int right = pub()->geometry().width() - 1;
+    int x = 1;
+    for (int column = firstColumn; column < columns && x < right; column++) {
+        const int width = columnWidth(column, metrics);
+        result.append({column, x, std::min(width, right - x)});
+        x += width + 1;
+    }
+    return result;
+}
+
+void ZTableViewPrivate::invalidateCells(int firstRow, int lastRow, int fromColumn, int toColumn) {
+    auto invalidate = [&](CachedRow &row) {
+        const int last = std::min(toColumn, static_cast<int>(row.cells.size()) - 1);
+        for (int column = std::max(0, fromColumn); column <= last; column++) {
+            row.cells[column] = CachedCell();
+        }
+    };
+
+    rowCache.forEachInRange(firstRow, lastRow, invalidate);
+}
+
+void ZTableViewPrivate::clearCaches() {
+    const int columns = model ? model->columnCount() : 0;
+    rowCache.clear();
+    headerCache.clear();
+    headerCacheValid = false;
+    autoColumnWidths.fill(-1, columns);
+    firstColumn = std::max(0, std::min(firstColumn, columns - 1));
+}
+
+ZTableView::ZTableView(ZWidget *parent) : ZWidget(parent, std::make_unique<ZTableViewPrivate>(this)) {
+    setFocusPolicy(StrongFocus);
+    setSizePolicyV(SizePolicy::Expanding);
+    setSizePolicyH(SizePolicy::Expanding);
+}
+
+ZTableView::~ZTableView() {
+    detachModel();
+}
+
+void ZTableView::setModel(QAbstractItemModel *model) {
+    auto *const p = tuiwidgets_impl();
+    detachModel();
+    p->model = model;
+    p->scrollPosition = 0;
+    p->firstColumn = 0;
+    p->clearCaches();
+    attachModel();
+    if (p->model) {
+        setCurrentIndex(p->model->index(0, 0));
+    }
+    update();
+}
+
+QAbstractItemModel *ZTableView::model() const {
+    auto *const p = tuiwidgets_impl();
+    return p->model;
+}
+
+void ZTableView::setCurrentIndex(QModelIndex index) {
+    auto *const p = tuiwidgets_impl();
+    if (index.isValid()) {
+        if (p->selectionModel) {
+            p->selectionModel->setCurrentIndex(index, QItemSelectionModel::ClearAndSelect
+                                                      | QItemSelectionModel::Rows);
+        }
+    }
+}
+
+QModelIndex ZTableView::currentIndex() const {
+    auto *const p = tuiwidgets_impl();
+    if (!p->selectionModel) {
+        return {};
+    }
+    return p->selectionModel->currentIndex();
+}
+
+QItemSelectionModel *ZTableView::selectionModel() const {
+    auto *const p = tuiwidgets_impl();
+    return p->selectionModel;
+}
+
+bool ZTableView::headerVisible() const {
+    auto *const p = tuiwidgets_impl();
+    return p->headerVisible;
+}
+
+void ZTableView::setHeaderVisible(bool visible) {
+    auto *const p = tuiwidgets_impl();
+    if (p->headerVisible == visible) {
+        return;
+    }
+    p->headerVisible = visible;
+    // The header text is part of the automatic column widths.
+    p->autoColumnWidths.fill(-1);
+    p->scrollPosition = std::min(p->scrollPosition, p->maxScrollPosition());
+    update();
+}
+
+int ZTableView::fixedRowCount() const {
+    auto *const p = tuiwidgets_impl();
+    return p->fixedRowCount;
+}
+
+void ZTableView::setFixedRowCount(int rows) {
+    auto *const p = tuiwidgets_impl();
+    p->fixedRowCount = std::max(0, rows);
+    p->scrollPosition = std::min(p->scrollPosition, p->maxScrollPosition());
+    update();
+}
+
+int ZTableView::columnWidth(int column) const {
+    auto *const p = tuiwidgets_impl();
+    auto explicitWidth = p->explicitColumnWidths.find(column);
+    if (explicitWidth != p->explicitColumnWidths.end()) {
+        return *explicitWidth;
+    }
+    if (column < 0 || column >= p->autoColumnWidths.size()) {
+        return 0;
+    }
+    return std::max(0, p->autoColumnWidths[column]);
+}
+
+void ZTableView::setColumnWidth(int column, int width) {
+    auto *const p = tuiwidgets_impl();
+    if (column < 0) {
+        return;
+    }
+    if (width > 0) {
+        p->explicitColumnWidths.insert(column, width);
+    } else {
+        p->explicitColumnWidths.remove(column);
+    }
+    update();
+}
+
+int ZTableView::firstVisibleColumn() const {
+    auto *const p = tuiwidgets_impl();
+    return p->firstColumn;
+}
+
+void ZTableView::setFirstVisibleColumn(int column) {
+    auto *const p = tuiwidgets_impl();
+    const int columns = p->model ? p->model->columnCount() : 0;
+    p->firstColumn = std::max(0, std::min(column, columns - 1));
+    update();
+}
+
+QSize ZTableView::sizeHint() const {
+    return {20, 5};
+}
+
+void ZTableView::scrollTo(const QModelIndex &index) {
+    auto *const p = tuiwidgets_impl();
+    if (!p->model || !index.isValid()) return;
+
+    p->scrollToRow(index.row());
+
+    const int column = index.column();
+    if (column < p->firstColumn) {
+        p->firstColumn = column;
+    } else if (terminal()) {
+        // Move the first visible column right until the column fits (or is the first visible column).
+        const ZTextMetrics metrics = terminal()->textMetrics();
+        const int availableWidth = geometry().width() - 2;
+        int first = column;
+        int usedWidth = p->columnWidth(column, metrics);
+        while (first > p->firstColumn) {
+            const int width = usedWidth + 1 + p->columnWidth(first - 1, metrics);
+            if (width > availableWidth) {
+                break;
+            }
+            usedWidth = width;
+            --first;
+        }
+        p->firstColumn = first;
+    }
+    update();
+}
+
+void ZTableView::resizeEvent(ZResizeEvent *event) {
+    auto *const p = tuiwidgets_impl();
+    if (p->model) {
+        p->scrollPosition = std::min(p->scrollPosition, p->maxScrollPosition());
+        if (event->size().height() && currentIndex().isValid()) {
+            p->scrollToRow(currentIndex().row());
+        }
+    }
+
+    ZWidget::resizeEvent(event);
+}
+
+void ZTableView::detachModel() {
+    auto *const p = tuiwidgets_impl();
+    if (!p->model) return;
+    if (p->selectionModel) {
+        p->selectionModel->deleteLater();
+        p->selectionModel = nullptr;
+    }
+    disconnect(p->model, nullptr, this, nullptr);
+    p->model = nullptr;
+    p->clearCaches();
+}
+
+void ZTableView::attachModel() {
+    auto *const p = tuiwidgets_impl();
+    if (!p->model) return;
+    p->selectionModel = new QItemSelectionModel(p->model, this);
+
+    connect(p->selectionModel, &QItemSelectionModel::currentChanged, this, [this](const QModelIndex &current, const QModelIndex &previous) {
+        (void)previous;
+        auto *const p = tuiwidgets_impl();
+        if (current.isValid()) {
+            p->lastSelectedRow = current.row();
+            // Only scroll vertically, the horizontal scroll position is independent of the current index.
+            p->scrollToRow(current.row());
+        }
+        update();
+    });
+
+    connect(p->selectionModel, &QItemSelectionModel::selectionChanged, this, [this]() {
+        update();
+    });
+
+    auto handler = [this] {
+        auto *const p = tuiwidgets_impl();
+        const QModelIndex current = currentIndex();
+        if (!current.isValid() && p->model->rowCount()) {
+            setCurrentIndex(p->model->index(std::min(p->lastSelectedRow, p->model->rowCount() - 1), 0));
+        }
+        p->scrollToRow(currentIndex().row());
+        update();
+    };
+
+    connect(p->model, &QObject::destroyed, this, [this] {
+        auto *const p = tuiwidgets_impl();
+        disconnect(p->model, nullptr, this, nullptr);
+        p->model = nullptr;
+        if (p->selectionModel) {
+            p->selectionModel->deleteLater();
+        }
+        p->selectionModel = nullptr;
+        p->lastSelectedRow = 0;
+        p->scrollPosition = 0;
+        p->clearCaches();
+    });
+
+    auto clearCacheHandler = [this, handler] {
+        auto *const p = tuiwidgets_impl();
+        p->clearCaches();
+        handler();
+    };
+
+    connect(p->model, &QAbstractItemModel::columnsInserted, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::columnsMoved, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::columnsRemoved, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        auto *const p = tuiwidgets_impl();
+        if (topLeft.parent().isValid()) {
+            return;
+        }
+        p->invalidateCells(topLeft.row(), bottomRight.row(), topLeft.column(), bottomRight.column());
+        // Changes to rows outside of the visible area only need to drop the cached data.
+        if (p->isAnyRowVisible(topLeft.row(), bottomRight.row())) {
+            update();
+        }
+    });
+    connect(p->model, &QAbstractItemModel::headerDataChanged, this,
+            [this](Qt::Orientation orientation) {
+        auto *const p = tuiwidgets_impl();
+        if (orientation == Qt::Horizontal) {
+            p->headerCacheValid = false;
+            update();
+        }
+    });
+    connect(p->model, &QAbstractItemModel::layoutChanged, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::modelReset, this, clearCacheHandler);
+    connect(p->model, &QAbstractItemModel::rowsInserted, this,
+            [this, handler](const QModelIndex &parent, int first, int last) {
+        auto *const p = tuiwidgets_impl();
+        if (!parent.isValid()) {
+            p->rowCache.shift(first, last - first + 1);
+        }
+        handler();
+    });
+    connect(p->model, &QAbstractItemModel::rowsMoved, this, [this, handler] {
+        auto *const p = tuiwidgets_impl();
+        p->rowCache.clear();
+        handler();
+    });
+    connect(p->model, &QAbstractItemModel::rowsRemoved, this,
+            [this, handler](const QModelIndex &parent, int first, int last) {
+        auto *const p = tuiwidgets_impl();
+        if (!parent.isValid()) {
+            p->rowCache.removeRange(first, last);
+            p->rowCache.shift(last + 1, -(last - first + 1));
+        }
+        handler();
+    });
+}
+
+void ZTableView::paintEvent(ZPaintEvent *event) {
+    auto *const p = tuiwidgets_impl();
+    ZTextStyle baseStyle;
+    ZTextStyle selectedStyle;
+    ZTextStyle selectedStyleFocus;
+
+    auto *painter = event->painter();
+    auto *term = terminal();
+
+    if (isEnabled()) {
+        baseStyle = {getColor("dataview.fg"), getColor("dataview.bg")};
+        selectedStyle = {getColor("dataview.selected.fg"), getColor("dataview.selected.bg")};
+        selectedStyleFocus = {getColor("dataview.selected.focused.fg"), getColor("dataview.selected.focused.bg")};
+    } else {
+        baseStyle = {getColor("dataview.disabled.fg"), getColor("dataview.disabled.bg")};
+        selectedStyle = {getColor("dataview.disabled.selected.fg"), getColor("dataview.disabled.selected.bg")};
+        selectedStyleFocus = selectedStyle;
+    }
+    painter->clear(baseStyle.foregroundColor(), baseStyle.backgroundColor());
+
+    if (!p->model || !term) return;
+
+    const ZTextMetrics metrics = term->textMetrics();
+    const bool focused = isAncestorOf(term->focusWidget());
+    const QModelIndex current = p->selectionModel ? p->selectionModel->currentIndex() : QModelIndex();
+
+    const int headerHeight = p->headerHeight();
+    const int lines = std::max(0, geometry().height() - headerHeight);
+
+    QVector<ZTableViewPrivate::VisibleColumn> columns = p->layoutColumns(metrics);
+
+    // Load the visible cells first. Their contents can widen columns, in that case the columns are laid out again
+    // so that all lines use the same column positions.
+    p->columnWidthsGrew = false;
+    for (int line = 0; line < lines; line++) {
+        const int row = p->rowAtLine(line);
+        if (row < 0) {
+            break;
+        }
+        for (const auto &column: columns) {
+            p->cachedCell(row, column.column, metrics);
+        }
+    }
+    if (p->columnWidthsGrew) {
+        columns = p->layoutColumns(metrics);
+    }
+
+    if (headerHeight) {
+        for (const auto &column: columns) {
+            const QString &text = p->headerText(column.column);
+            const int codeUnits = metrics.splitByColumns(text, column.width).codeUnits;
+            painter->writeWithAttributes(column.x, 0, text.constData(), codeUnits,
+                                         baseStyle.foregroundColor(), baseStyle.backgroundColor(),
+                                         ZTextAttribute::Bold);
+        }
+    }
+
+    for (int line = 0; line < lines; line++) {
+        const int row = p->rowAtLine(line);
+        if (row < 0) {
+            break;
+        }
+        const int y = headerHeight + line;
+
+        ZTextStyle effectiveStyle;
+        if (p->selectionModel && p->selectionModel->isRowSelected(row, QModelIndex())) {
+            if (focused) {
+                effectiveStyle = selectedStyleFocus;
+            } else {
+                effectiveStyle = selectedStyle;
+            }
+            painter->clearRect(0, y, geometry().width(), 1,
+                               effectiveStyle.foregroundColor(), effectiveStyle.backgroundColor());
+        } else {
+            effectiveStyle = baseStyle;
+        }
+
+        for (const auto &column: columns) {
+            const ZTableViewPrivate::CachedCell &cell = p->cachedCell(row, column.column, metrics);
+            const int codeUnits = cell.width <= column.width ? cell.text.size()
+                                                             : metrics.splitByColumns(cell.text, column.width).codeUnits;
+            painter->writeWithColors(column.x, y, cell.text.constData(), codeUnits,
+                                     effectiveStyle.foregroundColor(), effectiveStyle.backgroundColor());
+        }
+
+        if (current.isValid() && current.row() == row) {
+            if (focused && isEnabled()) {
+                painter->writeWithColors(geometry().width()-1, y, QStringLiteral("«"),
+                                         effectiveStyle.foregroundColor(),
+                                         effectiveStyle.backgroundColor());
+                painter->writeWithColors(0, y, QStringLiteral("»"),
+                                         effectiveStyle.foregroundColor(),
+                                         effectiveStyle.backgroundColor());
+            } else {
+                painter->writeWithColors(geometry().width()-1, y, QStringLiteral("←"),
+                                         effectiveStyle.foregroundColor(),
+                                         effectiveStyle.backgroundColor());
+                painter->writeWithColors(0, y, QStringLiteral("→"),
+                                         effectiveStyle.foregroundColor(),
+                                         effectiveStyle.backgroundColor());
+            }
+        }
+    }
+
+    p->rowCache.trim(p->effectiveFixedRows() + p->scrollPosition, p->bodyHeight(), p->effectiveFixedRows());
+}
+
+void ZTableView::keyEvent(ZKeyEvent *event) {
+    auto *const p = tuiwidgets_impl();
+    if (!p->model) {
+        ZWidget::keyEvent(event);
+        return;
+    }
+
+    const int size = p->model->rowCount();
+    const int columns = p->model->columnCount();
+    const int pageSize = std::max(1, p->bodyHeight());
+
+    const QModelIndex current = currentIndex();
+    const int column = current.isValid() ? current.column() : 0;
+
+    if (event->key() == Key_Up && event->modifiers() == 0) {
+        if (current.row() > 0) {
+            setCurrentIndex(p->model->index(current.row() - 1, column));
+        }
+    } else if (event->key() == Key_Down && event->modifiers() == 0) {
+        if (current.row() < size - 1) {
+            setCurrentIndex(p->model->index(current.row() + 1, column));
+        }
+    } else if (event->key() == Key_Home && event->modifiers() == 0) {
+        setCurrentIndex(p->model->index(0, column));
+    } else if (event->key() == Key_End && event->modifiers() == 0) {
+        setCurrentIndex(p->model->index(size - 1, column));
+    } else if (event->key() == Key_PageUp && event->modifiers() == 0) {
+        setCurrentIndex(p->model->index(std::max(0, current.row() - pageSize), column));
+    } else if (event->key() == Key_PageDown && event->modifiers() == 0) {
+        setCurrentIndex(p->model->index(std::min(size - 1, current.row() + pageSize), column));
+    } else if (event->key() == Key_Left && event->modifiers() == 0) {
+        if (p->firstColumn > 0) {
+            --p->firstColumn;
+            update();
+        }
+    } else if (event->key() == Key_Right && event->modifiers() == 0) {
+        if (p->firstColumn < columns - 1) {
+            ++p->firstColumn;
+            update();
+        }
+    } else if (event->key() == Key_Enter && event->modifiers() == 0) {
+        enterPressed(current.row());
+    } else {
+        ZWidget::keyEvent(event);
+    }
+}
+
+bool ZTableView::event(QEvent *event) {
+    return ZWidget::event(event);
+}
+
+bool ZTableView::eventFilter(QObject *watched, QEvent *event) {
+    return ZWidget::eventFilter(watched, event);
+}
+
+QSize ZTableView::minimumSizeHint() const {
+    return ZWidget::minimumSizeHint();
+}
+
+QRect ZTableView::layoutArea() const {
+    return ZWidget::layoutArea();
+}
+
+QObject *ZTableView::facet(const QMetaObject &metaObject) const {
+    return ZWidget::facet(metaObject);
+}
+
+ZWidget *ZTableView::resolveSizeHintChain() {
+    return ZWidget::resolveSizeHintChain();
+}
+
+void ZTableView::timerEvent(QTimerEvent *event) {
+    return ZWidget::timerEvent(event);
+}
+
+void ZTableView::childEvent(QChildEvent *event) {
+    return ZWidget::childEvent(event);
+}
+
+void ZTableView::customEvent(QEvent *event) {
+    return ZWidget::customEvent(event);
+}
+
+void ZTableView::connectNotify(const QMetaMethod &signal) {
+    return ZWidget::connectNotify(signal);
+}
+
+void ZTableView::disconnectNotify(const QMetaMethod &signal) {
+    return ZWidget::disconnectNotify(signal);
+}
+
+void ZTableView::pasteEvent(ZPasteEvent *event) {
+    return ZWidget::pasteEvent(event);
+}
+
+void ZTableView::focusInEvent(ZFocusEvent *event) {
+    return ZWidget::focusInEvent(event);
+}
+
+void ZTableView::focusOutEvent(ZFocusEvent *event) {
+    return ZWidget::focusOutEvent(event);
+}
+
+void ZTableView::moveEvent(ZMoveEvent *event) {
+    return ZWidget::moveEvent(event);
+}
+
+
+TUIWIDGETS_NS_END
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_ZTABLEVIEW_P_INCLUDED
+#define TUIWIDGETS_ZTABLEVIEW_P_INCLUDED
+
+#include <Tui/ZTableView.h>
+
+#include <QHash>
+#include <QPointer>
+#include <QVector>
+
+#include <Tui/RowCache_p.h>
+#include <Tui/ZTextMetrics.h>
+#include <Tui/ZWidget_p.h>
+
+#include <Tui/tuiwidgets_internal.h>
+
+TUIWIDGETS_NS_START
+
+class ZTableViewPrivate : public ZWidgetPrivate {
+public:
+    ZTableViewPrivate(ZWidget *pub);
+    ~ZTableViewPrivate() override;
+
+public:
+    // Model data of a cell as needed for painting. Cells are only loaded for visible columns, width is -1 for
+    // cells that are not loaded yet.
+    struct CachedCell {
+        QString text;
+        int width = -1;
+    };
+
+    struct CachedRow {
+        QVector<CachedCell> cells;
+    };
+
+    struct VisibleColumn {
+        int column;
+        int x;
+        int width;
+    };
+
+public:
+    int headerHeight() const;
+    int effectiveFixedRows() const;
+    int bodyHeight() const;
+    int maxScrollPosition() const;
+    int rowAtLine(int line) const;
+    bool isAnyRowVisible(int first, int last) const;
+    void scrollToRow(int row);
+
+    const CachedCell &cachedCell(int row, int column, const ZTextMetrics &metrics);
+    const QString &headerText(int column);
+    int columnWidth(int column, const ZTextMetrics &metrics);
+    void measureColumn(int column, const ZTextMetrics &metrics);
+    void growColumnWidth(int column, int width);
+    QVector<VisibleColumn> layoutColumns(const ZTextMetrics &metrics);
+    void invalidateCells(int firstRow, int lastRow, int firstColumn, int lastColumn);
+    void clearCaches();
+
+public:
+    QAbstractItemModel *model = nullptr;
+    QPointer<QItemSelectionModel> selectionModel;
+    int lastSelectedRow = 0;
+    // first row after the fixed rows that is displayed
+    int scrollPosition = 0;
+    int firstColumn = 0;
+    int fixedRowCount = 0;
+    bool headerVisible = true;
+    RowCache<CachedRow> rowCache;
+    QVector<QString> headerCache;
+    bool headerCacheValid = false;
+    // Automatically determined widths, -1 for columns that were not measured yet. Widths only grow as more
+    // rows are seen until the model is reset.
+    QVector<int> autoColumnWidths;
+    QHash<int, int> explicitColumnWidths;
+    bool columnWidthsGrew = false;
+
+    TUIWIDGETS_DECLARE_PUBLIC(ZTableView)
+};
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_ZTABLEVIEW_P_INCLUDED
@@ -3,10 +3,14 @@
 #include <Tui/ZTerminal.h>
 #include <Tui/ZTerminal_p.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <limits>
 
 #include <QAbstractEventDispatcher>
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QMetaMethod>
 #include <QPointer>
 #include <QThread>
@@ -24,6 +28,11 @@
 
 TUIWIDGETS_NS_START
 
+#ifdef Q_CC_GNU
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+#define container_of(ptr, type, member) (reinterpret_cast<type *>(reinterpret_cast<char *>(ptr) - offsetof(type, member)))
+
 class ZTerminal::TerminalConnectionPrivate {
 public:
     static TerminalConnectionPrivate *get(ZTerminal::TerminalConnection *data) { return data->tuiwidgets_pimpl_ptr.get(); }
@@ -42,8 +51,7 @@ ZTerminalPrivate::ZTerminalPrivate(ZTerminal *pub, ZTerminal::Options options)
     : options(options)
 {
     pub_ptr = pub;
-    QObject::connect(QThread::currentThread()->eventDispatcher(), &QAbstractEventDispatcher::aboutToBlock,
-                     pub, &ZTerminal::dispatcherIsAboutToBlock);
+    connectToEventDispatcher();
 }
 
 ZTerminalPrivate::~ZTerminalPrivate() {
@@ -58,6 +66,13 @@ const ZTerminalPrivate *ZTerminalPrivate::get(const ZTerminal *terminal) {
     return terminal->tuiwidgets_impl();
 }
 
+void ZTerminalPrivate::connectToEventDispatcher() {
+    QObject::disconnect(dispatcherConnection);
+    dispatcherConnection = QObject::connect(QThread::currentThread()->eventDispatcher(),
+                                            &QAbstractEventDispatcher::aboutToBlock,
+                                            pub(), &ZTerminal::dispatcherIsAboutToBlock);
+}
+
 bool ZTerminalPrivate::mainWidgetFullyAttached() {
     return mainWidget.data() && ZWidgetPrivate::get(mainWidget.data())->terminal == this->pub();
 }
@@ -284,7 +299,27 @@ void ZTerminalPrivate::resetTestLayoutRequestTracker() {
 }
 
 void ZTerminalPrivate::processPaintingAndUpdateOutput(bool fullRepaint) {
+    if (!externalConnection && internalConnectionOutputPending()) {
+        // The terminal did not yet accept all output of the previous frame. Rendering now would only add to the
+        // queue, so drop this frame. A replacement frame is rendered when the queue is drained.
+        outputFrameDropped = true;
+        outputFrameDroppedFullRepaint |= fullRepaint;
+        ++outputStatistics.framesDropped;
+        // Scroll hints are only applied together with the frame they were given for.
+        discardScrollHint();
+        return;
+    }
+    if (outputFrameDroppedFullRepaint) {
+        fullRepaint = true;
+    }
+    outputFrameDropped = false;
+    outputFrameDroppedFullRepaint = false;
+
     if (mainWidgetFullyAttached()) {
+        QElapsedTimer frameTimer;
+        if (frameStatisticsEnabled) {
+            frameTimer.start();
+        }
         Q_EMIT pub()->beforeRendering();
 
         if (pub()->isLayoutPending()) {
@@ -304,17 +339,29 @@ void ZTerminalPrivate::processPaintingAndUpdateOutput(bool fullRepaint) {
             }
         }
 
+        if (frameStatisticsEnabled) {
+            currentFrameStatistics.layoutNs = frameTimer.nsecsElapsed();
+            frameTimer.restart();
+        }
+
         std::unique_ptr<ZPainter> paint;
-        std::unique_ptr<ZImage> img;
         if (minSize.width() > termpaint_surface_width(surface) || minSize.height() > termpaint_surface_height(surface)) {
             viewportActive = true;
             viewportRange.setX(std::min(0, termpaint_surface_width(surface) - minSize.width()));
             viewportRange.setY(std::min(0, termpaint_surface_height(surface) - minSize.height() - 1));
             adjustViewportOffset();
-            img = std::make_unique<ZImage>(pub(), std::max(minSize.width(), termpaint_surface_width(surface)),
-                                           std::max(minSize.height(), termpaint_surface_height(surface)));
-            paint = std::make_unique<ZPainter>(img->painter());
+            const QSize imageSize = {std::max(minSize.width(), termpaint_surface_width(surface)),
+                                     std::max(minSize.height(), termpaint_surface_height(surface))};
+            // The backing image is kept between frames, so it only needs to be cleared instead of reallocated.
+            if (viewportImage && viewportImage->size() == imageSize) {
+                termpaint_surface_clear(ZImageData::get(viewportImage.get())->surface,
+                                        TERMPAINT_DEFAULT_COLOR, TERMPAINT_DEFAULT_COLOR);
+            } else {
+                viewportImage = std::make_unique<ZImage>(pub(), imageSize.width(), imageSize.height());
+            }
+            paint = std::make_unique<ZPainter>(viewportImage->painter());
         } else {
+            viewportImage.reset();
             viewportActive = false;
             viewportUI = false;
             viewportRange.setX(0);
@@ -350,7 +397,7 @@ void ZTerminalPrivate::processPaintingAndUpdateOutput(bool fullRepaint) {
         if (viewportActive) {
             ZPainter terminalPainter = pub()->painter();
             terminalPainter.clear(ZColor::defaultColor(), ZColor::defaultColor());
-            terminalPainter.drawImage(viewportOffset.x(), viewportOffset.y(), *img);
+            terminalPainter.drawImage(viewportOffset.x(), viewportOffset.y(), *viewportImage);
             if (viewportUI) {
                 terminalPainter.writeWithColors(0, termpaint_surface_height(surface) - 1, QStringLiteral("←↑→↓ ESC"),
                                                 ZColor::defaultColor(), ZColor::defaultColor());
@@ -360,11 +407,251 @@ void ZTerminalPrivate::processPaintingAndUpdateOutput(bool fullRepaint) {
             }
         }
         Q_EMIT pub()->afterRendering();
+        if (frameStatisticsEnabled) {
+            currentFrameStatistics.paintNs = frameTimer.nsecsElapsed();
+        }
         if (fullRepaint) {
             pub()->updateOutputForceFullRepaint();
         } else {
             pub()->updateOutput();
         }
+    } else {
+        discardScrollHint();
+    }
+}
+
+void ZTerminalPrivate::flushOutput(bool fullRepaint) {
+    if (!frameStatisticsEnabled) {
+        termpaint_terminal_flush(terminal, fullRepaint);
+    } else {
+        flushOutputWithStatistics(fullRepaint);
+    }
+    if (options.testFlag(ZTerminal::ScrollRegionOutput)) {
+        rememberFlushedFrame();
+    }
+}
+
+void ZTerminalPrivate::flushOutputWithStatistics(bool fullRepaint) {
+    const int changed = countChangedCells();
+    currentFrameStatistics.cellsChanged = fullRepaint ? termpaint_surface_width(surface) * termpaint_surface_height(surface)
+                                                      : changed;
+    const qint64 bytesBefore = frameStatisticsBytes;
+    frameStatisticsIoNs = 0;
+    QElapsedTimer timer;
+    timer.start();
+    termpaint_terminal_flush(terminal, fullRepaint);
+    const qint64 elapsed = timer.nsecsElapsed();
+    currentFrameStatistics.bytesWritten = frameStatisticsBytes - bytesBefore;
+    currentFrameStatistics.flushNs = frameStatisticsIoNs;
+    currentFrameStatistics.diffNs = std::max(qint64(0), elapsed - frameStatisticsIoNs);
+    recordFrameStatistics();
+}
+
+static bool cellsEqual(termpaint_surface *surface1, int x1, int y1, termpaint_surface *surface2, int x2, int y2) {
+    int len1, len2;
+    const char *text1 = termpaint_surface_peek_text(surface1, x1, y1, &len1, nullptr, nullptr);
+    const char *text2 = termpaint_surface_peek_text(surface2, x2, y2, &len2, nullptr, nullptr);
+    return len1 == len2 && memcmp(text1, text2, len1) == 0
+            && termpaint_surface_peek_fg_color(surface1, x1, y1) == termpaint_surface_peek_fg_color(surface2, x2, y2)
+            && termpaint_surface_peek_bg_color(surface1, x1, y1) == termpaint_surface_peek_bg_color(surface2, x2, y2)
+            && termpaint_surface_peek_deco_color(surface1, x1, y1) == termpaint_surface_peek_deco_color(surface2, x2, y2)
+            && termpaint_surface_peek_style(surface1, x1, y1) == termpaint_surface_peek_style(surface2, x2, y2)
+            && termpaint_surface_peek_softwrap_marker(surface1, x1, y1)
+               == termpaint_surface_peek_softwrap_marker(surface2, x2, y2);
+}
+
+static bool rowsEqual(termpaint_surface *surface1, int y1, termpaint_surface *surface2, int y2, int width) {
+    for (int x = 0; x < width; x++) {
+        if (!cellsEqual(surface1, x, y1, surface2, x, y2)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void copySurface(termpaint_surface *source, termpaint_surface *destination) {
+    termpaint_surface_copy_rect(source, 0, 0, termpaint_surface_width(source), termpaint_surface_height(source),
+                                destination, 0, 0, TERMPAINT_COPY_NO_TILE, TERMPAINT_COPY_NO_TILE);
+}
+
+int ZTerminalPrivate::countChangedCells() {
+    const int width = termpaint_surface_width(surface);
+    const int height = termpaint_surface_height(surface);
+
+    int changed = 0;
+    if (!frameStatisticsSurface || termpaint_surface_width(frameStatisticsSurface) != width
+            || termpaint_surface_height(frameStatisticsSurface) != height) {
+        freeFrameStatisticsSurface();
+        frameStatisticsSurface = termpaint_terminal_new_surface(terminal, width, height);
+        changed = width * height;
+    } else {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (!cellsEqual(surface, x, y, frameStatisticsSurface, x, y)) {
+                    changed++;
+                }
+            }
+        }
+    }
+
+    copySurface(surface, frameStatisticsSurface);
+    return changed;
+}
+
+void ZTerminalPrivate::recordFrameStatistics() {
+    lastFrameStatistics = currentFrameStatistics;
+    currentFrameStatistics = ZTerminal::FrameStatistics();
+    if (frameStatisticsHistorySize > 0) {
+        if (frameStatisticsHistory.size() < frameStatisticsHistorySize) {
+            frameStatisticsHistory.append(lastFrameStatistics);
+        } else {
+            frameStatisticsHistory[frameStatisticsHistoryNext] = lastFrameStatistics;
+            frameStatisticsHistoryNext = (frameStatisticsHistoryNext + 1) % frameStatisticsHistorySize;
+        }
+    }
+}
+
+void ZTerminalPrivate::freeFrameStatisticsSurface() {
+    if (frameStatisticsSurface) {
+        termpaint_surface_free(frameStatisticsSurface);
+        frameStatisticsSurface = nullptr;
+    }
+}
+
+void ZTerminalPrivate::hintVerticalScroll(const QRect &region, int lines) {
+    if (!options.testFlag(ZTerminal::ScrollRegionOutput) || !lines) {
+        return;
+    }
+    if (scrollHintLines == 0) {
+        scrollHintRegion = region;
+        scrollHintLines = lines;
+    } else if (scrollHintRegion == region) {
+        scrollHintLines += lines;
+    } else {
+        // Conflicting hints, scrolling only one of the regions could still help, but keep it simple.
+        scrollHintRegion = QRect();
+    }
+}
+
+void ZTerminalPrivate::discardScrollHint() {
+    scrollHintRegion = QRect();
+    scrollHintLines = 0;
+}
+
+void ZTerminalPrivate::applyScrollHint() {
+    const QRect region = scrollHintRegion;
+    const int lines = scrollHintLines;
+    discardScrollHint();
+
+    if (!lines || !region.isValid() || !scrollPreviousFrame || viewportActive
+            || options.testFlag(ZTerminal::Inline)) {
+        return;
+    }
+    const int width = termpaint_surface_width(surface);
+    const int height = termpaint_surface_height(surface);
+    if (termpaint_surface_width(scrollPreviousFrame) != width
+            || termpaint_surface_height(scrollPreviousFrame) != height) {
+        return;
+    }
+    // Scroll regions only restrict lines, so only regions covering the whole width can be scrolled.
+    const QRect effectiveRegion = region & QRect(0, 0, width, height);
+    if (effectiveRegion.x() != 0 || effectiveRegion.width() != width || std::abs(lines) >= effectiveRegion.height()) {
+        return;
+    }
+    // Changes to these are applied by termpaint while flushing and would get lost below.
+    if (terminalCursorVisible != scrollFlushedCursorVisible || terminalCursorStyle != scrollFlushedCursorStyle
+            || terminalCursorR != scrollFlushedCursorR || terminalCursorG != scrollFlushedCursorG
+            || terminalCursorB != scrollFlushedCursorB) {
+        return;
+    }
+
+    const int top = effectiveRegion.top();
+    const int bottom = effectiveRegion.bottom();
+    const int movedRows = effectiveRegion.height() - std::abs(lines);
+
+    // Only worth it if most of the region actually moved by the hinted amount.
+    int matchingRows = 0;
+    for (int y = top; y <= bottom; y++) {
+        const int previousY = y + lines;
+        if (previousY >= top && previousY <= bottom && rowsEqual(surface, y, scrollPreviousFrame, previousY, width)) {
+            matchingRows++;
+        }
+    }
+    if (matchingRows * 2 <= movedRows) {
+        return;
+    }
+
+    // termpaint diffs against what it thinks is on the terminal. Let it "output" the previous frame scrolled like
+    // the terminal will do it, without actually sending that output, so the following flush only sends what
+    // changed relative to the scrolled contents.
+    if (!scrollNewFrame || termpaint_surface_width(scrollNewFrame) != width
+            || termpaint_surface_height(scrollNewFrame) != height) {
+        if (scrollNewFrame) {
+            termpaint_surface_free(scrollNewFrame);
+        }
+        scrollNewFrame = termpaint_terminal_new_surface(terminal, width, height);
+    }
+    copySurface(surface, scrollNewFrame);
+
+    copySurface(scrollPreviousFrame, surface);
+    if (lines > 0) {
+        termpaint_surface_copy_rect(scrollPreviousFrame, 0, top + lines, width, movedRows,
+                                    surface, 0, top, TERMPAINT_COPY_NO_TILE, TERMPAINT_COPY_NO_TILE);
+        termpaint_surface_clear_rect(surface, 0, bottom - lines + 1, width, lines,
+                                     TERMPAINT_DEFAULT_COLOR, TERMPAINT_DEFAULT_COLOR);
+    } else {
+        termpaint_surface_copy_rect(scrollPreviousFrame, 0, top, width, movedRows,
+                                    surface, 0, top - lines, TERMPAINT_COPY_NO_TILE, TERMPAINT_COPY_NO_TILE);
+        termpaint_surface_clear_rect(surface, 0, top, width, -lines,
+                                     TERMPAINT_DEFAULT_COLOR, TERMPAINT_DEFAULT_COLOR);
+    }
+    suppressOutput = true;
+    termpaint_terminal_flush(terminal, false);
+    suppressOutput = false;
+    copySurface(scrollNewFrame, surface);
+
+    // Set the scroll region (DECSTBM) and scroll it (SU / SD) with default attributes, so the new lines are blank.
+    // The terminal then has to match what termpaint assumes after the discarded flush: attributes reset and the
+    // cursor at its position. Resetting the scroll region moves the cursor home, so position it explicitly.
+    const QPoint cursor = terminalCursorPosition.x() >= 0 && terminalCursorPosition.y() >= 0 ? terminalCursorPosition
+                                                                                            : QPoint{0, 0};
+    const QByteArray sequence = QByteArrayLiteral("\033[0m\033[") + QByteArray::number(top + 1) + ';'
+            + QByteArray::number(bottom + 1) + "r\033[" + QByteArray::number(std::abs(lines))
+            + (lines > 0 ? "S" : "T") + "\033[r\033[0m\033[" + QByteArray::number(cursor.y() + 1) + ';'
+            + QByteArray::number(cursor.x() + 1) + 'H';
+    if (externalConnection) {
+        externalConnection->delegate->write(sequence.constData(), sequence.size());
+    } else {
+        internalConnection_integration_write(sequence.constData(), sequence.size());
+    }
+}
+
+void ZTerminalPrivate::rememberFlushedFrame() {
+    const int width = termpaint_surface_width(surface);
+    const int height = termpaint_surface_height(surface);
+    if (!scrollPreviousFrame || termpaint_surface_width(scrollPreviousFrame) != width
+            || termpaint_surface_height(scrollPreviousFrame) != height) {
+        if (scrollPreviousFrame) {
+            termpaint_surface_free(scrollPreviousFrame);
+        }
+        scrollPreviousFrame = termpaint_terminal_new_surface(terminal, width, height);
+    }
+    copySurface(surface, scrollPreviousFrame);
+    scrollFlushedCursorVisible = terminalCursorVisible;
+    scrollFlushedCursorStyle = terminalCursorStyle;
+    scrollFlushedCursorR = terminalCursorR;
+    scrollFlushedCursorG = terminalCursorG;
+    scrollFlushedCursorB = terminalCursorB;
+}
+
+void ZTerminalPrivate::freeScrollSurfaces() {
+    if (scrollPreviousFrame) {
+        termpaint_surface_free(scrollPreviousFrame);
+        scrollPreviousFrame = nullptr;
+    }
+    if (scrollNewFrame) {
+        termpaint_surface_free(scrollNewFrame);
+        scrollNewFrame = nullptr;
     }
 }
 
@@ -452,9 +739,8 @@ void ZTerminalPrivate::initOffscreen(const ZTerminal::OffScreen &offscreen) {
         termpaint_integration_deinit(ptr);
     };
     auto write = [] (termpaint_integration *ptr, const char *data, int length) {
-        Q_UNUSED(ptr);
         Q_UNUSED(data);
-        Q_UNUSED(length);
+        container_of(ptr, ZTerminalPrivate, integration)->frameStatisticsBytes += length;
     };
     auto flush = [] (termpaint_integration *ptr) {
         Q_UNUSED(ptr);
@@ -513,6 +799,9 @@ void ZTerminalPrivate::deinitTerminal() {
         // already done
         return;
     }
+    freeFrameStatisticsSurface();
+    freeScrollSurfaces();
+    viewportImage.reset();
     if (initState == ZTerminalPrivate::InitState::Paused) {
         termpaint_terminal_free(terminal);
     } else {
@@ -537,9 +826,10 @@ void ZTerminalPrivate::inputFromConnection(const char *data, int length) {
     awaitingResponse = false;
 
     termpaint_terminal_add_input_data(terminal, data, length);
-    QByteArray peek = QByteArray(termpaint_terminal_peek_input_buffer(terminal), termpaint_terminal_peek_input_buffer_length(terminal));
-    if (peek.length()) {
-        ZRawSequenceEvent event(ZRawSequenceEvent::pending, peek);
+    const int peekLength = termpaint_terminal_peek_input_buffer_length(terminal);
+    if (peekLength) {
+        ZRawSequenceEvent event(ZRawSequenceEvent::pending,
+                                QByteArray(termpaint_terminal_peek_input_buffer(terminal), peekLength));
         QCoreApplication::sendEvent(pub(), &event);
     }
     if (callbackRequested) {
@@ -557,6 +847,11 @@ void ZTerminalPrivate::externalWasResized() {
 void ZTerminal::TerminalConnection::terminalInput(const char *data, int length) {
     auto *const p = tuiwidgets_impl();
     if (p->terminal) {
+        if (QThread::currentThread() != p->terminal->pub()->thread()) {
+            qWarning("ZTerminal::TerminalConnection::terminalInput: Called from a thread other than the thread of the"
+                     " terminal!");
+            return;
+        }
         p->terminal->inputFromConnection(data, length);
     } else {
         qWarning("ZTerminal::TerminalConnection::terminalInput: No terminal associated!");
@@ -603,8 +898,11 @@ ZPainter ZTerminal::painter() {
 }
 
 ZTextMetrics ZTerminal::textMetrics() const {
-    auto *surface = tuiwidgets_impl()->surface;
-    return ZTextMetrics(std::make_shared<ZTextMetricsPrivate>(surface));
+    auto *const p = tuiwidgets_impl();
+    if (!p->textMetricsCache || p->textMetricsCache->surface != p->surface) {
+        p->textMetricsCache = std::make_shared<ZTextMetricsPrivate>(p->surface);
+    }
+    return ZTextMetrics(p->textMetricsCache);
 }
 
 ZWidget *ZTerminal::mainWidget() const {
@@ -621,6 +919,10 @@ void ZTerminal::setMainWidget(ZWidget *w) {
         // already in a widget tree and not root
         return;
     }
+    if (w && w->thread() != thread()) {
+        qWarning("ZTerminal::setMainWidget: The widget must live in the same thread as the terminal.");
+        return;
+    }
 
     if (w && ZWidgetPrivate::get(w)->terminal) {
         // remove from previous terminal if it was the main widget elsewhere
@@ -842,11 +1144,14 @@ void ZTerminal::updateOutput() {
     auto *const p = tuiwidgets_impl();
     if (p->initState == ZTerminalPrivate::InitState::InInitWithoutPendingPaintRequest) {
         p->initState = ZTerminalPrivate::InitState::InInitWithPendingPaintRequest;
+        p->discardScrollHint();
     } else if (p->initState == ZTerminalPrivate::InitState::InInitWithPendingPaintRequest) {
         // already requested
+        p->discardScrollHint();
     } else if (p->initState == ZTerminalPrivate::InitState::Ready) {
+        p->applyScrollHint();
         p->updateNativeTerminalState();
-        termpaint_terminal_flush(p->terminal, false);
+        p->flushOutput(false);
     }
 }
 
@@ -857,8 +1162,9 @@ void ZTerminal::updateOutputForceFullRepaint() {
     } else if (p->initState == ZTerminalPrivate::InitState::InInitWithPendingPaintRequest) {
         // already requested
     } else if (p->initState == ZTerminalPrivate::InitState::Ready) {
+        p->discardScrollHint();
         p->updateNativeTerminalState();
-        termpaint_terminal_flush(p->terminal, true);
+        p->flushOutput(true);
     }
 }
 
@@ -928,6 +1234,66 @@ QString ZTerminal::terminalSelfReportedNameAndVersion() const {
     return QString::fromUtf8(termpaint_terminal_self_reported_name_and_version(p->terminal));
 }
 
+ZTerminal::OutputStatistics ZTerminal::outputStatistics() const {
+    auto *const p = tuiwidgets_impl();
+    return p->outputStatistics;
+}
+
+bool ZTerminal::isFrameStatisticsEnabled() const {
+    auto *const p = tuiwidgets_impl();
+    return p->frameStatisticsEnabled;
+}
+
+void ZTerminal::setFrameStatisticsEnabled(bool enabled) {
+    auto *const p = tuiwidgets_impl();
+    if (p->frameStatisticsEnabled == enabled) {
+        return;
+    }
+    p->frameStatisticsEnabled = enabled;
+    p->currentFrameStatistics = FrameStatistics();
+    if (!enabled) {
+        p->freeFrameStatisticsSurface();
+    }
+}
+
+ZTerminal::FrameStatistics ZTerminal::lastFrameStatistics() const {
+    auto *const p = tuiwidgets_impl();
+    return p->lastFrameStatistics;
+}
+
+int ZTerminal::frameStatisticsHistorySize() const {
+    auto *const p = tuiwidgets_impl();
+    return p->frameStatisticsHistorySize;
+}
+
+void ZTerminal::setFrameStatisticsHistorySize(int frames) {
+    auto *const p = tuiwidgets_impl();
+    frames = std::max(0, frames);
+    if (p->frameStatisticsHistorySize == frames) {
+        return;
+    }
+    // keep the newest entries
+    QVector<FrameStatistics> history = frameStatisticsHistory();
+    if (history.size() > frames) {
+        history.remove(0, history.size() - frames);
+    }
+    p->frameStatisticsHistory = history;
+    p->frameStatisticsHistoryNext = 0;
+    p->frameStatisticsHistorySize = frames;
+}
+
+QVector<ZTerminal::FrameStatistics> ZTerminal::frameStatisticsHistory() const {
+    auto *const p = tuiwidgets_impl();
+    if (p->frameStatisticsHistoryNext == 0) {
+        return p->frameStatisticsHistory;
+    }
+    QVector<FrameStatistics> result;
+    result.reserve(p->frameStatisticsHistory.size());
+    result += p->frameStatisticsHistory.mid(p->frameStatisticsHistoryNext);
+    result += p->frameStatisticsHistory.mid(0, p->frameStatisticsHistoryNext);
+    return result;
+}
+
 void ZTerminal::pauseOperation() {
     auto *const p = tuiwidgets_impl();
     if (p->initState != ZTerminalPrivate::InitState::Ready) return;
@@ -958,6 +1324,46 @@ bool ZTerminal::isPaused() const {
     return p->initState == ZTerminalPrivate::InitState::Paused;
 }
 
+bool ZTerminal::moveToThreadWithWidgets(QThread *targetThread) {
+    auto *const p = tuiwidgets_impl();
+    if (QThread::currentThread() != thread()) {
+        qWarning("ZTerminal::moveToThreadWithWidgets: Must be called from the thread the terminal lives in.");
+        return false;
+    }
+    if (p->inputNotifier) {
+        // The signal handling for the default terminal and the internal connection are bound to the main thread.
+        qWarning("ZTerminal::moveToThreadWithWidgets: Only terminals using a TerminalConnection or offscreen"
+                 " terminals can be moved.");
+        return false;
+    }
+    if (parent() || (p->mainWidget && p->mainWidget->parent())) {
+        qWarning("ZTerminal::moveToThreadWithWidgets: The terminal and its main widget must not have a parent.");
+        return false;
+    }
+    if (!targetThread || targetThread == thread()) {
+        return targetThread != nullptr;
+    }
+
+    QObject::disconnect(p->dispatcherConnection);
+    p->callbackTimer.moveToThread(targetThread);
+    if (p->mainWidget) {
+        p->mainWidget->moveToThread(targetThread);
+    }
+    moveToThread(targetThread);
+
+    // Connect to the event dispatcher of the new thread. It only exists once the thread is running.
+    if (targetThread->eventDispatcher()) {
+        p->dispatcherConnection = QObject::connect(targetThread->eventDispatcher(),
+                                                   &QAbstractEventDispatcher::aboutToBlock,
+                                                   this, &ZTerminal::dispatcherIsAboutToBlock);
+    } else {
+        p->dispatcherConnection = QObject::connect(targetThread, &QThread::started, this, [p] {
+            p->connectToEventDispatcher();
+        }, Qt::DirectConnection);
+    }
+    return true;
+}
+
 std::unique_ptr<ZKeyEvent> ZTerminal::translateKeyEvent(const ZTerminalNativeEvent &nativeEvent) {
     termpaint_event *native = static_cast<termpaint_event*>(nativeEvent.nativeEventPointer());
 
@@ -1202,13 +1608,16 @@ bool ZTerminal::event(QEvent *event) {
                 }
             }
         } else if (native->type == TERMPAINT_EV_PASTE) {
+            // Large pastes arrive in many parts. Collect the raw bytes and decode only once, this also keeps
+            // characters intact that are split between parts.
             if (native->paste.initial) {
-                p->pasteTemp = QString::fromUtf8(native->paste.string, native->paste.length);
-            } else {
-                p->pasteTemp += QString::fromUtf8(native->paste.string, native->paste.length);
+                p->pasteTemp.clear();
             }
+            p->pasteTemp.append(native->paste.string, native->paste.length);
             if (native->paste.final) {
-                std::unique_ptr<ZPasteEvent> translated = std::make_unique<ZPasteEvent>(p->pasteTemp);
+                const QString text = QString::fromUtf8(p->pasteTemp);
+                p->pasteTemp = QByteArray();
+                std::unique_ptr<ZPasteEvent> translated = std::make_unique<ZPasteEvent>(text);
                 dispatchPasteEvent(*translated);
             }
         } else if (native->type == TERMPAINT_EV_REPAINT_REQUESTED) {
@@ -1393,11 +1802,6 @@ void ZTerminal::TerminalConnection::setSize(int width, int height) {
     }
 }
 
-#ifdef Q_CC_GNU
-#pragma GCC diagnostic ignored "-Winvalid-offsetof"
-#endif
-#define container_of(ptr, type, member) (reinterpret_cast<type *>(reinterpret_cast<char *>(ptr) - offsetof(type, member)))
-
 void ZTerminalPrivate::initIntegrationCommon() {
     termpaint_integration_set_request_callback(&integration, [] (termpaint_integration *ptr) {
         container_of(ptr, ZTerminalPrivate, integration)->integration_request_callback();
@@ -1426,10 +1830,30 @@ void ZTerminalPrivate::initExternal(ZTerminal::TerminalConnectionPrivate *connec
         // this does not really free, because ZTerminalPrivate which contains the integration struct is externally owned
     };
     auto write = [] (termpaint_integration *ptr, const char *data, int length) {
-        container_of(ptr, ZTerminalPrivate, integration)->externalConnection->delegate->write(data, length);
+        auto *const p = container_of(ptr, ZTerminalPrivate, integration);
+        if (p->suppressOutput) {
+            return;
+        }
+        p->frameStatisticsBytes += length;
+        if (p->frameStatisticsEnabled) {
+            QElapsedTimer timer;
+            timer.start();
+            p->externalConnection->delegate->write(data, length);
+            p->frameStatisticsIoNs += timer.nsecsElapsed();
+        } else {
+            p->externalConnection->delegate->write(data, length);
+        }
     };
     auto flush = [] (termpaint_integration *ptr) {
-        container_of(ptr, ZTerminalPrivate, integration)->externalConnection->delegate->flush();
+        auto *const p = container_of(ptr, ZTerminalPrivate, integration);
+        if (p->frameStatisticsEnabled) {
+            QElapsedTimer timer;
+            timer.start();
+            p->externalConnection->delegate->flush();
+            p->frameStatisticsIoNs += timer.nsecsElapsed();
+        } else {
+            p->externalConnection->delegate->flush();
+        }
     };
     termpaint_integration_init(&integration, free, write, flush);
 
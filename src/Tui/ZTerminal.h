@@ -6,11 +6,14 @@
 #include <memory>
 
 #include <QObject>
+#include <QVector>
 
 #include <Tui/ZCommon.h>
 #include <Tui/ZValuePtr.h>
 #include <Tui/tuiwidgets_internal.h>
 
+class QThread;
+
 TUIWIDGETS_NS_START
 
 class ZKeyEvent;
@@ -40,6 +43,7 @@ class TUIWIDGETS_EXPORT ZTerminal : public QObject {
         DebugDisableBufferedIo = 1 << 8,
         ConservativeTrueColorOutput = 1 << 9,
         Inline = 1 << 10,
+        ScrollRegionOutput = 1 << 11,
     };
     Q_DECLARE_FLAGS(Options, Option)
 
@@ -52,6 +56,23 @@ class TUIWIDGETS_EXPORT ZTerminal : public QObject {
         int _fd;
     };
 
+    struct OutputStatistics {
+        qint64 bytesWritten = 0;
+        qint64 bytesQueued = 0;
+        qint64 maxBytesQueued = 0;
+        qint64 timeBlockedNs = 0;
+        int framesDropped = 0;
+    };
+
+    struct FrameStatistics {
+        int cellsChanged = 0;
+        qint64 bytesWritten = 0;
+        qint64 layoutNs = 0;
+        qint64 paintNs = 0;
+        qint64 diffNs = 0;
+        qint64 flushNs = 0;
+    };
+
     class OffScreenData;
     class OffScreen {
     public:
@@ -158,10 +179,20 @@ class TUIWIDGETS_EXPORT ZTerminal : public QObject {
     QString terminalDetectionResultText() const;
     QString terminalSelfReportedNameAndVersion() const;
 
+    OutputStatistics outputStatistics() const;
+    bool isFrameStatisticsEnabled() const;
+    void setFrameStatisticsEnabled(bool enabled);
+    FrameStatistics lastFrameStatistics() const;
+    int frameStatisticsHistorySize() const;
+    void setFrameStatisticsHistorySize(int frames);
+    QVector<FrameStatistics> frameStatisticsHistory() const;
+
     void pauseOperation();
     void unpauseOperation();
     bool isPaused() const;
 
+    bool moveToThreadWithWidgets(QThread *thread);
+
     void setCursorStyle(CursorStyle style);
     void setCursorPosition(QPoint cursorPosition);
     void setCursorColor(int cursorColorR, int cursorColorG, int cursorColorB);
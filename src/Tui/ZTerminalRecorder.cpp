@@ -0,0 +1,415 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "ZTerminalRecorder.h"
+#include "ZTerminalRecorder_p.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <QFile>
+#include <QIODevice>
+
+#include "Compression_p.h"
+#include "ZImage_p.h"
+#include "ZTerminal_p.h"
+
+TUIWIDGETS_NS_START
+
+namespace Private {
+    const char terminalRecordingMagic[] = "\x89TZR";
+}
+
+// Tables are reset with a key frame when one of them has more entries than this. This limits the memory used for
+// long recordings of content with many different colors or texts.
+static const int maxTableSize = 1 << 16;
+// Smaller payloads are stored uncompressed, compression rarely helps for them.
+static const int minCompressSize = 64;
+
+static bool sameString(const char *a, const char *b) {
+    if (!a || !b) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+namespace {
+    // Raw values of a cluster, used to reuse the cell table index of the previous cluster without hashing.
+    struct ClusterValues {
+        const char *text = nullptr;
+        int length = 0;
+        int width = 0;
+        unsigned int fg = 0;
+        unsigned int bg = 0;
+        unsigned int deco = 0;
+        int style = 0;
+        bool softwrap = false;
+        const char *setup = nullptr;
+        const char *cleanup = nullptr;
+        bool optimize = false;
+
+        bool operator==(const ClusterValues &other) const {
+            return length == other.length && width == other.width && fg == other.fg && bg == other.bg
+                    && deco == other.deco && style == other.style && softwrap == other.softwrap
+                    && optimize == other.optimize && memcmp(text, other.text, length) == 0
+                    && sameString(setup, other.setup) && sameString(cleanup, other.cleanup);
+        }
+    };
+}
+
+ZTerminalRecorderPrivate::ZTerminalRecorderPrivate(ZTerminalRecorder *pub) : pub_ptr(pub) {
+}
+
+ZTerminalRecorderPrivate::~ZTerminalRecorderPrivate() {
+}
+
+bool ZTerminalRecorderPrivate::startRecording(ZTerminal *terminal) {
+    QByteArray header;
+    header.append(Private::terminalRecordingMagic, Private::terminalRecordingMagicSize);
+    header.append(static_cast<char>(Private::terminalRecordingVersion));
+    if (device->write(header) != header.size()) {
+        errorString = device->errorString();
+        device = nullptr;
+        ownedFile.reset();
+        return false;
+    }
+
+    this->terminal = terminal;
+    errorString = QString();
+    framesRecorded = 0;
+    bytesWritten = header.size();
+    previousWidth = -1;
+    previousHeight = -1;
+    resetTables();
+    timer.start();
+
+    renderingConnection = QObject::connect(terminal, &ZTerminal::afterRendering, pub(), [this] {
+        recordFrame();
+    });
+    // The terminal is already destroyed when this is emitted, so only the recording state may be touched.
+    destroyedConnection = QObject::connect(terminal, &QObject::destroyed, pub(), [this] {
+        pub()->stop();
+    });
+    return true;
+}
+
+void ZTerminalRecorderPrivate::resetTables() {
+    texts.clear();
+    attrs.clear();
+    cells.clear();
+    newTexts.clear();
+    newAttrs.clear();
+    newCells.clear();
+    newTextCount = 0;
+    newAttrCount = 0;
+    newCellCount = 0;
+}
+
+int ZTerminalRecorderPrivate::internText(const char *text, int length) {
+    entry.clear();
+    Private::appendVarint(&entry, static_cast<quint64>(length));
+    entry.append(text, length);
+    auto it = texts.constFind(entry);
+    if (it != texts.constEnd()) {
+        return it.value();
+    }
+    const int id = texts.size();
+    texts.insert(entry, id);
+    newTexts.append(entry);
+    ++newTextCount;
+    return id;
+}
+
+int ZTerminalRecorderPrivate::internAttributes(termpaint_surface *surface, int x, int y) {
+    entry.clear();
+    ZImageData::appendAttributes(&entry, surface, x, y);
+    auto it = attrs.constFind(entry);
+    if (it != attrs.constEnd()) {
+        return it.value();
+    }
+    const int id = attrs.size();
+    attrs.insert(entry, id);
+    newAttrs.append(entry);
+    ++newAttrCount;
+    return id;
+}
+
+int ZTerminalRecorderPrivate::internCell(int text, int attr, int width, bool softwrap) {
+    entry.clear();
+    Private::appendVarint(&entry, static_cast<quint64>(text));
+    Private::appendVarint(&entry, static_cast<quint64>(attr));
+    Private::appendVarint(&entry, static_cast<quint64>(width));
+    entry.append(static_cast<char>(softwrap ? 1 : 0));
+    auto it = cells.constFind(entry);
+    if (it != cells.constEnd()) {
+        return it.value();
+    }
+    const int id = cells.size();
+    cells.insert(entry, id);
+    newCells.append(entry);
+    ++newCellCount;
+    return id;
+}
+
+void ZTerminalRecorderPrivate::recordFrame() {
+    if (!terminal || !device) {
+        return;
+    }
+
+    termpaint_surface *const surface = ZTerminalPrivate::get(terminal.data())->surface;
+    const int width = termpaint_surface_width(surface);
+    const int height = termpaint_surface_height(surface);
+    const int cellCount = width * height;
+
+    const bool keyFrame = width != previousWidth || height != previousHeight
+            || texts.size() > maxTableSize || attrs.size() > maxTableSize || cells.size() > maxTableSize;
+    if (keyFrame) {
+        resetTables();
+        // -2 never matches a cell, so all cells of a key frame are recorded.
+        previousCells.assign(static_cast<size_t>(cellCount), -2);
+        previousWidth = width;
+        previousHeight = height;
+    }
+    currentCells.assign(static_cast<size_t>(cellCount), -1);
+
+    QByteArray changes;
+    int changesEnd = 0;
+    int segmentStart = 0;
+    int segmentEnd = 0;
+    int segmentCell = -1;
+    int segmentCount = 0;
+    auto flushSegment = [&] {
+        if (segmentCount) {
+            Private::appendVarint(&changes, static_cast<quint64>(segmentStart - changesEnd));
+            Private::appendVarint(&changes, static_cast<quint64>(segmentCount));
+            Private::appendVarint(&changes, static_cast<quint64>(segmentCell));
+            changesEnd = segmentEnd;
+            segmentCount = 0;
+        }
+    };
+
+    ClusterValues last;
+    int lastCell = -1;
+    for (int y = 0; y < height; y++) {
+        int x = 0;
+        while (x < width) {
+            ClusterValues current;
+            int left, right;
+            current.text = termpaint_surface_peek_text(surface, x, y, &current.length, &left, &right);
+            current.width = std::max(1, std::min(right, width - 1) - x + 1);
+            current.fg = termpaint_surface_peek_fg_color(surface, x, y);
+            current.bg = termpaint_surface_peek_bg_color(surface, x, y);
+            current.deco = termpaint_surface_peek_deco_color(surface, x, y);
+            current.style = termpaint_surface_peek_style(surface, x, y);
+            current.softwrap = termpaint_surface_peek_softwrap_marker(surface, x, y);
+            termpaint_surface_peek_patch(surface, x, y, &current.setup, &current.cleanup, &current.optimize);
+
+            int cell;
+            if (lastCell != -1 && current == last) {
+                cell = lastCell;
+            } else {
+                const int text = internText(current.text, current.length);
+                const int attr = internAttributes(surface, x, y);
+                cell = internCell(text, attr, current.width, current.softwrap);
+                last = current;
+                lastCell = cell;
+            }
+
+            const int pos = y * width + x;
+            currentCells[static_cast<size_t>(pos)] = cell;
+            if (previousCells[static_cast<size_t>(pos)] != cell) {
+                if (segmentCount && segmentCell == cell && segmentEnd == pos) {
+                    ++segmentCount;
+                } else {
+                    flushSegment();
+                    segmentStart = pos;
+                    segmentCell = cell;
+                    segmentCount = 1;
+                }
+                segmentEnd = pos + current.width;
+            }
+            x += current.width;
+        }
+    }
+    flushSegment();
+
+    QByteArray payload;
+    Private::appendVarint(&payload, static_cast<quint64>(timer.nsecsElapsed() / 1000));
+    Private::appendVarint(&payload, static_cast<quint64>(width));
+    Private::appendVarint(&payload, static_cast<quint64>(height));
+    const QPoint cursor = terminal->grabCursorPosition();
+    if (terminal->grabCursorVisibility() && cursor.x() >= 0 && cursor.y() >= 0) {
+        Private::appendVarint(&payload, static_cast<quint64>(cursor.x() + 1));
+        Private::appendVarint(&payload, static_cast<quint64>(cursor.y() + 1));
+    } else {
+        Private::appendVarint(&payload, 0);
+        Private::appendVarint(&payload, 0);
+    }
+    Private::appendVarint(&payload, static_cast<quint64>(newTextCount));
+    payload.append(newTexts);
+    Private::appendVarint(&payload, static_cast<quint64>(newAttrCount));
+    payload.append(newAttrs);
+    Private::appendVarint(&payload, static_cast<quint64>(newCellCount));
+    payload.append(newCells);
+    payload.append(changes);
+
+    newTexts.clear();
+    newAttrs.clear();
+    newCells.clear();
+    newTextCount = 0;
+    newAttrCount = 0;
+    newCellCount = 0;
+    previousCells.swap(currentCells);
+
+    writeFrame(keyFrame, payload);
+}
+
+void ZTerminalRecorderPrivate::writeFrame(bool keyFrame, const QByteArray &payload) {
+    unsigned char flags = keyFrame ? Private::terminalRecordingFlagKeyFrame : 0;
+    QByteArray compressed;
+    if (payload.size() >= minCompressSize) {
+        compressed = Private::lzCompress(payload.constData(), payload.size());
+        if (compressed.size() < payload.size()) {
+            flags |= Private::terminalRecordingFlagCompressed;
+        }
+    }
+
+    QByteArray frame;
+    frame.append(static_cast<char>(flags));
+    if (flags & Private::terminalRecordingFlagCompressed) {
+        Private::appendVarint(&frame, static_cast<quint64>(payload.size()));
+        Private::appendVarint(&frame, static_cast<quint64>(compressed.size()));
+        frame.append(compressed);
+    } else {
+        Private::appendVarint(&frame, static_cast<quint64>(payload.size()));
+        frame.append(payload);
+    }
+
+    if (device->write(frame) != frame.size()) {
+        fail(device->errorString());
+        return;
+    }
+    bytesWritten += frame.size();
+    ++framesRecorded;
+}
+
+void ZTerminalRecorderPrivate::fail(const QString &message) {
+    pub()->stop();
+    errorString = message;
+}
+
+ZTerminalRecorder::ZTerminalRecorder(QObject *parent)
+    : QObject(parent), tuiwidgets_pimpl_ptr(std::make_unique<ZTerminalRecorderPrivate>(this))
+{
+}
+
+ZTerminalRecorder::~ZTerminalRecorder() {
+    stop();
+}
+
+bool ZTerminalRecorder::start(ZTerminal *terminal, const QString &fileName) {
+    auto *const p = tuiwidgets_impl();
+    stop();
+    if (!terminal) {
+        p->errorString = QStringLiteral("No terminal to record");
+        return false;
+    }
+
+    p->ownedFile = std::make_unique<QFile>(fileName);
+    if (!p->ownedFile->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        p->errorString = p->ownedFile->errorString();
+        p->ownedFile.reset();
+        return false;
+    }
+    p->device = p->ownedFile.get();
+    return p->startRecording(terminal);
+}
+
+bool ZTerminalRecorder::start(ZTerminal *terminal, QIODevice *device) {
+    auto *const p = tuiwidgets_impl();
+    stop();
+    if (!terminal) {
+        p->errorString = QStringLiteral("No terminal to record");
+        return false;
+    }
+    if (!device || !device->isWritable()) {
+        p->errorString = QStringLiteral("Device is not open for writing");
+        return false;
+    }
+    p->device = device;
+    return p->startRecording(terminal);
+}
+
+void ZTerminalRecorder::stop() {
+    auto *const p = tuiwidgets_impl();
+    QObject::disconnect(p->renderingConnection);
+    QObject::disconnect(p->destroyedConnection);
+    p->terminal = nullptr;
+    p->device = nullptr;
+    if (p->ownedFile) {
+        p->ownedFile->close();
+        p->ownedFile.reset();
+    }
+    p->resetTables();
+    p->previousCells = std::vector<int>();
+    p->currentCells = std::vector<int>();
+    p->previousWidth = -1;
+    p->previousHeight = -1;
+}
+
+bool ZTerminalRecorder::isRecording() const {
+    auto *const p = tuiwidgets_impl();
+    return p->device != nullptr;
+}
+
+ZTerminal *ZTerminalRecorder::terminal() const {
+    auto *const p = tuiwidgets_impl();
+    return p->terminal.data();
+}
+
+QString ZTerminalRecorder::errorString() const {
+    auto *const p = tuiwidgets_impl();
+    return p->errorString;
+}
+
+int ZTerminalRecorder::framesRecorded() const {
+    auto *const p = tuiwidgets_impl();
+    return p->framesRecorded;
+}
+
+qint64 ZTerminalRecorder::bytesWritten() const {
+    auto *const p = tuiwidgets_impl();
+    return p->bytesWritten;
+}
+
+bool ZTerminalRecorder::event(QEvent *event) {
+    return QObject::event(event);
+}
+
+bool ZTerminalRecorder::eventFilter(QObject *watched, QEvent *event) {
+    return QObject::eventFilter(watched, event);
+}
+
+void ZTerminalRecorder::timerEvent(QTimerEvent *event) {
+    return QObject::timerEvent(event);
+}
+
+void ZTerminalRecorder::childEvent(QChildEvent *event) {
+    return QObject::childEvent(event);
+}
+
+void ZTerminalRecorder::customEvent(QEvent *event) {
+    return QObject::customEvent(event);
+}
+
+void ZTerminalRecorder::connectNotify(const QMetaMethod &signal) {
+    // XXX needs to be thread-safe
+    QObject::connectNotify(signal);
+}
+
+void ZTerminalRecorder::disconnectNotify(const QMetaMethod &signal) {
+    // XXX needs to be thread-safe
+    QObject::disconnectNotify(signal);
+}
+
+TUIWIDGETS_NS_END
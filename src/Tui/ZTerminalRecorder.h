@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_ZTERMINALRECORDER_INCLUDED
+#define TUIWIDGETS_ZTERMINALRECORDER_INCLUDED
+
+#include <memory>
+
+#include <QObject>
+#include <QString>
+
+#include <Tui/tuiwidgets_internal.h>
+
+class QIODevice;
+
+TUIWIDGETS_NS_START
+
+class ZTerminal;
+
+class ZTerminalRecorderPrivate;
+class TUIWIDGETS_EXPORT ZTerminalRecorder : public QObject {
+    Q_OBJECT
+public:
+    explicit ZTerminalRecorder(QObject *parent = nullptr);
+    ~ZTerminalRecorder() override;
+
+public:
+    bool start(ZTerminal *terminal, const QString &fileName);
+    bool start(ZTerminal *terminal, QIODevice *device);
+    void stop();
+    bool isRecording() const;
+    ZTerminal *terminal() const;
+    QString errorString() const;
+
+    int framesRecorded() const;
+    qint64 bytesWritten() const;
+
+public:
+    // public virtuals from base class override everything for later ABI compatibility
+    bool event(QEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+protected:
+    // protected virtuals from base class override everything for later ABI compatibility
+    void timerEvent(QTimerEvent *event) override;
+    void childEvent(QChildEvent *event) override;
+    void customEvent(QEvent *event) override;
+    void connectNotify(const QMetaMethod &signal) override;
+    void disconnectNotify(const QMetaMethod &signal) override;
+
+private:
+    std::unique_ptr<ZTerminalRecorderPrivate> tuiwidgets_pimpl_ptr;
+
+    TUIWIDGETS_DECLARE_PRIVATE(ZTerminalRecorder)
+};
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_ZTERMINALRECORDER_INCLUDED
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_ZTERMINALRECORDER_P_INCLUDED
+#define TUIWIDGETS_ZTERMINALRECORDER_P_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMetaObject>
+#include <QPointer>
+
+#include <termpaint.h>
+
+#include <Tui/ZTerminal.h>
+#include <Tui/ZTerminalRecorder.h>
+
+#include <Tui/tuiwidgets_internal.h>
+
+class QFile;
+
+TUIWIDGETS_NS_START
+
+// Terminal recording format
+//
+// Header:
+//   4 bytes magic "\x89TZR", 1 byte version (1)
+// Followed by frames:
+//   1 byte flags (bit 0: payload is compressed, bit 1: key frame), if compressed: varint size of the uncompressed
+//   payload, varint size of the stored payload, stored payload.
+// Payload:
+//   varint timestamp in microseconds since the start of the recording
+//   varint width, varint height
+//   varint cursor x + 1, varint cursor y + 1 (both 0 if the cursor is hidden)
+//   new text entries: varint count, then for each entry varint length and the UTF-8 encoded cluster
+//   new attribute entries: varint count, then for each entry the attributes as in the binary image format
+//   new cell entries: varint count, then for each entry varint text index, varint attribute index,
+//     varint cluster width and one byte flags (bit 0: softwrap marker)
+//   changes until the end of the payload: varint cells skipped since the end of the previous change, varint count
+//     and varint cell table index. A change covers count clusters of the same cell entry in row major order.
+//
+// The tables are shared by all frames up to the next key frame, so each frame only adds entries it needs that
+// previous frames did not already use. A key frame starts with empty tables and contains all cells of the frame.
+// Key frames are written for the first frame, when the terminal size changes and when the tables get too large.
+
+namespace Private {
+    extern const char terminalRecordingMagic[];
+    const int terminalRecordingMagicSize = 4;
+    const unsigned char terminalRecordingVersion = 1;
+    const unsigned char terminalRecordingFlagCompressed = 1;
+    const unsigned char terminalRecordingFlagKeyFrame = 2;
+}
+
+class ZTerminalRecorderPrivate {
+public:
+    ZTerminalRecorderPrivate(ZTerminalRecorder *pub);
+    virtual ~ZTerminalRecorderPrivate();
+
+public:
+    bool startRecording(ZTerminal *terminal);
+    void recordFrame();
+    void resetTables();
+    int internText(const char *text, int length);
+    int internAttributes(termpaint_surface *surface, int x, int y);
+    int internCell(int text, int attr, int width, bool softwrap);
+    void writeFrame(bool keyFrame, const QByteArray &payload);
+    void fail(const QString &message);
+
+public:
+    QPointer<ZTerminal> terminal;
+    QIODevice *device = nullptr;
+    std::unique_ptr<QFile> ownedFile;
+    QMetaObject::Connection renderingConnection;
+    QMetaObject::Connection destroyedConnection;
+    QString errorString;
+    QElapsedTimer timer;
+    int framesRecorded = 0;
+    qint64 bytesWritten = 0;
+
+    // Cell table index of each cell of the previous frame, -1 for the cells covered by a wide cluster.
+    std::vector<int> previousCells;
+    std::vector<int> currentCells;
+    int previousWidth = -1;
+    int previousHeight = -1;
+
+    QHash<QByteArray, int> texts;
+    QHash<QByteArray, int> attrs;
+    QHash<QByteArray, int> cells;
+    // Table entries added since the last written frame.
+    QByteArray newTexts;
+    QByteArray newAttrs;
+    QByteArray newCells;
+    int newTextCount = 0;
+    int newAttrCount = 0;
+    int newCellCount = 0;
+    QByteArray entry;
+
+    ZTerminalRecorder *pub_ptr;
+    TUIWIDGETS_DECLARE_PUBLIC(ZTerminalRecorder)
+};
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_ZTERMINALRECORDER_P_INCLUDED
@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "ZTerminalReplay.h"
+#include "ZTerminalReplay_p.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <QFile>
+#include <QIODevice>
+#include <QPoint>
+
+#include "Compression_p.h"
+#include "ZImage_p.h"
+#include "ZTerminalRecorder_p.h"
+#include "ZTerminal_p.h"
+
+TUIWIDGETS_NS_START
+
+// Limits keep corrupted input from allocating unreasonable amounts of memory.
+static const int maxDimension = 1 << 14;
+static const int maxCells = 1 << 24;
+static const int maxFrameSize = 1 << 28;
+
+ZTerminalReplayPrivate::ZTerminalReplayPrivate() {
+}
+
+ZTerminalReplayPrivate::~ZTerminalReplayPrivate() {
+}
+
+bool ZTerminalReplayPrivate::openDevice() {
+    const QByteArray header = device->read(Private::terminalRecordingMagicSize + 1);
+    if (header.size() != Private::terminalRecordingMagicSize + 1
+            || memcmp(header.constData(), Private::terminalRecordingMagic, Private::terminalRecordingMagicSize) != 0) {
+        return fail(QStringLiteral("Not a terminal recording"));
+    }
+    if (static_cast<unsigned char>(header[Private::terminalRecordingMagicSize]) != Private::terminalRecordingVersion) {
+        return fail(QStringLiteral("Unsupported terminal recording version"));
+    }
+    errorString = QString();
+    keyFrameSeen = false;
+    frameNumber = 0;
+    frameTimestamp = 0;
+    frameSize = QSize();
+    frameCellsChanged = 0;
+    tables.clear();
+    return true;
+}
+
+bool ZTerminalReplayPrivate::readDeviceVarint(quint64 *value) {
+    quint64 result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        char c;
+        if (!device->getChar(&c)) {
+            return false;
+        }
+        const unsigned char byte = static_cast<unsigned char>(c);
+        result |= static_cast<quint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ZTerminalReplayPrivate::applyFrame(ZTerminal *terminal, bool keyFrame, const QByteArray &payload) {
+    Private::ByteReader reader(payload.constData(), payload.size());
+
+    quint64 timestamp;
+    int width;
+    int height;
+    int cursorX;
+    int cursorY;
+    if (!reader.varint(&timestamp) || timestamp > static_cast<quint64>(std::numeric_limits<qint64>::max())
+            || !reader.varintInt(&width, maxDimension) || !reader.varintInt(&height, maxDimension)
+            || width * height > maxCells
+            || !reader.varintInt(&cursorX, maxDimension) || !reader.varintInt(&cursorY, maxDimension)) {
+        return fail(QStringLiteral("Invalid frame header"));
+    }
+
+    if (keyFrame) {
+        tables.clear();
+    } else if (frameSize != QSize(width, height)) {
+        return fail(QStringLiteral("Size changed without a key frame"));
+    }
+
+    // A frame only adds table entries for the cells it changes.
+    const int cellCount = width * height;
+    if (!tables.readTextTable(&reader, cellCount)) {
+        return fail(QStringLiteral("Invalid text table"));
+    }
+    if (!tables.readAttributeTable(&reader, cellCount)) {
+        return fail(QStringLiteral("Invalid attribute table"));
+    }
+    if (!tables.readCellTable(&reader, cellCount)) {
+        return fail(QStringLiteral("Invalid cell table"));
+    }
+
+    if (terminal->width() != width || terminal->height() != height) {
+        terminal->resize(width, height);
+    }
+    termpaint_surface *const surface = ZTerminalPrivate::get(terminal)->surface;
+
+    int pos = 0;
+    int changed = 0;
+    while (!reader.atEnd()) {
+        int skip;
+        int count;
+        int cellIndex;
+        if (!reader.varintInt(&skip, cellCount - pos) || !reader.varintInt(&count, cellCount) || count < 1
+                || !reader.varintInt(&cellIndex, tables.cells.size() - 1)) {
+            return fail(QStringLiteral("Invalid change"));
+        }
+        pos += skip;
+        int x = pos % std::max(1, width);
+        int y = pos / std::max(1, width);
+        // The surface still has the softwrap markers of the previous frame, so they are also set when not wrapped.
+        if (!tables.writeRun(surface, width, height, &x, &y, cellIndex, count, true)) {
+            return fail(QStringLiteral("Change outside of the frame"));
+        }
+        changed += count;
+        pos = y * width + x;
+    }
+
+    if (cursorX && cursorY) {
+        terminal->setCursorPosition(QPoint(cursorX - 1, cursorY - 1));
+    } else {
+        terminal->setCursorPosition(QPoint(-1, -1));
+    }
+
+    keyFrameSeen = true;
+    ++frameNumber;
+    frameTimestamp = static_cast<qint64>(timestamp);
+    frameSize = QSize(width, height);
+    frameCellsChanged = changed;
+    return true;
+}
+
+bool ZTerminalReplayPrivate::fail(const QString &message) {
+    errorString = message;
+    return false;
+}
+
+ZTerminalReplay::ZTerminalReplay() : tuiwidgets_pimpl_ptr(std::make_unique<ZTerminalReplayPrivate>()) {
+}
+
+ZTerminalReplay::~ZTerminalReplay() {
+    close();
+}
+
+bool ZTerminalReplay::open(const QString &fileName) {
+    auto *const p = tuiwidgets_impl();
+    close();
+
+    p->ownedFile = std::make_unique<QFile>(fileName);
+    if (!p->ownedFile->open(QIODevice::ReadOnly)) {
+        p->errorString = p->ownedFile->errorString();
+        p->ownedFile.reset();
+        return false;
+    }
+    p->device = p->ownedFile.get();
+    if (!p->openDevice()) {
+        p->device = nullptr;
+        p->ownedFile.reset();
+        return false;
+    }
+    return true;
+}
+
+bool ZTerminalReplay::open(QIODevice *device) {
+    auto *const p = tuiwidgets_impl();
+    close();
+
+    if (!device || !device->isReadable()) {
+        p->errorString = QStringLiteral("Device is not open for reading");
+        return false;
+    }
+    p->device = device;
+    if (!p->openDevice()) {
+        p->device = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void ZTerminalReplay::close() {
+    auto *const p = tuiwidgets_impl();
+    p->device = nullptr;
+    if (p->ownedFile) {
+        p->ownedFile->close();
+        p->ownedFile.reset();
+    }
+    p->tables.clear();
+}
+
+bool ZTerminalReplay::isOpen() const {
+    auto *const p = tuiwidgets_impl();
+    return p->device != nullptr;
+}
+
+QString ZTerminalReplay::errorString() const {
+    auto *const p = tuiwidgets_impl();
+    return p->errorString;
+}
+
+bool ZTerminalReplay::readFrame(ZTerminal *terminal) {
+    auto *const p = tuiwidgets_impl();
+    if (!p->device || !terminal || !p->errorString.isEmpty()) {
+        return false;
+    }
+
+    char flagsChar;
+    if (!p->device->getChar(&flagsChar)) {
+        // Clean end of the recording.
+        return false;
+    }
+    const unsigned char flags = static_cast<unsigned char>(flagsChar);
+    if (flags & ~(Private::terminalRecordingFlagCompressed | Private::terminalRecordingFlagKeyFrame)) {
+        return p->fail(QStringLiteral("Invalid frame flags"));
+    }
+    const bool keyFrame = flags & Private::terminalRecordingFlagKeyFrame;
+    if (!keyFrame && !p->keyFrameSeen) {
+        return p->fail(QStringLiteral("Recording does not start with a key frame"));
+    }
+
+    quint64 payloadSize;
+    quint64 storedSize;
+    if (!p->readDeviceVarint(&payloadSize) || payloadSize > static_cast<quint64>(maxFrameSize)) {
+        return p->fail(QStringLiteral("Truncated or invalid frame"));
+    }
+    if (flags & Private::terminalRecordingFlagCompressed) {
+        if (!p->readDeviceVarint(&storedSize) || storedSize > static_cast<quint64>(maxFrameSize)) {
+            return p->fail(QStringLiteral("Truncated or invalid frame"));
+        }
+    } else {
+        storedSize = payloadSize;
+    }
+
+    const QByteArray stored = p->device->read(static_cast<qint64>(storedSize));
+    if (stored.size() != static_cast<int>(storedSize)) {
+        return p->fail(QStringLiteral("Truncated frame"));
+    }
+    if (flags & Private::terminalRecordingFlagCompressed) {
+        QByteArray payload;
+        if (!Private::lzDecompress(stored.constData(), stored.size(), static_cast<int>(payloadSize), &payload)) {
+            return p->fail(QStringLiteral("Invalid compressed frame"));
+        }
+        return p->applyFrame(terminal, keyFrame, payload);
+    }
+    return p->applyFrame(terminal, keyFrame, stored);
+}
+
+int ZTerminalReplay::frameNumber() const {
+    auto *const p = tuiwidgets_impl();
+    return p->frameNumber;
+}
+
+qint64 ZTerminalReplay::frameTimestamp() const {
+    auto *const p = tuiwidgets_impl();
+    return p->frameTimestamp;
+}
+
+QSize ZTerminalReplay::frameSize() const {
+    auto *const p = tuiwidgets_impl();
+    return p->frameSize;
+}
+
+int ZTerminalReplay::frameCellsChanged() const {
+    auto *const p = tuiwidgets_impl();
+    return p->frameCellsChanged;
+}
+
+TUIWIDGETS_NS_END
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_ZTERMINALREPLAY_INCLUDED
+#define TUIWIDGETS_ZTERMINALREPLAY_INCLUDED
+
+#include <memory>
+
+#include <QSize>
+#include <QString>
+
+#include <Tui/tuiwidgets_internal.h>
+
+class QIODevice;
+
+TUIWIDGETS_NS_START
+
+class ZTerminal;
+
+class ZTerminalReplayPrivate;
+class TUIWIDGETS_EXPORT ZTerminalReplay {
+public:
+    ZTerminalReplay();
+    ~ZTerminalReplay();
+
+public:
+    bool open(const QString &fileName);
+    bool open(QIODevice *device);
+    void close();
+    bool isOpen() const;
+    QString errorString() const;
+
+    bool readFrame(ZTerminal *terminal);
+    int frameNumber() const;
+    qint64 frameTimestamp() const;
+    QSize frameSize() const;
+    int frameCellsChanged() const;
+
+private:
+    Q_DISABLE_COPY(ZTerminalReplay)
+    std::unique_ptr<ZTerminalReplayPrivate> tuiwidgets_pimpl_ptr;
+
+    TUIWIDGETS_DECLARE_PRIVATE(ZTerminalReplay)
+};
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_ZTERMINALREPLAY_INCLUDED
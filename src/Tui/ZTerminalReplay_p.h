@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_ZTERMINALREPLAY_P_INCLUDED
+#define TUIWIDGETS_ZTERMINALREPLAY_P_INCLUDED
+
+#include <memory>
+
+#include <QByteArray>
+#include <QSize>
+#include <QString>
+
+#include <Tui/ZImage_p.h>
+#include <Tui/ZTerminalReplay.h>
+
+#include <Tui/tuiwidgets_internal.h>
+
+class QFile;
+
+TUIWIDGETS_NS_START
+
+class ZTerminalReplayPrivate {
+public:
+    ZTerminalReplayPrivate();
+    virtual ~ZTerminalReplayPrivate();
+
+public:
+    bool openDevice();
+    bool readDeviceVarint(quint64 *value);
+    bool applyFrame(ZTerminal *terminal, bool keyFrame, const QByteArray &payload);
+    bool fail(const QString &message);
+
+public:
+    QIODevice *device = nullptr;
+    std::unique_ptr<QFile> ownedFile;
+    QString errorString;
+    bool keyFrameSeen = false;
+
+    int frameNumber = 0;
+    qint64 frameTimestamp = 0;
+    QSize frameSize;
+    int frameCellsChanged = 0;
+
+    // shared by all frames up to the next key frame
+    ZImageData::BinaryTables tables;
+};
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_ZTERMINALREPLAY_P_INCLUDED
@@ -0,0 +1,563 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "ZTerminalServer.h"
+#include "ZTerminalServer_p.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+
+TUIWIDGETS_NS_START
+
+// Input of one session is read in parts of this size using a buffer shared by all sessions of a thread.
+static const int inputBufferSize = 64 * 1024;
+// Maximal amount of input handled per session before other sessions get a turn.
+static const int inputReadLimit = 1024 * 1024;
+// How long the destructor waits for sessions in other threads to be deleted before warning.
+static const int sessionShutdownWarningMs = 5000;
+
+static void setFdFlags(int fd) {
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags != -1) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+    const int fdFlags = fcntl(fd, F_GETFD);
+    if (fdFlags != -1) {
+        fcntl(fd, F_SETFD, fdFlags | FD_CLOEXEC);
+    }
+}
+
+static bool isSocket(int fd) {
+    struct stat st;
+    return fstat(fd, &st) == 0 && S_ISSOCK(st.st_mode);
+}
+
+ZTerminalServerSession::ZTerminalServerSession(ZTerminalServerPrivate *server, int fd)
+    : server(server), fd(fd), socket(isSocket(fd))
+{
+    connection.setDelegate(this);
+}
+
+ZTerminalServerSession::~ZTerminalServerSession() {
+    if (fd != -1) {
+        ::close(fd);
+    }
+}
+
+void ZTerminalServerSession::write(const char *data, int length) {
+    if (closed) {
+        return;
+    }
+    outputQueue.append(data, length);
+}
+
+void ZTerminalServerSession::flush() {
+    if (!writeQueued()) {
+        // Flushing happens from within rendering of the terminal, so disconnecting is deferred.
+        closed = true;
+        if (readNotifier) {
+            readNotifier->setEnabled(false);
+        }
+        if (terminal) {
+            scheduleDisconnect();
+        }
+    }
+}
+
+void ZTerminalServerSession::scheduleDisconnect() {
+    ZTerminalServerPrivate *const server = this->server;
+    ZTerminal *const terminal = this->terminal;
+    QTimer::singleShot(0, terminal, [server, terminal] {
+        ZTerminalServerSession *session = server->sessionFor(terminal);
+        if (session) {
+            server->sessionDisconnected(session);
+        }
+    });
+}
+
+void ZTerminalServerSession::restoreSequenceUpdated(const char *data, int len) {
+    // There is no way to send the restore sequence to the client out of band.
+    (void)data; (void)len;
+}
+
+void ZTerminalServerSession::deinit(bool awaitingResponse) {
+    (void)awaitingResponse;
+}
+
+void ZTerminalServerSession::fdHasData() {
+    // Sessions can live in different threads, so each thread uses its own buffer.
+    thread_local QByteArray buffer;
+    if (buffer.size() < inputBufferSize) {
+        buffer.resize(inputBufferSize);
+    }
+
+    QPointer<ZTerminal> weak = terminal;
+    int amount = 0;
+    while (amount < inputReadLimit) {
+        const ssize_t ret = ::read(fd, buffer.data(), buffer.size());
+        if (ret > 0) {
+            amount += static_cast<int>(ret);
+            {
+                QMutexLocker locker(&server->mutex);
+                statistics.bytesReceived += ret;
+            }
+            connection.terminalInput(buffer.constData(), static_cast<int>(ret));
+            if (!weak) {
+                // terminal and session were deleted while processing input
+                return;
+            }
+            if (closed) {
+                return;
+            }
+        } else if (ret == 0) {
+            server->sessionDisconnected(this);
+            return;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        } else {
+            server->sessionDisconnected(this);
+            return;
+        }
+    }
+}
+
+void ZTerminalServerSession::fdWritable() {
+    if (!writeQueued()) {
+        server->sessionDisconnected(this);
+    }
+}
+
+bool ZTerminalServerSession::writeQueued() {
+    if (closed) {
+        return true;
+    }
+    bool failed = false;
+    qint64 sent = 0;
+    while (outputQueueOffset < outputQueue.size()) {
+        const char *data = outputQueue.constData() + outputQueueOffset;
+        const size_t length = outputQueue.size() - outputQueueOffset;
+        // send with MSG_NOSIGNAL to avoid SIGPIPE when the client disconnected
+        const ssize_t ret = socket ? ::send(fd, data, length, MSG_NOSIGNAL) : ::write(fd, data, length);
+        if (ret > 0) {
+            outputQueueOffset += static_cast<int>(ret);
+            sent += ret;
+        } else if (ret < 0 && errno == EINTR) {
+            continue;
+        } else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            failed = true;
+            break;
+        }
+    }
+
+    if (outputQueueOffset == outputQueue.size()) {
+        outputQueue.clear();
+        outputQueueOffset = 0;
+    } else if (outputQueueOffset > outputQueue.size() / 2) {
+        outputQueue.remove(0, outputQueueOffset);
+        outputQueueOffset = 0;
+    }
+
+    qint64 queued = outputQueue.size() - outputQueueOffset;
+    {
+        QMutexLocker locker(&server->mutex);
+        statistics.bytesSent += sent;
+        statistics.maxBytesQueued = std::max(statistics.maxBytesQueued, queued);
+        // A client that does not keep up with the output is disconnected instead of buffering without limit.
+        if (failed || queued > server->sessionOutputLimit) {
+            failed = true;
+            queued = 0;
+        }
+        statistics.bytesQueued = queued;
+    }
+    if (failed) {
+        outputQueue.clear();
+        outputQueueOffset = 0;
+    }
+
+    if (writeNotifier) {
+        writeNotifier->setEnabled(queued > 0);
+    }
+    return !failed;
+}
+
+ZTerminalServerPrivate::ZTerminalServerPrivate(ZTerminalServer *pub) : pub_ptr(pub) {
+}
+
+ZTerminalServerPrivate::~ZTerminalServerPrivate() {
+}
+
+ZTerminalServerSession *ZTerminalServerPrivate::sessionFor(ZTerminal *terminal) const {
+    QMutexLocker locker(&mutex);
+    return sessions.value(terminal, nullptr);
+}
+
+void ZTerminalServerPrivate::acceptConnections() {
+    while (listenFd != -1) {
+        const int fd = accept(listenFd, nullptr, nullptr);
+        if (fd == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // EAGAIN: all pending connections are accepted, other errors are left for the next notification.
+            return;
+        }
+        pub()->addSession(fd);
+    }
+}
+
+void ZTerminalServerPrivate::sessionDisconnected(ZTerminalServerSession *session) {
+    // Called in the thread of the terminal of the session.
+    {
+        QMutexLocker locker(&mutex);
+        if (session->fd == -1) {
+            return;
+        }
+        ::close(session->fd);
+        session->fd = -1;
+        session->statistics.bytesQueued = 0;
+        --activeSessions;
+    }
+    session->closed = true;
+    if (session->readNotifier) {
+        session->readNotifier->setEnabled(false);
+    }
+    if (session->writeNotifier) {
+        session->writeNotifier->setEnabled(false);
+    }
+    session->outputQueue.clear();
+    session->outputQueueOffset = 0;
+
+    ZTerminal *const terminal = session->terminal;
+    pub()->sessionClosed(terminal);
+    terminal->deleteLater();
+}
+
+ZTerminalServer::ZTerminalServer(QObject *parent)
+    : QObject(parent), tuiwidgets_pimpl_ptr(std::make_unique<ZTerminalServerPrivate>(this))
+{
+}
+
+ZTerminalServer::~ZTerminalServer() {
+    auto *const p = tuiwidgets_impl();
+    close();
+
+    // Deleting the terminals frees the sessions via the destroyed signal. Terminals that were moved to other
+    // threads have to be deleted in their thread. The mutex is held while requesting that, because the destroyed
+    // signal of a terminal that is deleted concurrently blocks on the mutex before the terminal is gone.
+    QList<ZTerminal*> terminals;
+    bool otherThreads = false;
+    {
+        QMutexLocker locker(&p->mutex);
+        for (ZTerminal *terminal : p->sessions.keys()) {
+            if (terminal->thread() == thread()) {
+                terminals.append(terminal);
+            } else {
+                terminal->deleteLater();
+                otherThreads = true;
+            }
+        }
+    }
+    for (ZTerminal *terminal : terminals) {
+        delete terminal;
+    }
+    if (otherThreads) {
+        // The sessions reference the server, so wait until the other threads deleted their terminals.
+        QElapsedTimer timer;
+        timer.start();
+        bool warned = false;
+        while (true) {
+            {
+                QMutexLocker locker(&p->mutex);
+                if (p->sessions.isEmpty()) {
+                    break;
+                }
+            }
+            if (!warned && timer.hasExpired(sessionShutdownWarningMs)) {
+                qWarning("ZTerminalServer: Waiting for sessions in other threads to be deleted, "
+                         "are their event loops running?");
+                warned = true;
+            }
+            QThread::msleep(1);
+        }
+    }
+}
+
+bool ZTerminalServer::listen(const QString &path) {
+    auto *const p = tuiwidgets_impl();
+    if (p->listenFd != -1) {
+        p->errorString = QStringLiteral("Server is already listening");
+        return false;
+    }
+
+    const QByteArray encodedPath = QFile::encodeName(path);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (encodedPath.isEmpty() || static_cast<size_t>(encodedPath.size()) >= sizeof(addr.sun_path)) {
+        p->errorString = QStringLiteral("Invalid socket path");
+        return false;
+    }
+    memcpy(addr.sun_path, encodedPath.constData(), encodedPath.size());
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        p->errorString = QString::fromLocal8Bit(strerror(errno));
+        return false;
+    }
+    setFdFlags(fd);
+
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0
+            || ::listen(fd, SOMAXCONN) != 0) {
+        p->errorString = QString::fromLocal8Bit(strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    p->listenFd = fd;
+    p->serverPath = path;
+    p->errorString.clear();
+    p->listenNotifier = std::make_unique<QSocketNotifier>(fd, QSocketNotifier::Read);
+    QObject::connect(p->listenNotifier.get(), &QSocketNotifier::activated, this, [p] {
+        p->acceptConnections();
+    });
+    return true;
+}
+
+void ZTerminalServer::close() {
+    auto *const p = tuiwidgets_impl();
+    if (p->listenFd == -1) {
+        return;
+    }
+    // close might be called from a slot connected to newSession while the notifier is delivering its signal
+    p->listenNotifier->setEnabled(false);
+    p->listenNotifier.release()->deleteLater();
+    ::close(p->listenFd);
+    p->listenFd = -1;
+    unlink(QFile::encodeName(p->serverPath).constData());
+    p->serverPath.clear();
+}
+
+bool ZTerminalServer::isListening() const {
+    auto *const p = tuiwidgets_impl();
+    return p->listenFd != -1;
+}
+
+QString ZTerminalServer::serverPath() const {
+    auto *const p = tuiwidgets_impl();
+    return p->serverPath;
+}
+
+QString ZTerminalServer::errorString() const {
+    auto *const p = tuiwidgets_impl();
+    return p->errorString;
+}
+
+ZTerminal *ZTerminalServer::addSession(int fd) {
+    auto *const p = tuiwidgets_impl();
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (sessionCount() >= p->maxSessions) {
+        ::close(fd);
+        p->errorString = QStringLiteral("Maximal number of sessions reached");
+        return nullptr;
+    }
+    setFdFlags(fd);
+
+    ZTerminalServerSession *session = new ZTerminalServerSession(p, fd);
+    session->connection.setSize(p->initialSessionSize.width(), p->initialSessionSize.height());
+
+    // Not a child of the server, so the application can move it to another thread.
+    ZTerminal *terminal = new ZTerminal(&session->connection, p->terminalOptions, nullptr);
+    session->terminal = terminal;
+    {
+        QMutexLocker locker(&p->mutex);
+        p->sessions.insert(terminal, session);
+        ++p->activeSessions;
+    }
+
+    // The notifiers are children of the terminal, so they move with the terminal when it is moved to another
+    // thread.
+    session->readNotifier = std::make_unique<QSocketNotifier>(fd, QSocketNotifier::Read, terminal);
+    QObject::connect(session->readNotifier.get(), &QSocketNotifier::activated, terminal, [session] {
+        session->fdHasData();
+    });
+    session->writeNotifier = std::make_unique<QSocketNotifier>(fd, QSocketNotifier::Write, terminal);
+    QObject::connect(session->writeNotifier.get(), &QSocketNotifier::activated, terminal, [session] {
+        session->fdWritable();
+    });
+    if (session->closed) {
+        // writing the initial output already failed
+        session->readNotifier->setEnabled(false);
+        session->writeNotifier->setEnabled(false);
+        session->scheduleDisconnect();
+    } else {
+        // output the client did not yet accept
+        session->writeNotifier->setEnabled(session->outputQueueOffset < session->outputQueue.size());
+    }
+
+    // Runs in the thread of the terminal.
+    QObject::connect(terminal, &QObject::destroyed, this, [p, session, terminal] {
+        {
+            QMutexLocker locker(&p->mutex);
+            p->sessions.remove(terminal);
+            if (session->fd != -1) {
+                --p->activeSessions;
+            }
+        }
+        if (session->fd != -1) {
+            // The terminal was deleted by the application, send the rest of the terminal restore sequence as far
+            // as possible without blocking.
+            session->writeQueued();
+        }
+        delete session;
+    }, Qt::DirectConnection);
+
+    newSession(terminal);
+    return terminal;
+}
+
+void ZTerminalServer::closeSession(ZTerminal *terminal) {
+    auto *const p = tuiwidgets_impl();
+    if (!p->sessionFor(terminal)) {
+        return;
+    }
+    terminal->deleteLater();
+}
+
+void ZTerminalServer::setSessionSize(ZTerminal *terminal, int width, int height) {
+    auto *const p = tuiwidgets_impl();
+    ZTerminalServerSession *session = p->sessionFor(terminal);
+    if (!session) {
+        return;
+    }
+    if (terminal->thread() == QThread::currentThread()) {
+        session->connection.setSize(width, height);
+    } else {
+        QTimer::singleShot(0, terminal, [p, terminal, width, height] {
+            ZTerminalServerSession *session = p->sessionFor(terminal);
+            if (session) {
+                session->connection.setSize(width, height);
+            }
+        });
+    }
+}
+
+QList<ZTerminal*> ZTerminalServer::sessions() const {
+    auto *const p = tuiwidgets_impl();
+    QMutexLocker locker(&p->mutex);
+    QList<ZTerminal*> result;
+    for (auto it = p->sessions.cbegin(); it != p->sessions.cend(); ++it) {
+        if (it.value()->fd != -1) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+int ZTerminalServer::sessionCount() const {
+    auto *const p = tuiwidgets_impl();
+    QMutexLocker locker(&p->mutex);
+    return p->activeSessions;
+}
+
+ZTerminalServer::SessionStatistics ZTerminalServer::sessionStatistics(ZTerminal *terminal) const {
+    auto *const p = tuiwidgets_impl();
+    QMutexLocker locker(&p->mutex);
+    ZTerminalServerSession *session = p->sessions.value(terminal, nullptr);
+    if (!session) {
+        return {};
+    }
+    return session->statistics;
+}
+
+ZTerminal::Options ZTerminalServer::terminalOptions() const {
+    auto *const p = tuiwidgets_impl();
+    return p->terminalOptions;
+}
+
+void ZTerminalServer::setTerminalOptions(ZTerminal::Options options) {
+    auto *const p = tuiwidgets_impl();
+    p->terminalOptions = options;
+}
+
+QSize ZTerminalServer::initialSessionSize() const {
+    auto *const p = tuiwidgets_impl();
+    return p->initialSessionSize;
+}
+
+void ZTerminalServer::setInitialSessionSize(QSize size) {
+    auto *const p = tuiwidgets_impl();
+    p->initialSessionSize = size;
+}
+
+int ZTerminalServer::maxSessions() const {
+    auto *const p = tuiwidgets_impl();
+    return p->maxSessions;
+}
+
+void ZTerminalServer::setMaxSessions(int maxSessions) {
+    auto *const p = tuiwidgets_impl();
+    p->maxSessions = std::max(0, maxSessions);
+}
+
+qint64 ZTerminalServer::sessionOutputLimit() const {
+    auto *const p = tuiwidgets_impl();
+    QMutexLocker locker(&p->mutex);
+    return p->sessionOutputLimit;
+}
+
+void ZTerminalServer::setSessionOutputLimit(qint64 bytes) {
+    auto *const p = tuiwidgets_impl();
+    QMutexLocker locker(&p->mutex);
+    p->sessionOutputLimit = bytes;
+}
+
+bool ZTerminalServer::event(QEvent *event) {
+    return QObject::event(event);
+}
+
+bool ZTerminalServer::eventFilter(QObject *watched, QEvent *event) {
+    return QObject::eventFilter(watched, event);
+}
+
+void ZTerminalServer::timerEvent(QTimerEvent *event) {
+    return QObject::timerEvent(event);
+}
+
+void ZTerminalServer::childEvent(QChildEvent *event) {
+    return QObject::childEvent(event);
+}
+
+void ZTerminalServer::customEvent(QEvent *event) {
+    return QObject::customEvent(event);
+}
+
+void ZTerminalServer::connectNotify(const QMetaMethod &signal) {
+    // XXX needs to be thread-safe
+    QObject::connectNotify(signal);
+}
+
+void ZTerminalServer::disconnectNotify(const QMetaMethod &signal) {
+    // XXX needs to be thread-safe
+    QObject::disconnectNotify(signal);
+}
+
+TUIWIDGETS_NS_END
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_ZTERMINALSERVER_INCLUDED
+#define TUIWIDGETS_ZTERMINALSERVER_INCLUDED
+
+#include <memory>
+
+#include <QList>
+#include <QObject>
+#include <QSize>
+#include <QString>
+
+#include <Tui/ZTerminal.h>
+
+#include <Tui/tuiwidgets_internal.h>
+
+TUIWIDGETS_NS_START
+
+class ZTerminalServerPrivate;
+class TUIWIDGETS_EXPORT ZTerminalServer : public QObject {
+    Q_OBJECT
+public:
+    struct SessionStatistics {
+        qint64 bytesReceived = 0;
+        qint64 bytesSent = 0;
+        qint64 bytesQueued = 0;
+        qint64 maxBytesQueued = 0;
+    };
+
+public:
+    explicit ZTerminalServer(QObject *parent = nullptr);
+    ~ZTerminalServer() override;
+
+public:
+    bool listen(const QString &path);
+    void close();
+    bool isListening() const;
+    QString serverPath() const;
+    QString errorString() const;
+
+    ZTerminal *addSession(int fd);
+    void closeSession(ZTerminal *terminal);
+    void setSessionSize(ZTerminal *terminal, int width, int height);
+
+    QList<ZTerminal*> sessions() const;
+    int sessionCount() const;
+    SessionStatistics sessionStatistics(ZTerminal *terminal) const;
+
+    ZTerminal::Options terminalOptions() const;
+    void setTerminalOptions(ZTerminal::Options options);
+    QSize initialSessionSize() const;
+    void setInitialSessionSize(QSize size);
+    int maxSessions() const;
+    void setMaxSessions(int maxSessions);
+    qint64 sessionOutputLimit() const;
+    void setSessionOutputLimit(qint64 bytes);
+
+Q_SIGNALS:
+    void newSession(Tui::ZTerminal *terminal);
+    void sessionClosed(Tui::ZTerminal *terminal);
+
+public:
+    // public virtuals from base class override everything for later ABI compatibility
+    bool event(QEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+protected:
+    // protected virtuals from base class override everything for later ABI compatibility
+    void timerEvent(QTimerEvent *event) override;
+    void childEvent(QChildEvent *event) override;
+    void customEvent(QEvent *event) override;
+    void connectNotify(const QMetaMethod &signal) override;
+    void disconnectNotify(const QMetaMethod &signal) override;
+
+private:
+    std::unique_ptr<ZTerminalServerPrivate> tuiwidgets_pimpl_ptr;
+
+    TUIWIDGETS_DECLARE_PRIVATE(ZTerminalServer)
+};
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_ZTERMINALSERVER_INCLUDED
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_ZTERMINALSERVER_P_INCLUDED
+#define TUIWIDGETS_ZTERMINALSERVER_P_INCLUDED
+
+#include <memory>
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QSocketNotifier>
+
+#include <Tui/ZTerminalServer.h>
+
+#include <Tui/tuiwidgets_internal.h>
+
+TUIWIDGETS_NS_START
+
+class ZTerminalServerPrivate;
+
+// One client connection. The session owns the file descriptor and the connection, the terminal is deleted via
+// deleteLater and the session itself is freed when the terminal is destroyed, because the terminal still uses the
+// connection and delegate from its destructor. The session is only used from the thread of its terminal, except
+// for the members guarded by the server mutex.
+class ZTerminalServerSession : public ZTerminal::TerminalConnectionDelegate {
+public:
+    ZTerminalServerSession(ZTerminalServerPrivate *server, int fd);
+    ~ZTerminalServerSession() override;
+
+public:
+    void write(const char *data, int length) override;
+    void flush() override;
+    void restoreSequenceUpdated(const char *data, int len) override;
+    void deinit(bool awaitingResponse) override;
+
+public:
+    void fdHasData();
+    void fdWritable();
+    bool writeQueued();
+    void scheduleDisconnect();
+
+public:
+    ZTerminalServerPrivate *server;
+    int fd; // guarded by server mutex
+    bool socket;
+    bool closed = false;
+    ZTerminal::TerminalConnection connection;
+    ZTerminal *terminal = nullptr;
+    std::unique_ptr<QSocketNotifier> readNotifier;
+    std::unique_ptr<QSocketNotifier> writeNotifier;
+    QByteArray outputQueue;
+    int outputQueueOffset = 0;
+    ZTerminalServer::SessionStatistics statistics; // guarded by server mutex
+};
+
+class ZTerminalServerPrivate {
+public:
+    ZTerminalServerPrivate(ZTerminalServer *pub);
+    virtual ~ZTerminalServerPrivate();
+
+public:
+    void acceptConnections();
+    void sessionDisconnected(ZTerminalServerSession *session);
+    ZTerminalServerSession *sessionFor(ZTerminal *terminal) const;
+
+public:
+    int listenFd = -1;
+    QString serverPath;
+    QString errorString;
+    std::unique_ptr<QSocketNotifier> listenNotifier;
+
+    // Terminals of sessions can be moved to other threads, this guards all state accessed from sessions.
+    mutable QMutex mutex;
+    // All sessions with a terminal that is not yet destroyed, including disconnected sessions.
+    QHash<ZTerminal*, ZTerminalServerSession*> sessions;
+    int activeSessions = 0;
+
+    ZTerminal::Options terminalOptions;
+    QSize initialSessionSize = {80, 24};
+    int maxSessions = 1000;
+    qint64 sessionOutputLimit = 4 * 1024 * 1024; // guarded by mutex
+
+    ZTerminalServer *pub_ptr;
+    TUIWIDGETS_DECLARE_PUBLIC(ZTerminalServer)
+};
+
+TUIWIDGETS_NS_END
+
+#endif // TUIWIDGETS_ZTERMINALSERVER_P_INCLUDED
@@ -16,6 +16,8 @@
 #include <termios.h>
 #include <sys/ioctl.h>
 
+#include <algorithm>
+
 #include <QElapsedTimer>
 #include <QSocketNotifier>
 #include <QCoreApplication>
@@ -52,6 +54,7 @@ STATIC_ASSERT_ALWAYS_LOCKFREE(std::atomic<int>);
 static std::atomic<int> systemRestoreFd { -1 }; // only written by non signal handling code
                                                 // atomic for release-aquire pair for systemOriginalTerminalAttributes
 static std::atomic<int> systemPausedFd { -1 }; // written by signal handling and non signal handling code
+static std::atomic<int> systemOutputFd { -1 }; // only written by non signal handling code, fd_output if owned
 static termios systemOriginalTerminalAttributes;
 STATIC_ASSERT_ALWAYS_LOCKFREE(std::atomic<const char *>);
 static std::atomic<const char *> systemRestoreEscape { nullptr }; // only written by non signal handling code
@@ -62,6 +65,15 @@ static std::unique_ptr<PosixSignalNotifier> systemTerminalResumeNotifier;
 static std::unique_ptr<PosixSignalNotifier> systemTerminalSizeChangeNotifier;
 static QPointer<ZTerminal> systemTerminal;
 
+// Output is collected until this size is exceeded or termpaint requests a flush.
+static const int outputBufferFlushThreshold = 16 * 1024;
+// When more output is queued than this, the output is written blocking to bound memory usage.
+static const int outputQueueLimit = 4 * 1024 * 1024;
+// Input is read in batches of at most this size, the buffer grows up to this size as needed.
+static const int inputReadLimit = 1024 * 1024;
+static const int inputReadMinimumSpace = 4096;
+static const int inputBufferKeepSize = 64 * 1024;
+
 static bool terminal_is_disconnected(int fd) {
     // !!! signal handler code, only use async-safe calls (see signal-safety(7)) , no Qt at all.
 
@@ -147,6 +159,18 @@ static void suspendHelper(bool tcattr) {
                 fcntl(tmp, F_SETFD, O_CLOEXEC);
 #endif
             } while (tmp == -1 && errno == EINTR);
+            const int outputFd = systemOutputFd.load();
+            if (outputFd != -1) {
+                // reopened from the terminal's name on resume
+                do {
+#ifndef __APPLE__
+                    tmp = dup3(nullfd, outputFd, O_CLOEXEC);
+#else
+                    tmp = dup2(nullfd, outputFd);
+                    fcntl(tmp, F_SETFD, O_CLOEXEC);
+#endif
+                } while (tmp == -1 && errno == EINTR);
+            }
             close(nullfd);
 
             const char *restoreEscape = systemRestoreEscape.load();
@@ -360,10 +384,13 @@ bool ZTerminalPrivate::setupInternalConnection(ZTerminal::Options options, ZTerm
 
 void ZTerminalPrivate::deinitTerminalForInternalConnection() {
     inputNotifier = nullptr; // ensure no more notifications from this point
+    internalConnection_drain_output_queue();
+    outputNotifier = nullptr;
     if (fd_read != -1 && fd_read == systemRestoreFd.load()) {
         const char *old = systemRestoreEscape.load();
         systemRestoreEscape.store(nullptr);
         systemRestoreFd.store(-1);
+        systemOutputFd.store(-1);
         systemTerminal = nullptr;
         int pausedFd = systemPausedFd.load();
         if (pausedFd != -1) {
@@ -424,6 +451,7 @@ void ZTerminalPrivate::showErrorWithoutTerminal(const QByteArray utf) {
 }
 
 bool ZTerminalPrivate::commonInitForInternalConnection(ZTerminal::Options options) {
+    internalConnection_setup_output();
     initIntegrationForInternalConnection();
     callbackRequested = false;
     terminal = termpaint_terminal_new(&integration);
@@ -468,6 +496,9 @@ bool ZTerminalPrivate::commonInitForInternalConnection(ZTerminal::Options option
             // After this the signal handler pay attention to the just setup state
             // Also this forms a release-aquire pair with reads in the signal handler
             // to allow for race free access of systemOriginalTerminalAttributes.
+            if (fd_output_owned) {
+                systemOutputFd.store(fd_output);
+            }
             systemRestoreFd.store(fd_write);
             systemTerminal = pub();
 
@@ -496,6 +527,9 @@ bool ZTerminalPrivate::commonInitForInternalConnection(ZTerminal::Options option
                         // TSTP ran at least once since init or the last invocation of this handler
                         dup2(pausedFd, systemRestoreFd.load());
                         close(pausedFd);
+                        if (systemTerminal) {
+                            ZTerminalPrivate::get(systemTerminal)->internalConnection_reopen_output();
+                        }
 
                         if (terminal_is_disconnected(systemRestoreFd.load())) {
                             return;
@@ -561,6 +595,11 @@ bool ZTerminalPrivate::commonInitForInternalConnection(ZTerminal::Options option
         tcgetattr(systemRestoreFd.load(), &systemPresuspendTerminalAttributes);
     }
 
+    outputNotifier.reset(new QSocketNotifier(fd_output, QSocketNotifier::Write));
+    outputNotifier->setEnabled(false);
+    QObject::connect(outputNotifier.get(), &QSocketNotifier::activated,
+                     pub(), [this] { internalConnectionTerminalFdWritable(); });
+
     initCommon();
 
     inputNotifier.reset(new QSocketNotifier(fd_read, QSocketNotifier::Read));
@@ -586,6 +625,11 @@ void ZTerminalPrivate::pauseTerminalForInternalConnection() {
 
     inputNotifier->setEnabled(false);
     termpaint_terminal_pause(terminal);
+    // the terminal must see all output before the other application takes over
+    internalConnection_drain_output_queue();
+    if (fd_write_original_flags != -1) {
+        fcntl(fd_write, F_SETFL, fd_write_original_flags);
+    }
     tcsetattr(fd_read, TCSAFLUSH, &originalTerminalAttributes);
     if (fd_read == systemRestoreFd.load()) {
         systemTerminalPaused.store(true);
@@ -597,14 +641,66 @@ void ZTerminalPrivate::unpauseTerminalForInternalConnection() {
         systemTerminalPaused.store(false);
     }
     tcsetattr(fd_read, TCSAFLUSH, &prepauseTerminalAttributes);
+    if (fd_write_original_flags != -1) {
+        fcntl(fd_write, F_SETFL, fd_write_original_flags | O_NONBLOCK);
+    }
     inputNotifier->setEnabled(true);
     termpaint_terminal_unpause(terminal);
 }
 
 void ZTerminalPrivate::internalConnectionTerminalFdHasData(int socket) {
-    char buff[100];
-    int amount = read(socket, buff, 99);
-    if (amount == 0) {
+    // Read everything that is available (up to inputReadLimit) and pass it on in one batch, so large inputs like
+    // pastes don't need one event loop iteration per small read. The file descriptor is usually shared with other
+    // processes, so instead of switching it to non blocking mode each further read is only done when poll reports
+    // more data.
+    int amount = 0;
+    bool endOfInput = false;
+    while (amount < inputReadLimit) {
+        if (amount) {
+            struct pollfd info;
+            info.fd = socket;
+            info.events = POLLIN;
+            info.revents = 0;
+            int ret;
+            do {
+                ret = poll(&info, 1, 0);
+            } while (ret < 0 && errno == EINTR);
+            if (ret <= 0 || !(info.revents & (POLLIN | POLLHUP))) {
+                break;
+            }
+        }
+        if (input_buffer.size() - amount < inputReadMinimumSpace) {
+            input_buffer.resize(std::min(inputReadLimit, std::max(2 * input_buffer.size(),
+                                                                  amount + inputReadMinimumSpace)));
+        }
+        const ssize_t ret = read(socket, input_buffer.data() + amount, input_buffer.size() - amount);
+        if (ret > 0) {
+            amount += static_cast<int>(ret);
+        } else if (ret == 0) {
+            endOfInput = true;
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            // EAGAIN: everything available was read, other errors are ignored here
+            break;
+        }
+    }
+
+    if (amount) {
+        QPointer<ZTerminal> weak = pub();
+        inputFromConnection(input_buffer.constData(), amount);
+        if (weak.isNull() || !inputNotifier) {
+            return;
+        }
+    }
+
+    if (input_buffer.size() > inputBufferKeepSize) {
+        // don't keep the memory of a large paste around
+        input_buffer = QByteArray();
+    }
+
+    if (endOfInput) {
         if (terminal_is_disconnected((socket))) {
             inputNotifier->setEnabled(false);
             QPointer<ZTerminal> weak = pub();
@@ -619,14 +715,14 @@ void ZTerminalPrivate::internalConnectionTerminalFdHasData(int socket) {
             }
             return;
         }
-    } else if (amount < 0) {
-        return;
     }
-    inputFromConnection(buff, amount);
 }
 
 void ZTerminalPrivate::internalConnection_integration_free() {
     // this does not really free, because ZTerminalPrivate which contains the integration struct is externally owned
+    internalConnection_drain_output_queue();
+    outputNotifier = nullptr;
+    internalConnection_release_output();
     if (auto_close && fd_read != -1) {
         // assumnes that auto_close will only be true if fd_read == fd_write
         close(fd_read);
@@ -634,47 +730,214 @@ void ZTerminalPrivate::internalConnection_integration_free() {
 }
 
 void ZTerminalPrivate::internalConnection_integration_write_unbuffered(char *data, int length) {
+    // Blocking write, used where the output has to reach the terminal before continuing.
+    QElapsedTimer timer;
+    timer.start();
+    int written = 0;
+    while (written != length && fd_output != -1) {
+        const int ret = internalConnection_write_nonblocking(data + written, length - written);
+        if (ret < 0) {
+            break;
+        }
+        written += ret;
+        if (written != length) {
+            struct pollfd info;
+            info.fd = fd_output;
+            info.events = POLLOUT;
+            if (poll(&info, 1, -1) < 0 && errno != EINTR) {
+                internalConnection_write_failed();
+                break;
+            }
+        }
+    }
+    outputStatistics.bytesWritten += written;
+    outputStatistics.timeBlockedNs += timer.nsecsElapsed();
+}
+
+void ZTerminalPrivate::internalConnection_setup_output() {
+    // The file description of the terminal is usually shared with other processes (e.g. the shell). Setting
+    // O_NONBLOCK on it would make their reads and writes fail with EAGAIN, so output uses a separately opened
+    // description of the same terminal where possible.
+    char name[256];
+    if (isatty(fd_write) && ttyname_r(fd_write, name, sizeof(name)) == 0) {
+        fd_output = open(name, O_WRONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd_output != -1) {
+            fd_output_owned = true;
+            fd_output_name = name;
+            return;
+        }
+    }
+
+    fd_output = fd_write;
+    fd_output_owned = false;
+    const int flags = fcntl(fd_write, F_GETFL);
+    if (flags != -1 && !(flags & O_NONBLOCK)) {
+        fd_write_original_flags = flags;
+        fcntl(fd_write, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+void ZTerminalPrivate::internalConnection_reopen_output() {
+    // after resume from suspend, where fd_output was redirected to /dev/null
+    if (!fd_output_owned) {
+        return;
+    }
+    const int fd = open(fd_output_name.constData(), O_WRONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd != -1) {
+        dup2(fd, fd_output);
+        close(fd);
+    }
+}
+
+void ZTerminalPrivate::internalConnection_release_output() {
+    if (fd_output_owned) {
+        if (systemOutputFd.load() == fd_output) {
+            systemOutputFd.store(-1);
+        }
+        close(fd_output);
+    } else if (fd_write_original_flags != -1 && fd_write != -1) {
+        fcntl(fd_write, F_SETFL, fd_write_original_flags);
+    }
+    fd_output = -1;
+    fd_output_owned = false;
+    fd_write_original_flags = -1;
+}
+
+int ZTerminalPrivate::internalConnection_write_nonblocking(const char *data, int length) {
+    if (fd_output == -1) {
+        return -1;
+    }
+
     int written = 0;
-    int ret;
-    errno = 0;
     while (written != length) {
-        ret = write(fd_write, data + written, length - written);
+        const ssize_t ret = write(fd_output, data + written, length - written);
         if (ret > 0) {
-            written += ret;
+            written += static_cast<int>(ret);
+        } else if (ret < 0 && errno == EINTR) {
+            continue;
+        } else if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // terminal does not accept more output for now
+            break;
         } else {
-            // error handling?
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // fatal, non blocking is not supported by this integration
-                fd_read = fd_write = -1;
-                return;
-            }
-            if (errno == EIO || errno == ENOSPC) {
-                // fatal?
-                fd_read = fd_write = -1;
-                return;
-            }
-            if (errno == EBADF || errno == EINVAL || errno == EPIPE) {
-                // fatal, or fd is gone bad
-                fd_read = fd_write = -1;
-                return;
-            }
-            if (errno == EINTR) {
-                continue;
-            }
+            // EIO, ENOSPC, EBADF, EINVAL, EPIPE, ...: fatal, or fd is gone bad
+            internalConnection_write_failed();
+            return -1;
         }
     }
+    return written;
+}
+
+void ZTerminalPrivate::internalConnection_write_failed() {
+    if (outputNotifier) {
+        outputNotifier->setEnabled(false);
+    }
+    internalConnection_release_output();
+    fd_read = fd_write = -1;
+    output_queue.clear();
+    output_queue_offset = 0;
+    outputStatistics.bytesQueued = 0;
 }
 
 void ZTerminalPrivate::internalConnection_integration_write(const char *data, int length) {
+    if (suppressOutput) {
+        return;
+    }
+    frameStatisticsBytes += length;
     output_buffer.append(data, length);
-    if (output_buffer.size() > 512 || options.testFlag(ZTerminal::DebugDisableBufferedIo)) {
+    if (output_buffer.size() > outputBufferFlushThreshold || options.testFlag(ZTerminal::DebugDisableBufferedIo)) {
         internalConnection_integration_flush();
     }
 }
 
 void ZTerminalPrivate::internalConnection_integration_flush() {
-    internalConnection_integration_write_unbuffered(output_buffer.data(), output_buffer.size());
-    output_buffer.clear();
+    if (frameStatisticsEnabled) {
+        QElapsedTimer timer;
+        timer.start();
+        internalConnection_flush_output_buffer();
+        frameStatisticsIoNs += timer.nsecsElapsed();
+    } else {
+        internalConnection_flush_output_buffer();
+    }
+}
+
+void ZTerminalPrivate::internalConnection_flush_output_buffer() {
+    if (output_buffer.isEmpty()) {
+        return;
+    }
+    if (fd_write == -1) {
+        output_buffer.clear();
+        return;
+    }
+
+    if (internalConnectionOutputPending()) {
+        // keep ordering, everything has to wait behind already queued output
+        output_queue.append(output_buffer);
+        output_buffer.clear();
+    } else {
+        const int written = internalConnection_write_nonblocking(output_buffer.constData(), output_buffer.size());
+        if (written < 0) {
+            output_buffer.clear();
+            return;
+        }
+        outputStatistics.bytesWritten += written;
+        if (written == output_buffer.size()) {
+            output_buffer.clear();
+            return;
+        }
+        output_queue.swap(output_buffer);
+        output_queue_offset = written;
+        output_buffer.clear();
+    }
+
+    outputStatistics.bytesQueued = output_queue.size() - output_queue_offset;
+    outputStatistics.maxBytesQueued = std::max(outputStatistics.maxBytesQueued, outputStatistics.bytesQueued);
+
+    if (outputStatistics.bytesQueued > outputQueueLimit) {
+        // Even with frames dropped the terminal does not keep up (e.g. lots of output outside of rendering).
+        // Wait instead of letting the queue grow without bounds.
+        internalConnection_drain_output_queue();
+    } else if (outputNotifier) {
+        outputNotifier->setEnabled(true);
+    }
+}
+
+bool ZTerminalPrivate::internalConnectionOutputPending() const {
+    return output_queue_offset != output_queue.size();
+}
+
+void ZTerminalPrivate::internalConnectionTerminalFdWritable() {
+    const int written = internalConnection_write_nonblocking(output_queue.constData() + output_queue_offset,
+                                                             output_queue.size() - output_queue_offset);
+    if (written < 0) {
+        return;
+    }
+    outputStatistics.bytesWritten += written;
+    output_queue_offset += written;
+    outputStatistics.bytesQueued = output_queue.size() - output_queue_offset;
+    if (!internalConnectionOutputPending()) {
+        internalConnection_output_queue_drained();
+    }
+}
+
+void ZTerminalPrivate::internalConnection_drain_output_queue() {
+    if (internalConnectionOutputPending()) {
+        internalConnection_integration_write_unbuffered(output_queue.data() + output_queue_offset,
+                                                        output_queue.size() - output_queue_offset);
+        internalConnection_output_queue_drained();
+    }
+}
+
+void ZTerminalPrivate::internalConnection_output_queue_drained() {
+    output_queue.clear();
+    output_queue_offset = 0;
+    outputStatistics.bytesQueued = 0;
+    if (outputNotifier) {
+        outputNotifier->setEnabled(false);
+    }
+    if (outputFrameDropped) {
+        // render the replacement for the dropped frame(s)
+        pub()->update();
+    }
 }
 
 bool ZTerminalPrivate::internalConnection_integration_is_bad() {
@@ -5,16 +5,20 @@
 
 #include <termios.h>
 
+#include <memory>
+
 #include <QByteArray>
 #include <QMap>
 #include <QPoint>
 #include <QPointer>
+#include <QRect>
 #include <QSocketNotifier>
 #include <QTimer>
 
 #include <termpaint.h>
 
 #include <Tui/ListNode_p.h>
+#include <Tui/ZImage.h>
 #include <Tui/ZMoFunc_p.h>
 #include <Tui/ZTerminal.h>
 
@@ -26,6 +30,7 @@ class ZWidget;
 class ZWidgetPrivate;
 class ZShortcutManager;
 class ZSymbol;
+class ZTextMetricsPrivate;
 
 struct FocusHistoryTag;
 
@@ -37,6 +42,7 @@ class ZTerminalPrivate {
     static const ZTerminalPrivate *get(const ZTerminal *terminal);
 
     bool mainWidgetFullyAttached();
+    void connectToEventDispatcher();
     void attachMainWidgetStage2();
 
     void setFocus(ZWidget *w);
@@ -55,6 +61,17 @@ class ZTerminalPrivate {
 
     void processPaintingAndUpdateOutput(bool fullRepaint);
     void updateNativeTerminalState();
+    void flushOutput(bool fullRepaint);
+    void flushOutputWithStatistics(bool fullRepaint);
+    int countChangedCells();
+    void recordFrameStatistics();
+    void freeFrameStatisticsSurface();
+    // region in terminal coordinates, lines > 0 when the contents moved up
+    void hintVerticalScroll(const QRect &region, int lines);
+    void discardScrollHint();
+    void applyScrollHint();
+    void rememberFlushedFrame();
+    void freeScrollSurfaces();
 
     bool setTestLayoutRequestTracker(std::function<void(ZWidget *)> closure);
     void resetTestLayoutRequestTracker();
@@ -81,9 +98,19 @@ class ZTerminalPrivate {
     void internalConnection_integration_write(const char *data, int length);
     void internalConnection_integration_write_unbuffered(char *data, int length);
     void internalConnection_integration_flush();
+    void internalConnection_flush_output_buffer();
     bool internalConnection_integration_is_bad();
     void internalConnection_integration_restore_sequence_updated(const char *data, int len, bool force);
     void internalConnectionTerminalFdHasData(int socket);
+    void internalConnectionTerminalFdWritable();
+    void internalConnection_setup_output();
+    void internalConnection_reopen_output();
+    void internalConnection_release_output();
+    int internalConnection_write_nonblocking(const char *data, int length);
+    void internalConnection_write_failed();
+    void internalConnection_drain_output_queue();
+    void internalConnection_output_queue_drained();
+    bool internalConnectionOutputPending() const;
     // ^^
 
     // external connection
@@ -101,6 +128,8 @@ class ZTerminalPrivate {
     // ^^
 
     termpaint_surface *surface = nullptr; // TODO use ref counted ptr of some kind
+    // Text metrics only depend on the surface, all ZTextMetrics instances returned by textMetrics() share this.
+    mutable std::shared_ptr<ZTextMetricsPrivate> textMetricsCache;
     termpaint_terminal *terminal = nullptr;
     QPoint terminalCursorPosition;
     CursorStyle terminalCursorStyle = CursorStyle::Unset;
@@ -124,7 +153,31 @@ class ZTerminalPrivate {
     bool titleNeedsUpdate = false;
     QString iconTitle;
     bool iconTitleNeedsUpdate = false;
-    QString pasteTemp;
+    QByteArray pasteTemp; // utf8, decoded once the paste is complete
+
+    bool frameStatisticsEnabled = false;
+    ZTerminal::FrameStatistics currentFrameStatistics;
+    ZTerminal::FrameStatistics lastFrameStatistics;
+    // ring buffer, frameStatisticsHistoryNext is the oldest entry once the buffer is full
+    QVector<ZTerminal::FrameStatistics> frameStatisticsHistory;
+    int frameStatisticsHistorySize = 0;
+    int frameStatisticsHistoryNext = 0;
+    // copy of the last flushed frame, to count changed cells
+    termpaint_surface *frameStatisticsSurface = nullptr;
+    // updated by the integrations while frame statistics are enabled
+    qint64 frameStatisticsBytes = 0;
+    qint64 frameStatisticsIoNs = 0;
+
+    QRect scrollHintRegion;
+    int scrollHintLines = 0;
+    // copy of the last flushed frame and the cursor state flushed with it
+    termpaint_surface *scrollPreviousFrame = nullptr;
+    termpaint_surface *scrollNewFrame = nullptr;
+    bool scrollFlushedCursorVisible = true;
+    CursorStyle scrollFlushedCursorStyle = CursorStyle::Unset;
+    int scrollFlushedCursorR = -1, scrollFlushedCursorG = -1, scrollFlushedCursorB = -1;
+    // drop output of the integration, used to update termpaint's idea of the terminal contents
+    bool suppressOutput = false;
 
     QList<QPointer<ZWidget>> layoutPendingWidgets;
     bool layoutRequested = false;
@@ -137,6 +190,7 @@ class ZTerminalPrivate {
     bool viewportUI = false;
     QPoint viewportOffset = {0, 0};
     QPoint viewportRange = {0, 0};
+    std::unique_ptr<ZImage> viewportImage;
 
     enum class InitState {
         InInitWithoutPendingPaintRequest,
@@ -150,7 +204,22 @@ class ZTerminalPrivate {
     int fd_read = -1;
     int fd_write = -1;
     bool auto_close = false; // if true fd_read == fd_write is assumed
+    // Non blocking descriptor used for output. Either a separately opened description of the terminal (owned) or
+    // fd_write with O_NONBLOCK set for the lifetime of the connection (original flags in fd_write_original_flags).
+    int fd_output = -1;
+    bool fd_output_owned = false;
+    int fd_write_original_flags = -1;
+    QByteArray fd_output_name;
     QByteArray output_buffer;
+    QByteArray input_buffer;
+    // Output not yet accepted by the terminal, pending from output_queue_offset on. Written when fd_write is
+    // writable again.
+    QByteArray output_queue;
+    int output_queue_offset = 0;
+    std::unique_ptr<QSocketNotifier> outputNotifier;
+    bool outputFrameDropped = false;
+    bool outputFrameDroppedFullRepaint = false;
+    ZTerminal::OutputStatistics outputStatistics;
     termios originalTerminalAttributes;
     termios prepauseTerminalAttributes;
     // ^^
@@ -161,6 +230,8 @@ class ZTerminalPrivate {
 
     // common integration
     QTimer callbackTimer;
+    // aboutToBlock of the event dispatcher of the thread the terminal currently lives in
+    QMetaObject::Connection dispatcherConnection;
     bool backspaceIsX08 = false;
     bool callbackRequested = false;
     bool awaitingResponse = false;
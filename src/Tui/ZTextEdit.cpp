@@ -3,14 +3,116 @@
 #include "ZTextEdit.h"
 #include "ZTextEdit_p.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+
+#include <QFutureInterface>
 #include <QFutureWatcher>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QTimer>
 
 #include <Tui/ZClipboard.h>
+#include <Tui/ZDocumentCursor_p.h>
+#include <Tui/ZDocument_p.h>
 #include <Tui/ZPainter.h>
 #include <Tui/ZSymbol.h>
+#include <Tui/ZTerminal_p.h>
+
+#include <Tui/Utils_p.h>
 
 TUIWIDGETS_NS_START
 
+namespace {
+    // Lines longer than this (in code units) are only partially layouted where possible.
+    constexpr int longLineThreshold = 8192;
+    // Distance of the column checkpoints of long lines in code units.
+    constexpr int longLineCheckpointInterval = 1024;
+    // Upper limit for the number of long lines with cached checkpoints.
+    constexpr int longLineCacheSize = 256;
+
+    // Number of lines handed to a background thread at once when computing visual lines.
+    constexpr int rewrapChunkLines = 1024;
+
+    // Same result as .toUtf8().size() but without converting.
+    int utf8Size(const QChar *string, int size) {
+        int result = 0;
+        for (int i = 0; i < size; i++) {
+            const char16_t ch = string[i].unicode();
+            if (ch < 0x80) {
+                result += 1;
+            } else if (ch < 0x800) {
+                result += 2;
+            } else if (QChar::isHighSurrogate(ch) && i + 1 < size && QChar::isLowSurrogate(string[i + 1].unicode())) {
+                result += 4;
+                ++i;
+            } else if (QChar::isSurrogate(ch)) {
+                // converted to '?'
+                result += 1;
+            } else {
+                result += 3;
+            }
+        }
+        return result;
+    }
+
+    class RewrapJob {
+    public:
+        RewrapJob(const ZTextMetrics &metrics) : metrics(metrics) {}
+
+    public:
+        ZTextMetrics metrics;
+        // Per line, only set for lines that need to be computed. Unlike a snapshot this does not share the line
+        // vector of the document, so edits while the job runs don't need to copy it.
+        std::vector<QString> lines;
+        ZTextOption option;
+        int width = 0;
+        std::vector<int> knownVisualLines; // per line, 0 for lines that need to be computed
+        std::vector<int> chunks; // first lines of the chunks to compute, in order of priority
+        std::atomic<int> nextChunk{0};
+        std::atomic<int> runningWorkers{0};
+    };
+
+    class RewrapOnThread : public QRunnable {
+    public:
+        void run() override {
+            while (!promise.isCanceled()) {
+                const int chunk = job->nextChunk++;
+                if (chunk >= size2int(job->chunks.size())) {
+                    break;
+                }
+
+                ZTextEditPrivate::RewrapChunk result;
+                result.firstLine = job->chunks[chunk];
+                const int endLine = std::min(result.firstLine + rewrapChunkLines, size2int(job->lines.size()));
+                result.visualLines.reserve(endLine - result.firstLine);
+                for (int line = result.firstLine; line < endLine; line++) {
+                    int visualLines = job->knownVisualLines[line];
+                    if (!visualLines) {
+                        ZTextLayout lay(job->metrics, job->lines[line]);
+                        lay.setTextOption(job->option);
+                        lay.doLayout(job->width);
+                        visualLines = lay.lineCount();
+                    }
+                    result.visualLines.push_back(visualLines);
+                }
+                promise.reportResult(result);
+            }
+
+            if (--job->runningWorkers == 0) {
+                promise.reportFinished();
+            }
+        }
+
+    public:
+        QFutureInterface<ZTextEditPrivate::RewrapChunk> promise;
+        std::shared_ptr<RewrapJob> job;
+    };
+}
+
 ZTextEditPrivate::ZTextEditPrivate(const ZTextMetrics &textMetrics, ZDocument *document, ZWidget *pub)
     : ZWidgetPrivate(pub), textMetrics(textMetrics),
       doc(document ? document : new ZDocument()),
@@ -68,9 +170,19 @@ ZTextEdit::ZTextEdit(const ZTextMetrics &textMetrics, ZDocument *document, ZWidg
             emitCursorPostionChanged();
         }
     });
+
+    QObject::connect(p->doc, &ZDocument::contentsChanged, this, [this] {
+        auto *const p = tuiwidgets_impl();
+        p->scheduleRewrap();
+    });
+    p->scheduleRewrap();
 }
 
 ZTextEdit::~ZTextEdit() {
+    auto *const p = tuiwidgets_impl();
+    // The background threads, also those of cancelled computations, use the text metrics, which must not outlive
+    // the terminal.
+    p->cancelRewrap(true);
 }
 
 void ZTextEdit::registerCommandNotifiers(Qt::ShortcutContext context) {
@@ -121,13 +233,8 @@ void ZTextEdit::emitCursorPostionChanged() {
     auto *const p = tuiwidgets_impl();
 
     const auto [cursorCodeUnit, cursorLine] = p->cursor.position();
-    ZTextLayout layNoWrap = textLayoutForLineWithoutWrapping(cursorLine);
-    int cursorColumn = layNoWrap.lineAt(0).cursorToX(cursorCodeUnit, ZTextLayout::Leading);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    int utf8CodeUnit = QStringView{p->doc->line(cursorLine)}.left(cursorCodeUnit).toUtf8().size();
-#else
-    int utf8CodeUnit = p->doc->line(cursorLine).leftRef(cursorCodeUnit).toUtf8().size();
-#endif
+    int cursorColumn = p->columnForPositionWithoutWrapping(cursorCodeUnit, cursorLine);
+    int utf8CodeUnit = utf8Size(p->doc->line(cursorLine).constData(), cursorCodeUnit);
     cursorPositionChanged(cursorColumn, cursorCodeUnit, utf8CodeUnit, cursorLine);
 }
 
@@ -206,20 +313,42 @@ ZDocumentCursor ZTextEdit::makeCursor() {
 }
 
 ZDocumentCursor ZTextEditPrivate::makeCursor() {
-    return ZDocumentCursor(doc, [this](int line, bool wrappingAllowed) {
-        ZTextLayout lay(textMetrics, doc->line(line));
+    ZDocumentCursor cursor(doc, [this](int line, bool wrappingAllowed) {
+        return cursorTextLayout(line, wrappingAllowed);
+    });
+    // Cursor movement in long lines without wrapping only layouts the part of the line around the cursor, starting
+    // from the column checkpoints.
+    ZDocumentCursorPrivate::get(&cursor)->createTextLayoutWindow = [this](int line, bool wrappingAllowed,
+                                                                          bool byColumn, int start, int end) {
+        if ((wrappingAllowed && wrapMode != ZTextOption::NoWrap) || !isLongLine(line)) {
+            return cursorTextLayout(line, wrappingAllowed);
+        }
         ZTextOption option;
         option.setTabStopDistance(tabsize);
-        if (wrappingAllowed) {
-            option.setWrapMode(wrapMode);
-            lay.setTextOption(option);
-            lay.doLayout(std::max(pub()->rect().width() - pub()->allBordersWidth(), 0));
-        } else {
-            lay.setTextOption(option);
-            lay.doLayout(std::numeric_limits<unsigned short>::max() - 1);
+        option.setWrapMode(ZTextOption::NoWrap);
+        if (byColumn) {
+            return longLineLayoutWindow(option, line, start, end);
         }
-        return lay;
-    });
+        return longLineLayoutWindowForCodeUnits(option, line, start, end);
+    };
+    return cursor;
+}
+
+ZTextLayout ZTextEditPrivate::cursorTextLayout(int line, bool wrappingAllowed) {
+    ZTextLayout lay(textMetrics, doc->line(line));
+    ZTextOption option;
+    option.setTabStopDistance(tabsize);
+    if (wrappingAllowed && wrapMode != ZTextOption::NoWrap) {
+        option.setWrapMode(wrapMode);
+        lay.setTextOption(option);
+        lay.doLayout(std::max(pub()->rect().width() - pub()->allBordersWidth(), 0));
+    } else {
+        // same as painting, lines wider than the layout width are not wrapped either
+        option.setWrapMode(ZTextOption::NoWrap);
+        lay.setTextOption(option);
+        lay.doLayout(std::numeric_limits<unsigned short>::max() - 1);
+    }
+    return lay;
 }
 
 ZDocument *ZTextEdit::document() const {
@@ -241,6 +370,7 @@ void ZTextEdit::setTabStopDistance(int tab) {
     auto *const p = tuiwidgets_impl();
 
     p->tabsize = std::max(1, tab);
+    p->scheduleRewrap();
     adjustScrollPosition();
     update();
 }
@@ -255,6 +385,7 @@ void ZTextEdit::setShowLineNumbers(bool show) {
     auto *const p = tuiwidgets_impl();
 
     p->showLineNumbers = show;
+    p->scheduleRewrap();
     adjustScrollPosition();
     update();
 }
@@ -285,6 +416,7 @@ void ZTextEdit::setWordWrapMode(ZTextOption::WrapMode wrap) {
     if (p->wrapMode != ZTextOption::WrapMode::NoWrap) {
         p->scrollPositionColumn = 0;
     }
+    p->scheduleRewrap();
     adjustScrollPosition();
     update();
 }
@@ -415,10 +547,55 @@ bool ZTextEdit::isModified() const {
     return p->doc->isModified();
 }
 
+void ZTextEdit::setAdditionalCursorPositions(const QVector<Position> &positions) {
+    auto *const p = tuiwidgets_impl();
+
+    p->additionalCursors.clear();
+    p->additionalCursors.reserve(positions.size());
+    for (const Position &position: positions) {
+        auto cur = std::make_unique<ZDocumentCursor>(p->makeCursor());
+        cur->setPosition(position);
+        p->additionalCursors.push_back(std::move(cur));
+    }
+    p->normalizeAdditionalCursors();
+
+    update();
+}
+
+QVector<ZDocumentCursor::Position> ZTextEdit::additionalCursorPositions() const {
+    auto *const p = tuiwidgets_impl();
+
+    QVector<Position> result;
+    result.reserve(size2int(p->additionalCursors.size()));
+    for (const auto &cur: p->additionalCursors) {
+        result.append(cur->position());
+    }
+    return result;
+}
+
+void ZTextEdit::clearAdditionalCursors() {
+    auto *const p = tuiwidgets_impl();
+
+    if (p->additionalCursors.size()) {
+        p->additionalCursors.clear();
+        update();
+    }
+}
+
+bool ZTextEdit::hasAdditionalCursors() const {
+    auto *const p = tuiwidgets_impl();
+
+    return p->additionalCursors.size();
+}
+
 void ZTextEdit::insertText(const QString &str) {
     auto *const p = tuiwidgets_impl();
 
-    p->cursor.insertText(str);
+    if (p->additionalCursors.size()) {
+        p->multiCursorInsertText(str, false);
+    } else {
+        p->cursor.insertText(str);
+    }
 
     updateCommands();
     adjustScrollPosition();
@@ -433,9 +610,7 @@ void ZTextEdit::insertTabAt(ZDocumentCursor &cur) {
     if (useTabChar()) {
         cur.insertText(QStringLiteral("\t"));
     } else {
-        ZTextLayout lay = textLayoutForLineWithoutWrapping(cur.position().line);
-        ZTextLineRef tlr = lay.lineAt(0);
-        const int colum = tlr.cursorToX(cur.position().codeUnit, ZTextLayout::Leading);
+        const int colum = p->columnForPositionWithoutWrapping(cur.position().codeUnit, cur.position().line);
         const int remainingTabWidth = tabStopDistance() - colum % tabStopDistance();
         cur.insertText(QStringLiteral(" ").repeated(remainingTabWidth));
     }
@@ -576,6 +751,28 @@ void ZTextEdit::redo() {
 void ZTextEdit::paintEvent(ZPaintEvent *event) {
     auto *const p = tuiwidgets_impl();
 
+    {
+        const int scrollLine = p->scrollPositionLine.line();
+        int scrolledRows = 0;
+        if (p->lastPaintedScrollLine != -1 && p->lastPaintedScrollColumn == p->scrollPositionColumn
+                && p->lastPaintedGeometry == geometry()) {
+            if (scrollLine == p->lastPaintedScrollLine) {
+                scrolledRows = p->scrollPositionFineLine - p->lastPaintedScrollFineLine;
+            } else if (p->wrapMode == ZTextOption::WrapMode::NoWrap) {
+                // without wrapping each line is exactly one row
+                scrolledRows = scrollLine - p->lastPaintedScrollLine;
+            }
+        }
+        if (scrolledRows && terminal()) {
+            ZTerminalPrivate::get(terminal())->hintVerticalScroll({mapToTerminal({0, 0}), geometry().size()},
+                                                                  scrolledRows);
+        }
+        p->lastPaintedScrollLine = scrollLine;
+        p->lastPaintedScrollFineLine = p->scrollPositionFineLine;
+        p->lastPaintedScrollColumn = p->scrollPositionColumn;
+        p->lastPaintedGeometry = geometry();
+    }
+
 
     ZColor fg;
     ZColor bg;
@@ -625,11 +822,44 @@ void ZTextEdit::paintEvent(ZPaintEvent *event) {
 
     const auto [cursorCodeUnit, cursorLine] = p->cursor.position();
 
+    // Additional cursors are drawn as inverted cells, the terminal only has one cursor.
+    const ZTextStyle additionalCursorStyle{bg, fg};
+    QVector<Position> additionalCursors = additionalCursorPositions();
+    std::sort(additionalCursors.begin(), additionalCursors.end());
+    auto additionalCursorIt = std::lower_bound(additionalCursors.begin(), additionalCursors.end(),
+                                               Position{0, p->scrollPositionLine.line()});
+
     int y = -p->scrollPositionFineLine;
     for (int line = p->scrollPositionLine.line(); y < rect().height() && line < p->doc->lineCount(); line++) {
         QVector<ZFormatRange> highlights;
 
-        ZTextLayout lay = textLayoutForLine(option, line);
+        const int lineCodeUnits = p->doc->lineCodeUnits(line);
+
+        // For long lines only the visible part is layouted, in that case positions outside of the layouted part
+        // are not visible.
+        const bool longLine = p->wrapMode == ZTextOption::WrapMode::NoWrap && p->isLongLine(line);
+        ZTextLayout lay = longLine ? p->longLineLayoutWindow(option, line, p->scrollPositionColumn,
+                                                             p->scrollPositionColumn + rect().width())
+                                   : textLayoutForLine(option, line);
+        const int layoutStart = longLine ? lay.lineAt(0).textStart() : 0;
+        const int layoutEnd = longLine ? layoutStart + lay.lineAt(0).textLength() : lineCodeUnits;
+        auto isLayouted = [&](int codeUnit) {
+            return codeUnit >= layoutStart && (codeUnit < layoutEnd || layoutEnd == lineCodeUnits);
+        };
+
+        QVector<int> additionalCursorsAtLineEnd;
+        for (; additionalCursorIt != additionalCursors.end() && additionalCursorIt->line == line; ++additionalCursorIt) {
+            const int codeUnit = additionalCursorIt->codeUnit;
+            if (!isLayouted(codeUnit)) {
+                continue;
+            }
+            if (codeUnit < lineCodeUnits) {
+                const int next = lay.nextCursorPosition(codeUnit, ZTextLayout::SkipCharacters);
+                highlights.append(ZFormatRange{codeUnit, next - codeUnit, additionalCursorStyle, additionalCursorStyle});
+            } else {
+                additionalCursorsAtLineEnd.append(codeUnit);
+            }
+        }
 
         if (line > selectionStartPos.line && line < selectionEndPos.line) {
             // whole line
@@ -659,7 +889,14 @@ void ZTextEdit::paintEvent(ZPaintEvent *event) {
 
         lay.draw(*painter, {-p->scrollPositionColumn + allBordersWidth(), y}, base, &base, highlights);
 
-        if (cursorLine == line) {
+        for (const int codeUnit: additionalCursorsAtLineEnd) {
+            ZTextLineRef tlr = lay.lineForTextPosition(codeUnit);
+            const int x = tlr.cursorToX(codeUnit, ZTextLayout::Leading);
+            painter->clearRect(-p->scrollPositionColumn + allBordersWidth() + x, y + tlr.y(), 1, 1,
+                               additionalCursorStyle.foregroundColor(), additionalCursorStyle.backgroundColor());
+        }
+
+        if (cursorLine == line && isLayouted(cursorCodeUnit)) {
             if (focus()) {
                 lay.showCursor(*painter, {-p->scrollPositionColumn + allBordersWidth(), y}, cursorCodeUnit);
             }
@@ -703,6 +940,14 @@ void ZTextEdit::keyEvent(ZKeyEvent *event) {
     const bool editable = !p->readOnly;
     const bool undoredo = editable && p->undoRedoEnabled;
 
+    if (p->additionalCursors.size()) {
+        if (p->multiCursorKeyEvent(event, text)) {
+            return;
+        }
+        // All other keys end multi-cursor mode
+        clearAdditionalCursors();
+    }
+
     if (editable && event->key() == Key_Backspace && event->modifiers() == 0) {
         p->detachedScrolling = false;
         setSelectMode(false);
@@ -1041,6 +1286,10 @@ void ZTextEdit::setScrollPosition(int column, int line, int fineLine) {
         }
 
         if (fineLine > 0) {
+            if (p->wrapMode == ZTextOption::WrapMode::NoWrap) {
+                // without wrapping each line has exactly one visual line
+                return;
+            }
             ZTextLayout lay = textLayoutForLine(textOption(), line);
             if (fineLine >= lay.lineCount()) {
                 return;
@@ -1059,6 +1308,16 @@ int ZTextEdit::pageNavigationLineCount() const {
     return std::max(1, geometry().height() - 1);
 }
 
+int ZTextEdit::visualLineCount() const {
+    auto *const p = tuiwidgets_impl();
+    return p->visualLineCount();
+}
+
+bool ZTextEdit::isRewrapInProgress() const {
+    auto *const p = tuiwidgets_impl();
+    return p->rewrapScheduled || p->visualLines.unknownLines > 0;
+}
+
 ZDocumentCursor ZTextEdit::findSync(const QString &subString,
                                          ZDocument::FindFlags options)
 {
@@ -1233,6 +1492,7 @@ bool ZTextEdit::readFrom(QIODevice *file) {
 bool ZTextEdit::readFrom(QIODevice *file, Position initialPosition) {
     auto *const p = tuiwidgets_impl();
 
+    p->longLineColumnsCache.clear();
     bool ok = p->doc->readFrom(file, initialPosition, &p->cursor);
     adjustScrollPosition();
     updateCommands();
@@ -1258,6 +1518,7 @@ void ZTextEdit::setText(const QString &text) {
 void ZTextEdit::setText(const QString &text, ZTextEdit::Position initialPosition) {
     auto *const p = tuiwidgets_impl();
 
+    p->longLineColumnsCache.clear();
     p->doc->setText(text, initialPosition, &p->cursor);
     adjustScrollPosition();
     updateCommands();
@@ -1307,6 +1568,8 @@ const ZTextMetrics &ZTextEdit::textMetrics() const {
 }
 
 void ZTextEdit::resizeEvent(ZResizeEvent *event) {
+    auto *const p = tuiwidgets_impl();
+    p->scheduleRewrap();
     if (event->size().height() > 0 && event->size().width() > 0) {
         adjustScrollPosition();
     }
@@ -1339,8 +1602,7 @@ void ZTextEdit::adjustScrollPosition() {
 
     // horizontal scroll position
     if (p->wrapMode == ZTextOption::WrapMode::NoWrap) {
-        ZTextLayout layNoWrap = textLayoutForLineWithoutWrapping(cursorLine);
-        int cursorColumn = layNoWrap.lineAt(0).cursorToX(cursorCodeUnit, ZTextLayout::Leading);
+        int cursorColumn = p->columnForPositionWithoutWrapping(cursorCodeUnit, cursorLine);
 
         if (cursorColumn - newScrollPositionColumn >= viewWidth) {
              newScrollPositionColumn = cursorColumn - viewWidth + 1;
@@ -1375,6 +1637,18 @@ void ZTextEdit::adjustScrollPosition() {
     } else {
         ZTextOption option = textOption();
 
+        // Use the visual lines computed in the background where available.
+        const bool useVisualLineIndex = p->visualLines.matches(option, viewWidth);
+        auto visualLinesForLine = [&](int line) {
+            if (useVisualLineIndex) {
+                const int visualLines = p->visualLines.visualLinesFor(line, p->doc->lineRevision(line));
+                if (visualLines) {
+                    return visualLines;
+                }
+            }
+            return textLayoutForLine(option, line).lineCount();
+        };
+
         const int availableLinesAbove = geometry().height() - 2;
 
         ZTextLayout layCursorLayout = textLayoutForLine(option, cursorLine);
@@ -1392,20 +1666,20 @@ void ZTextEdit::adjustScrollPosition() {
             }
         } else {
             for (int line = cursorLine - 1; line >= 0; line--) {
-                ZTextLayout lay = textLayoutForLine(option, line);
-                if (linesAbove + lay.lineCount() >= availableLinesAbove) {
+                const int lineCount = visualLinesForLine(line);
+                if (linesAbove + lineCount >= availableLinesAbove) {
                     if (newScrollPositionLine < line) {
                         newScrollPositionLine = line;
-                        newScrollPositionFineLine = (linesAbove + lay.lineCount()) - availableLinesAbove;
+                        newScrollPositionFineLine = (linesAbove + lineCount) - availableLinesAbove;
                     }
                     if (newScrollPositionLine == line) {
-                        if (newScrollPositionFineLine < (linesAbove + lay.lineCount()) - availableLinesAbove) {
-                            newScrollPositionFineLine = (linesAbove + lay.lineCount()) - availableLinesAbove;
+                        if (newScrollPositionFineLine < (linesAbove + lineCount) - availableLinesAbove) {
+                            newScrollPositionFineLine = (linesAbove + lineCount) - availableLinesAbove;
                         }
                     }
                     break;
                 }
-                linesAbove += lay.lineCount();
+                linesAbove += lineCount;
             }
         }
 
@@ -1425,8 +1699,7 @@ void ZTextEdit::adjustScrollPosition() {
             int linesCounted = 0;
 
             for (int line = p->doc->lineCount() - 1; line >= 0; line--) {
-                ZTextLayout lay = textLayoutForLine(option, line);
-                linesCounted += lay.lineCount();
+                linesCounted += visualLinesForLine(line);
                 if (linesCounted >= geometry().height() - 1) {
                     if (newScrollPositionLine > line) {
                         newScrollPositionLine = line;
@@ -1495,6 +1768,475 @@ void ZTextEditPrivate::updatePasteCommandEnabled() {
     }
 }
 
+bool ZTextEditPrivate::isLongLine(int line) const {
+    return doc->lineCodeUnits(line) > longLineThreshold;
+}
+
+const ZTextEditPrivate::LongLineColumns &ZTextEditPrivate::longLineColumns(const ZTextOption &option, int line) {
+    const unsigned revision = doc->lineRevision(line);
+    auto it = longLineColumnsCache.find(revision);
+    if (it != longLineColumnsCache.end() && it->tabStopDistance == option.tabStopDistance()
+            && it->tabs == option.tabs()) {
+        it->lastUse = ++longLineColumnsUseCounter;
+        return *it;
+    }
+
+    if (it == longLineColumnsCache.end() && longLineColumnsCache.size() >= longLineCacheSize) {
+        // evict the least recently used entry
+        auto leastRecentlyUsed = longLineColumnsCache.begin();
+        for (auto candidate = longLineColumnsCache.begin(); candidate != longLineColumnsCache.end(); ++candidate) {
+            if (candidate->lastUse < leastRecentlyUsed->lastUse) {
+                leastRecentlyUsed = candidate;
+            }
+        }
+        longLineColumnsCache.erase(leastRecentlyUsed);
+    }
+
+    LongLineColumns entry;
+    entry.lastUse = ++longLineColumnsUseCounter;
+    entry.tabStopDistance = option.tabStopDistance();
+    entry.tabs = option.tabs();
+
+    // This is the only place that needs to layout the whole line, once per line revision.
+    ZTextOption optionNoWrap = option;
+    optionNoWrap.setWrapMode(ZTextOption::NoWrap);
+    ZTextLayout lay(textMetrics, doc->line(line));
+    lay.setTextOption(optionNoWrap);
+    lay.doLayout(std::numeric_limits<unsigned short>::max() - 1);
+    ZTextLineRef tlr = lay.lineAt(0);
+
+    const int lineCodeUnits = doc->lineCodeUnits(line);
+    entry.checkpoints.reserve(lineCodeUnits / longLineCheckpointInterval + 1);
+    for (int codeUnit = 0; codeUnit < lineCodeUnits; codeUnit += longLineCheckpointInterval) {
+        // checkpoints need to be at the start of a cluster
+        const int position = lay.isValidCursorPosition(codeUnit) ? codeUnit : lay.nextCursorPosition(codeUnit);
+        if (position >= lineCodeUnits) {
+            break;
+        }
+        if (entry.checkpoints.size() && entry.checkpoints.back().first >= position) {
+            continue;
+        }
+        entry.checkpoints.emplace_back(position, tlr.cursorToX(position, ZTextLayout::Leading));
+    }
+
+    return *longLineColumnsCache.insert(revision, std::move(entry));
+}
+
+ZTextLayout ZTextEditPrivate::longLineLayoutWindow(const ZTextOption &option, int line, int startColumn,
+                                                   int endColumn) {
+    const auto &checkpoints = longLineColumns(option, line).checkpoints;
+    // last checkpoint at or before startColumn
+    auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), startColumn,
+                               [](int column, const std::pair<int, int> &checkpoint) {
+        return column < checkpoint.second;
+    });
+    if (it != checkpoints.begin()) {
+        --it;
+    }
+
+    ZTextOption optionNoWrap = option;
+    optionNoWrap.setWrapMode(ZTextOption::NoWrap);
+    ZTextLayout lay(textMetrics, doc->line(line));
+    lay.setTextOption(optionNoWrap);
+    lay.doLayoutWindow(it->first, it->second, std::numeric_limits<int>::max(), endColumn);
+    return lay;
+}
+
+ZTextLayout ZTextEditPrivate::longLineLayoutWindowForCodeUnits(const ZTextOption &option, int line,
+                                                               int startCodeUnit, int endCodeUnit) {
+    const auto &checkpoints = longLineColumns(option, line).checkpoints;
+    // last checkpoint at or before startCodeUnit
+    auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), startCodeUnit,
+                               [](int codeUnit, const std::pair<int, int> &checkpoint) {
+        return codeUnit < checkpoint.first;
+    });
+    if (it != checkpoints.begin()) {
+        --it;
+    }
+
+    ZTextOption optionNoWrap = option;
+    optionNoWrap.setWrapMode(ZTextOption::NoWrap);
+    ZTextLayout lay(textMetrics, doc->line(line));
+    lay.setTextOption(optionNoWrap);
+    lay.doLayoutWindow(it->first, it->second, endCodeUnit, std::numeric_limits<int>::max());
+    return lay;
+}
+
+ZTextLayout ZTextEditPrivate::textLayoutWithoutWrappingForCodeUnits(int line, int startCodeUnit, int endCodeUnit) {
+    if (!isLongLine(line)) {
+        return pub()->textLayoutForLineWithoutWrapping(line);
+    }
+    return longLineLayoutWindowForCodeUnits(pub()->textOption(), line, startCodeUnit, endCodeUnit);
+}
+
+int ZTextEditPrivate::columnForPositionWithoutWrapping(int codeUnit, int line) {
+    ZTextLayout lay = textLayoutWithoutWrappingForCodeUnits(line, codeUnit, codeUnit);
+    return lay.lineAt(0).cursorToX(codeUnit, ZTextLayout::Leading);
+}
+
+bool ZTextEditPrivate::VisualLineIndex::matches(const ZTextOption &option, int width) const {
+    return this->width == width && wrapMode == option.wrapMode() && flags == option.flags()
+            && tabStopDistance == option.tabStopDistance() && tabs == option.tabs();
+}
+
+int ZTextEditPrivate::VisualLineIndex::visualLinesFor(int line, unsigned lineRevision) const {
+    if (line < 0 || line >= size2int(lineRevisions.size()) || lineRevisions[line] != lineRevision) {
+        return 0;
+    }
+    return visualLines[line];
+}
+
+void ZTextEditPrivate::scheduleRewrap() {
+    if (rewrapScheduled) {
+        return;
+    }
+    rewrapScheduled = true;
+    // Edits and resizes often come in bursts, this restarts the computation once for all of them.
+    QTimer::singleShot(0, pub(), [this] {
+        if (rewrapScheduled) {
+            startRewrap();
+        }
+    });
+}
+
+// Computes the visual lines of all lines of the document in the background. The chunks around the scroll position
+// are computed first.
+void ZTextEditPrivate::startRewrap() {
+    rewrapScheduled = false;
+
+    const ZTextOption option = pub()->textOption();
+    const int width = std::max(pub()->rect().width() - pub()->allBordersWidth(), 0);
+
+    if (option.wrapMode() == ZTextOption::NoWrap || width == 0) {
+        cancelRewrap(false);
+        visualLines = VisualLineIndex();
+        emitVisualLineCountChanged();
+        return;
+    }
+
+    if (visualLines.matches(option, width) && visualLines.documentRevision == doc->revision()) {
+        return;
+    }
+
+    const int lineCount = doc->lineCount();
+
+    VisualLineIndex index;
+    index.width = width;
+    index.wrapMode = option.wrapMode();
+    index.flags = option.flags();
+    index.tabStopDistance = option.tabStopDistance();
+    index.tabs = option.tabs();
+    index.documentRevision = doc->revision();
+    index.lineRevisions.resize(lineCount);
+    for (int line = 0; line < lineCount; line++) {
+        index.lineRevisions[line] = doc->lineRevision(line);
+    }
+    index.visualLines.assign(lineCount, 0);
+
+    if (visualLines.matches(option, width)) {
+        // Edits usually change a contiguous range of lines, keep what is known for the lines before and after.
+        const int oldLineCount = size2int(visualLines.lineRevisions.size());
+        int prefix = 0;
+        while (prefix < lineCount && prefix < oldLineCount
+               && index.lineRevisions[prefix] == visualLines.lineRevisions[prefix]) {
+            index.visualLines[prefix] = visualLines.visualLines[prefix];
+            prefix++;
+        }
+        int suffix = 0;
+        while (suffix < lineCount - prefix && suffix < oldLineCount - prefix
+               && index.lineRevisions[lineCount - 1 - suffix] == visualLines.lineRevisions[oldLineCount - 1 - suffix]) {
+            index.visualLines[lineCount - 1 - suffix] = visualLines.visualLines[oldLineCount - 1 - suffix];
+            suffix++;
+        }
+    }
+
+    auto job = std::make_shared<RewrapJob>(textMetrics);
+    const int priorityChunk = std::min(scrollPositionLine.line(), std::max(0, lineCount - 1)) / rewrapChunkLines;
+    for (int line = 0; line < lineCount; line++) {
+        if (index.visualLines[line]) {
+            index.knownVisualLines += index.visualLines[line];
+        } else {
+            index.unknownLines++;
+            if (job->chunks.empty() || job->chunks.back() != line / rewrapChunkLines * rewrapChunkLines) {
+                job->chunks.push_back(line / rewrapChunkLines * rewrapChunkLines);
+            }
+        }
+    }
+    std::stable_sort(job->chunks.begin(), job->chunks.end(), [priorityChunk](int lhs, int rhs) {
+        return std::abs(lhs / rewrapChunkLines - priorityChunk) < std::abs(rhs / rewrapChunkLines - priorityChunk);
+    });
+
+    cancelRewrap(false);
+    visualLines = std::move(index);
+
+    if (!job->chunks.empty()) {
+        job->lines.resize(lineCount);
+        for (int line = 0; line < lineCount; line++) {
+            if (!visualLines.visualLines[line]) {
+                job->lines[line] = doc->line(line);
+            }
+        }
+        job->option = option;
+        job->width = width;
+        job->knownVisualLines = visualLines.visualLines;
+
+        QThreadPool *const pool = QThreadPool::globalInstance();
+        const int workers = std::max(1, std::min(pool->maxThreadCount(), size2int(job->chunks.size())));
+        job->runningWorkers = workers;
+
+        QFutureInterface<RewrapChunk> promise;
+        promise.reportStarted();
+
+        rewrapWatcher = std::make_unique<QFutureWatcher<RewrapChunk>>();
+        QObject::connect(rewrapWatcher.get(), &QFutureWatcher<RewrapChunk>::resultsReadyAt, pub(),
+                         [this](int begin, int end) {
+            rewrapResultsReady(begin, end);
+        });
+        rewrapWatcher->setFuture(promise.future());
+
+        for (int i = 0; i < workers; i++) {
+            RewrapOnThread *runnable = new RewrapOnThread();
+            runnable->promise = promise;
+            runnable->job = job;
+            pool->start(runnable);
+        }
+    }
+
+    emitVisualLineCountChanged();
+}
+
+void ZTextEditPrivate::cancelRewrap(bool wait) {
+    if (rewrapWatcher) {
+        QFuture<RewrapChunk> future = rewrapWatcher->future();
+        rewrapWatcher.reset();
+        future.cancel();
+        cancelledRewraps.push_back(future);
+    }
+    // Workers of cancelled jobs still finish their current chunk, they use copies of textMetrics.
+    cancelledRewraps.erase(std::remove_if(cancelledRewraps.begin(), cancelledRewraps.end(),
+                                          [](const QFuture<RewrapChunk> &future) {
+                               return future.isFinished();
+                           }), cancelledRewraps.end());
+    if (wait) {
+        for (QFuture<RewrapChunk> &future: cancelledRewraps) {
+            future.waitForFinished();
+        }
+        cancelledRewraps.clear();
+    }
+}
+
+void ZTextEditPrivate::rewrapResultsReady(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        const RewrapChunk chunk = rewrapWatcher->future().resultAt(i);
+        for (int j = 0; j < size2int(chunk.visualLines.size()); j++) {
+            int &visualLinesOfLine = visualLines.visualLines[chunk.firstLine + j];
+            if (!visualLinesOfLine) {
+                visualLinesOfLine = chunk.visualLines[j];
+                visualLines.knownVisualLines += visualLinesOfLine;
+                visualLines.unknownLines--;
+            }
+        }
+    }
+    emitVisualLineCountChanged();
+}
+
+// Lines not computed yet are counted as one visual line.
+int ZTextEditPrivate::visualLineCount() const {
+    if (visualLines.width < 0) {
+        return doc->lineCount();
+    }
+    return visualLines.knownVisualLines + visualLines.unknownLines;
+}
+
+void ZTextEditPrivate::emitVisualLineCountChanged() {
+    const int count = visualLineCount();
+    if (count != reportedVisualLineCount) {
+        reportedVisualLineCount = count;
+        pub()->visualLineCountChanged(count);
+    }
+}
+
+void ZTextEditPrivate::normalizeAdditionalCursors() {
+    std::stable_sort(additionalCursors.begin(), additionalCursors.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs->position() < rhs->position();
+    });
+
+    // Cursors that ended up on the same position (e.g. after deleting the text between them) are merged.
+    const Position mainPosition = cursor.position();
+    auto last = std::unique(additionalCursors.begin(), additionalCursors.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs->position() == rhs->position();
+    });
+    last = std::remove_if(additionalCursors.begin(), last, [&mainPosition](const auto &cur) {
+        return cur->position() == mainPosition;
+    });
+    additionalCursors.erase(last, additionalCursors.end());
+}
+
+QVector<ZDocumentCursor*> ZTextEditPrivate::allCursorsSorted() {
+    normalizeAdditionalCursors();
+
+    QVector<ZDocumentCursor*> result;
+    result.reserve(size2int(additionalCursors.size()) + 1);
+    result.append(&cursor);
+    for (const auto &cur: additionalCursors) {
+        result.append(cur.get());
+    }
+    std::sort(result.begin(), result.end(), [](ZDocumentCursor *lhs, ZDocumentCursor *rhs) {
+        return lhs->position() < rhs->position();
+    });
+    return result;
+}
+
+void ZTextEditPrivate::multiCursorInsertText(const QString &text, bool overwrite) {
+    const QVector<ZDocumentCursor*> cursors = allCursorsSorted();
+
+    const bool batchable = !text.contains(QLatin1Char('\n'))
+            && std::none_of(cursors.begin(), cursors.end(), [](ZDocumentCursor *cur) {
+                return cur->hasSelection();
+            });
+
+    if (batchable) {
+        // Fast path: All insertions are done in one document operation.
+        QVector<LineEdit> edits;
+        edits.reserve(cursors.size());
+        std::optional<ZTextLayout> lay;
+        int layLine = -1;
+        for (ZDocumentCursor *cur: cursors) {
+            const auto [codeUnit, line] = cur->position();
+            int codeUnits = 0;
+            if (overwrite && codeUnit < doc->lineCodeUnits(line)) {
+                // long lines are only layouted around each cursor
+                if (layLine != line || isLongLine(line)) {
+                    lay.emplace(textLayoutWithoutWrappingForCodeUnits(line, codeUnit, codeUnit + 1));
+                    layLine = line;
+                }
+                codeUnits = lay->nextCursorPosition(codeUnit, ZTextLayout::SkipCharacters) - codeUnit;
+            }
+            edits.append({line, codeUnit, codeUnits, text});
+        }
+        ZDocumentPrivate::get(doc)->applyLineEdits(&cursor, edits, true,
+                                                   !text.contains(QLatin1Char(' '))
+                                                   && !text.contains(QLatin1Char('\t')));
+    } else {
+        auto undoGroup = doc->startUndoGroup(&cursor);
+        for (ZDocumentCursor *cur: cursors) {
+            if (overwrite) {
+                cur->overwriteText(text);
+            } else {
+                cur->insertText(text);
+            }
+        }
+    }
+
+    normalizeAdditionalCursors();
+}
+
+void ZTextEditPrivate::multiCursorDeleteCharacter(bool previous) {
+    const QVector<ZDocumentCursor*> cursors = allCursorsSorted();
+
+    // Deleting line breaks changes the line structure, that is handled by the slow path below.
+    const bool batchable = std::none_of(cursors.begin(), cursors.end(), [this, previous](ZDocumentCursor *cur) {
+        const auto [codeUnit, line] = cur->position();
+        return cur->hasSelection() || (previous ? codeUnit == 0 : codeUnit == doc->lineCodeUnits(line));
+    });
+
+    if (batchable) {
+        QVector<LineEdit> edits;
+        edits.reserve(cursors.size());
+        std::optional<ZTextLayout> lay;
+        int layLine = -1;
+        for (ZDocumentCursor *cur: cursors) {
+            const auto [codeUnit, line] = cur->position();
+            // long lines are only layouted around each cursor
+            if (layLine != line || isLongLine(line)) {
+                lay.emplace(textLayoutWithoutWrappingForCodeUnits(line, std::max(0, codeUnit - 1), codeUnit + 1));
+                layLine = line;
+            }
+            if (previous) {
+                const int start = lay->previousCursorPosition(codeUnit, ZTextLayout::SkipCharacters);
+                edits.append({line, start, codeUnit - start, QString()});
+            } else {
+                const int end = lay->nextCursorPosition(codeUnit, ZTextLayout::SkipCharacters);
+                edits.append({line, codeUnit, end - codeUnit, QString()});
+            }
+        }
+        ZDocumentPrivate::get(doc)->applyLineEdits(&cursor, edits);
+    } else {
+        auto undoGroup = doc->startUndoGroup(&cursor);
+        for (ZDocumentCursor *cur: cursors) {
+            if (previous) {
+                cur->deletePreviousCharacter();
+            } else {
+                cur->deleteCharacter();
+            }
+        }
+    }
+
+    normalizeAdditionalCursors();
+}
+
+bool ZTextEditPrivate::multiCursorKeyEvent(ZKeyEvent *event, const QString &text) {
+    const bool editable = !readOnly;
+
+    auto forAllCursors = [this](auto fn) {
+        for (ZDocumentCursor *cur: allCursorsSorted()) {
+            fn(cur);
+        }
+        normalizeAdditionalCursors();
+    };
+
+    // Inserting might adjust the scroll position, so save it here and restore it later.
+    const int scrollLine = scrollPositionLine.line();
+
+    if (editable && event->key() == Key_Backspace && event->modifiers() == 0) {
+        multiCursorDeleteCharacter(true);
+    } else if (editable && event->key() == Key_Delete && event->modifiers() == 0) {
+        multiCursorDeleteCharacter(false);
+    } else if (editable && text.size() && event->modifiers() == 0) {
+        multiCursorInsertText(text, overwriteMode);
+        scrollPositionLine.setLine(scrollLine);
+    } else if (editable && event->key() == Qt::Key_Enter && (event->modifiers() & ~Qt::KeypadModifier) == 0) {
+        multiCursorInsertText(QStringLiteral("\n"), false);
+        scrollPositionLine.setLine(scrollLine);
+    } else if (event->key() == Qt::Key_Left && event->modifiers() == 0) {
+        forAllCursors([](ZDocumentCursor *cur) { cur->moveCharacterLeft(); });
+        doc->clearCollapseUndoStep();
+    } else if (event->key() == Qt::Key_Right && event->modifiers() == 0) {
+        forAllCursors([](ZDocumentCursor *cur) { cur->moveCharacterRight(); });
+        doc->clearCollapseUndoStep();
+    } else if (event->key() == Qt::Key_Up && event->modifiers() == 0) {
+        forAllCursors([](ZDocumentCursor *cur) { cur->moveUp(); });
+        doc->clearCollapseUndoStep();
+    } else if (event->key() == Qt::Key_Down && event->modifiers() == 0) {
+        forAllCursors([](ZDocumentCursor *cur) { cur->moveDown(); });
+        doc->clearCollapseUndoStep();
+    } else if (event->key() == Qt::Key_Home && event->modifiers() == 0) {
+        forAllCursors([](ZDocumentCursor *cur) {
+            if (cur->atLineStart()) {
+                cur->moveToStartIndentedText();
+            } else {
+                cur->moveToStartOfLine();
+            }
+        });
+        doc->clearCollapseUndoStep();
+    } else if (event->key() == Qt::Key_End && event->modifiers() == 0) {
+        forAllCursors([](ZDocumentCursor *cur) { cur->moveToEndOfLine(); });
+        doc->clearCollapseUndoStep();
+    } else if (event->key() == Qt::Key_Escape && event->modifiers() == 0) {
+        pub()->clearAdditionalCursors();
+        return true;
+    } else {
+        return false;
+    }
+
+    detachedScrolling = false;
+    pub()->setSelectMode(false);
+    pub()->updateCommands();
+    pub()->adjustScrollPosition();
+    pub()->update();
+    return true;
+}
+
 void ZTextEdit::clearAdvancedSelection() {
     // derived classes can override this
 }
@@ -3,6 +3,8 @@
 #ifndef TUIWIDGETS_ZTEXTEDIT_INCLUDED
 #define TUIWIDGETS_ZTEXTEDIT_INCLUDED
 
+#include <QVector>
+
 #include <Tui/ZCommandNotifier.h>
 #include <Tui/ZCommon.h>
 #include <Tui/ZDocument.h>
@@ -71,6 +73,11 @@ class TUIWIDGETS_EXPORT ZTextEdit : public ZWidget {
 
     bool isModified() const;
 
+    void setAdditionalCursorPositions(const QVector<Position> &positions);
+    QVector<Position> additionalCursorPositions() const;
+    void clearAdditionalCursors();
+    bool hasAdditionalCursors() const;
+
     void insertText(const QString &str);
     void insertTabAt(ZDocumentCursor &cur);
 
@@ -106,6 +113,9 @@ class TUIWIDGETS_EXPORT ZTextEdit : public ZWidget {
 
     virtual int pageNavigationLineCount() const;
 
+    int visualLineCount() const;
+    bool isRewrapInProgress() const;
+
     ZDocumentCursor findSync(const QString &subString, FindFlags options = FindFlags{});
     ZDocumentCursor findSync(const QRegularExpression &regex, FindFlags options = FindFlags{});
     ZDocumentFindResult findSyncWithDetails(const QRegularExpression &regex, FindFlags options = FindFlags{});
@@ -138,6 +148,7 @@ class TUIWIDGETS_EXPORT ZTextEdit : public ZWidget {
     void overwriteModeChanged(bool overwrite);
     void modifiedChanged(bool modified);
     void selectModeChanged(bool mode);
+    void visualLineCountChanged(int visualLineCount);
 
 protected:
     void paintEvent(ZPaintEvent *event) override;
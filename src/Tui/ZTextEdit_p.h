@@ -3,6 +3,14 @@
 #ifndef TUIWIDGETS_ZTEXTEDIT_P_INCLUDED
 #define TUIWIDGETS_ZTEXTEDIT_P_INCLUDED
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+
 #include <Tui/ZTextEdit.h>
 #include <Tui/ZWidget_p.h>
 
@@ -11,12 +19,52 @@
 TUIWIDGETS_NS_START
 
 class ZTextEditPrivate : public ZWidgetPrivate {
+public:
+    // Checkpoints of the layout of a long line without wrapping, so that parts of the line can be layouted without
+    // layouting everything before them.
+    class LongLineColumns {
+    public:
+        int tabStopDistance = 0;
+        QList<ZTextOption::Tab> tabs;
+        std::vector<std::pair<int, int>> checkpoints; // (code unit, column), code units ascending
+        quint64 lastUse = 0; // for eviction of the least recently used entry
+    };
+
+    // Number of visual lines of each line of the document with wrapping. Computed in the background for a
+    // revision of the document and the wrapping parameters below.
+    class VisualLineIndex {
+    public:
+        bool matches(const ZTextOption &option, int width) const;
+        // Returns 0 if not known for the line with this revision, e.g. when lines before it were inserted or removed
+        // since the snapshot. Line revisions are unique per line content, so a matching revision is the same text.
+        int visualLinesFor(int line, unsigned lineRevision) const;
+
+    public:
+        int width = -1; // -1 when not wrapping
+        ZTextOption::WrapMode wrapMode = ZTextOption::NoWrap;
+        ZTextOption::Flags flags;
+        int tabStopDistance = 0;
+        QList<ZTextOption::Tab> tabs;
+        unsigned documentRevision = 0;
+        std::vector<unsigned> lineRevisions;
+        std::vector<int> visualLines; // 0 while not yet known
+        int knownVisualLines = 0; // sum of known entries in visualLines
+        int unknownLines = 0;
+    };
+
+    class RewrapChunk {
+    public:
+        int firstLine = 0;
+        std::vector<int> visualLines;
+    };
+
 public:
     ZTextEditPrivate(const Tui::ZTextMetrics &textMetrics, Tui::ZDocument *document, ZWidget *pub);
     ~ZTextEditPrivate() override;
 
 public:
     Tui::ZDocumentCursor makeCursor();
+    ZTextLayout cursorTextLayout(int line, bool wrappingAllowed);
 
     QFuture<ZDocumentFindAsyncResult> connectAsyncFindCommon(QFuture<ZDocumentFindAsyncResult> res,
                                                              ZTextEdit::FindFlags options);
@@ -27,11 +75,36 @@ class ZTextEditPrivate : public ZWidgetPrivate {
 
     void updatePasteCommandEnabled();
 
+    void normalizeAdditionalCursors();
+    QVector<ZDocumentCursor*> allCursorsSorted();
+    bool multiCursorKeyEvent(ZKeyEvent *event, const QString &text);
+    void multiCursorInsertText(const QString &text, bool overwrite);
+    void multiCursorDeleteCharacter(bool previous);
+
+    bool isLongLine(int line) const;
+    const LongLineColumns &longLineColumns(const ZTextOption &option, int line);
+    ZTextLayout longLineLayoutWindow(const ZTextOption &option, int line, int startColumn, int endColumn);
+    ZTextLayout longLineLayoutWindowForCodeUnits(const ZTextOption &option, int line, int startCodeUnit,
+                                                 int endCodeUnit);
+    // Layout without wrapping that is valid for the code units in [startCodeUnit, endCodeUnit), only that part is
+    // layouted for long lines.
+    ZTextLayout textLayoutWithoutWrappingForCodeUnits(int line, int startCodeUnit, int endCodeUnit);
+    int columnForPositionWithoutWrapping(int codeUnit, int line);
+
+    void scheduleRewrap();
+    void startRewrap();
+    void cancelRewrap(bool wait);
+    void rewrapResultsReady(int begin, int end);
+    int visualLineCount() const;
+    void emitVisualLineCountChanged();
+
 public:
     Tui::ZTextMetrics textMetrics;
     Tui::ZDocument *doc = nullptr;
     std::unique_ptr<Tui::ZDocument> autoDeleteDoc;
     Tui::ZDocumentCursor cursor;
+    // Multi-cursor mode: Edits are applied at `cursor` and all of these.
+    std::vector<std::unique_ptr<Tui::ZDocumentCursor>> additionalCursors;
     bool selectMode = false;
 
     int tabsize = 8;
@@ -49,6 +122,20 @@ class ZTextEditPrivate : public ZWidgetPrivate {
     int scrollPositionColumn = 0;
     Tui::ZDocumentLineMarker scrollPositionLine;
     int scrollPositionFineLine = 0;
+    // scroll position and geometry of the last paint, to hint the terminal about scrolled lines
+    int lastPaintedScrollLine = -1;
+    int lastPaintedScrollFineLine = 0;
+    int lastPaintedScrollColumn = 0;
+    QRect lastPaintedGeometry;
+
+    QHash<unsigned, LongLineColumns> longLineColumnsCache; // by line revision, unique for each line content of doc
+    quint64 longLineColumnsUseCounter = 0;
+
+    VisualLineIndex visualLines;
+    std::unique_ptr<QFutureWatcher<RewrapChunk>> rewrapWatcher;
+    std::vector<QFuture<RewrapChunk>> cancelledRewraps; // not finished when cancelled, pruned on each cancel
+    bool rewrapScheduled = false;
+    int reportedVisualLineCount = -1;
 
     Tui::ZCommandNotifier *cmdCopy = nullptr;
     Tui::ZCommandNotifier *cmdCut = nullptr;
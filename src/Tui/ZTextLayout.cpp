@@ -3,8 +3,12 @@
 #include "ZTextLayout.h"
 #include "ZTextLayout_p.h"
 
+#include <algorithm>
+#include <utility>
+
 #include <QList>
 #include <QTextBoundaryFinder>
+#include <QVarLengthArray>
 
 #include <Tui/ZFormatRange.h>
 #include <Tui/ZPainter.h>
@@ -15,6 +19,13 @@
 
 TUIWIDGETS_NS_START
 
+namespace {
+    // Upper limit for the total number of cached code units and line break opportunities per thread.
+    constexpr qint64 lineBreaksCacheMaxCost = 2 * 1024 * 1024;
+}
+
+thread_local ZTextLayoutPrivate::LineBreaksCache ZTextLayoutPrivate::lineBreaksCache;
+
 ZTextLayout::ZTextLayout(ZTextMetrics metrics) : tuiwidgets_pimpl_ptr(ZTextLayoutPrivate(metrics))
 {
 }
@@ -37,6 +48,7 @@ QString ZTextLayout::text() const {
 void ZTextLayout::setText(const QString &text) {
     auto *const p = tuiwidgets_impl();
     p->text = text;
+    p->textLineBreaks.reset();
 }
 
 const ZTextOption &ZTextLayout::textOption() const {
@@ -53,7 +65,8 @@ void ZTextLayout::beginLayout() {
     auto *const p = tuiwidgets_impl();
     p->lines.clear();
     p->nextIndex = 0;
-    p->columns.resize(p->text.size());
+    p->columns.clear();
+    p->textRuns.clear();
 }
 
 void ZTextLayout::doLayout(int width) {
@@ -74,6 +87,27 @@ void ZTextLayout::doLayout(int width) {
     endLayout();
 }
 
+void ZTextLayout::doLayoutWindow(int startCodeUnit, int startColumn, int endCodeUnit, int endColumn) {
+    auto *const p = tuiwidgets_impl();
+    beginLayout();
+    p->nextIndex = std::max(0, std::min(startCodeUnit, size2int(p->text.size())));
+    p->layoutWindow = true;
+    p->windowStartColumn = startColumn;
+    p->windowEndCodeUnit = endCodeUnit;
+    p->windowEndColumn = endColumn;
+
+    p->lines.append(ZTextLayoutPrivate::LineData());
+    layoutLine(0, 0);
+    ZTextLayoutPrivate::LineData &ld = p->lines[0];
+    ld.maxWidth = ld.offset != ld.endIndex ? p->columns.at(ld.endIndex - 1) : startColumn;
+
+    p->layoutWindow = false;
+    p->windowStartColumn = 0;
+    p->windowEndCodeUnit = std::numeric_limits<int>::max();
+    p->windowEndColumn = std::numeric_limits<int>::max();
+    endLayout();
+}
+
 void ZTextLayout::endLayout() {
 }
 
@@ -215,9 +249,10 @@ int ZTextLayout::previousCursorPosition(int oldPos, ZTextLayout::CursorMode mode
         return oldPos;
     } else {
         --oldPos;
-        int column = p->columns[oldPos];
+        ZTextLayoutPrivate::ColumnIndex::Reader columns(p->columns);
+        int column = columns.at(oldPos);
         int line = lineNumberForTextPosition(oldPos);
-        while (oldPos >= 0 && p->columns[oldPos] == column && lineNumberForTextPosition(oldPos) == line) {
+        while (oldPos >= 0 && columns.at(oldPos) == column && lineNumberForTextPosition(oldPos) == line) {
             --oldPos;
         }
         return oldPos + 1;
@@ -251,9 +286,10 @@ int ZTextLayout::nextCursorPosition(int oldPos, ZTextLayout::CursorMode mode) co
 
         return oldPos;
     } else {
-        int column = p->columns[oldPos];
+        ZTextLayoutPrivate::ColumnIndex::Reader columns(p->columns);
+        int column = columns.at(oldPos);
         int line = lineNumberForTextPosition(oldPos);
-        while (oldPos < p->text.size() && p->columns[oldPos] == column && lineNumberForTextPosition(oldPos) == line) {
+        while (oldPos < p->text.size() && columns.at(oldPos) == column && lineNumberForTextPosition(oldPos) == line) {
             ++oldPos;
         }
         return oldPos;
@@ -269,7 +305,8 @@ bool ZTextLayout::isValidCursorPosition(int pos) const {
         return true;
     }
 
-    return p->columns[pos] != p->columns[pos - 1] || lineNumberForTextPosition(pos) != lineNumberForTextPosition(pos - 1);
+    ZTextLayoutPrivate::ColumnIndex::Reader columns(p->columns);
+    return columns.at(pos) != columns.at(pos - 1) || lineNumberForTextPosition(pos) != lineNumberForTextPosition(pos - 1);
 }
 
 void ZTextLayout::layoutLine(int index, int width) {
@@ -278,9 +315,17 @@ void ZTextLayout::layoutLine(int index, int width) {
         return;
     }
     ZTextLayoutPrivate::LineData &ld = p->lines[index];
+    if (ld.textRunCount && ld.firstTextRun + ld.textRunCount == p->textRuns.size()) {
+        // The line is layouted again, drop the text runs of its previous layout.
+        p->textRuns.resize(ld.firstTextRun);
+    }
     ld.maxWidth = width;
     ld.offset = p->nextIndex;
+    ld.firstTextRun = size2int(p->textRuns.size());
+    ld.textRunCount = 0;
+    ld.startColumn = p->windowStartColumn;
     int offset = ld.offset;
+    p->columns.startLine(offset);
 
     if (offset == p->text.size()) {
         ld.endIndex = p->nextIndex;
@@ -289,10 +334,10 @@ void ZTextLayout::layoutLine(int index, int width) {
     }
 
     auto textOptionFlags = p->textOption.flags();
-    auto textOptionWrapMode = p->textOption.wrapMode();
+    auto textOptionWrapMode = p->layoutWindow ? ZTextOption::NoWrap : p->textOption.wrapMode();
     auto textOptionTabWidth = p->textOption.tabStopDistance();
 
-    int column = 0;
+    int column = ld.startColumn;
 
     ZTextLayoutPrivate::TextRun run;
     run.type = ZTextLayoutPrivate::TextRun::COPY;
@@ -309,21 +354,31 @@ void ZTextLayout::layoutLine(int index, int width) {
                 // of ascii spaces should count as a break opportunity as well.
                 return;
             }
-            QTextBoundaryFinder bndFinder(QTextBoundaryFinder::Line, p->text.data() + run.offset, std::max(offset + 2 /* allow for surrogate */, size2int(p->text.size())) - run.offset);
-            bndFinder.setPosition(offset - run.offset);
-            int boundary = bndFinder.isAtBoundary() ? bndFinder.position() : bndFinder.toPreviousBoundary();
-            if (boundary != -1 && run.offset + boundary != ld.offset) {
-                for (int i = run.offset + boundary; i < offset; i++) {
-                    // remove _columns values for wrapped code units
-                    p->columns[i] = 0;
-                }
-                offset = run.offset + boundary;
+            if (offset == run.offset) {
+                return;
+            }
+            // Last break opportunity at or before offset, the start of the run always counts as one.
+            const std::vector<int> &breaks = p->lineBreaks().positions;
+            auto it = std::upper_bound(breaks.begin(), breaks.end(), offset);
+            int boundary = run.offset;
+            if (it != breaks.begin() && *(it - 1) > run.offset) {
+                boundary = *(it - 1);
+            }
+            if (boundary != ld.offset) {
+                // remove columns values for wrapped code units
+                p->columns.truncate(boundary);
+                offset = boundary;
             }
         }
     };
 
     while (offset < p->text.size()) {
         // column is the colum relative to pos in LineData where the next cluster would be placed
+        if (offset >= p->windowEndCodeUnit || column >= p->windowEndColumn) {
+            // end of layout window
+            break;
+        }
+
         uint ch = p->text[offset].unicode();
 
         if (ch == '\n') {
@@ -331,11 +386,11 @@ void ZTextLayout::layoutLine(int index, int width) {
             run.endIndex = offset;
             if (run.endIndex != run.offset) {
                 run.width = column - run.x;
-                ld.textRuns.append(run);
+                p->appendTextRun(ld, run);
             }
             p->nextIndex = offset + 1;
             ld.endIndex = offset + 1;
-            p->columns[offset] = column + 1;
+            p->columns.addCluster(offset, 1, column + 1);
             return;
         }
 
@@ -360,7 +415,7 @@ void ZTextLayout::layoutLine(int index, int width) {
             run.endIndex = offset;
             if (run.endIndex != run.offset) {
                 run.width = column - run.x;
-                ld.textRuns.append(run);
+                p->appendTextRun(ld, run);
             }
 
             // add tab run
@@ -388,8 +443,8 @@ void ZTextLayout::layoutLine(int index, int width) {
             }
 
             run.width = column - run.x;
-            p->columns[offset] = column;
-            ld.textRuns.append(run);
+            p->columns.addCluster(offset, 1, column);
+            p->appendTextRun(ld, run);
             run.width = -1;
 
             offset += 1;
@@ -440,7 +495,7 @@ void ZTextLayout::layoutLine(int index, int width) {
             run.endIndex = offset;
             if (run.endIndex != run.offset) {
                 run.width = column - run.x;
-                ld.textRuns.append(run);
+                p->appendTextRun(ld, run);
             }
 
             int widthOfDisplay;
@@ -469,10 +524,8 @@ void ZTextLayout::layoutLine(int index, int width) {
             column += widthOfDisplay;
 
             run.width = column - run.x;
-            for (int i = 0; i < chLen; i++) {
-                p->columns[offset + i] = column;
-            }
-            ld.textRuns.append(run);
+            p->columns.addCluster(offset, chLen, column);
+            p->appendTextRun(ld, run);
             run.width = -1;
 
             offset += chLen;
@@ -489,7 +542,7 @@ void ZTextLayout::layoutLine(int index, int width) {
             run.endIndex = offset;
             if (run.endIndex != run.offset) {
                 run.width = column - run.x;
-                ld.textRuns.append(run);
+                p->appendTextRun(ld, run);
             }
 
             // add spaces run
@@ -499,19 +552,22 @@ void ZTextLayout::layoutLine(int index, int width) {
 
             // find offset that is after the spaces run
             while (offset < p->text.size() && p->text[offset] == u' ' && cs.codePoints == 1) {
+                if (offset >= p->windowEndCodeUnit || column >= p->windowEndColumn) {
+                    break;
+                }
                 if (textOptionWrapMode != ZTextOption::NoWrap) {
                     if (column && column >= width) { // but always consume at least one cluster
                         break;
                     }
                 }
                 column += 1;
-                p->columns[offset] = column;
+                p->columns.addCluster(offset, 1, column);
                 offset += 1;
                 cs = p->metrics.nextCluster(p->text, offset);
             }
             run.width = column - run.x;
             run.endIndex = offset;
-            ld.textRuns.append(run);
+            p->appendTextRun(ld, run);
             run.width = -1;
 
             // prepare new run
@@ -585,16 +641,14 @@ void ZTextLayout::layoutLine(int index, int width) {
         }
 
         column += cs.columns;
-        for (int i = 0; i < cs.codeUnits; i++) {
-            p->columns[offset + i] = column;
-        }
+        p->columns.addCluster(offset, cs.codeUnits, column);
         offset += cs.codeUnits;
     }
     // commit text run
     run.endIndex = offset;
     if (run.endIndex != run.offset) {
         run.width = column - run.x;
-        ld.textRuns.append(run);
+        p->appendTextRun(ld, run);
     }
 
     // finalize
@@ -626,6 +680,20 @@ namespace {
         int run;
         const ZFormatRange *ptr;
     };
+
+    // Writes count copies of ch without allocating a string for it.
+    void writeRepeated(ZPainter &painter, int x, int y, QChar ch, int count, const ZTextStyle &style) {
+        constexpr int chunkSize = 64;
+        QChar buffer[chunkSize];
+        std::fill(buffer, buffer + std::min(count, chunkSize), ch);
+        while (count > 0) {
+            const int chunk = std::min(count, chunkSize);
+            painter.writeWithAttributes(x, y, buffer, chunk,
+                                        style.foregroundColor(), style.backgroundColor(), style.attributes());
+            x += chunk;
+            count -= chunk;
+        }
+    }
 }
 
 void ZTextLineRef::draw(ZPainter painter, const QPoint &pos, ZTextStyle color, ZTextStyle formattingChars,
@@ -634,23 +702,21 @@ void ZTextLineRef::draw(ZPainter painter, const QPoint &pos, ZTextStyle color, Z
         auto *const p = _layout->tuiwidgets_impl();
         auto textOptionFlags = p->textOption.flags();
 
-        ZTextLayoutPrivate::LineData &ld = p->lines[_index];
+        // Only const access, to never detach data shared with copies of the layout.
+        const ZTextLayoutPrivate::LineData &ld = std::as_const(p->lines)[_index];
+        const QChar *const text = p->text.constData();
+        const ZTextLayoutPrivate::TextRun *const textRuns = p->textRuns.constData() + ld.firstTextRun;
+        const ZTextLayoutPrivate::TextRun *const textRunsEnd = textRuns + ld.textRunCount;
+        ZTextLayoutPrivate::ColumnIndex::Reader columns(p->columns);
         ZPainter painterClipped = painter.translateAndClip({0, 0, pos.x() + ld.pos.x() + ld.maxWidth,
                                                             pos.y() + ld.pos.y() + 1});
 
-        // Prepare to use binary search to find first text run that a format range intersects
-        std::vector<int> textRunStarts;
-        textRunStarts.reserve(ld.textRuns.size());
-        for (int i = 0; i < ld.textRuns.size(); i++) {
-            textRunStarts.push_back(ld.textRuns[i].offset);
-        }
-
         // match each format range to all text runs that intersect it.
         // This can add multiple entries per original format range.
-        std::vector<HighlightSortHelper> partitionedRanges;
-        partitionedRanges.reserve(ranges.size()); // enough if no format range intersects multiple text runs
+        // The inline capacity is enough for usual highlighting, so this does not allocate.
+        QVarLengthArray<HighlightSortHelper, 64> partitionedRanges;
 
-        for (int i = 0; i < ranges.size(); i++) {
+        for (int i = 0; ld.textRunCount && i < ranges.size(); i++) {
             const ZFormatRange &formatRange = ranges[i];
             const auto formatRangeLength = formatRange.length();
             if (formatRangeLength <= 0) {
@@ -667,30 +733,37 @@ void ZTextLineRef::draw(ZPainter painter, const QPoint &pos, ZTextStyle color, Z
                 formatRangeStart = ld.offset;
             }
 
-            auto lb = std::upper_bound(textRunStarts.begin(), textRunStarts.end(), formatRangeStart);
-            lb--; // safe as formatRangeStart >= ld.offset and *textRunStarts.begin() == ld.offset
-            int textRunIndex = lb - textRunStarts.begin();
-            for (; textRunIndex < ld.textRuns.size(); textRunIndex++) {
-                partitionedRanges.push_back(HighlightSortHelper{textRunIndex, &formatRange});
-                if (ld.textRuns[textRunIndex].endIndex >= formatRangeEnd) {
+            // binary search for the first text run that the format range intersects
+            auto lb = std::upper_bound(textRuns, textRunsEnd, formatRangeStart,
+                                       [] (int offset, const ZTextLayoutPrivate::TextRun &run) {
+                return offset < run.offset;
+            });
+            lb--; // safe as formatRangeStart >= ld.offset and textRuns->offset == ld.offset
+            int textRunIndex = size2int(lb - textRuns);
+            for (; textRunIndex < ld.textRunCount; textRunIndex++) {
+                partitionedRanges.append(HighlightSortHelper{textRunIndex, &formatRange});
+                if (textRuns[textRunIndex].endIndex >= formatRangeEnd) {
                     break;
                 }
             }
         }
 
         // Sort by run index, so that the rendering code can iterate over the format ranges in O(1)
-        std::stable_sort(partitionedRanges.begin(), partitionedRanges.end(),
-                         [] (const HighlightSortHelper &lhs, const HighlightSortHelper &rhs) {
+        // Format ranges are usually passed in order, skip the sort (which allocates a temporary buffer) then.
+        auto byRun = [] (const HighlightSortHelper &lhs, const HighlightSortHelper &rhs) {
             return lhs.run < rhs.run;
-        });
+        };
+        if (!std::is_sorted(partitionedRanges.begin(), partitionedRanges.end(), byRun)) {
+            std::stable_sort(partitionedRanges.begin(), partitionedRanges.end(), byRun);
+        }
 
 
         auto nextFormatRange = partitionedRanges.begin();
-        for (int i = 0; i < ld.textRuns.size(); i++) {
-            const ZTextLayoutPrivate::TextRun &run = ld.textRuns[i];
+        for (int i = 0; i < ld.textRunCount; i++) {
+            const ZTextLayoutPrivate::TextRun &run = textRuns[i];
             if (run.type == ZTextLayoutPrivate::TextRun::COPY) {
                 painterClipped.writeWithAttributes(pos.x() + ld.pos.x() + run.x, pos.y() + ld.pos.y(),
-                                                   p->text.mid(run.offset, run.endIndex - run.offset),
+                                                   text + run.offset, run.endIndex - run.offset,
                                                    color.foregroundColor(), color.backgroundColor(), color.attributes());
                 for (; nextFormatRange != partitionedRanges.end() && nextFormatRange->run == i; nextFormatRange++) {
                     const ZFormatRange &formatRange = *nextFormatRange->ptr;
@@ -701,30 +774,30 @@ void ZTextLineRef::draw(ZPainter painter, const QPoint &pos, ZTextStyle color, Z
                         // selection ends in run
                         // make sure it's not an invalid position
                         while (formatRangeEnd < run.endIndex
-                               && p->columns[formatRangeEnd - 1] == p->columns[formatRangeEnd]) {
+                               && columns.at(formatRangeEnd - 1) == columns.at(formatRangeEnd)) {
                             ++formatRangeEnd;
                         }
                         painterClipped.writeWithAttributes(pos.x() + ld.pos.x() + run.x, pos.y() + ld.pos.y(),
-                                                    p->text.mid(run.offset, std::min(run.endIndex, formatRangeEnd) - run.offset),
+                                                    text + run.offset, std::min(run.endIndex, formatRangeEnd) - run.offset,
                                                     formatRange.format().foregroundColor(), formatRange.format().backgroundColor(),
                                                     formatRange.format().attributes());
                     } else if (formatRangeStart > run.offset && formatRangeStart < run.endIndex) {
                         // selection starts in run
                         int start = formatRangeStart;
                         // make sure it's not an invalid position
-                        while (start > 0 && p->columns[start - 1] == p->columns[start]) {
+                        while (start > 0 && columns.at(start - 1) == columns.at(start)) {
                             start--;
                         }
                         while (formatRangeEnd < run.endIndex
-                               && p->columns[formatRangeEnd - 1] == p->columns[formatRangeEnd]) {
+                               && columns.at(formatRangeEnd - 1) == columns.at(formatRangeEnd)) {
                             ++formatRangeEnd;
                         }
-                        int startX = 0;
-                        if (start > 0) {
-                            startX = p->columns[start - 1];
+                        int startX = ld.startColumn;
+                        if (start > ld.offset) {
+                            startX = columns.at(start - 1);
                         }
                         painterClipped.writeWithAttributes(pos.x() + ld.pos.x() + startX, pos.y() + ld.pos.y(),
-                                                           p->text.mid(start, std::min(run.endIndex, formatRangeEnd) - start),
+                                                           text + start, std::min(run.endIndex, formatRangeEnd) - start,
                                                            formatRange.format().foregroundColor(),
                                                            formatRange.format().backgroundColor(),
                                                            formatRange.format().attributes());
@@ -772,14 +845,12 @@ void ZTextLineRef::draw(ZPainter painter, const QPoint &pos, ZTextStyle color, Z
                 }
                 bool highlightingTrailingWhitespace = false;
                 if (textOptionFlags & ZTextOption::ShowTabsAndSpacesWithColors) {
-                    if (i + 1 == ld.textRuns.size() && (run.endIndex != ld.endIndex || ld.endIndex == p->text.size())) {
+                    if (i + 1 == ld.textRunCount && (run.endIndex != ld.endIndex || ld.endIndex == p->text.size())) {
                         highlightingTrailingWhitespace = true;
                         style = p->textOption.mapTrailingWhitespaceColor(color, formattingChars, nullptr);
                     }
                 }
-                painterClipped.writeWithAttributes(pos.x() + ld.pos.x() + run.x, pos.y() + ld.pos.y(),
-                                                   QString(run.width, ch),
-                                                   style.foregroundColor(), style.backgroundColor(), style.attributes());
+                writeRepeated(painterClipped, pos.x() + ld.pos.x() + run.x, pos.y() + ld.pos.y(), ch, run.width, style);
                 for (; nextFormatRange != partitionedRanges.end() && nextFormatRange->run == i; nextFormatRange++) {
                     const ZFormatRange &formatRange = *nextFormatRange->ptr;
                     const auto formatRangeLength = formatRange.length();
@@ -791,23 +862,21 @@ void ZTextLineRef::draw(ZPainter painter, const QPoint &pos, ZTextStyle color, Z
                         if (highlightingTrailingWhitespace) {
                             style = p->textOption.mapTrailingWhitespaceColor(color, formattingChars, &formatRange);
                         }
-                        painterClipped.writeWithAttributes(pos.x() + ld.pos.x() + run.x, pos.y() + ld.pos.y(),
-                                                           QString(std::min(run.width, formatRangeEnd - run.offset), ch),
-                                                           style.foregroundColor(), style.backgroundColor(), style.attributes());
+                        writeRepeated(painterClipped, pos.x() + ld.pos.x() + run.x, pos.y() + ld.pos.y(), ch,
+                                      std::min(run.width, formatRangeEnd - run.offset), style);
                     } else if (formatRangeStart > run.offset && formatRangeStart < run.endIndex) {
                         // selection starts in run
                         style = formatRange.formattingChar();
                         if (highlightingTrailingWhitespace) {
                             style = p->textOption.mapTrailingWhitespaceColor(color, formattingChars, &formatRange);
                         }
-                        painterClipped.writeWithAttributes(pos.x() + ld.pos.x() + p->columns[formatRange.start() - 1],
-                                                           pos.y() + ld.pos.y(),
-                                                           QString(std::min(run.endIndex, formatRangeEnd) - formatRangeStart, ch),
-                                                           style.foregroundColor(), style.backgroundColor(), style.attributes());
+                        writeRepeated(painterClipped, pos.x() + ld.pos.x() + columns.at(formatRange.start() - 1),
+                                      pos.y() + ld.pos.y(), ch,
+                                      std::min(run.endIndex, formatRangeEnd) - formatRangeStart, style);
                     }
                 }
             } else if (run.type == ZTextLayoutPrivate::TextRun::SPECIAL_BYTE_OR_CHAR) {
-                unsigned short ch = p->text[run.offset].unicode();
+                unsigned short ch = text[run.offset].unicode();
                 auto formatHex = [] (unsigned int value, int length) {
                     return QString::number(value, 16).rightJustified(length, u'0').toUpper();
                 };
@@ -821,7 +890,7 @@ void ZTextLineRef::draw(ZPainter painter, const QPoint &pos, ZTextStyle color, Z
                 } else if (!QChar::isHighSurrogate(ch)) { // invariant: a run of type SPECIAL_BYTE_OR_CHAR is only generated for valid pairs
                     contents = QStringLiteral("<U+%0>").arg(formatHex(ch, 4));
                 } else {
-                    unsigned int ch32 = QChar::surrogateToUcs4(ch, p->text[run.offset + 1].unicode());
+                    unsigned int ch32 = QChar::surrogateToUcs4(ch, text[run.offset + 1].unicode());
                     contents = QStringLiteral("<U+%0>").arg(formatHex(ch32, 6));
                 }
                 contents = contents.left(run.width);
@@ -851,8 +920,8 @@ void ZTextLineRef::draw(ZPainter painter, const QPoint &pos, ZTextStyle color, Z
         }
         bool lastLine = ld.endIndex >= p->text.size();
         if (!lastLine) {
-            if (ld.textRuns.size()) {
-                auto lastRun = ld.textRuns.last();
+            if (ld.textRunCount) {
+                const auto &lastRun = textRunsEnd[-1];
                 painterClipped.setSoftwrapMarker(pos.x() + ld.pos.x() + lastRun.x + lastRun.width - 1, pos.y() + ld.pos.y());
             }
         }
@@ -866,7 +935,7 @@ int ZTextLineRef::cursorToX(int *cursorPos, ZTextLayout::Edge edge) const {
 
         if (ld.offset == ld.endIndex) {
             *cursorPos = ld.offset;
-            return ld.pos.x();
+            return ld.pos.x() + ld.startColumn;
         }
 
         if (*cursorPos < ld.offset) {
@@ -877,15 +946,16 @@ int ZTextLineRef::cursorToX(int *cursorPos, ZTextLayout::Edge edge) const {
         }
 
         int leading, trailing;
+        ZTextLayoutPrivate::ColumnIndex::Reader columns(p->columns);
         // if *cursorPos does not point to initial codepoint in a cluster move it
         // to the beginning of the current cluster
         if (*cursorPos != ld.offset) {
-            int col = p->columns[*cursorPos];
-            if (p->columns[*cursorPos - 1] == col) {
+            int col = columns.at(*cursorPos);
+            if (columns.at(*cursorPos - 1) == col) {
                 // *cursorPos does not point to the beginning of a cluster
                 --*cursorPos;
                 while (true) {
-                    if (p->columns[*cursorPos] != col) {
+                    if (columns.at(*cursorPos) != col) {
                         ++*cursorPos;
                         break;
                     }
@@ -896,23 +966,23 @@ int ZTextLineRef::cursorToX(int *cursorPos, ZTextLayout::Edge edge) const {
                     }
                 }
                 if (*cursorPos == ld.offset) {
-                    leading = 0;
-                    trailing = p->columns[*cursorPos];
+                    leading = ld.startColumn;
+                    trailing = columns.at(*cursorPos);
                 } else {
-                    leading = p->columns[*cursorPos - 1];
-                    trailing = p->columns[*cursorPos];
+                    leading = columns.at(*cursorPos - 1);
+                    trailing = columns.at(*cursorPos);
                 }
             } else {
                 // *cursorPos points to the beginning of a cluster
-                leading = p->columns[*cursorPos - 1];
-                trailing = p->columns[*cursorPos];
+                leading = columns.at(*cursorPos - 1);
+                trailing = columns.at(*cursorPos);
                 if (p->text[*cursorPos] == u'\n') {
                     trailing = leading;
                 }
             }
         } else {
-            leading = 0;
-            trailing = p->columns[*cursorPos];
+            leading = ld.startColumn;
+            trailing = columns.at(*cursorPos);
             if (p->text[*cursorPos] == u'\n') {
                 trailing = leading;
             }
@@ -936,24 +1006,21 @@ int ZTextLineRef::cursorToX(int cursorPos, ZTextLayout::Edge edge) const {
 int ZTextLineRef::xToCursor(int x) const {
     if (_layout) {
         auto *const p = _layout->tuiwidgets_impl();
-        ZTextLayoutPrivate::LineData &ld = p->lines[_index];
+        const ZTextLayoutPrivate::LineData &ld = std::as_const(p->lines)[_index];
         x -= ld.pos.x();
-        int charLeft = 0;
-        for (int i = ld.offset; i < ld.endIndex; i++) {
-            int charRight = p->columns[i];
-            if (charLeft == charRight) {
-                continue;
-            }
-            if (charRight > x) {
-                if (charLeft + 1 == charRight || (charLeft + charRight) / 2 > x) {
-                    return i;
-                } else {
-                    return _layout->nextCursorPosition(i);
-                }
-            }
-            charLeft = charRight;
+        // columns are non decreasing in a line, so the cluster containing x can be found by binary search.
+        // Zero width clusters at the start of the line are never a match.
+        const int i = p->columns.firstIndexAfterColumn(ld.offset, ld.endIndex, std::max(x, ld.startColumn));
+        if (i == ld.endIndex) {
+            return ld.endIndex;
+        }
+        const int charLeft = i > ld.offset ? p->columns.at(i - 1) : ld.startColumn;
+        const int charRight = p->columns.at(i);
+        if (charLeft + 1 == charRight || (charLeft + charRight) / 2 > x) {
+            return i;
+        } else {
+            return _layout->nextCursorPosition(i);
         }
-        return ld.endIndex;
     } else {
         return 0;
     }
@@ -990,9 +1057,9 @@ int ZTextLineRef::width() const {
         auto *const p = _layout->tuiwidgets_impl();
         ZTextLayoutPrivate::LineData &ld = p->lines[_index];
         if (ld.offset != ld.endIndex) {
-            return p->columns[ld.endIndex - 1] - (p->text[ld.endIndex - 1] == u'\n' ? 1 : 0);
+            return p->columns.at(ld.endIndex - 1) - (p->text[ld.endIndex - 1] == u'\n' ? 1 : 0);
         } else {
-            return 0;
+            return ld.startColumn;
         }
     } else {
         return 0;
@@ -1037,7 +1104,235 @@ void ZTextLineRef::setLineWidth(int width) {
     }
 }
 
+void ZTextLayoutPrivate::ColumnIndex::clear() {
+    segments.clear();
+    flat = false;
+    flatStart = 0;
+    flatColumns.clear();
+    lineStart = -1;
+}
+
+void ZTextLayoutPrivate::ColumnIndex::startLine(int offset) {
+    truncate(offset);
+    lineStart = offset;
+}
+
+void ZTextLayoutPrivate::ColumnIndex::addCluster(int offset, int codeUnits, int column) {
+    if (flat) {
+        if (flatColumns.isEmpty()) {
+            flatStart = offset;
+        }
+        // code units skipped since the last cluster have no column
+        flatColumns.resize(offset - flatStart);
+        for (int i = 0; i < codeUnits; i++) {
+            flatColumns.append(column);
+        }
+        return;
+    }
+
+    if (segments.size() && offset != lineStart) {
+        Segment &last = segments.last();
+        const int length = last.end - last.start;
+        if (last.end == offset && codeUnits == last.codeUnitsPerCluster && length % codeUnits == 0) {
+            const int lastColumn = last.columnAt(last.end - 1);
+            if (length == codeUnits && column >= lastColumn) {
+                // The second cluster of a segment decides the width of all its clusters.
+                last.clusterWidth = column - lastColumn;
+                last.base = lastColumn - last.clusterWidth;
+                last.end += codeUnits;
+                return;
+            }
+            if (column == lastColumn + last.clusterWidth) {
+                last.end += codeUnits;
+                return;
+            }
+        }
+    }
+    segments.append(Segment{offset, offset + codeUnits, column, codeUnits, 0});
+
+    // Some segments are always kept, so that text starting with short segments does not switch before
+    // its later long segments are seen.
+    constexpr int minSegmentsBeforeFlat = 64;
+    if (segments.size() >= minSegmentsBeforeFlat) {
+        const qint64 codeUnitsCovered = segments.last().end - segments.first().start;
+        if (segments.size() * static_cast<qint64>(sizeof(Segment)) > codeUnitsCovered * static_cast<qint64>(sizeof(int))) {
+            switchToFlat();
+        }
+    }
+}
+
+void ZTextLayoutPrivate::ColumnIndex::switchToFlat() {
+    flat = true;
+    flatStart = segments.first().start;
+    flatColumns.resize(segments.last().end - flatStart);
+    int *const columns = flatColumns.data();
+    for (const Segment &segment: std::as_const(segments)) {
+        for (int i = segment.start; i < segment.end; i++) {
+            columns[i - flatStart] = segment.columnAt(i);
+        }
+    }
+    // release the memory of the segments
+    segments = QVector<Segment>();
+}
+
+void ZTextLayoutPrivate::ColumnIndex::truncate(int offset) {
+    if (flat) {
+        if (offset - flatStart < flatColumns.size()) {
+            flatColumns.resize(std::max(0, offset - flatStart));
+        }
+        return;
+    }
+    while (segments.size() && segments.last().start >= offset) {
+        segments.removeLast();
+    }
+    if (segments.size() && segments.last().end > offset) {
+        segments.last().end = offset;
+    }
+}
+
+int ZTextLayoutPrivate::ColumnIndex::segmentIndexFor(int index) const {
+    // last segment with start <= index
+    auto it = std::upper_bound(segments.begin(), segments.end(), index, [] (int index, const Segment &segment) {
+        return index < segment.start;
+    });
+    if (it == segments.begin()) {
+        return -1;
+    }
+    return size2int(it - segments.begin()) - 1;
+}
+
+int ZTextLayoutPrivate::ColumnIndex::flatAt(int index) const {
+    if (index < flatStart || index - flatStart >= flatColumns.size()) {
+        return 0;
+    }
+    return flatColumns[index - flatStart];
+}
+
+int ZTextLayoutPrivate::ColumnIndex::at(int index) const {
+    if (flat) {
+        return flatAt(index);
+    }
+    const int segmentIndex = segmentIndexFor(index);
+    if (segmentIndex < 0) {
+        return 0;
+    }
+    const Segment &segment = segments[segmentIndex];
+    if (index >= segment.end) {
+        return 0;
+    }
+    return segment.columnAt(index);
+}
+
+int ZTextLayoutPrivate::ColumnIndex::Reader::at(int index) {
+    if (_index.flat) {
+        return _index.flatAt(index);
+    }
+    const QVector<Segment> &segments = _index.segments;
+    if (_segment < 0) {
+        _segment = _index.segmentIndexFor(index);
+        if (_segment < 0) {
+            return 0;
+        }
+    } else {
+        while (_segment + 1 < segments.size() && segments[_segment + 1].start <= index) {
+            ++_segment;
+        }
+        while (_segment > 0 && segments[_segment].start > index) {
+            --_segment;
+        }
+        if (segments[_segment].start > index) {
+            return 0;
+        }
+    }
+    const Segment &segment = segments[_segment];
+    if (index >= segment.end) {
+        return 0;
+    }
+    return segment.columnAt(index);
+}
+
+int ZTextLayoutPrivate::ColumnIndex::firstIndexAfterColumn(int begin, int end, int column) const {
+    if (begin >= end) {
+        return end;
+    }
+
+    if (flat) {
+        const int first = std::max(begin, flatStart);
+        const int last = std::min(end, flatStart + size2int(flatColumns.size()));
+        if (first >= last) {
+            return end;
+        }
+        const int *const columns = flatColumns.constData();
+        const int *const it = std::partition_point(columns + (first - flatStart), columns + (last - flatStart),
+                                                   [&] (int value) {
+            return value <= column;
+        });
+        if (it == columns + (last - flatStart)) {
+            return end;
+        }
+        return flatStart + static_cast<int>(it - columns);
+    }
+
+    const int firstSegment = std::max(0, segmentIndexFor(begin));
+    const int lastSegment = segmentIndexFor(end - 1);
+    if (lastSegment < firstSegment) {
+        return end;
+    }
+
+    // first segment whose last column in [begin, end) is > column
+    auto it = std::partition_point(segments.begin() + firstSegment, segments.begin() + lastSegment + 1,
+                                   [&] (const Segment &segment) {
+        return segment.columnAt(std::min(segment.end, end) - 1) <= column;
+    });
+    if (it == segments.begin() + lastSegment + 1) {
+        return end;
+    }
+    const Segment &segment = *it;
+
+    int cluster = 0;
+    if (segment.clusterWidth && column >= segment.base) {
+        cluster = (column - segment.base) / segment.clusterWidth;
+    }
+    return std::max(begin, segment.start + cluster * segment.codeUnitsPerCluster);
+}
+
 ZTextLayoutPrivate::~ZTextLayoutPrivate() {
 }
 
+const ZTextLayoutPrivate::LineBreaks &ZTextLayoutPrivate::lineBreaks() {
+    if (textLineBreaks) {
+        return *textLineBreaks;
+    }
+
+    // Looking up the text hashes and on a hit compares it, both are a lot cheaper than finding the line breaks.
+    // This happens at most once per layout and only if wrapping needs break opportunities.
+    auto it = lineBreaksCache.entries.find(text);
+    if (it != lineBreaksCache.entries.end()) {
+        textLineBreaks = *it;
+        return *textLineBreaks;
+    }
+
+    auto entry = std::make_shared<LineBreaks>();
+    QTextBoundaryFinder finder(QTextBoundaryFinder::Line, text);
+    for (int pos = finder.toNextBoundary(); pos != -1; pos = finder.toNextBoundary()) {
+        entry->positions.push_back(pos);
+    }
+
+    // The key keeps the text alive, so count its code units too. Each entry counts one more, so that many
+    // empty texts without breaks are bounded too.
+    const qint64 cost = qint64(text.size()) + qint64(entry->positions.size()) + 1;
+    if (lineBreaksCache.cost + cost > lineBreaksCacheMaxCost) {
+        lineBreaksCache.entries.clear();
+        lineBreaksCache.cost = 0;
+    }
+    if (cost <= lineBreaksCacheMaxCost) {
+        // A deep copy, text might be created by QString::fromRawData and its buffer reused later.
+        lineBreaksCache.entries.insert(QString(text.constData(), text.size()), entry);
+        lineBreaksCache.cost += cost;
+    }
+
+    textLineBreaks = std::move(entry);
+    return *textLineBreaks;
+}
+
 TUIWIDGETS_NS_END
@@ -51,6 +51,7 @@ class TUIWIDGETS_EXPORT ZTextLayout {
 
     void beginLayout();
     void doLayout(int width);
+    void doLayoutWindow(int startCodeUnit, int startColumn, int endCodeUnit, int endColumn);
     void endLayout();
     ZTextLineRef createLine();
 
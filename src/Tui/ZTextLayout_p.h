@@ -5,6 +5,12 @@
 
 #include <Tui/ZTextLayout.h>
 
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <QHash>
+
 #include <Tui/ZTextMetrics.h>
 #include <Tui/ZTextOption.h>
 
@@ -28,24 +34,122 @@ class ZTextLayoutPrivate {
         int offset = -1;
         int endIndex = -1;
         QPoint pos;
-        QVector<TextRun> textRuns;
+        int startColumn = 0;
+        int firstTextRun = 0; // index into textRuns
+        int textRunCount = 0;
         int maxWidth = -1;
     };
 
+    // For each code unit the column (relative to pos in LineData) after the cluster it belongs to.
+    // Stored run length encoded as segments of equally sized clusters, which for most text is one segment per
+    // line. Text that changes cluster sizes often (e.g. alternating single and double width characters) would
+    // need more memory for the segments than for one column per code unit, such text is stored as a flat array
+    // instead.
+    // Code units without a column (not yet laid out or wrapped away) have column 0.
+    class ColumnIndex {
+    public:
+        // Code units in [start, end) form clusters of codeUnitsPerCluster code units each taking clusterWidth
+        // columns, starting after column base.
+        struct Segment {
+            int start;
+            int end;
+            int base;
+            int codeUnitsPerCluster;
+            int clusterWidth;
+
+            int columnAt(int index) const {
+                return base + clusterWidth * ((index - start) / codeUnitsPerCluster + 1);
+            }
+        };
+
+        // For loops over adjacent code units: Remembers the last used segment and steps to the neighbouring
+        // segments instead of searching all segments for each code unit.
+        class Reader {
+        public:
+            explicit Reader(const ColumnIndex &index) : _index(index) {}
+
+            int at(int index);
+
+        private:
+            const ColumnIndex &_index;
+            int _segment = -1;
+        };
+
+    public:
+        void clear();
+        // Marks offset as the start of a layout line. Clusters are never merged across lines.
+        void startLine(int offset);
+        // Sets the column for the codeUnits code units starting at offset, which must be >= all previously set
+        // code units.
+        void addCluster(int offset, int codeUnits, int column);
+        // Discards the columns of all code units >= offset.
+        void truncate(int offset);
+
+        int at(int index) const;
+        // Returns the first index in [begin, end) with at(index) > column or end if none.
+        // Columns must be non decreasing in [begin, end), as they are in a layout line.
+        int firstIndexAfterColumn(int begin, int end, int column) const;
+
+    private:
+        int segmentIndexFor(int index) const;
+        int flatAt(int index) const;
+        void switchToFlat();
+
+    private:
+        QVector<Segment> segments;
+        // Used instead of segments when flat is set, columns of the code units starting at flatStart.
+        bool flat = false;
+        int flatStart = 0;
+        QVector<int> flatColumns;
+        int lineStart = -1;
+    };
+
+    // Line break opportunities of a text as found by QTextBoundaryFinder::Line. They do not depend on the width,
+    // so they are computed once per text content and reused for all layouts of the same text.
+    class LineBreaks {
+    public:
+        std::vector<int> positions; // ascending, excluding 0
+    };
+
+    // Keyed by a copy of the text content.
+    class LineBreaksCache {
+    public:
+        QHash<QString, std::shared_ptr<const LineBreaks>> entries;
+        qint64 cost = 0;
+    };
+
 public:
     ZTextLayoutPrivate(ZTextMetrics metrics) : metrics(metrics) {}
     ZTextLayoutPrivate(ZTextMetrics metrics, const QString &text) : metrics(metrics), text(text) {}
     virtual ~ZTextLayoutPrivate();
 
+public:
+    void appendTextRun(LineData &ld, const TextRun &run) {
+        textRuns.append(run);
+        ld.textRunCount++;
+    }
+
+    const LineBreaks &lineBreaks();
+
 public:
     ZTextMetrics metrics;
 
     ZTextOption textOption;
 
     QString text;
-    QVector<unsigned short> columns; // for each code unit the column (relative to pos in LineData) after the cluster
+    std::shared_ptr<const LineBreaks> textLineBreaks; // set on first use by lineBreaks()
+    ColumnIndex columns;
+    QVector<TextRun> textRuns; // of all lines, in order
     QVector<LineData> lines;
     int nextIndex = -1;
+
+    // layout window, only set in doLayoutWindow
+    bool layoutWindow = false;
+    int windowStartColumn = 0;
+    int windowEndCodeUnit = std::numeric_limits<int>::max();
+    int windowEndColumn = std::numeric_limits<int>::max();
+
+    static thread_local LineBreaksCache lineBreaksCache;
 };
 
 TUIWIDGETS_NS_END
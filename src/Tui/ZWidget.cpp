@@ -290,7 +290,7 @@ void ZWidgetPrivate::updateEffectivelyEnabledRecursively() {
         childP->updateEffectivelyEnabledRecursively();
     }
     QEvent enabledChangedEvent(QEvent::EnabledChange);
-    QCoreApplication::instance()->sendEvent(pub(), &enabledChangedEvent);
+    QCoreApplication::sendEvent(pub(), &enabledChangedEvent);
 }
 
 bool ZWidget::isVisible() const {
@@ -356,7 +356,7 @@ void ZWidgetPrivate::updateEffectivelyVisibleRecursively() {
     effectivelyVisible = newEffectiveValue;
     if (!effectivelyVisible) {
         QEvent hideEvent(ZEventType::hide());
-        QCoreApplication::instance()->sendEvent(pub(), &hideEvent);
+        QCoreApplication::sendEvent(pub(), &hideEvent);
     }
     for (ZWidget *child : toQPointerListWithCast<ZWidget>(pub()->children())) {
         if (!child) {
@@ -367,7 +367,7 @@ void ZWidgetPrivate::updateEffectivelyVisibleRecursively() {
     }
     if (effectivelyVisible) {
         QEvent showEvent(ZEventType::show());
-        QCoreApplication::instance()->sendEvent(pub(), &showEvent);
+        QCoreApplication::sendEvent(pub(), &showEvent);
     }
 }
 
@@ -1324,7 +1324,7 @@ void ZWidgetPrivate::updateRequestEvent(ZPaintEvent *event)
     auto *painter = event->painter();
     {
         ZPaintEvent nestedEvent(painter);
-        QCoreApplication::instance()->sendEvent(pub(), &nestedEvent);
+        QCoreApplication::sendEvent(pub(), &nestedEvent);
     }
     for (ZWidget *child : toQPointerListWithCast<ZWidget>(pub()->children())) {
         if (!child) {
@@ -1337,7 +1337,7 @@ void ZWidgetPrivate::updateRequestEvent(ZPaintEvent *event)
         ZPainter transformedPainter = painter->translateAndClip(childRect);
         transformedPainter.setWidget(child);
         ZPaintEvent nestedEvent(ZPaintEvent::update, &transformedPainter);
-        QCoreApplication::instance()->sendEvent(child, &nestedEvent);
+        QCoreApplication::sendEvent(child, &nestedEvent);
     }
 }
 
@@ -3,13 +3,22 @@
 
 # entities.json from https://www.w3.org/TR/html5/entities.json
 
+# Generates a minimal perfect hash table (hash and displace) for the named character references.
+#
+# Lookup of a name:
+#   bucket = fnv1a32(name, entitiesBucketBasis) % entitiesBuckets
+#   slot = (fnv1a32(name, entitiesSlotBasis) + entitiesDisplacements[bucket]) % entitiesSize
+# and then comparing the name with the one entry in that slot.
+
 import json
 from collections import namedtuple
 
-Entry = namedtuple('Entry', ['len', 'has_next', 'strpool_offset', 'data'])
+Entry = namedtuple('Entry', ['name', 'data'])
+
+FNV_OFFSET_BASIS = 2166136261
 
-def fnv1a32(data):
-    h = 2166136261
+def fnv1a32(data, basis):
+    h = basis
 
     for b in data:
         h = h ^ b
@@ -18,43 +27,79 @@ def fnv1a32(data):
     return h
 
 
-j = json.load(open('entities.json', 'r'))
+def build(names, bucket_count, slot_basis):
+    buckets = [[] for i in range(bucket_count)]
+    for name in names:
+        buckets[fnv1a32(name.encode(), FNV_OFFSET_BASIS) % bucket_count].append(name)
+
+    size = len(names)
+    slots = [None] * size
+    displacements = [0] * bucket_count
+
+    for bucket in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+        items = buckets[bucket]
+        if not items:
+            break
+        hashes = [fnv1a32(name.encode(), slot_basis) for name in items]
+        for displacement in range(size):
+            positions = [(h + displacement) % size for h in hashes]
+            if len(set(positions)) == len(positions) and all(slots[pos] is None for pos in positions):
+                for pos, name in zip(positions, items):
+                    slots[pos] = name
+                displacements[bucket] = displacement
+                break
+        else:
+            return None
 
-table_size = len(j)
+    return slots, displacements
 
-hashtbl = [[] for i in range(table_size)]
 
+j = json.load(open('entities.json', 'r'))
+
+entities = {}
 for name, v in j.items():
+    # The tokenizer only supports references terminated by ';', the legacy forms without are not needed.
+    if not name.endswith(';'):
+        continue
     name = name[1:-1]
-    hashtbl[fnv1a32(name.encode()) % table_size].append((name, v))
+    data = v['codepoints']
+    if len(data) not in (1, 2):
+        raise RuntimeError('too many codepoints for entity ' + name)
+    entities[name] = data
+
+names = sorted(entities.keys())
+table_size = len(names)
+bucket_count = (table_size + 1) // 2
+
+if table_size > 0x10000:
+    raise RuntimeError('too many entities')
+
+for slot_basis in range(FNV_OFFSET_BASIS + 1, FNV_OFFSET_BASIS + 1000):
+    result = build(names, bucket_count, slot_basis)
+    if result is not None:
+        break
+else:
+    raise RuntimeError('no perfect hash found')
+
+slots, displacements = result
 
 stringpool = ""
 entries = []
+strpool_offsets = []
 
-for i in range(table_size):
-    items = hashtbl[i]
-    if not items:
-        hashtbl[i] = None
-    else:
-        for j, (name, item) in enumerate(items):
-            strtbl_offset = len(stringpool)
-            stringpool += name
-            data = item['codepoints']
-            if len(data) not in (1, 2):
-                raise RuntimeError('too many codepoints for entity ' + name)
-            if j == 0:
-                hashtbl[i] = len(entries)
-            entries.append(Entry(len=len(name),
-                                 has_next= (j != len(items) - 1),
-                                 strpool_offset=strtbl_offset,
-                                 data=data))
-
-if len(entries) > 0x10000:
-    raise RuntimeError('too many entities')
+for name in slots:
+    strpool_offsets.append(len(stringpool))
+    stringpool += name
+    entries.append(Entry(name=name, data=entities[name]))
+
+if len(stringpool) > 0x10000:
+    raise RuntimeError('string pool too large')
 
 out = open('entities.inc', 'w')
 
-print('static const char entitiesStringpool[] =', file=out)
+print('// Generated by entities.inc.gen.py, do not edit.', file=out)
+print('', file=out)
+print('static constexpr char entitiesStringpool[] =', file=out)
 rest = stringpool
 while rest:
     print('    "' + rest[:100] + '"', file=out)
@@ -62,28 +107,30 @@ while rest:
 print('  ;', file=out)
 
 print('', file=out)
-print('static const EntitiesEntry entitiesEntries[] = {', file=out)
-for entry in entries:
+print('static constexpr EntitiesEntry entitiesEntries[] = {', file=out)
+for entry, strpool_offset in zip(entries, strpool_offsets):
     data1 = entry.data[0]
     if len(entry.data) == 2:
         data2 = entry.data[1]
     else:
         data2 = 0
-    name = stringpool[entry.strpool_offset:entry.strpool_offset+entry.len]
-    print('    { %2d, %d, %5d, { %7s, %7s } }, // %s' % (entry.len, entry.has_next, entry.strpool_offset, hex(data1), hex(data2), name), file=out)
+    print('    { %2d, %5d, { %7s, %7s } }, // %s' % (len(entry.name), strpool_offset, hex(data1), hex(data2), entry.name), file=out)
 
 print('};', file=out)
 print('', file=out)
-print('static const uint16_t entitiesHashtbl[] = {', file=out)
+print('static constexpr uint16_t entitiesDisplacements[] = {', file=out)
 
-for offset in hashtbl:
-    if offset is not None:
-        print('    %d,' % (offset,), file=out)
-    else:
-        print('    0, // unused', file=out)
+rest = displacements
+while rest:
+    print('    ' + ' '.join('%d,' % d for d in rest[:16]), file=out)
+    rest = rest[16:]
 
 print('};', file=out)
 print('', file=out)
-print('static const uint16_t entitiesSize = %d;' % (table_size,), file=out)
+print('static constexpr uint32_t entitiesBucketBasis = %d;' % (FNV_OFFSET_BASIS,), file=out)
+print('static constexpr uint32_t entitiesSlotBasis = %d;' % (slot_basis,), file=out)
+print('static constexpr uint16_t entitiesBuckets = %d;' % (bucket_count,), file=out)
+print('static constexpr uint16_t entitiesSize = %d;' % (table_size,), file=out)
+print('static constexpr int entitiesMaxNameLength = %d;' % (max(len(name) for name in names),), file=out)
 
 out.close()
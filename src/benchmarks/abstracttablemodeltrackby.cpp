@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/Misc/AbstractTableModelTrackBy.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <random>
+#include <string>
+
+#include <QCoreApplication>
+
+namespace {
+    using Model = Tui::Misc::AbstractTableModelTrackBy<int>;
+
+    Model::Row makeRow(int key, int generation, int columns) {
+        Model::Row row;
+        row.key = key;
+        for (int column = 0; column < columns; column++) {
+            row.columns.append({{Qt::DisplayRole, QStringLiteral("r%1 c%2 g%3").arg(key).arg(column).arg(generation)},
+                                {Qt::ToolTipRole, column}});
+        }
+        return row;
+    }
+}
+
+TEST_CASE("abstracttablemodeltrackby setData", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    const int rowCount = 100000;
+    const int columnCount = 10;
+
+    QVector<Model::Row> base;
+    base.reserve(rowCount);
+    for (int i = 0; i < rowCount; i++) {
+        base.append(makeRow(i, 0, columnCount));
+    }
+
+    const int churnPercent = GENERATE(0, 1, 10, 50);
+
+    // The churned snapshot differs in churnPercent of the rows. Most of them are changed in place, the rest is
+    // split between removed, newly inserted and moved rows.
+    // unseeded is ok
+    std::mt19937 gen;
+    QVector<Model::Row> churned;
+    churned.reserve(rowCount);
+    QVector<Model::Row> moved;
+    int nextKey = rowCount;
+    for (int i = 0; i < rowCount; i++) {
+        if (static_cast<int>(gen() % 100) >= churnPercent) {
+            churned.append(base[i]);
+            continue;
+        }
+        switch (gen() % 10) {
+            case 0:
+                // removed
+                break;
+            case 1:
+                churned.append(makeRow(nextKey++, 1, columnCount));
+                churned.append(base[i]);
+                break;
+            case 2:
+                moved.append(base[i]);
+                break;
+            default:
+                churned.append(makeRow(i, 1, columnCount));
+                break;
+        }
+    }
+    for (const auto &row: moved) {
+        churned.insert(gen() % (churned.size() + 1), row);
+    }
+
+    Model model(columnCount);
+    model.setData(base);
+    bool atBase = true;
+
+    // Each iteration reconciles a full 100k row snapshot.
+    BENCHMARK("setData 100k rows x 10 columns with " + std::to_string(churnPercent) + "% churn") {
+        model.setData(atBase ? churned : base);
+        atBase = !atBase;
+        return model.rowCount();
+    };
+
+}
+
+TEST_CASE("abstracttablemodeltrackby setData unchanged", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    const int rowCount = 100000;
+    const int columnCount = 10;
+
+    // Snapshots with equal content but without shared data need to compare all cells. Alternating between two
+    // copies avoids that the model keeps data shared with the next snapshot.
+    QVector<Model::Row> copies[2];
+    for (auto &copy: copies) {
+        copy.reserve(rowCount);
+        for (int i = 0; i < rowCount; i++) {
+            copy.append(makeRow(i, 0, columnCount));
+        }
+    }
+    Model unchanged(columnCount);
+    unchanged.setData(copies[0]);
+    int nextCopy = 1;
+    BENCHMARK("setData 100k rows x 10 columns unchanged, not shared") {
+        unchanged.setData(copies[nextCopy]);
+        nextCopy = 1 - nextCopy;
+        return unchanged.rowCount();
+    };
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "alloccounter.h"
+
+#include <atomic>
+#include <cstddef>
+
+// Counting is done by interposing the malloc family, which also covers allocations from Qt. This relies on
+// glibc exporting its implementation as __libc_*.
+
+#ifdef __GLIBC__
+
+static std::atomic<int64_t> counter{0};
+
+extern "C" {
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t nmemb, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void __libc_free(void *ptr);
+
+    void *malloc(size_t size) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t nmemb, size_t size) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(nmemb, size);
+    }
+
+    void *realloc(void *ptr, size_t size) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void *ptr) {
+        __libc_free(ptr);
+    }
+}
+
+int64_t allocationCount() {
+    return counter.load(std::memory_order_relaxed);
+}
+
+#else
+
+int64_t allocationCount() {
+    return -1;
+}
+
+#endif
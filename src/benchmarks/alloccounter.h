@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_BENCHMARKS_ALLOCCOUNTER_INCLUDED
+#define TUIWIDGETS_BENCHMARKS_ALLOCCOUNTER_INCLUDED
+
+#include <cstdint>
+
+// Number of heap allocations (malloc, calloc, realloc) since program start. This includes allocations from
+// libraries (e.g. QString data). Returns -1 if allocations can not be counted on this platform.
+int64_t allocationCount();
+
+#endif // TUIWIDGETS_BENCHMARKS_ALLOCCOUNTER_INCLUDED
@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#define CATCH_CONFIG_RUNNER
+#include "../tests/catchwrapper.h"
+
+int main (int argc, char * argv[]) {
+    return Catch::Session().run( argc, argv );
+}
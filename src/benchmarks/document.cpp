@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZDocument.h>
+#include <Tui/ZDocumentCursor.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <random>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QThreadPool>
+
+#include <Tui/ZTerminal.h>
+#include <Tui/ZTextLayout.h>
+#include <Tui/ZTextMetrics.h>
+
+TEST_CASE("document sortLines", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{80, 24}};
+    auto textMetrics = terminal.textMetrics();
+
+    const int lineCount = 1000000;
+    // unseeded is ok
+    std::mt19937 gen;
+    QStringList lines;
+    lines.reserve(lineCount);
+    for (int i = 0; i < lineCount; i++) {
+        lines.append(QString::number(gen() % 100000) + QStringLiteral(" Line ") + QString::number(gen()));
+    }
+    const QString text = lines.join(QStringLiteral("\n"));
+
+    Tui::ZDocument doc;
+    Tui::ZDocumentCursor cursor{&doc, [&textMetrics, &doc](int line, bool /* wrappingAllowed */) {
+            Tui::ZTextLayout lay(textMetrics, doc.line(line));
+            lay.doLayout(65000);
+            return lay;
+        }
+    };
+
+    const int savedMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+
+    BENCHMARK("baseline setText 1M lines") {
+        doc.setText(text);
+        return doc.lineCount();
+    };
+
+    const auto mode = GENERATE(Tui::ZDocument::SortByCodeUnits, Tui::ZDocument::SortCaseInsensitive,
+                               Tui::ZDocument::SortNumeric, Tui::ZDocument::SortLocaleAware);
+
+    BENCHMARK("setText + sortLines 1M lines mode " + std::to_string(mode)) {
+        doc.setText(text);
+        doc.sortLines(0, doc.lineCount(), &cursor, mode);
+        return doc.lineCount();
+    };
+
+    QThreadPool::globalInstance()->setMaxThreadCount(1);
+    BENCHMARK("setText + sortLines 1M lines mode " + std::to_string(mode) + " single thread") {
+        doc.setText(text);
+        doc.sortLines(0, doc.lineCount(), &cursor, mode);
+        return doc.lineCount();
+    };
+    QThreadPool::globalInstance()->setMaxThreadCount(savedMaxThreadCount);
+}
+
+TEST_CASE("document follow", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString filename = dir.filePath(QStringLiteral("log.txt"));
+    {
+        QFile file(filename);
+        REQUIRE(file.open(QIODevice::WriteOnly));
+    }
+
+    Tui::ZDocument doc;
+    doc.setFollowMaxLines(100000);
+    REQUIRE(doc.followFile(filename));
+
+    QFile writer(filename);
+    REQUIRE(writer.open(QIODevice::WriteOnly | QIODevice::Append));
+
+    const int linesPerBatch = 100000;
+    int batch = 0;
+
+    // Throughput of ingesting appended lines, reported as time per 100000 lines. Includes the latency of the
+    // file change notification.
+    BENCHMARK("follow 100k appended lines") {
+        ++batch;
+        QByteArray data;
+        for (int i = 0; i < linesPerBatch; i++) {
+            data += "2024-01-01 12:00:00 [info] request handled in 12ms, batch ";
+            data += QByteArray::number(batch);
+            data += " line ";
+            data += QByteArray::number(i);
+            data += '\n';
+        }
+        writer.write(data);
+        writer.flush();
+
+        const QString lastLine = QStringLiteral("2024-01-01 12:00:00 [info] request handled in 12ms, batch %1 line %2")
+                .arg(batch).arg(linesPerBatch - 1);
+        QElapsedTimer timeout;
+        timeout.start();
+        while (doc.line(doc.lineCount() - 1) != lastLine && !timeout.hasExpired(60000)) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+        }
+        return doc.lineCount();
+    };
+}
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "driver.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+
+#include <Tui/ZTerminal.h>
+#include <Tui/ZTerminalReplay.h>
+
+#include "scenarios.h"
+
+namespace {
+    // Summary of durations in nanoseconds, reported in microseconds using the nearest rank for percentiles.
+    QJsonObject summarize(QVector<qint64> values) {
+        QJsonObject result;
+        if (values.isEmpty()) {
+            return result;
+        }
+        std::sort(values.begin(), values.end());
+        qint64 sum = 0;
+        for (qint64 value : values) {
+            sum += value;
+        }
+        auto percentile = [&values](int p) {
+            const int rank = std::max(1, static_cast<int>((p * values.size() + 99) / 100));
+            return values[rank - 1] / 1000.;
+        };
+        result.insert(QStringLiteral("min"), values.first() / 1000.);
+        result.insert(QStringLiteral("mean"), double(sum) / values.size() / 1000.);
+        result.insert(QStringLiteral("median"), percentile(50));
+        result.insert(QStringLiteral("p90"), percentile(90));
+        result.insert(QStringLiteral("p99"), percentile(99));
+        result.insert(QStringLiteral("max"), values.last() / 1000.);
+        return result;
+    }
+
+    QJsonArray rawValues(const QVector<qint64> &values) {
+        QJsonArray result;
+        for (qint64 value : values) {
+            result.append(value / 1000.);
+        }
+        return result;
+    }
+
+    double perSecond(int count, qint64 durationNs) {
+        return durationNs > 0 ? count * 1e9 / durationNs : 0;
+    }
+}
+
+QJsonObject runScript(const QString &name, const InputScript &script, const DriverOptions &options) {
+    QJsonObject result;
+    result.insert(QStringLiteral("name"), name);
+    result.insert(QStringLiteral("setup"), script.setup);
+
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(script.size.width(), script.size.height())};
+    QString error;
+    std::unique_ptr<Tui::ZRoot> root = createSetup(script.setup, &terminal, &error);
+    if (!root) {
+        result.insert(QStringLiteral("error"), error);
+        return result;
+    }
+    terminal.setFrameStatisticsEnabled(options.frameStatistics);
+
+    int frames = 0;
+    QObject::connect(&terminal, &Tui::ZTerminal::afterRendering, &terminal, [&frames] {
+        ++frames;
+    });
+
+    // Processes events until a frame was rendered. Returns false on timeout.
+    auto waitForFrame = [&frames, &options] {
+        const int framesBefore = frames;
+        QElapsedTimer timer;
+        timer.start();
+        while (frames == framesBefore) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents);
+            if (frames == framesBefore && timer.elapsed() > options.timeoutMs) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // the initial frame is not part of the measurement
+    waitForFrame();
+    frames = 0;
+
+    QVector<qint64> latencies;
+    Tui::ZTerminal::FrameStatistics statistics;
+    int batchesWithoutFrame = 0;
+    qint64 waitedWithoutFrameNs = 0;
+
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer timer;
+    const int batch = std::max(1, options.batch);
+    for (int i = 0; i < script.events.size(); i += batch) {
+        timer.start();
+        const int end = std::min<int>(i + batch, script.events.size());
+        for (int j = i; j < end; j++) {
+            InputScript::send(&terminal, script.events[j]);
+        }
+        if (waitForFrame()) {
+            latencies.append(timer.nsecsElapsed());
+            if (options.frameStatistics) {
+                const Tui::ZTerminal::FrameStatistics last = terminal.lastFrameStatistics();
+                statistics.cellsChanged += last.cellsChanged;
+                statistics.bytesWritten += last.bytesWritten;
+                statistics.layoutNs += last.layoutNs;
+                statistics.paintNs += last.paintNs;
+                statistics.diffNs += last.diffNs;
+                statistics.flushNs += last.flushNs;
+            }
+        } else {
+            ++batchesWithoutFrame;
+            waitedWithoutFrameNs += timer.nsecsElapsed();
+        }
+    }
+    // time spent waiting for frames that never came would distort the throughput
+    const qint64 durationNs = total.nsecsElapsed() - waitedWithoutFrameNs;
+
+    result.insert(QStringLiteral("size"), QStringLiteral("%1x%2").arg(script.size.width()).arg(script.size.height()));
+    result.insert(QStringLiteral("batch"), batch);
+    result.insert(QStringLiteral("events"), script.events.size());
+    result.insert(QStringLiteral("frames"), frames);
+    result.insert(QStringLiteral("batchesWithoutFrame"), batchesWithoutFrame);
+    result.insert(QStringLiteral("durationUs"), durationNs / 1000.);
+    result.insert(QStringLiteral("eventsPerSecond"), perSecond(script.events.size(), durationNs));
+    result.insert(QStringLiteral("framesPerSecond"), perSecond(frames, durationNs));
+    result.insert(QStringLiteral("latencyUs"), summarize(latencies));
+    if (options.frameStatistics && !latencies.isEmpty()) {
+        const int count = latencies.size();
+        QJsonObject frameStatistics;
+        frameStatistics.insert(QStringLiteral("cellsChanged"), double(statistics.cellsChanged) / count);
+        frameStatistics.insert(QStringLiteral("bytesWritten"), double(statistics.bytesWritten) / count);
+        frameStatistics.insert(QStringLiteral("layoutUs"), statistics.layoutNs / 1000. / count);
+        frameStatistics.insert(QStringLiteral("paintUs"), statistics.paintNs / 1000. / count);
+        frameStatistics.insert(QStringLiteral("diffUs"), statistics.diffNs / 1000. / count);
+        frameStatistics.insert(QStringLiteral("flushUs"), statistics.flushNs / 1000. / count);
+        result.insert(QStringLiteral("frameStatisticsMean"), frameStatistics);
+    }
+    if (options.raw) {
+        result.insert(QStringLiteral("latenciesUs"), rawValues(latencies));
+    }
+    return result;
+}
+
+QJsonObject runRecording(const QString &fileName, const DriverOptions &options) {
+    QJsonObject result;
+    result.insert(QStringLiteral("name"), fileName);
+    result.insert(QStringLiteral("setup"), QStringLiteral("recording"));
+
+    Tui::ZTerminalReplay replay;
+    if (!replay.open(fileName)) {
+        result.insert(QStringLiteral("error"), replay.errorString());
+        return result;
+    }
+
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(1, 1)};
+
+    QVector<qint64> frameTimes;
+    QElapsedTimer timer;
+    qint64 durationNs = 0;
+    while (true) {
+        timer.start();
+        if (!replay.readFrame(&terminal)) {
+            break;
+        }
+        terminal.updateOutput();
+        const qint64 elapsed = timer.nsecsElapsed();
+        frameTimes.append(elapsed);
+        durationNs += elapsed;
+    }
+    if (!replay.errorString().isEmpty()) {
+        result.insert(QStringLiteral("error"), replay.errorString());
+    }
+
+    result.insert(QStringLiteral("frames"), frameTimes.size());
+    result.insert(QStringLiteral("durationUs"), durationNs / 1000.);
+    result.insert(QStringLiteral("framesPerSecond"), perSecond(frameTimes.size(), durationNs));
+    result.insert(QStringLiteral("frameTimeUs"), summarize(frameTimes));
+    if (options.raw) {
+        result.insert(QStringLiteral("frameTimesUs"), rawValues(frameTimes));
+    }
+    return result;
+}
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_BENCH_DRIVER_INCLUDED
+#define TUIWIDGETS_BENCH_DRIVER_INCLUDED
+
+#include <QJsonObject>
+#include <QString>
+
+#include "inputscript.h"
+
+struct DriverOptions {
+    // number of events sent before waiting for the resulting frame
+    int batch = 1;
+    // maximal time to wait for a frame after a batch, batches without a frame don't count towards the latency
+    int timeoutMs = 100;
+    bool frameStatistics = false;
+    bool raw = false;
+};
+
+// Runs script in an off screen terminal and returns latency (input to rendered frame) and throughput.
+// Returns an object with an "error" member if the script can not be run.
+QJsonObject runScript(const QString &name, const InputScript &script, const DriverOptions &options);
+
+// Replays the frames of a recording made with ZTerminalRecorder and returns the time needed per frame. Recordings
+// only contain output, so this measures rendering without any input handling.
+QJsonObject runRecording(const QString &fileName, const DriverOptions &options);
+
+#endif // TUIWIDGETS_BENCH_DRIVER_INCLUDED
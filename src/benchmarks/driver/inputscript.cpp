@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "inputscript.h"
+
+#include <QFile>
+#include <QStringList>
+
+#include <Tui/ZTest.h>
+
+namespace {
+    struct KeyName {
+        const char *name;
+        Tui::Key key;
+    };
+
+    const KeyName keyNames[] = {
+        {"Backspace", Tui::Key_Backspace},
+        {"Delete", Tui::Key_Delete},
+        {"Down", Tui::Key_Down},
+        {"End", Tui::Key_End},
+        {"Enter", Tui::Key_Enter},
+        {"Escape", Tui::Key_Escape},
+        {"F1", Tui::Key_F1},
+        {"F2", Tui::Key_F2},
+        {"F3", Tui::Key_F3},
+        {"F4", Tui::Key_F4},
+        {"F5", Tui::Key_F5},
+        {"F6", Tui::Key_F6},
+        {"F7", Tui::Key_F7},
+        {"F8", Tui::Key_F8},
+        {"F9", Tui::Key_F9},
+        {"F10", Tui::Key_F10},
+        {"F11", Tui::Key_F11},
+        {"F12", Tui::Key_F12},
+        {"Home", Tui::Key_Home},
+        {"Insert", Tui::Key_Insert},
+        {"Left", Tui::Key_Left},
+        {"Menu", Tui::Key_Menu},
+        {"PageDown", Tui::Key_PageDown},
+        {"PageUp", Tui::Key_PageUp},
+        {"Right", Tui::Key_Right},
+        {"Space", Tui::Key_Space},
+        {"Tab", Tui::Key_Tab},
+        {"Up", Tui::Key_Up},
+    };
+
+    QStringList words(const QString &text) {
+        QStringList result;
+        for (const QString &word : text.split(QLatin1Char(' '))) {
+            if (!word.isEmpty()) {
+                result.append(word);
+            }
+        }
+        return result;
+    }
+
+    QString unescape(const QString &text) {
+        QString result;
+        for (int i = 0; i < text.size(); i++) {
+            if (text[i] == QLatin1Char('\\') && i + 1 < text.size()) {
+                ++i;
+                if (text[i] == QLatin1Char('n')) {
+                    result += QLatin1Char('\n');
+                } else {
+                    result += text[i];
+                }
+            } else {
+                result += text[i];
+            }
+        }
+        return result;
+    }
+
+    bool parseModifiers(const QString &text, Tui::KeyboardModifiers *modifiers) {
+        *modifiers = {};
+        for (const QString &name : text.split(QLatin1Char('+'))) {
+            if (name == QStringLiteral("ctrl")) {
+                *modifiers |= Tui::ControlModifier;
+            } else if (name == QStringLiteral("alt")) {
+                *modifiers |= Tui::AltModifier;
+            } else if (name == QStringLiteral("shift")) {
+                *modifiers |= Tui::ShiftModifier;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parseEvent(InputScript *script, const QString &command, const QString &argument, QString *error) {
+        if (command == QStringLiteral("type")) {
+            script->addTyping(unescape(argument));
+        } else if (command == QStringLiteral("paste")) {
+            script->addPaste(unescape(argument));
+        } else if (command == QStringLiteral("key") || command == QStringLiteral("text")) {
+            const QStringList parts = words(argument);
+            if (parts.isEmpty() || parts.size() > 2) {
+                *error = QStringLiteral("expected %1 and optional modifiers").arg(command);
+                return false;
+            }
+            Tui::KeyboardModifiers modifiers;
+            if (parts.size() == 2 && !parseModifiers(parts[1], &modifiers)) {
+                *error = QStringLiteral("unknown modifiers: %1").arg(parts[1]);
+                return false;
+            }
+            if (command == QStringLiteral("text")) {
+                const QString text = unescape(parts[0]);
+                if (text == QStringLiteral("\n")) {
+                    *error = QStringLiteral("use key Enter instead of text \\n");
+                    return false;
+                }
+                script->addText(text, modifiers);
+                return true;
+            }
+            for (const KeyName &keyName : keyNames) {
+                if (parts[0] == QLatin1String(keyName.name)) {
+                    script->addKey(keyName.key, modifiers);
+                    return true;
+                }
+            }
+            *error = QStringLiteral("unknown key: %1").arg(parts[0]);
+            return false;
+        } else {
+            *error = QStringLiteral("unknown command: %1").arg(command);
+            return false;
+        }
+        return true;
+    }
+}
+
+void InputScript::addKey(Tui::Key key, Tui::KeyboardModifiers modifiers) {
+    InputEvent event;
+    event.type = InputEvent::Type::Key;
+    event.key = key;
+    event.modifiers = modifiers;
+    events.append(event);
+}
+
+void InputScript::addText(const QString &text, Tui::KeyboardModifiers modifiers) {
+    InputEvent event;
+    event.type = InputEvent::Type::Text;
+    event.text = text;
+    event.modifiers = modifiers;
+    events.append(event);
+}
+
+void InputScript::addPaste(const QString &text) {
+    InputEvent event;
+    event.type = InputEvent::Type::Paste;
+    event.text = text;
+    events.append(event);
+}
+
+void InputScript::addTyping(const QString &text) {
+    for (int i = 0; i < text.size(); i++) {
+        if (text[i] == QLatin1Char(' ')) {
+            addKey(Tui::Key_Space);
+        } else if (text[i] == QLatin1Char('\n')) {
+            addKey(Tui::Key_Enter);
+        } else if (text[i].isHighSurrogate() && i + 1 < text.size() && text[i + 1].isLowSurrogate()) {
+            addText(text.mid(i, 2));
+            ++i;
+        } else {
+            addText(text.mid(i, 1));
+        }
+    }
+}
+
+bool InputScript::parse(const QString &source, QString *error) {
+    const QStringList lines = source.split(QLatin1Char('\n'));
+    for (int i = 0; i < lines.size(); i++) {
+        QString line = lines[i];
+        if (line.endsWith(QLatin1Char('\r'))) {
+            line.chop(1);
+        }
+        if (line.trimmed().isEmpty() || line.trimmed().startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+
+        const int separator = line.indexOf(QLatin1Char(' '));
+        const QString command = separator == -1 ? line : line.left(separator);
+        const QString argument = separator == -1 ? QString() : line.mid(separator + 1);
+        QString message;
+        bool ok = true;
+        if (command == QStringLiteral("setup")) {
+            setup = argument.trimmed();
+        } else if (command == QStringLiteral("size")) {
+            const QStringList parts = words(argument);
+            const int width = parts.size() == 2 ? parts[0].toInt() : 0;
+            const int height = parts.size() == 2 ? parts[1].toInt() : 0;
+            if (width <= 0 || height <= 0) {
+                message = QStringLiteral("expected width and height");
+                ok = false;
+            } else {
+                size = {width, height};
+            }
+        } else if (command == QStringLiteral("repeat")) {
+            const int countSeparator = argument.indexOf(QLatin1Char(' '));
+            const int count = argument.left(countSeparator).toInt();
+            const QString eventLine = countSeparator == -1 ? QString() : argument.mid(countSeparator + 1);
+            const int eventSeparator = eventLine.indexOf(QLatin1Char(' '));
+            InputScript repeated;
+            if (count <= 0) {
+                message = QStringLiteral("expected repeat count");
+                ok = false;
+            } else if (parseEvent(&repeated, eventLine.left(eventSeparator),
+                                  eventSeparator == -1 ? QString() : eventLine.mid(eventSeparator + 1), &message)) {
+                for (int j = 0; j < count; j++) {
+                    events += repeated.events;
+                }
+            } else {
+                ok = false;
+            }
+        } else {
+            ok = parseEvent(this, command, argument, &message);
+        }
+        if (!ok) {
+            *error = QStringLiteral("line %1: %2").arg(i + 1).arg(message);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool InputScript::load(const QString &fileName, QString *error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QStringLiteral("%1: %2").arg(fileName, file.errorString());
+        return false;
+    }
+    if (!parse(QString::fromUtf8(file.readAll()), error)) {
+        *error = QStringLiteral("%1: %2").arg(fileName, *error);
+        return false;
+    }
+    return true;
+}
+
+void InputScript::send(Tui::ZTerminal *terminal, const InputEvent &event) {
+    switch (event.type) {
+        case InputEvent::Type::Text:
+            Tui::ZTest::sendText(terminal, event.text, event.modifiers);
+            break;
+        case InputEvent::Type::Key:
+            Tui::ZTest::sendKey(terminal, event.key, event.modifiers);
+            break;
+        case InputEvent::Type::Paste:
+            Tui::ZTest::sendPaste(terminal, event.text);
+            break;
+    }
+}
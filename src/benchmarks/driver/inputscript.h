@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_BENCH_INPUTSCRIPT_INCLUDED
+#define TUIWIDGETS_BENCH_INPUTSCRIPT_INCLUDED
+
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+#include <Tui/ZCommon.h>
+#include <Tui/ZTerminal.h>
+
+struct InputEvent {
+    enum class Type {
+        Text,
+        Key,
+        Paste,
+    };
+
+    Type type = Type::Key;
+    Tui::Key key = Tui::Key_unknown;
+    Tui::KeyboardModifiers modifiers;
+    QString text;
+};
+
+// A deterministic stream of input events together with the widget setup it is meant for.
+//
+// Scripts can be loaded from a line based text format:
+//
+//   # comment
+//   setup textedit              name of the widget setup, see scenarios.h
+//   size 120 40                 terminal size
+//   key Down                    key with optional modifiers, e.g. "key Left ctrl+shift"
+//   text a                      text input, optionally followed by modifiers, e.g. "text x alt"
+//   type Hello world\n          one event per character, spaces and \n are sent as keys
+//   paste first\nsecond         a bracketed paste
+//   repeat 20 key PageDown      repeats the event in the rest of the line
+//
+// In the text of type, text and paste "\n" is a new line and "\\" a backslash.
+class InputScript {
+public:
+    void addKey(Tui::Key key, Tui::KeyboardModifiers modifiers = {});
+    void addText(const QString &text, Tui::KeyboardModifiers modifiers = {});
+    void addPaste(const QString &text);
+    void addTyping(const QString &text);
+
+    bool parse(const QString &source, QString *error);
+    bool load(const QString &fileName, QString *error);
+
+    static void send(Tui::ZTerminal *terminal, const InputEvent &event);
+
+public:
+    QString setup;
+    QSize size = {120, 40};
+    QVector<InputEvent> events;
+};
+
+#endif // TUIWIDGETS_BENCH_INPUTSCRIPT_INCLUDED
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: BSL-1.0
+
+// tuiwidgets-bench drives an off screen terminal with scripted input and writes latency (input to rendered frame)
+// and throughput results as JSON. Run with --help for the options and --list for the built-in scenarios.
+//
+// Input is only supported as scripts (see inputscript.h). Recordings made with ZTerminalRecorder contain the
+// rendered frames but no input, so --recording only measures applying and rendering those frames.
+
+#include <stdio.h>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPair>
+
+#include "driver.h"
+#include "inputscript.h"
+#include "scenarios.h"
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Measures input latency and throughput of tuiwidgets."));
+    parser.addHelpOption();
+    QCommandLineOption listOption(QStringLiteral("list"), QStringLiteral("List built-in scenarios and setups."));
+    QCommandLineOption scenarioOption(QStringLiteral("scenario"),
+                                      QStringLiteral("Run built-in scenario <name>, can be repeated. Default: all."),
+                                      QStringLiteral("name"));
+    QCommandLineOption scriptOption(QStringLiteral("script"), QStringLiteral("Run input script <file>, can be repeated."),
+                                    QStringLiteral("file"));
+    QCommandLineOption recordingOption(QStringLiteral("recording"),
+                                       QStringLiteral("Replay the output frames of ZTerminalRecorder recording <file> and "
+                                                      "measure rendering, can be repeated. Recordings contain no input."),
+                                       QStringLiteral("file"));
+    QCommandLineOption sizeOption(QStringLiteral("size"), QStringLiteral("Terminal size, overrides the script."),
+                                  QStringLiteral("WxH"));
+    QCommandLineOption batchOption(QStringLiteral("batch"),
+                                   QStringLiteral("Send <n> events before waiting for a frame. Default: 1."),
+                                   QStringLiteral("n"), QStringLiteral("1"));
+    QCommandLineOption timeoutOption(QStringLiteral("timeout"),
+                                     QStringLiteral("Wait at most <ms> for a frame. Default: 100."),
+                                     QStringLiteral("ms"), QStringLiteral("100"));
+    QCommandLineOption frameStatisticsOption(QStringLiteral("frame-statistics"),
+                                             QStringLiteral("Include mean rendering phase times."));
+    QCommandLineOption rawOption(QStringLiteral("raw"), QStringLiteral("Include each measured latency."));
+    QCommandLineOption outputOption({QStringLiteral("o"), QStringLiteral("output")},
+                                    QStringLiteral("Write results to <file> instead of stdout."),
+                                    QStringLiteral("file"));
+    parser.addOptions({listOption, scenarioOption, scriptOption, recordingOption, sizeOption, batchOption,
+                       timeoutOption, frameStatisticsOption, rawOption, outputOption});
+    parser.process(app);
+
+    if (parser.isSet(listOption)) {
+        printf("scenarios:\n");
+        for (const QString &name : scenarioNames()) {
+            printf("  %s\n", qPrintable(name));
+        }
+        printf("setups for scripts:\n");
+        for (const QString &name : setupNames()) {
+            printf("  %s\n", qPrintable(name));
+        }
+        return 0;
+    }
+
+    DriverOptions options;
+    bool ok = false;
+    options.batch = parser.value(batchOption).toInt(&ok);
+    if (!ok || options.batch < 1) {
+        fprintf(stderr, "invalid batch size\n");
+        return 1;
+    }
+    options.timeoutMs = parser.value(timeoutOption).toInt(&ok);
+    if (!ok || options.timeoutMs < 0) {
+        fprintf(stderr, "invalid timeout\n");
+        return 1;
+    }
+    options.frameStatistics = parser.isSet(frameStatisticsOption);
+    options.raw = parser.isSet(rawOption);
+
+    QSize size;
+    if (parser.isSet(sizeOption)) {
+        const QStringList parts = parser.value(sizeOption).split(QLatin1Char('x'));
+        if (parts.size() == 2) {
+            size = {parts[0].toInt(), parts[1].toInt()};
+        }
+        if (size.width() <= 0 || size.height() <= 0) {
+            fprintf(stderr, "invalid size, expected e.g. 120x40\n");
+            return 1;
+        }
+    }
+
+    QVector<QPair<QString, InputScript>> scripts;
+    QStringList scenarios = parser.values(scenarioOption);
+    if (scenarios.isEmpty() && !parser.isSet(scriptOption) && !parser.isSet(recordingOption)) {
+        scenarios = scenarioNames();
+    }
+    for (const QString &name : scenarios) {
+        InputScript script;
+        if (!createScenario(name, &script)) {
+            fprintf(stderr, "unknown scenario: %s\n", qPrintable(name));
+            return 1;
+        }
+        scripts.append({name, script});
+    }
+    for (const QString &fileName : parser.values(scriptOption)) {
+        InputScript script;
+        QString error;
+        if (!script.load(fileName, &error)) {
+            fprintf(stderr, "%s\n", qPrintable(error));
+            return 1;
+        }
+        scripts.append({fileName, script});
+    }
+
+    QJsonArray results;
+    for (auto &entry : scripts) {
+        if (size.isValid()) {
+            entry.second.size = size;
+        }
+        fprintf(stderr, "running %s\n", qPrintable(entry.first));
+        results.append(runScript(entry.first, entry.second, options));
+    }
+    for (const QString &fileName : parser.values(recordingOption)) {
+        fprintf(stderr, "replaying %s\n", qPrintable(fileName));
+        results.append(runRecording(fileName, options));
+    }
+
+    QJsonObject document;
+    document.insert(QStringLiteral("tool"), QStringLiteral("tuiwidgets-bench"));
+    document.insert(QStringLiteral("version"), 1);
+    document.insert(QStringLiteral("results"), results);
+    const QByteArray json = QJsonDocument(document).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+            fprintf(stderr, "%s: %s\n", qPrintable(file.fileName()), qPrintable(file.errorString()));
+            return 1;
+        }
+    } else {
+        fwrite(json.constData(), 1, json.size(), stdout);
+    }
+
+    bool failed = false;
+    for (const QJsonValue &result : results) {
+        if (result.toObject().contains(QStringLiteral("error"))) {
+            fprintf(stderr, "%s: %s\n", qPrintable(result.toObject().value(QStringLiteral("name")).toString()),
+                    qPrintable(result.toObject().value(QStringLiteral("error")).toString()));
+            failed = true;
+        }
+    }
+    return failed ? 1 : 0;
+}
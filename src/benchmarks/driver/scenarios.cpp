@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "scenarios.h"
+
+#include <Tui/ZLabel.h>
+#include <Tui/ZListView.h>
+#include <Tui/ZTextEdit.h>
+#include <Tui/ZWindow.h>
+
+namespace {
+    QString documentText() {
+        QString text;
+        for (int i = 0; i < 20000; i++) {
+            text += QStringLiteral("%1: void handleRequest%2(Request *request) { return dispatch(request, %3); } // äöü\n")
+                    .arg(i, 5).arg(i * 7919 % 10007).arg(i % 97);
+        }
+        return text;
+    }
+
+    const char paragraph[] = "The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs.\n"
+                             "Sphinx of black quartz, judge my vow. How vexingly quick daft zebras jump!\n\n";
+}
+
+std::unique_ptr<Tui::ZRoot> createSetup(const QString &name, Tui::ZTerminal *terminal, QString *error) {
+    if (!setupNames().contains(name)) {
+        *error = QStringLiteral("unknown setup: %1").arg(name);
+        return nullptr;
+    }
+
+    auto root = std::make_unique<Tui::ZRoot>();
+    terminal->setMainWidget(root.get());
+    const QRect area = {0, 0, terminal->width(), terminal->height()};
+
+    if (name == QStringLiteral("textedit") || name == QStringLiteral("textedit-document")) {
+        auto *edit = new Tui::ZTextEdit(terminal->textMetrics(), root.get());
+        edit->setGeometry(area);
+        if (name == QStringLiteral("textedit-document")) {
+            edit->setText(documentText());
+        }
+        edit->setFocus();
+    } else if (name == QStringLiteral("listview")) {
+        QStringList items;
+        for (int i = 0; i < 10000; i++) {
+            items.append(QStringLiteral("item %1 with some additional text %2").arg(i, 5).arg(i * 7919 % 10007));
+        }
+        auto *view = new Tui::ZListView(root.get());
+        view->setGeometry(area);
+        view->setItems(items);
+        view->setFocus();
+    } else {
+        Tui::ZWindow *first = nullptr;
+        for (int i = 0; i < 4; i++) {
+            auto *window = new Tui::ZWindow(QStringLiteral("Window %1").arg(i + 1), root.get());
+            window->setGeometry({2 + 6 * i, 1 + 3 * i, area.width() / 2, area.height() / 2});
+            auto *label = new Tui::ZLabel(QStringLiteral("Some label text"), window);
+            label->setGeometry({2, 1, area.width() / 2 - 4, 1});
+            auto *edit = new Tui::ZTextEdit(terminal->textMetrics(), window);
+            edit->setGeometry({1, 2, area.width() / 2 - 2, area.height() / 2 - 3});
+            edit->setText(QString::fromLatin1(paragraph).repeated(4));
+            if (!first) {
+                first = window;
+                edit->setFocus();
+            }
+        }
+        first->raise();
+        first->startInteractiveMove();
+    }
+    return root;
+}
+
+QStringList setupNames() {
+    return {QStringLiteral("textedit"), QStringLiteral("textedit-document"), QStringLiteral("listview"),
+            QStringLiteral("windows")};
+}
+
+QStringList scenarioNames() {
+    return {QStringLiteral("textedit-typing"), QStringLiteral("textedit-scrolling"),
+            QStringLiteral("listview-browsing"), QStringLiteral("window-dragging")};
+}
+
+bool createScenario(const QString &name, InputScript *script) {
+    if (name == QStringLiteral("textedit-typing")) {
+        script->setup = QStringLiteral("textedit");
+        for (int i = 0; i < 10; i++) {
+            script->addTyping(QString::fromLatin1(paragraph));
+        }
+        for (int i = 0; i < 50; i++) {
+            script->addKey(Tui::Key_Backspace);
+        }
+    } else if (name == QStringLiteral("textedit-scrolling")) {
+        script->setup = QStringLiteral("textedit-document");
+        for (int i = 0; i < 200; i++) {
+            script->addKey(Tui::Key_PageDown);
+        }
+        for (int i = 0; i < 500; i++) {
+            script->addKey(Tui::Key_Up);
+        }
+        for (int i = 0; i < 100; i++) {
+            script->addKey(Tui::Key_PageUp);
+        }
+        script->addKey(Tui::Key_End, Tui::ControlModifier);
+        script->addKey(Tui::Key_Home, Tui::ControlModifier);
+    } else if (name == QStringLiteral("listview-browsing")) {
+        script->setup = QStringLiteral("listview");
+        for (int i = 0; i < 500; i++) {
+            script->addKey(Tui::Key_Down);
+        }
+        for (int i = 0; i < 100; i++) {
+            script->addKey(Tui::Key_PageDown);
+        }
+        for (int i = 0; i < 300; i++) {
+            script->addKey(Tui::Key_Up);
+        }
+        script->addKey(Tui::Key_End);
+        script->addKey(Tui::Key_Home);
+    } else if (name == QStringLiteral("window-dragging")) {
+        script->setup = QStringLiteral("windows");
+        for (int i = 0; i < 20; i++) {
+            for (int j = 0; j < 20; j++) {
+                script->addKey(Tui::Key_Right);
+            }
+            for (int j = 0; j < 10; j++) {
+                script->addKey(Tui::Key_Down);
+            }
+            for (int j = 0; j < 20; j++) {
+                script->addKey(Tui::Key_Left);
+            }
+            for (int j = 0; j < 10; j++) {
+                script->addKey(Tui::Key_Up);
+            }
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#ifndef TUIWIDGETS_BENCH_SCENARIOS_INCLUDED
+#define TUIWIDGETS_BENCH_SCENARIOS_INCLUDED
+
+#include <memory>
+
+#include <QString>
+#include <QStringList>
+
+#include <Tui/ZRoot.h>
+#include <Tui/ZTerminal.h>
+
+#include "inputscript.h"
+
+// Widget setups scripts can run against:
+//
+//   textedit            an empty ZTextEdit filling the terminal
+//   textedit-document   a ZTextEdit with a large document
+//   listview            a ZListView with many items
+//   windows             overlapping windows, the first one is in interactive move mode
+//
+// The setup is created as main widget of terminal. Returns nullptr and sets error for unknown names.
+std::unique_ptr<Tui::ZRoot> createSetup(const QString &name, Tui::ZTerminal *terminal, QString *error);
+QStringList setupNames();
+
+// Built-in scenarios, each is a script for one of the setups.
+QStringList scenarioNames();
+bool createScenario(const QString &name, InputScript *script);
+
+#endif // TUIWIDGETS_BENCH_SCENARIOS_INCLUDED
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZImage.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <string>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include <Tui/ZColor.h>
+#include <Tui/ZPainter.h>
+#include <Tui/ZTerminal.h>
+
+namespace {
+    // Something like a text editor with a menu, a status line and a bit of syntax highlighting.
+    void paintFrame(Tui::ZImage &image, int frame) {
+        Tui::ZPainter painter = image.painter();
+        const int width = image.width();
+        const int height = image.height();
+        painter.clear(Tui::Colors::brightWhite, Tui::Colors::blue);
+        painter.writeWithColors(0, 0, QStringLiteral(" File  Edit  Search  View  Help").leftJustified(width),
+                                Tui::Colors::black, Tui::Colors::lightGray);
+        for (int y = 1; y < height - 1; y++) {
+            const int line = y + frame;
+            QString text = QStringLiteral("%1    if (value_%2 > limit) { return compute(value_%2, \"ünïcödé\"); }")
+                    .arg(line, 5).arg(line % 17);
+            painter.writeWithColors(0, y, text, Tui::Colors::brightWhite, Tui::Colors::blue);
+            painter.writeWithColors(10, y, QStringLiteral("if"), Tui::Colors::yellow, Tui::Colors::blue);
+            painter.writeWithAttributes(40, y, QStringLiteral("return"), Tui::Colors::brightGreen, Tui::Colors::blue,
+                                        Tui::ZTextAttribute::Bold);
+        }
+        painter.writeWithColors(0, height - 1, QStringLiteral(" Line %1 Col 1  UTF-8  あいう").arg(frame).leftJustified(width),
+                                Tui::Colors::black, Tui::Colors::cyan);
+    }
+}
+
+TEST_CASE("image formats 300x100", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(300, 100)};
+    Tui::ZImage image(&terminal, 300, 100);
+    paintFrame(image, 0);
+
+    struct NamedFormat {
+        const char *name;
+        Tui::ZImage::Format format;
+    };
+    const NamedFormat formats[] = {
+        {"termpaint", Tui::ZImage::Format::Termpaint},
+        {"binary", Tui::ZImage::Format::Binary},
+        {"binary compressed", Tui::ZImage::Format::BinaryCompressed},
+    };
+
+    for (const NamedFormat &format : formats) {
+        const QByteArray data = image.saveToByteArray(format.format);
+        auto loaded = Tui::ZImage::fromByteArray(&terminal, data);
+        REQUIRE(loaded);
+        REQUIRE(*loaded == image);
+
+        // Size of a recording of 100 frames with changing content
+        qint64 recordingSize = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int frame = 0; frame < 100; frame++) {
+            Tui::ZImage frameImage(&terminal, 300, 100);
+            paintFrame(frameImage, frame);
+            recordingSize += frameImage.saveToByteArray(format.format).size();
+        }
+        WARN(format.name << ": " << data.size() << " bytes per frame, " << recordingSize
+             << " bytes for 100 frames (" << timer.elapsed() << "ms including painting)");
+
+        BENCHMARK(std::string("save ") + format.name) {
+            return image.saveToByteArray(format.format);
+        };
+
+        BENCHMARK(std::string("load ") + format.name) {
+            return Tui::ZImage::fromByteArray(&terminal, data);
+        };
+    }
+}
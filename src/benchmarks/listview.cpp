@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZListView.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QStringListModel>
+
+#include <Tui/ZImage.h>
+#include <Tui/ZPainter.h>
+#include <Tui/ZRoot.h>
+#include <Tui/ZStyledTextLine.h>
+#include <Tui/ZTerminal.h>
+#include <Tui/ZTextStyle.h>
+
+#include "alloccounter.h"
+
+TEST_CASE("listview scroll", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{80, 50}};
+    Tui::ZRoot root;
+    terminal.setMainWidget(&root);
+
+    const int rowCount = 1000000;
+    QStringList rows;
+    rows.reserve(rowCount);
+    for (int i = 0; i < rowCount; i++) {
+        rows.append(QStringLiteral("Item number %1 of the list").arg(i));
+    }
+    QStringListModel model(rows);
+
+    Tui::ZListView view(&root);
+    view.setGeometry({0, 0, 80, 50});
+    view.setFocus();
+    view.setModel(&model);
+
+    int row = 0;
+    BENCHMARK("scroll page and repaint in 1M rows") {
+        row = (row + 50) % rowCount;
+        view.scrollTo(model.index(row, 0), Tui::ZListView::PositionAtTop);
+        terminal.forceRepaint();
+        return row;
+    };
+
+    const int64_t allocationsBefore = allocationCount();
+    const int frames = 100;
+    for (int i = 0; i < frames; i++) {
+        row = (row + 50) % rowCount;
+        view.scrollTo(model.index(row, 0), Tui::ZListView::PositionAtTop);
+        terminal.forceRepaint();
+    }
+    WARN("allocations per frame: " << (allocationCount() - allocationsBefore) / frames);
+}
+
+TEST_CASE("styledtextline markup", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{80, 50}};
+    Tui::ZImage image{&terminal, 80, 50};
+    Tui::ZPainter painter = image.painter();
+
+    const Tui::ZTextStyle base{Tui::Colors::lightGray, Tui::Colors::black};
+    const Tui::ZTextStyle mnemonic{Tui::Colors::brightWhite, Tui::Colors::black};
+
+    // Like a menu that is repainted with temporary ZStyledTextLine instances.
+    BENCHMARK("write 50 menu items with markup") {
+        for (int i = 0; i < 50; i++) {
+            Tui::ZStyledTextLine st;
+            st.setMnemonicStyle(base, mnemonic);
+            st.setMarkup(QStringLiteral("<m>O</m>pen recent file ") + QString::number(i % 10));
+            st.write(&painter, 0, i, 80);
+        }
+        return 0;
+    };
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "../tests/catchwrapper.h"
+
+#include <QString>
+
+#include "Tui/MarkupParser.h"
+
+#include "alloccounter.h"
+
+namespace {
+    QString makeMarkup() {
+        const QString line = QStringLiteral("<b class=\"item\" id='row'>Item</b> <m>n</m>umber &amp; &rarr; "
+                                            "&NotEqualTilde; \U0001F600 some plain text of the line\n");
+        const int size = 10 * 1024 * 1024;
+        QString result;
+        result.reserve(size + line.size());
+        while (result.size() < size) {
+            result += line;
+        }
+        return result;
+    }
+
+    // Returns the number of events, or -1 on parse errors.
+    int parseAll(const QString &markup) {
+        Tui::Private::MarkupParser parser(markup);
+        int events = 0;
+        while (true) {
+            parser.nextEvent();
+            if (parser.isDocumentEnd()) {
+                return events;
+            } else if (parser.isElementBegin()) {
+                events += 1 + static_cast<int>(parser.elementBegin().attributes().size());
+            } else if (parser.isElementEnd() || parser.isCharEvent()) {
+                ++events;
+            } else {
+                return -1;
+            }
+        }
+    }
+}
+
+TEST_CASE("markupparser parse", "[benchmark]") {
+    const QString markup = makeMarkup();
+    REQUIRE(parseAll(markup) > 0);
+
+    BENCHMARK("parse 10MB markup") {
+        return parseAll(markup);
+    };
+
+    const int64_t allocationsBefore = allocationCount();
+    parseAll(markup);
+    WARN("allocations per 10MB parse: " << (allocationCount() - allocationsBefore));
+}
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/Misc/SurrogateEscape.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <random>
+#include <vector>
+
+#include "Tui/Misc/SurrogateEscape_p.h"
+
+using Kernel = Tui::Private::SurrogateEscapeKernels::Kernel;
+
+namespace {
+    QByteArray makeInput(const QString &kind) {
+        // unseeded is ok
+        std::mt19937 gen;
+        const int size = 1024 * 1024;
+
+        QByteArray result;
+        result.reserve(size + 8);
+        while (result.size() < size) {
+            const unsigned int value = gen();
+            if (kind == QStringLiteral("ascii")) {
+                result += static_cast<char>(value % 64 ? 0x20 + value % 0x5f : '\n');
+            } else if (kind == QStringLiteral("latin")) {
+                // mostly ASCII with some accented characters
+                if (value % 16) {
+                    result += static_cast<char>(0x20 + value % 0x5f);
+                } else {
+                    result += "\xc3\xa9";
+                }
+            } else if (kind == QStringLiteral("cjk")) {
+                result += "\xe6\xbc\xa2";
+            } else {
+                // binary
+                result += static_cast<char>(value);
+            }
+        }
+        return result;
+    }
+}
+
+TEST_CASE("surrogateescape decode", "[benchmark]") {
+    const QString kind = GENERATE(QStringLiteral("ascii"), QStringLiteral("latin"), QStringLiteral("cjk"),
+                                  QStringLiteral("binary"));
+    const QByteArray input = makeInput(kind);
+    std::vector<char16_t> output(input.size());
+
+    BENCHMARK(("public api 1MiB " + kind).toStdString()) {
+        return Tui::Misc::SurrogateEscape::decode(input);
+    };
+
+    for (Kernel kernel: {Kernel::Scalar, Kernel::SSE2, Kernel::AVX2}) {
+        if (!Tui::Private::SurrogateEscapeKernels::isSupported(kernel)) {
+            continue;
+        }
+        const char *names[] = {"scalar", "sse2", "avx2"};
+        BENCHMARK(("kernel " + QString::fromLatin1(names[static_cast<int>(kernel)]) + " 1MiB " + kind).toStdString()) {
+            return Tui::Private::SurrogateEscapeKernels::decode(kernel, input.constData(), input.size(), output.data());
+        };
+    }
+}
+
+TEST_CASE("surrogateescape encode", "[benchmark]") {
+    const QString kind = GENERATE(QStringLiteral("ascii"), QStringLiteral("latin"), QStringLiteral("cjk"),
+                                  QStringLiteral("binary"));
+    const QString input = Tui::Misc::SurrogateEscape::decode(makeInput(kind));
+    std::vector<char> output(3 * input.size());
+
+    BENCHMARK(("public api 1MiB " + kind).toStdString()) {
+        return Tui::Misc::SurrogateEscape::encode(input);
+    };
+
+    for (Kernel kernel: {Kernel::Scalar, Kernel::SSE2, Kernel::AVX2}) {
+        if (!Tui::Private::SurrogateEscapeKernels::isSupported(kernel)) {
+            continue;
+        }
+        const char *names[] = {"scalar", "sse2", "avx2"};
+        BENCHMARK(("kernel " + QString::fromLatin1(names[static_cast<int>(kernel)]) + " 1MiB " + kind).toStdString()) {
+            return Tui::Private::SurrogateEscapeKernels::encode(kernel, reinterpret_cast<const char16_t*>(input.constData()),
+                                                                input.size(), output.data());
+        };
+    }
+}
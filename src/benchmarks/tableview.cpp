@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTableView.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <QCoreApplication>
+
+#include <Tui/Misc/AbstractTableModelTrackBy.h>
+#include <Tui/ZRoot.h>
+#include <Tui/ZTerminal.h>
+
+#include "alloccounter.h"
+
+namespace {
+    using Model = Tui::Misc::AbstractTableModelTrackBy<int>;
+}
+
+TEST_CASE("tableview live updates", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{200, 50}};
+    Tui::ZRoot root;
+    terminal.setMainWidget(&root);
+
+    const int rowCount = 100000;
+    const int columnCount = 30;
+    const int updatedRows = 10000;
+
+    // Two variants of each row. Apart from the first column the cells are shared between rows to keep the memory
+    // usage reasonable, the model still compares all cells of each row.
+    QVector<QVector<QMap<int, QVariant>>> sharedCells(2);
+    for (int variant = 0; variant < 2; variant++) {
+        for (int column = 0; column < columnCount; column++) {
+            sharedCells[variant].append({{Qt::DisplayRole, QStringLiteral("value %1/%2").arg(column).arg(variant)}});
+        }
+    }
+    QVector<Model::Row> variants[2];
+    for (int i = 0; i < rowCount; i++) {
+        for (int variant = 0; variant < 2; variant++) {
+            Model::Row row{i, sharedCells[variant]};
+            row.columns[0] = {{Qt::DisplayRole, QStringLiteral("row %1").arg(i)}};
+            variants[variant].append(row);
+        }
+    }
+
+    // Rows are split into groups of rows spread over the whole table, so some rows of each group are always
+    // visible. Going from one state to the next switches the variant of exactly one group, i.e. 10k rows.
+    const int groups = rowCount / updatedRows;
+    QVector<QVector<Model::Row>> states;
+    for (int state = 0; state < 2 * groups; state++) {
+        QVector<Model::Row> rows;
+        rows.reserve(rowCount);
+        for (int i = 0; i < rowCount; i++) {
+            const int group = i % groups;
+            const int variant = (state > group && state <= group + groups) ? 1 : 0;
+            rows.append(variants[variant][i]);
+        }
+        states.append(rows);
+    }
+
+    Model model(columnCount);
+    model.setData(states.last());
+
+    Tui::ZTableView view(&root);
+    view.setGeometry({0, 0, 200, 50});
+    view.setFocus();
+    view.setModel(&model);
+    view.setFixedRowCount(2);
+    terminal.forceRepaint();
+
+    int state = 0;
+    // One iteration corresponds to one second of 10k row updates per second with one repaint.
+    BENCHMARK("update 10k of 100k rows x 30 columns and repaint") {
+        model.setData(states[state]);
+        state = (state + 1) % states.size();
+        terminal.forceRepaint();
+        return state;
+    };
+
+    int row = 0;
+    BENCHMARK("scroll page and repaint in 100k rows x 30 columns") {
+        row = (row + 48) % rowCount;
+        view.setCurrentIndex(model.index(row, 0));
+        terminal.forceRepaint();
+        return row;
+    };
+
+    const int64_t allocationsBefore = allocationCount();
+    const int frames = 100;
+    for (int i = 0; i < frames; i++) {
+        row = (row + 48) % rowCount;
+        view.setCurrentIndex(model.index(row, 0));
+        terminal.forceRepaint();
+    }
+    WARN("allocations per scrolled frame: " << (allocationCount() - allocationsBefore) / frames);
+}
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTerminal.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include <Tui/ZEvent.h>
+#include <Tui/ZWidget.h>
+
+#include "alloccounter.h"
+
+namespace {
+    // Acts like a very basic terminal that only answers status requests. Answers are collected and fed back
+    // from the benchmark, as calling terminalInput from within write is not allowed.
+    class BasicTerminal : public Tui::ZTerminal::TerminalConnectionDelegate {
+    public:
+        void write(const char *data, int length) override {
+            output.append(data, length);
+            int pos;
+            while ((pos = output.indexOf("\033[5n")) != -1) {
+                responses.append("\033[0n");
+                output.remove(0, pos + 4);
+            }
+            // only keep a possibly incomplete request
+            if (output.size() > 3) {
+                output.remove(0, output.size() - 3);
+            }
+        }
+        void flush() override {}
+        void restoreSequenceUpdated(const char *data, int len) override {
+            (void)data; (void)len;
+        }
+        void deinit(bool awaitingResponse) override {
+            (void)awaitingResponse;
+        }
+
+        QByteArray output;
+        QByteArray responses;
+    };
+
+    class PasteSink : public Tui::ZWidget {
+    public:
+        using Tui::ZWidget::ZWidget;
+
+        void pasteEvent(Tui::ZPasteEvent *event) override {
+            received += event->text().size();
+        }
+
+        qint64 received = 0;
+    };
+}
+
+TEST_CASE("terminal paste", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    BasicTerminal delegate;
+    Tui::ZTerminal::TerminalConnection connection;
+    connection.setDelegate(&delegate);
+    connection.setSize(80, 24);
+    Tui::ZTerminal terminal{&connection, Tui::ZTerminal::ForceIncompatibleTerminals
+                                         | Tui::ZTerminal::DisableAutoDetectTimeoutMessage};
+    PasteSink sink;
+    terminal.setMainWidget(&sink);
+    sink.setFocus();
+
+    QElapsedTimer timer;
+    timer.start();
+    while (terminal.terminalDetectionResultText().isEmpty() && !timer.hasExpired(5000)) {
+        QCoreApplication::processEvents();
+        if (delegate.responses.size()) {
+            const QByteArray responses = delegate.responses;
+            delegate.responses.clear();
+            connection.terminalInput(responses.constData(), responses.size());
+        }
+    }
+    REQUIRE(!terminal.terminalDetectionResultText().isEmpty());
+
+    QByteArray paste = "\033[200~";
+    const int textSize = 10 * 1024 * 1024;
+    while (paste.size() < textSize) {
+        paste += "Some pasted text with a few words, numbers 1234567890 and the odd äöü.\n";
+    }
+    paste += "\033[201~";
+
+    auto feed = [&](int chunkSize) {
+        sink.received = 0;
+        for (int pos = 0; pos < paste.size(); pos += chunkSize) {
+            connection.terminalInput(paste.constData() + pos, std::min(chunkSize, paste.size() - pos));
+        }
+        return sink.received;
+    };
+
+    // 99 bytes is the read size used for terminal input before reads were batched.
+    BENCHMARK("10MB paste in 99 byte parts") {
+        return feed(99);
+    };
+
+    BENCHMARK("10MB paste in 64kB parts") {
+        return feed(64 * 1024);
+    };
+
+    CHECK(feed(64 * 1024) > textSize / 2);
+
+    const int64_t allocationsBefore = allocationCount();
+    feed(64 * 1024);
+    WARN("allocations per 10MB paste in 64kB parts: " << (allocationCount() - allocationsBefore));
+}
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTerminalRecorder.h>
+#include <Tui/ZTerminalReplay.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <algorithm>
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <Tui/ZColor.h>
+#include <Tui/ZPainter.h>
+#include <Tui/ZRoot.h>
+#include <Tui/ZTerminal.h>
+
+namespace {
+    // A scrolling log with a status line, most frames change a few lines.
+    class LogRoot : public Tui::ZRoot {
+    public:
+        void paintEvent(Tui::ZPaintEvent *event) override {
+            Tui::ZRoot::paintEvent(event);
+            auto *painter = event->painter();
+            const int height = geometry().height();
+            for (int y = 0; y < height - 1; y++) {
+                const int line = y + frame / 4;
+                painter->writeWithColors(0, y, QStringLiteral("%1 request %2 handled in %3ms ✓")
+                                         .arg(line, 6).arg(line * 7919 % 10007).arg(line % 97),
+                                         line % 5 ? Tui::Colors::brightWhite : Tui::Colors::yellow, Tui::Colors::blue);
+            }
+            painter->writeWithColors(0, height - 1, QStringLiteral(" frame %1  あいう").arg(frame),
+                                     Tui::Colors::black, Tui::Colors::cyan);
+        }
+
+        int frame = 0;
+    };
+
+    // Replays all frames of the recording in data and returns the number of frames.
+    int replayAll(const QByteArray &data, Tui::ZTerminal *terminal) {
+        QBuffer buffer;
+        buffer.setData(data);
+        buffer.open(QIODevice::ReadOnly);
+        Tui::ZTerminalReplay replay;
+        if (!replay.open(&buffer)) {
+            return 0;
+        }
+        while (replay.readFrame(terminal)) {
+            terminal->updateOutput();
+        }
+        return replay.frameNumber();
+    }
+}
+
+TEST_CASE("terminal replay", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    // A recording made with ZTerminalRecorder can be replayed by setting TUIWIDGETS_BENCH_RECORDING to its file name.
+    QByteArray recording;
+    const QString fileName = qEnvironmentVariable("TUIWIDGETS_BENCH_RECORDING");
+    if (!fileName.isEmpty()) {
+        QFile file(fileName);
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        recording = file.readAll();
+    } else {
+        Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(160, 50)};
+        LogRoot root;
+        terminal.setMainWidget(&root);
+
+        const int frames = 400;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < frames; i++) {
+            root.frame = i;
+            terminal.forceRepaint();
+        }
+        const qint64 withoutRecorder = timer.nsecsElapsed();
+
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        Tui::ZTerminalRecorder recorder;
+        REQUIRE(recorder.start(&terminal, &buffer));
+        timer.restart();
+        for (int i = 0; i < frames; i++) {
+            root.frame = i;
+            terminal.forceRepaint();
+        }
+        const qint64 withRecorder = timer.nsecsElapsed();
+        recorder.stop();
+        recording = buffer.data();
+
+        WARN("recording 160x50: " << recording.size() / frames << " bytes per frame, "
+             << (withRecorder - withoutRecorder) / frames / 1000 << "us recorder overhead per frame");
+    }
+
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(1, 1)};
+    QElapsedTimer timer;
+    timer.start();
+    const int frames = replayAll(recording, &terminal);
+    REQUIRE(frames > 0);
+    WARN("replayed " << frames << " frames at "
+         << frames * 1000 / std::max<qint64>(1, timer.elapsed()) << " frames/s");
+
+    BENCHMARK("replay") {
+        return replayAll(recording, &terminal);
+    };
+}
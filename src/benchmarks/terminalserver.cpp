@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTerminalServer.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <Tui/ZColor.h>
+#include <Tui/ZEvent.h>
+#include <Tui/ZPainter.h>
+#include <Tui/ZRoot.h>
+
+#include "alloccounter.h"
+
+namespace {
+    // Simulated client on the other end of a session. Like a very basic terminal it only answers status requests.
+    struct Client {
+        int fd = -1;
+        QByteArray tail;
+        qint64 bytesReceived = 0;
+    };
+
+    void pumpClient(Client &client) {
+        char buffer[16 * 1024];
+        while (true) {
+            const ssize_t ret = read(client.fd, buffer, sizeof(buffer));
+            if (ret <= 0) {
+                break;
+            }
+            client.bytesReceived += ret;
+            client.tail.append(buffer, static_cast<int>(ret));
+            int pos;
+            while ((pos = client.tail.indexOf("\033[5n")) != -1) {
+                const ssize_t written = write(client.fd, "\033[0n", 4);
+                (void)written;
+                client.tail.remove(0, pos + 4);
+            }
+            // only keep a possibly incomplete request
+            if (client.tail.size() > 3) {
+                client.tail.remove(0, client.tail.size() - 3);
+            }
+        }
+    }
+
+    class SessionRoot : public Tui::ZRoot {
+    public:
+        void paintEvent(Tui::ZPaintEvent *event) override {
+            Tui::ZRoot::paintEvent(event);
+            auto *painter = event->painter();
+            for (int y = 1; y < geometry().height() - 1; y += 2) {
+                painter->writeWithColors(2, y, QStringLiteral("session output line %1, frame %2").arg(y).arg(frame),
+                                         Tui::Colors::brightWhite, Tui::Colors::blue);
+            }
+        }
+
+        int frame = 0;
+    };
+}
+
+TEST_CASE("terminal server 500 sessions", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    const int sessionCount = 500;
+
+    // Each session needs two file descriptors in this process.
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < 4 * sessionCount) {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, 4 * sessionCount);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    Tui::ZTerminalServer server;
+    server.setTerminalOptions(Tui::ZTerminal::ForceIncompatibleTerminals
+                              | Tui::ZTerminal::DisableAutoDetectTimeoutMessage);
+    server.setInitialSessionSize({80, 24});
+
+    QVector<Client> clients;
+    QVector<Tui::ZTerminal*> terminals;
+    std::vector<std::unique_ptr<SessionRoot>> roots;
+
+    QElapsedTimer timer;
+    timer.start();
+    const int64_t allocationsBeforeSetup = allocationCount();
+    for (int i = 0; i < sessionCount; i++) {
+        int fds[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+        Tui::ZTerminal *terminal = server.addSession(fds[0]);
+        REQUIRE(terminal != nullptr);
+        terminals.append(terminal);
+        Client client;
+        client.fd = fds[1];
+        clients.append(client);
+        roots.push_back(std::make_unique<SessionRoot>());
+        terminal->setMainWidget(roots.back().get());
+    }
+    const int64_t setupAllocations = allocationCount() - allocationsBeforeSetup;
+
+    auto pumpAll = [&] {
+        QCoreApplication::processEvents();
+        for (Client &client : clients) {
+            pumpClient(client);
+        }
+    };
+
+    auto allDetected = [&] {
+        for (Tui::ZTerminal *terminal : terminals) {
+            if (terminal->terminalDetectionResultText().isEmpty()) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    while (!allDetected() && !timer.hasExpired(60000)) {
+        pumpAll();
+    }
+    REQUIRE(allDetected());
+    REQUIRE(server.sessionCount() == sessionCount);
+    WARN("setup and terminal detection of " << sessionCount << " sessions: " << timer.elapsed() << "ms, "
+         << setupAllocations / sessionCount << " allocations per session setup");
+
+    auto renderAll = [&] {
+        for (int i = 0; i < sessionCount; i++) {
+            roots[i]->frame++;
+            roots[i]->update();
+            terminals[i]->forceRepaint();
+        }
+        pumpAll();
+        return clients[0].bytesReceived;
+    };
+
+    BENCHMARK("render one frame in each of 500 sessions") {
+        return renderAll();
+    };
+
+    // Per session accounting
+    qint64 bytesSentBefore = 0;
+    for (Tui::ZTerminal *terminal : terminals) {
+        bytesSentBefore += server.sessionStatistics(terminal).bytesSent;
+    }
+    const int64_t allocationsBefore = allocationCount();
+    const int frames = 10;
+    for (int i = 0; i < frames; i++) {
+        renderAll();
+    }
+    const int64_t allocations = allocationCount() - allocationsBefore;
+    qint64 bytesSent = 0;
+    qint64 maxBytesQueued = 0;
+    for (Tui::ZTerminal *terminal : terminals) {
+        const auto statistics = server.sessionStatistics(terminal);
+        bytesSent += statistics.bytesSent;
+        maxBytesQueued = std::max(maxBytesQueued, statistics.maxBytesQueued);
+    }
+    WARN("per session and frame: " << (bytesSent - bytesSentBefore) / sessionCount / frames << " bytes sent, "
+         << allocations / sessionCount / frames << " allocations; max queued output of any session: "
+         << maxBytesQueued << " bytes");
+
+    // Disconnect all clients, the server closes the sessions.
+    for (Client &client : clients) {
+        ::close(client.fd);
+    }
+    timer.restart();
+    while (server.sessionCount() && !timer.hasExpired(10000)) {
+        QCoreApplication::processEvents();
+    }
+    CHECK(server.sessionCount() == 0);
+}
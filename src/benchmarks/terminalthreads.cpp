@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTerminal.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <QAtomicInteger>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+
+#include <Tui/ZColor.h>
+#include <Tui/ZEvent.h>
+#include <Tui/ZPainter.h>
+#include <Tui/ZRoot.h>
+
+#include "alloccounter.h"
+
+namespace {
+    class CounterRoot : public Tui::ZRoot {
+    public:
+        void paintEvent(Tui::ZPaintEvent *event) override {
+            Tui::ZRoot::paintEvent(event);
+            auto *painter = event->painter();
+            for (int y = 1; y < geometry().height() - 1; y++) {
+                painter->writeWithColors(2, y, QStringLiteral("terminal line %1, frame %2").arg(y).arg(frame),
+                                         Tui::Colors::brightWhite, Tui::Colors::blue);
+            }
+        }
+
+        int frame = 0;
+    };
+
+    struct Worker {
+        std::unique_ptr<QThread> thread;
+        QVector<Tui::ZTerminal*> terminals;
+        QVector<CounterRoot*> roots;
+    };
+}
+
+TEST_CASE("terminal threads", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    const int terminalCount = 64;
+    const int runMs = 500;
+    const int maxThreads = std::max(1, QThread::idealThreadCount());
+
+    for (int threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+        std::vector<Worker> workers(threadCount);
+        for (Worker &worker : workers) {
+            worker.thread = std::make_unique<QThread>();
+            worker.thread->start();
+        }
+
+        for (int i = 0; i < terminalCount; i++) {
+            Worker &worker = workers[i % threadCount];
+            auto *terminal = new Tui::ZTerminal(Tui::ZTerminal::OffScreen(120, 40));
+            auto *root = new CounterRoot();
+            terminal->setMainWidget(root);
+            REQUIRE(terminal->moveToThreadWithWidgets(worker.thread.get()));
+            worker.terminals.append(terminal);
+            worker.roots.append(root);
+        }
+
+        // Each worker renders its terminals until the time is up and then deletes them.
+        QAtomicInteger<qint64> frames = 0;
+        const int64_t allocationsBefore = allocationCount();
+        QElapsedTimer timer;
+        timer.start();
+        for (Worker &worker : workers) {
+            Worker *w = &worker;
+            QTimer::singleShot(0, w->terminals.first(), [w, &frames, runMs] {
+                QElapsedTimer workerTimer;
+                workerTimer.start();
+                qint64 workerFrames = 0;
+                while (!workerTimer.hasExpired(runMs)) {
+                    for (int i = 0; i < w->terminals.size(); i++) {
+                        w->roots[i]->frame++;
+                        w->roots[i]->update();
+                        w->terminals[i]->forceRepaint();
+                        workerFrames++;
+                    }
+                }
+                frames.fetchAndAddRelaxed(workerFrames);
+                for (int i = 0; i < w->terminals.size(); i++) {
+                    delete w->terminals[i];
+                    delete w->roots[i];
+                }
+                QThread::currentThread()->quit();
+            });
+        }
+        for (Worker &worker : workers) {
+            REQUIRE(worker.thread->wait(60000));
+        }
+        const qint64 elapsed = timer.elapsed();
+        const int64_t allocations = allocationCount() - allocationsBefore;
+
+        WARN(threadCount << " threads, " << terminalCount << " terminals: "
+             << frames.loadAcquire() * 1000 / std::max<qint64>(1, elapsed) << " frames/s, "
+             << allocations / std::max<qint64>(1, frames.loadAcquire()) << " allocations per frame");
+    }
+}
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTextEdit.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QVector>
+
+#include <Tui/ZDocument.h>
+#include <Tui/ZDocumentCursor.h>
+#include <Tui/ZRoot.h>
+#include <Tui/ZTerminal.h>
+#include <Tui/ZTextLayout.h>
+#include <Tui/ZTextMetrics.h>
+
+TEST_CASE("textedit multi cursor", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{80, 24}};
+    Tui::ZRoot root;
+    terminal.setMainWidget(&root);
+
+    const int cursorCount = GENERATE(1000, 10000);
+
+    QString text;
+    for (int i = 0; i < cursorCount; i++) {
+        text += QStringLiteral("    value_%1 = compute(%1);\n").arg(i);
+    }
+
+    Tui::ZTextEdit edit(terminal.textMetrics(), &root);
+    edit.setGeometry({0, 0, 80, 24});
+
+    QVector<Tui::ZDocumentCursor::Position> positions;
+    for (int i = 1; i < cursorCount; i++) {
+        positions.append({4, i});
+    }
+
+    BENCHMARK("insert at " + std::to_string(cursorCount) + " cursors") {
+        edit.document()->setText(text);
+        edit.setCursorPosition({4, 0});
+        edit.setAdditionalCursorPositions(positions);
+        edit.insertText(QStringLiteral("const "));
+        return edit.document()->lineCount();
+    };
+
+    // Baseline: the same edit done with one document operation per cursor.
+    BENCHMARK("insert at " + std::to_string(cursorCount) + " cursors sequentially") {
+        edit.document()->setText(text);
+        auto textMetrics = terminal.textMetrics();
+        Tui::ZDocument *doc = edit.document();
+        std::vector<std::unique_ptr<Tui::ZDocumentCursor>> cursors;
+        for (int i = 0; i < cursorCount; i++) {
+            cursors.push_back(std::make_unique<Tui::ZDocumentCursor>(doc,
+                [&textMetrics, doc](int line, bool /* wrappingAllowed */) {
+                    Tui::ZTextLayout lay(textMetrics, doc->line(line));
+                    lay.doLayout(65000);
+                    return lay;
+                }));
+            cursors.back()->setPosition({4, i});
+        }
+        auto undoGroup = doc->startUndoGroup(cursors.front().get());
+        for (auto &cur: cursors) {
+            cur->insertText(QStringLiteral("const "));
+        }
+        return doc->lineCount();
+    };
+
+    edit.document()->setText(text);
+    edit.setCursorPosition({4, 0});
+    edit.setAdditionalCursorPositions(positions);
+
+    BENCHMARK("type and undo at " + std::to_string(cursorCount) + " cursors") {
+        edit.insertText(QStringLiteral("x"));
+        // undo keeps the document size stable across iterations
+        edit.undo();
+        return edit.document()->lineCount();
+    };
+}
+
+TEST_CASE("textedit long line", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{80, 24}};
+    Tui::ZRoot root;
+    terminal.setMainWidget(&root);
+
+    // A minified json like line of about 10MB.
+    QString text;
+    text.reserve(10 * 1024 * 1024);
+    for (int i = 0; text.size() < 10 * 1024 * 1024; i++) {
+        text += QStringLiteral("{\"id\":%1,\"name\":\"item %1\",\"tags\":[\"a\",\"b\"]},").arg(i);
+    }
+    const int length = static_cast<int>(text.size());
+
+    Tui::ZTextEdit edit(terminal.textMetrics(), &root);
+    edit.setGeometry({0, 0, 80, 24});
+    edit.setFocus();
+    edit.setWordWrapMode(Tui::ZTextOption::NoWrap);
+    edit.document()->setText(text);
+
+    edit.setCursorPosition({length / 2, 0});
+    terminal.forceRepaint();
+
+    // Scrolling without moving the cursor, only the painting of the visible part is measured.
+    edit.enableDetachedScrolling();
+    int column = edit.scrollPositionColumn();
+    BENCHMARK("scroll and repaint in the middle of a 10MB line") {
+        column += 100;
+        edit.setScrollPosition(column, 0, 0);
+        terminal.forceRepaint();
+        return edit.scrollPositionColumn();
+    };
+    edit.disableDetachedScrolling();
+
+    int position = length / 2;
+    BENCHMARK("move cursor and repaint in the middle of a 10MB line") {
+        position += 100;
+        edit.setCursorPosition({position, 0});
+        terminal.forceRepaint();
+        return edit.scrollPositionColumn();
+    };
+
+    BENCHMARK("move cursor by character in the middle of a 10MB line") {
+        Tui::ZDocumentCursor cursor = edit.textCursor();
+        cursor.moveCharacterRight();
+        cursor.moveCharacterLeft();
+        return cursor.position().codeUnit;
+    };
+
+    BENCHMARK("insert and repaint in the middle of a 10MB line") {
+        edit.insertText(QStringLiteral("x"));
+        terminal.forceRepaint();
+        // undo keeps the document size stable across iterations
+        edit.undo();
+        return edit.scrollPositionColumn();
+    };
+}
+
+TEST_CASE("textedit rewrap", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{120, 40}};
+    Tui::ZRoot root;
+    terminal.setMainWidget(&root);
+
+    QString text;
+    const QString sentence = QStringLiteral("The quick brown fox jumps over the lazy dog, again and again. ");
+    for (int i = 0; i < 100000; i++) {
+        text += sentence.repeated(1 + i % 4);
+        text += QLatin1Char('\n');
+    }
+
+    Tui::ZTextEdit edit(terminal.textMetrics(), &root);
+    edit.setGeometry({0, 0, 120, 40});
+    edit.setWordWrapMode(Tui::ZTextOption::WordWrap);
+    edit.document()->setText(text);
+    edit.setCursorPosition({0, 50000});
+
+    int width = 120;
+
+    // Time until the first frame after a resize is painted.
+    BENCHMARK("resize and repaint 100k lines") {
+        width = width > 40 ? width - 1 : 120;
+        edit.setGeometry({0, 0, width, 40});
+        terminal.forceRepaint();
+        return edit.visualLineCount();
+    };
+
+    // Time until the visual line count of the whole document is final after a resize.
+    BENCHMARK("resize and wait for visual line count of 100k lines") {
+        width = width > 40 ? width - 1 : 120;
+        edit.setGeometry({0, 0, width, 40});
+        while (edit.isRewrapInProgress()) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+        }
+        return edit.visualLineCount();
+    };
+}
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTextLayout.h>
+
+#include "../tests/catchwrapper.h"
+
+#include <vector>
+
+#include <QCoreApplication>
+#include <QVector>
+
+#include <Tui/ZFormatRange.h>
+#include <Tui/ZImage.h>
+#include <Tui/ZPainter.h>
+#include <Tui/ZTerminal.h>
+#include <Tui/ZTextMetrics.h>
+#include <Tui/ZTextOption.h>
+#include <Tui/ZTextStyle.h>
+
+#include "alloccounter.h"
+
+TEST_CASE("textlayout draw", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{200, 100}};
+    auto textMetrics = terminal.textMetrics();
+
+    const bool showTabsAndSpaces = GENERATE(false, true);
+
+    Tui::ZTextOption option;
+    option.setTabStopDistance(4);
+    if (showTabsAndSpaces) {
+        option.setFlags(Tui::ZTextOption::ShowTabsAndSpaces);
+    }
+
+    // About one screen of source code, as drawn by ZTextEdit in one frame.
+    const int lineCount = 100;
+    std::vector<Tui::ZTextLayout> layouts;
+    for (int i = 0; i < lineCount; i++) {
+        Tui::ZTextLayout lay(textMetrics, QStringLiteral("\tif (value_%1 != nullptr && äöü[%1] > 0) {  // ✓ comment %1")
+                                          .arg(i));
+        lay.setTextOption(option);
+        lay.doLayout(200);
+        layouts.push_back(lay);
+    }
+
+    // a selection and a search match per line, like in a text editor
+    const Tui::ZTextStyle base{Tui::Colors::lightGray, Tui::Colors::black};
+    const Tui::ZTextStyle selected{Tui::Colors::black, Tui::Colors::lightGray};
+    const QVector<Tui::ZFormatRange> highlights = {
+        Tui::ZFormatRange{5, 10, selected, selected},
+        Tui::ZFormatRange{30, 6, selected, selected},
+    };
+
+    Tui::ZImage image{&terminal, 200, 100};
+    Tui::ZPainter painter = image.painter();
+
+    auto drawAll = [&] {
+        for (int i = 0; i < lineCount; i++) {
+            layouts[i].draw(painter, {0, i}, base, &base, highlights);
+        }
+    };
+
+    drawAll(); // warm up
+
+    const int64_t before = allocationCount();
+    drawAll();
+    const int64_t after = allocationCount();
+    if (before >= 0) {
+        // The remaining allocations per line are the ZPainter copies required by the by-value draw API.
+        WARN("allocations per drawn line" << (showTabsAndSpaces ? " (show tabs and spaces): " : ": ")
+             << double(after - before) / lineCount);
+    }
+
+    BENCHMARK("draw " + std::to_string(lineCount) + " lines" + (showTabsAndSpaces ? " show tabs and spaces" : "")) {
+        drawAll();
+        return lineCount;
+    };
+}
+
+TEST_CASE("textlayout long line", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{200, 100}};
+    auto textMetrics = terminal.textMetrics();
+
+    // 1MB of minified JSON like text in a single line
+    QString text;
+    while (text.size() < 1024 * 1024) {
+        text += QStringLiteral("{\"id\":%1,\"name\":\"entry %1\",\"tags\":[\"a\",\"b\"],\"value\":%1.5},").arg(text.size());
+    }
+
+    const bool wrap = GENERATE(false, true);
+    const std::string suffix = wrap ? " wrapped" : " no wrap";
+
+    Tui::ZTextOption option;
+    option.setWrapMode(wrap ? Tui::ZTextOption::WrapAnywhere : Tui::ZTextOption::NoWrap);
+
+    Tui::ZTextLayout lay(textMetrics, text);
+    lay.setTextOption(option);
+
+    BENCHMARK("layout 1MB line" + suffix) {
+        lay.doLayout(200);
+        return lay.lineCount();
+    };
+
+    lay.doLayout(200);
+    const Tui::ZTextLineRef lastLine = lay.lineAt(lay.lineCount() - 1);
+
+    BENCHMARK("cursorToX 1MB line" + suffix) {
+        int sum = 0;
+        for (int i = 0; i < 1000; i++) {
+            const int pos = text.size() - 1 - i * 997;
+            sum += lay.lineForTextPosition(pos).cursorToX(pos, Tui::ZTextLayout::Leading);
+        }
+        return sum;
+    };
+
+    BENCHMARK("xToCursor 1MB line" + suffix) {
+        int sum = 0;
+        for (int i = 0; i < 1000; i++) {
+            sum += lastLine.xToCursor(lastLine.width() - i * 7);
+        }
+        return sum;
+    };
+
+    Tui::ZImage image{&terminal, 200, 100};
+    const Tui::ZTextStyle base{Tui::Colors::lightGray, Tui::Colors::black};
+
+    BENCHMARK("draw end of 1MB line" + suffix) {
+        lastLine.draw(image.painter(), {-lastLine.width() + 200, 0}, base, base, {});
+        return 0;
+    };
+}
+
+TEST_CASE("textlayout rewrap", "[benchmark]") {
+    static char prgname[] = "bench";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen{200, 100}};
+    auto textMetrics = terminal.textMetrics();
+
+    // 100k lines of prose, every 1000th line is a long paragraph.
+    const int lineCount = 100000;
+    const QString sentence = QStringLiteral("The quick brown fox jumps over the lazy dog, again and again. ");
+    std::vector<QString> lines;
+    lines.reserve(lineCount);
+    for (int i = 0; i < lineCount; i++) {
+        lines.push_back(sentence.repeated(i % 1000 == 0 ? 100 : 1 + i % 3));
+    }
+
+    Tui::ZTextOption option;
+    option.setWrapMode(Tui::ZTextOption::WordWrap);
+
+    // Like a terminal being resized, each iteration re-wraps all lines at the next width.
+    int width = 120;
+    BENCHMARK("rewrap 100k lines at successive widths") {
+        width = width > 40 ? width - 1 : 120;
+        int visualLines = 0;
+        for (const QString &line: lines) {
+            Tui::ZTextLayout lay(textMetrics, line);
+            lay.setTextOption(option);
+            lay.doLayout(width);
+            visualLines += lay.lineCount();
+        }
+        return visualLines;
+    };
+
+    // A single long paragraph, previously each wrap scanned the rest of the paragraph.
+    const QString paragraph = sentence.repeated(16 * 1024);
+    BENCHMARK("wrap 1MB paragraph") {
+        width = width > 40 ? width - 1 : 120;
+        Tui::ZTextLayout lay(textMetrics, paragraph);
+        lay.setTextOption(option);
+        lay.doLayout(width);
+        return lay.lineCount();
+    };
+}
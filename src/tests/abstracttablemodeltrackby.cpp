@@ -194,6 +194,86 @@ TEST_CASE("abstracttablemodeltrackby-add-add-swap", "") {
     CHECK(recorder.noMoreSignal());
 }
 
+TEST_CASE("abstracttablemodeltrackby-blocks", "") {
+    Tui::Misc::AbstractTableModelTrackBy<int> model(1);
+#ifdef MODELTESTER_COMPAT
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::Fatal);
+#endif
+
+    PermanetIndexChecker pidxChecker;
+
+    SignalRecorder recorder;
+    recordAllModelSignals(recorder, &model);
+
+    auto makeRows = [](QVector<int> keys, QVector<int> changedKeys = {}) {
+        QVector<Row> rows;
+        for (int key: keys) {
+            const QString suffix = changedKeys.contains(key) ? QStringLiteral(".1") : QString();
+            rows.append({ key, {{{Qt::DisplayRole, v(QStringLiteral("row%1").arg(key) + suffix)}}}});
+        }
+        return rows;
+    };
+
+    auto checkRows = [&model](QVector<int> keys) {
+        REQUIRE(model.rowCount() == keys.size());
+        for (int i = 0; i < keys.size(); i++) {
+            CHECK(model.index(i, 0).data().toString().startsWith(QStringLiteral("row%1").arg(keys[i])));
+        }
+    };
+
+    model.setData(makeRows({1, 2, 3, 4, 5, 6}));
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsAboutToBeInserted, QModelIndex(), 0, 5));
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsInserted, QModelIndex(), 0, 5));
+    CHECK(recorder.noMoreSignal());
+
+    // adjacent rows are removed together
+    pidxChecker.prepare(model);
+    model.setData(makeRows({1, 4, 5, 6}));
+    CHECK(pidxChecker.check() == 4);
+    checkRows({1, 4, 5, 6});
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsAboutToBeRemoved, QModelIndex(), 1, 2));
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsRemoved, QModelIndex(), 1, 2));
+    CHECK(recorder.noMoreSignal());
+
+    // adjacent rows are inserted together
+    pidxChecker.prepare(model);
+    model.setData(makeRows({1, 7, 8, 4, 5, 6}));
+    CHECK(pidxChecker.check() == 4);
+    checkRows({1, 7, 8, 4, 5, 6});
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsAboutToBeInserted, QModelIndex(), 1, 2));
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsInserted, QModelIndex(), 1, 2));
+    CHECK(recorder.noMoreSignal());
+
+    // rows that keep their relative order are moved together
+    pidxChecker.prepare(model);
+    model.setData(makeRows({7, 8, 4, 5, 6, 1}));
+    CHECK(pidxChecker.check() == 6);
+    checkRows({7, 8, 4, 5, 6, 1});
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsAboutToBeMoved, QModelIndex(), 1, 5, QModelIndex(), 0));
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsMoved, QModelIndex(), 1, 5, QModelIndex(), 0));
+    CHECK(recorder.noMoreSignal());
+
+    // changes in adjacent rows are reported together
+    model.setData(makeRows({7, 8, 4, 5, 6, 1}, {4, 5, 1}));
+    CHECK(model.index(2, 0).data().toString() == "row4.1");
+    CHECK(model.index(3, 0).data().toString() == "row5.1");
+    CHECK(model.index(5, 0).data().toString() == "row1.1");
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::dataChanged, model.index(2, 0), model.index(3, 0), QVector<int>()));
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::dataChanged, model.index(5, 0), model.index(5, 0), QVector<int>()));
+    CHECK(recorder.noMoreSignal());
+
+    // unchanged data does not emit signals
+    model.setData(makeRows({7, 8, 4, 5, 6, 1}, {4, 5, 1}));
+    CHECK(recorder.noMoreSignal());
+
+    model.setData({});
+    model.setData({});
+    CHECK(model.rowCount() == 0);
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsAboutToBeRemoved, QModelIndex(), 0, 5));
+    CHECK(recorder.consumeFirst(&QAbstractItemModel::rowsRemoved, QModelIndex(), 0, 5));
+    CHECK(recorder.noMoreSignal());
+}
+
 TEST_CASE("abstracttablemodeltrackby-random", "") {
     Tui::Misc::AbstractTableModelTrackBy<int> model(1);
 #ifdef MODELTESTER_COMPAT
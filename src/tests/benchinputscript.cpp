@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "../benchmarks/driver/inputscript.h"
+
+#include "catchwrapper.h"
+
+TEST_CASE("bench-inputscript-parse", "") {
+    SECTION("commands") {
+        InputScript script;
+        QString error;
+        REQUIRE(script.parse(QStringLiteral("# comment\n"
+                                            "setup textedit\n"
+                                            "size 80 24\r\n"
+                                            "\n"
+                                            "key Down\n"
+                                            "key Left ctrl+shift\n"
+                                            "text x alt\n"
+                                            "type a b\\n\n"
+                                            "paste first\\nsecond\\\\\n"
+                                            "repeat 3 key PageDown\n"), &error));
+        CHECK(script.setup == QStringLiteral("textedit"));
+        CHECK(script.size == QSize{80, 24});
+
+        REQUIRE(script.events.size() == 11);
+        CHECK(script.events[0].type == InputEvent::Type::Key);
+        CHECK(script.events[0].key == Tui::Key_Down);
+        CHECK(script.events[0].modifiers == Tui::KeyboardModifiers{});
+
+        CHECK(script.events[1].type == InputEvent::Type::Key);
+        CHECK(script.events[1].key == Tui::Key_Left);
+        CHECK(script.events[1].modifiers == (Tui::ControlModifier | Tui::ShiftModifier));
+
+        CHECK(script.events[2].type == InputEvent::Type::Text);
+        CHECK(script.events[2].text == QStringLiteral("x"));
+        CHECK(script.events[2].modifiers == Tui::AltModifier);
+
+        // type sends one event per character, spaces and new lines as keys
+        CHECK(script.events[3].type == InputEvent::Type::Text);
+        CHECK(script.events[3].text == QStringLiteral("a"));
+        CHECK(script.events[4].type == InputEvent::Type::Key);
+        CHECK(script.events[4].key == Tui::Key_Space);
+        CHECK(script.events[5].type == InputEvent::Type::Text);
+        CHECK(script.events[5].text == QStringLiteral("b"));
+        CHECK(script.events[6].type == InputEvent::Type::Key);
+        CHECK(script.events[6].key == Tui::Key_Enter);
+
+        CHECK(script.events[7].type == InputEvent::Type::Paste);
+        CHECK(script.events[7].text == QStringLiteral("first\nsecond\\"));
+
+        for (int i = 8; i < 11; i++) {
+            CAPTURE(i);
+            CHECK(script.events[i].type == InputEvent::Type::Key);
+            CHECK(script.events[i].key == Tui::Key_PageDown);
+        }
+    }
+
+    SECTION("defaults") {
+        InputScript script;
+        QString error;
+        REQUIRE(script.parse(QString::fromUtf8("type \xf0\x9f\x98\x80"), &error));
+        CHECK(script.setup == QString());
+        CHECK(script.size == QSize{120, 40});
+        // a surrogate pair is a single event
+        REQUIRE(script.events.size() == 1);
+        CHECK(script.events[0].type == InputEvent::Type::Text);
+        CHECK(script.events[0].text == QString::fromUtf8("\xf0\x9f\x98\x80"));
+    }
+
+    SECTION("errors") {
+        struct TestCase {
+            QString source;
+            QString error;
+        };
+        const TestCase testCases[] = {
+            {QStringLiteral("bogus"), QStringLiteral("line 1: unknown command: bogus")},
+            {QStringLiteral("size 10"), QStringLiteral("line 1: expected width and height")},
+            {QStringLiteral("size 0 10"), QStringLiteral("line 1: expected width and height")},
+            {QStringLiteral("# comment\nkey Nope"), QStringLiteral("line 2: unknown key: Nope")},
+            {QStringLiteral("key"), QStringLiteral("line 1: expected key and optional modifiers")},
+            {QStringLiteral("key Left hyper"), QStringLiteral("line 1: unknown modifiers: hyper")},
+            {QStringLiteral("text \\n"), QStringLiteral("line 1: use key Enter instead of text \\n")},
+            {QStringLiteral("repeat 0 key Down"), QStringLiteral("line 1: expected repeat count")},
+            {QStringLiteral("repeat 2 frobnicate"), QStringLiteral("line 1: unknown command: frobnicate")},
+        };
+        for (const TestCase &testCase : testCases) {
+            CAPTURE(testCase.source);
+            InputScript script;
+            QString error;
+            CHECK(!script.parse(testCase.source, &error));
+            CHECK(error == testCase.error);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "catchwrapper.h"
+
+#include <random>
+
+#include "Tui/Compression_p.h"
+
+TEST_CASE("lz compression roundtrip") {
+    const int alphabet = GENERATE(1, 2, 26, 256);
+    CAPTURE(alphabet);
+
+    // unseeded is ok, results just need to be reproducible
+    std::mt19937 random;
+    for (int size : {0, 1, 3, 4, 5, 100, 5000}) {
+        CAPTURE(size);
+        QByteArray input;
+        for (int i = 0; i < size; i++) {
+            if (input.size() > 10 && random() % 3 == 0) {
+                // repeat an earlier part, possibly overlapping with the repeated data
+                const int offset = 1 + random() % input.size();
+                for (int j = 0; j < 20 && input.size() < size; j++) {
+                    input.append(input[input.size() - offset]);
+                }
+            } else {
+                input.append(static_cast<char>(random() % alphabet));
+            }
+        }
+        const QByteArray compressed = Tui::Private::lzCompress(input.constData(), input.size());
+        QByteArray output;
+        REQUIRE(Tui::Private::lzDecompress(compressed.constData(), compressed.size(), input.size(), &output));
+        CHECK(output == input);
+        if (alphabet == 1 && size == 5000) {
+            CHECK(compressed.size() < 20);
+        }
+    }
+}
+
+TEST_CASE("lz decompression rejects invalid data") {
+    QByteArray output;
+    // literal count beyond the end of the data
+    CHECK(!Tui::Private::lzDecompress("\x05" "ab", 3, 5, &output));
+    // match before the start of the output
+    CHECK(!Tui::Private::lzDecompress("\x01" "a" "\x00" "\x02", 4, 5, &output));
+    // match with offset 0
+    CHECK(!Tui::Private::lzDecompress("\x01" "a" "\x00" "\x00", 4, 5, &output));
+    // output longer than announced
+    CHECK(!Tui::Private::lzDecompress("\x01" "a" "\x10" "\x01", 4, 5, &output));
+    // output shorter than announced
+    CHECK(!Tui::Private::lzDecompress("\x01" "a", 2, 5, &output));
+    // truncated varint
+    CHECK(!Tui::Private::lzDecompress("\x80", 1, 5, &output));
+
+    CHECK(Tui::Private::lzDecompress("\x01" "a" "\x00" "\x01", 4, 5, &output));
+    CHECK(output == "aaaaa");
+}
@@ -10,6 +10,9 @@
 
 #include <QBuffer>
 #include <QCoreApplication>
+#include <QFile>
+#include <QSet>
+#include <QTemporaryDir>
 
 #include <Tui/ZTerminal.h>
 #include <Tui/ZTextMetrics.h>
@@ -1946,6 +1949,31 @@ TEST_CASE("ZDocument") {
     }
 
 
+    SECTION("line revisions of new lines") {
+        // Lines that are loaded or inserted get a revision that no other line had before.
+        doc.setText("same\nsame\nsame");
+        REQUIRE(doc.lineCount() == 3);
+        QSet<unsigned> revisions;
+        for (int i = 0; i < doc.lineCount(); i++) {
+            revisions.insert(doc.lineRevision(i));
+        }
+        CHECK(revisions.size() == 3);
+
+        cursor.setPosition({2, 1});
+        cursor.insertText("\n");
+        REQUIRE(doc.lineCount() == 4);
+        CHECK(!revisions.contains(doc.lineRevision(1)));
+        CHECK(!revisions.contains(doc.lineRevision(2)));
+        CHECK(doc.lineRevision(1) != doc.lineRevision(2));
+        revisions.insert(doc.lineRevision(1));
+        revisions.insert(doc.lineRevision(2));
+
+        doc.setText("same\nsame\nsame");
+        for (int i = 0; i < doc.lineCount(); i++) {
+            CHECK(!revisions.contains(doc.lineRevision(i)));
+        }
+    }
+
     SECTION("userdata") {
         cursor.insertText("test\ntest");
         REQUIRE(doc.lineCount() == 2);
@@ -2062,6 +2090,73 @@ TEST_CASE("ZDocument") {
         CHECK(snap3.lineUserData(1) == nullptr);
     }
 
+    SECTION("snapshot writeToFileAsync") {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        const QString filename = dir.filePath("out.txt");
+
+        auto readBack = [&] {
+            QFile file(filename);
+            REQUIRE(file.open(QIODevice::ReadOnly));
+            return file.readAll();
+        };
+
+        SECTION("simple") {
+            cursor.insertText("line1\nline2\n");
+            Tui::ZDocumentSnapshot snap = doc.snapshot();
+            CHECK(snap.newlineAfterLastLineMissing() == false);
+            QFuture<bool> future = snap.writeToFileAsync(filename);
+            future.waitForFinished();
+            CHECK(future.result() == true);
+            CHECK(readBack() == QByteArray("line1\nline2\n\n"));
+        }
+
+        SECTION("crlf - missing last linebreak") {
+            cursor.insertText("line1\nline2");
+            doc.setNewlineAfterLastLineMissing(true);
+            Tui::ZDocumentSnapshot snap = doc.snapshot();
+            CHECK(snap.newlineAfterLastLineMissing() == true);
+            QFuture<bool> future = snap.writeToFileAsync(filename, true);
+            future.waitForFinished();
+            CHECK(future.result() == true);
+            CHECK(readBack() == QByteArray("line1\r\nline2"));
+        }
+
+        SECTION("same as writeTo") {
+            // not valid utf8 and lines longer than the internal chunk size
+            QByteArray inData = QByteArray("li\x80\x89\xa0\xff\1451\nline2\n", 15);
+            inData += QByteArray(1024 * 1024, 'a') + "\n\xff\n" + QByteArray(1024, 'b');
+            QBuffer inFile(&inData);
+            REQUIRE(inFile.open(QIODevice::ReadOnly));
+            doc.readFrom(&inFile);
+
+            QFuture<bool> future = doc.snapshot().writeToFileAsync(filename, doc.crLfMode());
+            future.waitForFinished();
+            CHECK(future.result() == true);
+            CHECK(future.progressValue() == doc.lineCount());
+            CHECK(readBack() == inData);
+        }
+
+        SECTION("replaces existing file") {
+            {
+                QFile file(filename);
+                REQUIRE(file.open(QIODevice::WriteOnly));
+                file.write("old contents that is longer than the new contents\n");
+            }
+            cursor.insertText("new");
+            QFuture<bool> future = doc.snapshot().writeToFileAsync(filename);
+            future.waitForFinished();
+            CHECK(future.result() == true);
+            CHECK(readBack() == QByteArray("new\n"));
+        }
+
+        SECTION("error") {
+            QFuture<bool> future = doc.snapshot().writeToFileAsync(dir.filePath("does-not-exist/out.txt"));
+            future.waitForFinished();
+            CHECK(future.result() == false);
+        }
+    }
+
     SECTION("overwriteText") {
         cursor.insertText("test test\ntest test");
         cursor.setPosition({0, 0});
@@ -10,6 +10,7 @@
 
 #include <QBuffer>
 #include <QCoreApplication>
+#include <QStringList>
 
 #include <Tui/ZTerminal.h>
 #include <Tui/ZTextMetrics.h>
@@ -1811,6 +1812,93 @@ TEST_CASE("Cursor") {
         CHECK(cursor2.hasSelection() == true);
     }
 
+    SECTION("sort case insensitive") {
+        cursor1.selectAll();
+        cursor1.insertText("b\nB\na\nA");
+
+        doc.sortLines(0, 4, &cursor2, Tui::ZDocument::SortCaseInsensitive);
+        REQUIRE(doc.lineCount() == 4);
+        CHECK(doc.line(0) == "a");
+        CHECK(doc.line(1) == "A");
+        CHECK(doc.line(2) == "b");
+        CHECK(doc.line(3) == "B");
+    }
+
+    SECTION("sort numeric") {
+        cursor1.selectAll();
+        cursor1.insertText("10\n 9\n-1\nx\n2.5\n+2.25");
+
+        doc.sortLines(0, 6, &cursor2, Tui::ZDocument::SortNumeric);
+        REQUIRE(doc.lineCount() == 6);
+        CHECK(doc.line(0) == "-1");
+        CHECK(doc.line(1) == "x");
+        CHECK(doc.line(2) == "+2.25");
+        CHECK(doc.line(3) == "2.5");
+        CHECK(doc.line(4) == " 9");
+        CHECK(doc.line(5) == "10");
+    }
+
+    SECTION("sort locale aware") {
+        cursor1.selectAll();
+        cursor1.insertText("c\na\nb");
+
+        doc.sortLines(0, 3, &cursor2, Tui::ZDocument::SortLocaleAware);
+        REQUIRE(doc.lineCount() == 3);
+        CHECK(doc.line(0) == "a");
+        CHECK(doc.line(1) == "b");
+        CHECK(doc.line(2) == "c");
+    }
+
+    SECTION("sort large") {
+        // Large enough to use the parallel code path
+        const int lineCount = 200000;
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> dist(0, 1000);
+        QStringList lines;
+        for (int i = 0; i < lineCount; i++) {
+            lines.append(QString::number(dist(gen)) + QStringLiteral(" ") + QString::number(i));
+        }
+        const QString original = lines.join(QStringLiteral("\n"));
+
+        cursor1.selectAll();
+        cursor1.insertText(original);
+        cursor1.setPosition({0, 1234});
+        const QString cursorLine = doc.line(1234);
+        Tui::ZDocumentLineMarker marker(&doc, 4321);
+        const QString markerLine = doc.line(4321);
+
+        const auto mode = GENERATE(Tui::ZDocument::SortByCodeUnits, Tui::ZDocument::SortNumeric);
+        CAPTURE(mode);
+
+        doc.sortLines(0, lineCount, &cursor2, mode);
+        REQUIRE(doc.lineCount() == lineCount);
+
+        for (int i = 1; i < lineCount; i++) {
+            if (mode == Tui::ZDocument::SortNumeric) {
+                const int prev = doc.line(i - 1).section(QLatin1Char(' '), 0, 0).toInt();
+                const int cur = doc.line(i).section(QLatin1Char(' '), 0, 0).toInt();
+                REQUIRE(prev <= cur);
+                if (prev == cur) {
+                    // stable
+                    REQUIRE(doc.line(i - 1).section(QLatin1Char(' '), 1, 1).toInt()
+                            < doc.line(i).section(QLatin1Char(' '), 1, 1).toInt());
+                }
+            } else {
+                REQUIRE(doc.line(i - 1) <= doc.line(i));
+            }
+        }
+
+        CHECK(doc.line(cursor1.position().line) == cursorLine);
+        CHECK(doc.line(marker.line()) == markerLine);
+
+        doc.undo(&cursor2);
+        for (int i = 0; i < lineCount; i++) {
+            REQUIRE(doc.line(i) == lines[i]);
+        }
+        CHECK(cursor1.position() == Tui::ZDocumentCursor::Position{0, 1234});
+        CHECK(marker.line() == 4321);
+    }
+
 
     SECTION("select") {
         cursor1.setPosition({0, 2});
@@ -0,0 +1,299 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZDocument.h>
+#include <Tui/ZDocumentCursor.h>
+#include <Tui/ZDocumentLineMarker.h>
+
+#include <functional>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <Tui/ZTerminal.h>
+#include <Tui/ZTextMetrics.h>
+
+#include "../catchwrapper.h"
+#include "../Testhelper.h"
+
+
+namespace {
+    void appendToFile(const QString &filename, const QByteArray &data) {
+        QFile file(filename);
+        REQUIRE(file.open(QIODevice::WriteOnly | QIODevice::Append));
+        REQUIRE(file.write(data) == data.size());
+        file.close();
+    }
+
+    void writeFile(const QString &filename, const QByteArray &data) {
+        QFile file(filename);
+        REQUIRE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        REQUIRE(file.write(data) == data.size());
+        file.close();
+    }
+
+    bool waitUntil(std::function<bool()> condition) {
+        QElapsedTimer timer;
+        timer.start();
+        while (!condition()) {
+            if (timer.hasExpired(10000)) {
+                return false;
+            }
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        }
+        return true;
+    }
+}
+
+TEST_CASE("ZDocument follow") {
+    Testhelper t("unused", "unused", 2, 4);
+    auto textMetrics = t.terminal->textMetrics();
+
+    Tui::ZDocument doc;
+
+    Tui::ZDocumentCursor cursor{&doc, [&textMetrics, &doc](int line, bool /* wrappingAllowed */) {
+            Tui::ZTextLayout lay(textMetrics, doc.line(line));
+            lay.doLayout(65000);
+            return lay;
+        }
+    };
+
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString filename = dir.filePath(QStringLiteral("log.txt"));
+
+    SECTION("missing file") {
+        CHECK(doc.followFile(filename) == false);
+        CHECK(doc.isFollowing() == false);
+    }
+
+    SECTION("initial contents") {
+        writeFile(filename, "line1\nline2\npart");
+        REQUIRE(doc.followFile(filename));
+        CHECK(doc.isFollowing() == true);
+        REQUIRE(doc.lineCount() == 2);
+        CHECK(doc.line(0) == "line1");
+        CHECK(doc.line(1) == "line2");
+        CHECK(doc.isUndoAvailable() == false);
+
+        appendToFile(filename, "ial\nline4\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 4; }));
+        CHECK(doc.line(2) == "partial");
+        CHECK(doc.line(3) == "line4");
+        CHECK(doc.isUndoAvailable() == false);
+        CHECK(doc.isModified() == false);
+    }
+
+    SECTION("empty file") {
+        writeFile(filename, "");
+        REQUIRE(doc.followFile(filename));
+        CHECK(doc.lineCount() == 1);
+        CHECK(doc.line(0) == "");
+
+        appendToFile(filename, "a\n");
+        REQUIRE(waitUntil([&] { return doc.line(0) == "a"; }));
+        CHECK(doc.lineCount() == 1);
+        CHECK(doc.newlineAfterLastLineMissing() == false);
+    }
+
+    SECTION("incomplete line only") {
+        writeFile(filename, "part");
+        // The line had different contents while loading, its revision must differ from that.
+        Tui::ZDocument plainDoc;
+        {
+            QFile file(filename);
+            REQUIRE(file.open(QIODevice::ReadOnly));
+            REQUIRE(plainDoc.readFrom(&file));
+        }
+        REQUIRE(doc.followFile(filename));
+        CHECK(doc.lineCount() == 1);
+        CHECK(doc.line(0) == "");
+        CHECK(doc.lineRevision(0) != plainDoc.lineRevision(0));
+
+        appendToFile(filename, "ial\n");
+        REQUIRE(waitUntil([&] { return doc.line(0) == "partial"; }));
+        CHECK(doc.lineCount() == 1);
+    }
+
+    SECTION("incomplete line is not added") {
+        writeFile(filename, "a\n");
+        REQUIRE(doc.followFile(filename));
+
+        appendToFile(filename, "b");
+        appendToFile(filename, "\nc");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 2; }));
+        CHECK(doc.line(1) == "b");
+
+        appendToFile(filename, "\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 3; }));
+        CHECK(doc.line(2) == "c");
+    }
+
+    SECTION("crlf") {
+        writeFile(filename, "a\r\nb\r\n");
+        REQUIRE(doc.followFile(filename));
+        CHECK(doc.crLfMode() == true);
+
+        appendToFile(filename, "c\r\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 3; }));
+        CHECK(doc.line(2) == "c");
+    }
+
+    SECTION("crlf detected from appended lines") {
+        writeFile(filename, "");
+        REQUIRE(doc.followFile(filename));
+        CHECK(doc.crLfMode() == false);
+
+        appendToFile(filename, "a\r\nb\r\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 2; }));
+        CHECK(doc.crLfMode() == true);
+        CHECK(doc.line(0) == "a");
+        CHECK(doc.line(1) == "b");
+    }
+
+    SECTION("crlf switched off by appended lines") {
+        writeFile(filename, "a\r\n");
+        REQUIRE(doc.followFile(filename));
+        CHECK(doc.crLfMode() == true);
+        const unsigned revision = doc.lineRevision(0);
+
+        appendToFile(filename, "b\r\nc\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 3; }));
+        CHECK(doc.crLfMode() == false);
+        CHECK(doc.line(0) == "a\r");
+        CHECK(doc.lineRevision(0) != revision);
+        CHECK(doc.line(1) == "b\r");
+        CHECK(doc.line(2) == "c");
+    }
+
+    SECTION("cursor at end follows") {
+        writeFile(filename, "a\nb\n");
+        REQUIRE(doc.followFile(filename));
+
+        Tui::ZDocumentCursor cursor2{&doc, [&textMetrics, &doc](int line, bool /* wrappingAllowed */) {
+                Tui::ZTextLayout lay(textMetrics, doc.line(line));
+                lay.doLayout(65000);
+                return lay;
+            }
+        };
+
+        cursor.moveToEndOfDocument();
+        cursor2.setPosition({0, 0});
+
+        appendToFile(filename, "ccc\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 3; }));
+        CHECK(cursor.position() == Tui::ZDocumentCursor::Position{3, 2});
+        CHECK(cursor2.position() == Tui::ZDocumentCursor::Position{0, 0});
+    }
+
+    SECTION("max lines") {
+        writeFile(filename, "1\n2\n3\n4\n");
+        doc.setFollowMaxLines(3);
+        CHECK(doc.followMaxLines() == 3);
+        REQUIRE(doc.followFile(filename));
+        REQUIRE(doc.lineCount() == 3);
+        CHECK(doc.line(0) == "2");
+
+        Tui::ZDocumentLineMarker marker(&doc, 2);
+        cursor.setPosition({0, 1});
+        cursor.setPosition({1, 2}, true);
+
+        appendToFile(filename, "5\n");
+        REQUIRE(waitUntil([&] { return doc.line(2) == "5"; }));
+        CHECK(doc.lineCount() == 3);
+        CHECK(doc.line(0) == "3");
+        CHECK(doc.line(1) == "4");
+        CHECK(marker.line() == 1);
+        CHECK(cursor.anchor() == Tui::ZDocumentCursor::Position{0, 0});
+        CHECK(cursor.position() == Tui::ZDocumentCursor::Position{1, 1});
+
+        appendToFile(filename, "6\n7\n8\n");
+        REQUIRE(waitUntil([&] { return doc.line(2) == "8"; }));
+        CHECK(marker.line() == 0);
+        CHECK(cursor.anchor() == Tui::ZDocumentCursor::Position{0, 0});
+        CHECK(cursor.position() == Tui::ZDocumentCursor::Position{0, 0});
+
+        doc.setFollowMaxLines(2);
+        CHECK(doc.lineCount() == 2);
+        CHECK(doc.line(0) == "7");
+    }
+
+    SECTION("truncate") {
+        writeFile(filename, "a\nb\n");
+        REQUIRE(doc.followFile(filename));
+
+        writeFile(filename, "c\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 3; }));
+        CHECK(doc.line(2) == "c");
+    }
+
+    SECTION("truncated and grown larger") {
+        writeFile(filename, "a\nb\n");
+        REQUIRE(doc.followFile(filename));
+
+        writeFile(filename, "cccccc\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 3; }));
+        CHECK(doc.line(0) == "a");
+        CHECK(doc.line(1) == "b");
+        CHECK(doc.line(2) == "cccccc");
+    }
+
+    SECTION("incomplete line continued after truncate") {
+        writeFile(filename, "a\npar");
+        REQUIRE(doc.followFile(filename));
+        CHECK(doc.lineCount() == 1);
+
+        writeFile(filename, "tial\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 2; }));
+        CHECK(doc.line(1) == "partial");
+
+        appendToFile(filename, "x\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 3; }));
+        CHECK(doc.line(2) == "x");
+    }
+
+    SECTION("incomplete line continued after replace") {
+        writeFile(filename, "a\npar");
+        REQUIRE(doc.followFile(filename));
+
+        const QString tmpName = dir.filePath(QStringLiteral("new.txt"));
+        writeFile(tmpName, "tial\nb\n");
+        REQUIRE(QFile::remove(filename));
+        REQUIRE(QFile::rename(tmpName, filename));
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 3; }));
+        CHECK(doc.line(1) == "partial");
+        CHECK(doc.line(2) == "b");
+    }
+
+    SECTION("replaced") {
+        writeFile(filename, "a\n");
+        REQUIRE(doc.followFile(filename));
+
+        const QString tmpName = dir.filePath(QStringLiteral("new.txt"));
+        writeFile(tmpName, "b\n");
+        REQUIRE(QFile::remove(filename));
+        REQUIRE(QFile::rename(tmpName, filename));
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 2; }));
+        CHECK(doc.line(1) == "b");
+
+        appendToFile(filename, "c\n");
+        REQUIRE(waitUntil([&] { return doc.lineCount() == 3; }));
+        CHECK(doc.line(2) == "c");
+    }
+
+    SECTION("stop") {
+        writeFile(filename, "a\n");
+        REQUIRE(doc.followFile(filename));
+        doc.stopFollowing();
+        CHECK(doc.isFollowing() == false);
+
+        appendToFile(filename, "b\n");
+        QElapsedTimer timer;
+        timer.start();
+        while (!timer.hasExpired(200)) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        }
+        CHECK(doc.lineCount() == 1);
+    }
+}
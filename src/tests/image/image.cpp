@@ -110,6 +110,103 @@ TEST_CASE("image", "") {
         CHECK(!res);
     }
 
+    SECTION("binary") {
+        const Tui::ZImage::Format format = GENERATE(Tui::ZImage::Format::Binary, Tui::ZImage::Format::BinaryCompressed);
+        CAPTURE(static_cast<int>(format));
+        image.painter().writeWithAttributes(1, 1, "stuff", {0xFF, 0xFF, 0xFF}, {0x80, 0x80, 0x80}, Tui::ZTextAttribute::Bold);
+        image.painter().writeWithColors(1, 2, "あ😎", Tui::TerminalColor::red, Tui::TerminalColor::blue);
+        image.painter().writeWithColors(6, 2, "e\u0301", Tui::TerminalColor::red, Tui::TerminalColor::blue);
+        image.painter().clearRect(8, 0, 3, 3, Tui::TerminalColor::green, Tui::ZColor::defaultColor());
+        image.painter().setSoftwrapMarker(13, 3);
+
+        QByteArray byteData = image.saveToByteArray(format);
+        CHECK(byteData.size() < image.saveToByteArray().size());
+
+        auto res = Tui::ZImage::fromByteArray(t.terminal.get(), byteData);
+        REQUIRE(res);
+        CHECK(res->size() == QSize{14, 4});
+        CHECK(*res == image);
+        CHECK(res->peekSoftwrapMarker(13, 3) == true);
+
+        SECTION("file") {
+            QTemporaryFile tfile;
+            tfile.open();
+            tfile.close();
+            QString fileName = tfile.fileName();
+            CHECK(image.save(fileName, format) == true);
+            auto res2 = Tui::ZImage::fromFile(t.terminal.get(), fileName);
+            REQUIRE(res2);
+            CHECK(*res2 == image);
+        }
+
+        SECTION("subImage") {
+            Tui::ZImage sub = image.subImage(1, 1, 5, 2);
+            auto res2 = Tui::ZImage::fromByteArray(t.terminal.get(), sub.saveToByteArray(format));
+            REQUIRE(res2);
+            CHECK(*res2 == sub);
+        }
+
+        SECTION("truncated") {
+            for (int i = 0; i < byteData.size(); i++) {
+                CAPTURE(i);
+                CHECK(!Tui::ZImage::fromByteArray(t.terminal.get(), byteData.left(i)));
+            }
+        }
+
+        SECTION("corrupted") {
+            // must not crash, but the result might still be a valid image.
+            for (int i = 6; i < byteData.size(); i++) {
+                QByteArray corrupted = byteData;
+                corrupted[i] = static_cast<char>(corrupted[i] ^ 0x5a);
+                (void)Tui::ZImage::fromByteArray(t.terminal.get(), corrupted);
+            }
+        }
+    }
+
+    SECTION("binary-table-limits") {
+        // A 1x1 image with one cell "a", built by hand so the tables can have more entries than cells.
+        auto build = [](int texts, int attrs, int kinds) {
+            QByteArray data("\x89TZI\x01\x00\x01\x01", 8);
+            data.append(static_cast<char>(texts));
+            for (int i = 0; i < texts; i++) {
+                data.append('\x01');
+                data.append(static_cast<char>('a' + i));
+            }
+            data.append(static_cast<char>(attrs));
+            for (int i = 0; i < attrs; i++) {
+                // fg and bg TERMPAINT_DEFAULT_COLOR (0x1000000), no deco, no style, no patch
+                data.append("\x80\x80\x80\x08\x80\x80\x80\x08\x00\x00\x00", 11);
+            }
+            data.append(static_cast<char>(kinds));
+            for (int i = 0; i < kinds; i++) {
+                data.append("\x00\x00\x01\x00", 4);
+            }
+            // one run of one cell of kind 0
+            data.append("\x01\x00", 2);
+            return data;
+        };
+
+        auto res = Tui::ZImage::fromByteArray(t.terminal.get(), build(1, 1, 1));
+        REQUIRE(res);
+        CHECK(res->size() == QSize{1, 1});
+        CHECK(res->peekText(0, 0, nullptr, nullptr) == "a");
+
+        CHECK(!Tui::ZImage::fromByteArray(t.terminal.get(), build(2, 1, 1)));
+        CHECK(!Tui::ZImage::fromByteArray(t.terminal.get(), build(1, 2, 1)));
+        CHECK(!Tui::ZImage::fromByteArray(t.terminal.get(), build(1, 1, 2)));
+
+        // A 128x128 image claiming 16384 texts without data for them is rejected before allocating the table.
+        const QByteArray huge("\x89TZI\x01\x00\x80\x01\x80\x01\x80\x80\x01", 13);
+        CHECK(!Tui::ZImage::fromByteArray(t.terminal.get(), huge));
+    }
+
+    SECTION("binary-empty") {
+        Tui::ZImage empty(t.terminal.get(), 0, 0);
+        auto res = Tui::ZImage::fromByteArray(t.terminal.get(), empty.saveToByteArray(Tui::ZImage::Format::Binary));
+        REQUIRE(res);
+        CHECK(res->size() == QSize{0, 0});
+    }
+
     SECTION("peekText") {
         int l = 3, r = 4;
         CHECK(image.peekText(1, 2, &l, &r) == TERMPAINT_ERASED);
@@ -224,6 +321,76 @@ TEST_CASE("image", "") {
         CHECK(image.peekForground(1, 1) == Tui::ZColor{0xFF, 0xFF, 0xFF});
     }
 
+    SECTION("move-assign") {
+        Tui::ZImage image2(t.terminal.get(), 80, 11);
+        image2 = std::move(image);
+        CHECK(image2.size() == QSize{14, 4});
+        CHECK(image2.peekForground(1, 1) == Tui::ZColor{0xFF, 0xFF, 0xFF});
+        image2.painter().setForeground(1, 1, Tui::ZColor{0xFF, 0xAE, 0xFF});
+        CHECK(image2.peekForground(1, 1) == Tui::ZColor{0xFF, 0xAE, 0xFF});
+    }
+
+    SECTION("subImage") {
+        int l = 0, r = 0;
+        Tui::ZImage sub = image.subImage(1, 1, 3, 2);
+        CHECK(sub.size() == QSize{3, 2});
+        CHECK(sub.peekText(0, 0, &l, &r) == "s");
+        CHECK(sub.peekText(2, 0, &l, &r) == "u");
+        CHECK(l == 2);
+        CHECK(r == 2);
+        CHECK(sub.peekForground(0, 0) == Tui::ZColor{0xFF, 0xFF, 0xFF});
+        CHECK(sub.peekAttributes(0, 0) == Tui::ZTextAttributes(Tui::ZTextAttribute::Bold));
+        // cells outside of the sub image are not visible
+        CHECK(sub.peekForground(-1, 0) == Tui::ZColor::defaultColor());
+        CHECK(sub.peekForground(3, 0) == Tui::ZColor::defaultColor());
+        CHECK(sub.peekSoftwrapMarker(-1, 0) == false);
+
+        Tui::ZImage expected(t.terminal.get(), 3, 2);
+        expected.painter().writeWithAttributes(0, 0, "stu", {0xFF, 0xFF, 0xFF}, {0x80, 0x80, 0x80}, Tui::ZTextAttribute::Bold);
+        CHECK(sub == expected);
+        CHECK(sub.saveToByteArray() == expected.saveToByteArray());
+
+        Tui::ZImage clipped = image.subImage(12, 3, 10, 10);
+        CHECK(clipped.size() == QSize{2, 1});
+
+        Tui::ZImage nested = sub.subImage(1, 0, 2, 1);
+        CHECK(nested.size() == QSize{2, 1});
+        CHECK(nested.peekText(0, 0, &l, &r) == "t");
+
+        SECTION("paint-original") {
+            image.painter().writeWithColors(1, 1, "X", Tui::TerminalColor::red, Tui::TerminalColor::blue);
+            CHECK(image.peekText(1, 1, &l, &r) == "X");
+            CHECK(sub.peekText(0, 0, &l, &r) == "s");
+        }
+
+        SECTION("paint-sub") {
+            sub.painter().writeWithColors(0, 0, "X", Tui::TerminalColor::red, Tui::TerminalColor::blue);
+            CHECK(sub.peekText(0, 0, &l, &r) == "X");
+            CHECK(sub.peekText(1, 0, &l, &r) == "t");
+            CHECK(image.peekText(1, 1, &l, &r) == "s");
+            CHECK(nested.peekText(0, 0, &l, &r) == "t");
+        }
+
+        SECTION("draw") {
+            Tui::ZImage target(t.terminal.get(), 5, 3);
+            target.painter().drawImage(1, 1, sub, -1, 0, 10, 10);
+            CHECK(target.peekText(1, 1, &l, &r) == TERMPAINT_ERASED);
+            CHECK(target.peekText(2, 1, &l, &r) == "s");
+            CHECK(target.peekText(4, 1, &l, &r) == "u");
+            CHECK(target.peekForground(2, 1) == Tui::ZColor{0xFF, 0xFF, 0xFF});
+            CHECK(target.peekText(1, 2, &l, &r) == TERMPAINT_ERASED);
+        }
+    }
+
+    SECTION("subImage-with-painter") {
+        int l = 0, r = 0;
+        Tui::ZPainter painter = image.painter();
+        Tui::ZImage sub = image.subImage(1, 1, 3, 2);
+        painter.writeWithColors(1, 1, "X", Tui::TerminalColor::red, Tui::TerminalColor::blue);
+        CHECK(image.peekText(1, 1, &l, &r) == "X");
+        CHECK(sub.peekText(0, 0, &l, &r) == "s");
+    }
+
     SECTION("copy-ctor-with-painter") {
         CHECK(image.peekForground(1, 1) == Tui::ZColor{0xFF, 0xFF, 0xFF});
 
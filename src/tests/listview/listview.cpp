@@ -2,9 +2,12 @@
 
 #include <Tui/ZListView.h>
 
+#include <QCoreApplication>
 #include <QStringListModel>
 
+#include <Tui/ZImage.h>
 #include <Tui/ZPalette.h>
+#include <Tui/ZTerminal.h>
 
 #include "../catchwrapper.h"
 #include "../Testhelper.h"
@@ -29,6 +32,59 @@ namespace {
 
         QVector<QMap<int, QVariant>> rows;
     };
+
+    class CountingModel : public QStringListModel {
+    public:
+        using QStringListModel::QStringListModel;
+
+        QVariant data(const QModelIndex &index, int role) const override {
+            ++dataCalls;
+            return QStringListModel::data(index, role);
+        }
+
+        mutable int dataCalls = 0;
+    };
+
+    class IncrementalModel : public QAbstractListModel {
+    public:
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+            return parent.isValid() ? 0 : loaded;
+        }
+
+        QVariant data(const QModelIndex &index, int role) const override {
+            if (role != Qt::DisplayRole) {
+                return {};
+            }
+            return QString::number(index.row());
+        }
+
+        bool canFetchMore(const QModelIndex &parent) const override {
+            return !parent.isValid() && loaded < total;
+        }
+
+        void fetchMore(const QModelIndex &parent) override {
+            if (parent.isValid()) {
+                return;
+            }
+            const int count = std::min(10, total - loaded);
+            beginInsertRows(QModelIndex(), loaded, loaded + count - 1);
+            loaded += count;
+            endInsertRows();
+        }
+
+        int loaded = 3;
+        int total = 100;
+    };
+
+    // Text of a row without the current item markers
+    QString rowText(Testhelper &t, int y) {
+        const Tui::ZImage image = t.terminal->grabCurrentImage();
+        QString result;
+        for (int x = 1; x < image.width() - 1; x++) {
+            result += image.peekText(x, y, nullptr, nullptr);
+        }
+        return result.trimmed();
+    }
 }
 
 TEST_CASE("listview-base", "") {
@@ -1587,3 +1643,96 @@ TEST_CASE("listview-scroll-by-index", "") {
         t.compare("set index 2");
     }
 }
+
+TEST_CASE("listview-row-cache", "") {
+    Testhelper t("listview", "listview", 15, 5);
+    Tui::ZWindow *w = new Tui::ZWindow(t.root);
+    w->setGeometry({0, 0, 15, 5});
+
+    Tui::ZListView *lv1 = new Tui::ZListView(w);
+    lv1->setGeometry({0, 0, 15, 5});
+    lv1->setFocus();
+
+    CountingModel model({"a", "b", "c"});
+    lv1->setModel(&model);
+    t.render();
+    CHECK(rowText(t, 0) == "a");
+    CHECK(rowText(t, 1) == "b");
+    CHECK(rowText(t, 2) == "c");
+
+    SECTION("unchanged rows are not queried again") {
+        model.dataCalls = 0;
+        lv1->update();
+        t.render();
+        CHECK(model.dataCalls == 0);
+        CHECK(rowText(t, 1) == "b");
+    }
+
+    SECTION("dataChanged") {
+        model.setData(model.index(1, 0), QStringLiteral("x"));
+        t.render();
+        CHECK(rowText(t, 0) == "a");
+        CHECK(rowText(t, 1) == "x");
+        CHECK(rowText(t, 2) == "c");
+    }
+
+    SECTION("rowsInserted") {
+        model.insertRows(1, 2);
+        model.setData(model.index(1, 0), QStringLiteral("n1"));
+        model.setData(model.index(2, 0), QStringLiteral("n2"));
+        t.render();
+        CHECK(rowText(t, 0) == "a");
+        CHECK(rowText(t, 1) == "n1");
+        CHECK(rowText(t, 2) == "n2");
+        CHECK(rowText(t, 3) == "b");
+        CHECK(rowText(t, 4) == "c");
+    }
+
+    SECTION("rowsRemoved") {
+        model.removeRows(1, 1);
+        t.render();
+        CHECK(rowText(t, 0) == "a");
+        CHECK(rowText(t, 1) == "c");
+        CHECK(rowText(t, 2) == "");
+    }
+
+    SECTION("modelReset") {
+        model.setStringList({"r1", "r2"});
+        t.render();
+        CHECK(rowText(t, 0) == "r1");
+        CHECK(rowText(t, 1) == "r2");
+        CHECK(rowText(t, 2) == "");
+    }
+}
+
+TEST_CASE("listview-fetch-more", "") {
+    Testhelper t("listview", "listview", 15, 5);
+    Tui::ZWindow *w = new Tui::ZWindow(t.root);
+    w->setGeometry({0, 0, 15, 5});
+
+    Tui::ZListView *lv1 = new Tui::ZListView(w);
+    lv1->setGeometry({0, 0, 15, 5});
+    lv1->setFocus();
+
+    IncrementalModel model;
+    lv1->setModel(&model);
+    t.render();
+    // fetching is deferred to the event loop
+    CHECK(model.loaded == 3);
+    QCoreApplication::processEvents();
+    t.render();
+    QCoreApplication::processEvents();
+    // enough rows for the visible page and one page of prefetch
+    CHECK(model.loaded == 13);
+    CHECK(rowText(t, 4) == "4");
+
+    lv1->setCurrentIndex(model.index(12, 0));
+    t.render();
+    QCoreApplication::processEvents();
+    t.render();
+    QCoreApplication::processEvents();
+    CHECK(model.loaded == 23);
+    // inserting rows moves the current row up to keep one row below it visible
+    CHECK(rowText(t, 3) == "12");
+    CHECK(rowText(t, 4) == "13");
+}
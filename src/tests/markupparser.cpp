@@ -15,6 +15,8 @@ TEST_CASE("markup parser entities") {
         TestCase{ "&larrlp;", { 0x21ab } }, // chain with length 6
         TestCase{ "&NotEqualTilde;", { 8770, 824 } }, // two code points
         TestCase{ "&Xopf;", { 0x1d54f } }, // non BMP
+        TestCase{ "&sup;", { 0x2283 } }, // prefix of legacy reference without semicolon (&sup1)
+        TestCase{ "&CounterClockwiseContourIntegral;", { 0x2233 } }, // longest name
         TestCase{ "&#60;", { 60 } },
         TestCase{ "&#x60;", { 0x60 } }
     );
@@ -43,3 +45,63 @@ TEST_CASE("astral plain") {
     CHECK(tok.currentToken == Tui::Private::MarkupTokenizer::TT_EOF);
     // TODO this needs checks for unpaired surrogates and end of string just after a high surrogate.
 }
+
+TEST_CASE("markup tokenizer unknown entities") {
+    const auto text = GENERATE(QString("&am;"), QString("&bogus;"),
+                               QString("&aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa;"));
+    CAPTURE(text);
+    Tui::Private::MarkupTokenizer tok = text;
+    tok.getToken();
+    CHECK(tok._isError == true);
+}
+
+TEST_CASE("markup tokenizer line breaks") {
+    Tui::Private::MarkupTokenizer tok{"a\r\nb\rc\nd"};
+    for (char32_t expected: {U'a', U'\n', U'b', U'\n', U'c', U'\n', U'd'}) {
+        tok.getToken();
+        CHECK(tok._isError == false);
+        CHECK(tok.currentToken == Tui::Private::MarkupTokenizer::TT_Char);
+        CHECK(tok.currentChar == expected);
+    }
+    tok.getToken();
+    CHECK(tok._isError == false);
+    CHECK(tok.currentToken == Tui::Private::MarkupTokenizer::TT_EOF);
+}
+
+namespace {
+    // Advances to the next begin of an element with the given name. Returns false on errors and at the end of
+    // the document.
+    bool nextElementBegin(Tui::Private::MarkupParser &parser, const QString &name) {
+        while (true) {
+            parser.nextEvent();
+            if (parser.isElementBegin()) {
+                if (parser.elementBegin().name() == name) {
+                    return true;
+                }
+            } else if (!parser.isElementEnd() && !parser.isCharEvent()) {
+                return false;
+            }
+        }
+    }
+}
+
+TEST_CASE("markup parser attributes") {
+    Tui::Private::MarkupParser parser{"<b Name=\"a&amp;b\" other='&#x1F600;' flag u=x>text</b><i>x</i>"};
+    REQUIRE(nextElementBegin(parser, QStringLiteral("b")));
+    const QMap<QString, QString> attributes = parser.elementBegin().attributes();
+    CHECK(attributes.size() == 4);
+    CHECK(attributes.value(QStringLiteral("name")) == QStringLiteral("a&b"));
+    CHECK(attributes.value(QStringLiteral("other")) == QStringLiteral("😀"));
+    CHECK(attributes.contains(QStringLiteral("flag")));
+    CHECK(attributes.value(QStringLiteral("flag")) == QString());
+    CHECK(attributes.value(QStringLiteral("u")) == QStringLiteral("x"));
+
+    REQUIRE(nextElementBegin(parser, QStringLiteral("i")));
+    CHECK(parser.elementBegin().attributes().isEmpty());
+}
+
+TEST_CASE("markup parser duplicate attribute") {
+    Tui::Private::MarkupParser parser{"<b a=1 A=2>text</b>"};
+    CHECK(nextElementBegin(parser, QStringLiteral("b")) == false);
+    CHECK(parser.isDocumentEnd() == false);
+}
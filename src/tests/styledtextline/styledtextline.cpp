@@ -6,6 +6,7 @@
 
 #include "../Testhelper.h"
 
+#include <Tui/ZImage.h>
 #include <Tui/ZPainter.h>
 #include <Tui/ZPalette.h>
 #include <Tui/ZTerminal.h>
@@ -440,3 +441,73 @@ TEST_CASE("styledtextline-ascii+latin", "") {
     }
 
 }
+
+TEST_CASE("styledtextline-shared-markup", "") {
+    Testhelper t("unused", "unused", 10, 2);
+
+    const Tui::ZTextStyle baseStyle{Tui::Colors::lightGray, Tui::Colors::black};
+    const Tui::ZTextStyle mnemonicA{Tui::Colors::red, Tui::Colors::black};
+    const Tui::ZTextStyle mnemonicB{Tui::Colors::green, Tui::Colors::blue};
+
+    // Instances with the same markup share the parsed result, but styles are per instance.
+    Tui::ZStyledTextLine a;
+    a.setMnemonicStyle(baseStyle, mnemonicA);
+    a.setMarkup("x<m>y</m>z");
+    Tui::ZStyledTextLine b;
+    b.setMnemonicStyle(baseStyle, mnemonicB);
+    b.setMarkup("x<m>y</m>z");
+
+    CHECK(a.mnemonic() == "y");
+    CHECK(b.mnemonic() == "y");
+    CHECK(a.text() == "");
+
+    Tui::ZImage zi{t.terminal.get(), 10, 2};
+    auto painter = zi.painter();
+    a.write(&painter, 0, 0, 10);
+    b.write(&painter, 0, 1, 10);
+
+    CHECK(zi.peekText(0, 0, nullptr, nullptr) == "x");
+    CHECK(zi.peekText(1, 0, nullptr, nullptr) == "y");
+    CHECK(zi.peekText(2, 0, nullptr, nullptr) == "z");
+    CHECK(zi.peekForground(0, 0) == baseStyle.foregroundColor());
+    CHECK(zi.peekForground(1, 0) == mnemonicA.foregroundColor());
+    CHECK(zi.peekForground(1, 1) == mnemonicB.foregroundColor());
+    CHECK(zi.peekBackground(1, 1) == mnemonicB.backgroundColor());
+    CHECK(zi.peekForground(2, 1) == baseStyle.foregroundColor());
+
+    SECTION("same mnemonic and base style") {
+        a.setMnemonicStyle(baseStyle, baseStyle);
+        a.write(&painter, 0, 0, 10);
+        CHECK(zi.peekForground(1, 0) == baseStyle.foregroundColor());
+        CHECK(a.mnemonic() == "y");
+    }
+
+    SECTION("changed markup") {
+        b.setMarkup("<m>x</m>yz");
+        CHECK(b.mnemonic() == "x");
+        b.write(&painter, 0, 1, 10);
+        CHECK(zi.peekForground(0, 1) == mnemonicB.foregroundColor());
+        CHECK(zi.peekForground(1, 1) == baseStyle.foregroundColor());
+        CHECK(a.mnemonic() == "y");
+    }
+
+    SECTION("switch to text") {
+        a.setText("x<m>y</m>z");
+        CHECK(a.mnemonic() == "");
+        CHECK(a.markup() == "");
+        a.setMarkup("x<m>y</m>z");
+        CHECK(a.mnemonic() == "y");
+        CHECK(a.text() == "");
+    }
+
+    SECTION("parsing error") {
+        Tui::ZStyledTextLine c;
+        c.setMarkup("<m>x<m>y</m></m>");
+        CHECK(c.hasParsingError());
+        CHECK(c.mnemonic() == "");
+        Tui::ZStyledTextLine d;
+        d.setMarkup("<m>x<m>y</m></m>");
+        CHECK(d.hasParsingError());
+        CHECK(d.width(t.terminal->textMetrics()) == 13);
+    }
+}
@@ -5,6 +5,9 @@
 #include "catchwrapper.h"
 
 #include <array>
+#include <random>
+
+#include <QTextCodec>
 
 #define U8(x) reinterpret_cast<const char*>(u8##x)
 
@@ -79,3 +82,147 @@ TEST_CASE("surrogateescape decode mixed valid and invalid to surrogate escape an
     QString res = Tui::Misc::SurrogateEscape::decode(QByteArray(U8("\xff\u00ff\uffff\U0010ffff\xf8\x80\x80\x80\x80\xfc\x80\x80\x80\x80\x80")));
     CHECK(res == QString::fromUtf16(expected.data(), expected.size()));
 }
+
+namespace {
+    // The implementation before the vectorized kernels, used as reference for equivalence testing.
+    QString referenceDecode(const char *data, int len) {
+        QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+        QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+        QString text = codec->toUnicode(data, len, &state);
+        if (state.invalidChars > 0 || state.remainingChars > 0) {
+            text = QStringLiteral("");
+            for (int i = 0; i < len; i++) {
+                int first_byte = (unsigned char)data[i];
+
+                int size;
+                if (0xf0 == (0xf8 & first_byte)) {
+                    size = 4;
+                } else if (0xe0 == (0xf0 & first_byte)) {
+                    size = 3;
+                } else if (0xc0 == (0xe0 & first_byte)) {
+                    size = 2;
+                } else {
+                    size = 1;
+                }
+
+                if (i + size > len) {
+                    text.append((QChar)(0xdc00 + (unsigned char)data[i]));
+                    continue;
+                }
+
+                QTextCodec::ConverterState state2(QTextCodec::IgnoreHeader);
+                QString tmp = codec->toUnicode(data + i, size, &state2);
+                if (state2.invalidChars) {
+                    text.append((QChar)(0xdc00 + (unsigned char)data[i]));
+                    continue;
+                } else {
+                    text += tmp;
+                    i += size - 1;
+                }
+            }
+        }
+        return text;
+    }
+
+    QByteArray referenceEncode(const QChar *str, int len) {
+        QByteArray data;
+        QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+        QTextCodec::ConverterState state(QTextCodec::IgnoreHeader);
+        data = codec->fromUnicode(str, len, &state);
+
+        if (state.invalidChars || state.remainingChars) {
+            data.resize(0);
+            for (int i = 0; i < len; i++) {
+                QChar ch = str[i];
+                if (ch.isSurrogate()) {
+                    if (ch.isHighSurrogate() && i + 1 < len && str[i + 1].isLowSurrogate()) {
+                        data += codec->fromUnicode(str + i, 2);
+                        i++;
+                    } else {
+                        if ((ch.unicode() & 0xff80) == 0xdc80) {
+                            data.append((char)ch.unicode() & 0xff);
+                        } else {
+                            data.append("\357\277\275", 3);
+                        }
+                    }
+                } else {
+                    data += codec->fromUnicode(str + i, 1);
+                }
+            }
+        }
+        return data;
+    }
+}
+
+TEST_CASE("surrogateescape decode fuzz against reference") {
+    // unseeded is ok
+    std::mt19937 gen;
+
+    const std::array<QByteArray, 12> pieces = {
+        QByteArray("abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"),
+        QByteArray("x"),
+        QByteArray("\xc3\xa9"), // é
+        QByteArray("\xe2\x82\xac"), // €
+        QByteArray("\xf0\x9f\x98\x80"), // non BMP
+        QByteArray("\xef\xbf\xbf"), // U+FFFF
+        QByteArray("\xed\xa0\x80"), // encoded surrogate
+        QByteArray("\xc0\x80"), // overlong
+        QByteArray("\xf4\x90\x80\x80"), // beyond U+10FFFF
+        QByteArray("\xe2\x82"), // truncated
+        QByteArray("\xff"),
+        QByteArray("\x00", 1),
+    };
+
+    for (int iteration = 0; iteration < 5000; iteration++) {
+        QByteArray input;
+        if (iteration % 2) {
+            const int count = gen() % 40;
+            for (int i = 0; i < count; i++) {
+                input += pieces[gen() % pieces.size()];
+            }
+        } else {
+            input.resize(gen() % 300);
+            const bool mostlyAscii = gen() % 2;
+            for (int i = 0; i < input.size(); i++) {
+                const unsigned int value = gen();
+                input[i] = static_cast<char>((mostlyAscii && value % 16) ? 0x20 + value % 0x5f : value);
+            }
+        }
+        CAPTURE(input.toHex());
+        const QString expected = referenceDecode(input.constData(), input.size());
+        const QString res = Tui::Misc::SurrogateEscape::decode(input);
+        REQUIRE(res == expected);
+        REQUIRE(Tui::Misc::SurrogateEscape::encode(res) == input);
+    }
+}
+
+TEST_CASE("surrogateescape encode fuzz against reference") {
+    // unseeded is ok
+    std::mt19937 gen;
+
+    for (int iteration = 0; iteration < 5000; iteration++) {
+        QString input;
+        input.resize(gen() % 300);
+        const bool mostlyAscii = gen() % 2;
+        for (int i = 0; i < input.size(); i++) {
+            const unsigned int value = gen();
+            if (mostlyAscii && value % 16) {
+                input[i] = QChar(0x20 + value % 0x5f);
+            } else if (value % 3 == 0) {
+                input[i] = QChar(0xd800 + value % 0x800);
+            } else {
+                input[i] = QChar(value % 0x10000);
+            }
+        }
+        CAPTURE(input.toUtf8().toHex());
+        const QByteArray expected = referenceEncode(input.constData(), input.size());
+        REQUIRE(Tui::Misc::SurrogateEscape::encode(input) == expected);
+    }
+}
+
+TEST_CASE("surrogateescape long ascii with trailing non ascii") {
+    const QString input = QString(100000, QLatin1Char('a')) + QString::fromUtf16(u"\u00e9");
+    const QByteArray encoded = Tui::Misc::SurrogateEscape::encode(input);
+    CHECK(encoded == QByteArray(100000, 'a') + QByteArray(U8("\u00e9")));
+    CHECK(Tui::Misc::SurrogateEscape::decode(encoded) == input);
+}
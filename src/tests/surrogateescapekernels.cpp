@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include "catchwrapper.h"
+
+#include <random>
+#include <vector>
+
+#include "Tui/Misc/SurrogateEscape_p.h"
+
+using Kernel = Tui::Private::SurrogateEscapeKernels::Kernel;
+
+TEST_CASE("surrogateescape kernels agree with scalar") {
+    const Kernel kernel = GENERATE(Kernel::SSE2, Kernel::AVX2);
+    CAPTURE(static_cast<int>(kernel));
+
+    if (!Tui::Private::SurrogateEscapeKernels::isSupported(kernel)) {
+        return;
+    }
+
+    // unseeded is ok
+    std::mt19937 gen;
+
+    for (int iteration = 0; iteration < 5000; iteration++) {
+        std::vector<char> input(gen() % 200);
+        const unsigned int nonAsciiRate = 1 + gen() % 64;
+        for (char &ch: input) {
+            const unsigned int value = gen();
+            ch = static_cast<char>(value % nonAsciiRate ? 0x20 + value % 0x5f : value);
+        }
+
+        // Guard area after the output to detect writes beyond the documented buffer size.
+        std::vector<char16_t> expected(input.size() + 64, 0xaaaa);
+        std::vector<char16_t> output(input.size() + 64, 0xaaaa);
+        const int expectedLen = Tui::Private::SurrogateEscapeKernels::decode(Kernel::Scalar, input.data(),
+                                                                             input.size(), expected.data());
+        const int outputLen = Tui::Private::SurrogateEscapeKernels::decode(kernel, input.data(),
+                                                                           input.size(), output.data());
+        REQUIRE(outputLen == expectedLen);
+        REQUIRE(std::equal(output.begin(), output.begin() + outputLen, expected.begin()));
+        for (size_t i = input.size(); i < output.size(); i++) {
+            REQUIRE(output[i] == 0xaaaa);
+        }
+
+        std::vector<char> encodedExpected(3 * outputLen + 64, 0x55);
+        std::vector<char> encoded(3 * outputLen + 64, 0x55);
+        const int encodedExpectedLen = Tui::Private::SurrogateEscapeKernels::encode(Kernel::Scalar, output.data(),
+                                                                                    outputLen, encodedExpected.data());
+        const int encodedLen = Tui::Private::SurrogateEscapeKernels::encode(kernel, output.data(),
+                                                                            outputLen, encoded.data());
+        REQUIRE(encodedLen == encodedExpectedLen);
+        REQUIRE(encodedLen == static_cast<int>(input.size()));
+        REQUIRE(std::equal(input.begin(), input.end(), encoded.begin()));
+        for (size_t i = 3 * outputLen; i < encoded.size(); i++) {
+            REQUIRE(encoded[i] == 0x55);
+        }
+
+        int asciiPrefix = 0;
+        while (asciiPrefix < outputLen && output[asciiPrefix] < 0x80) {
+            asciiPrefix++;
+        }
+        std::vector<char> asciiOutput(outputLen + 64, 0x55);
+        REQUIRE(Tui::Private::SurrogateEscapeKernels::encodeAscii(kernel, output.data(), outputLen,
+                                                                  asciiOutput.data()) == asciiPrefix);
+        for (size_t i = outputLen; i < asciiOutput.size(); i++) {
+            REQUIRE(asciiOutput[i] == 0x55);
+        }
+    }
+}
@@ -0,0 +1,315 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTableView.h>
+
+#include <QAbstractTableModel>
+#include <QCoreApplication>
+
+#include <Tui/Misc/AbstractTableModelTrackBy.h>
+#include <Tui/ZImage.h>
+#include <Tui/ZTerminal.h>
+
+#include "../catchwrapper.h"
+#include "../Testhelper.h"
+#include "../vcheck_zwidget.h"
+
+namespace {
+    class TableModel : public QAbstractTableModel {
+    public:
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+            return parent.isValid() ? 0 : rows.size();
+        }
+
+        int columnCount(const QModelIndex &parent = QModelIndex()) const override {
+            return parent.isValid() ? 0 : headers.size();
+        }
+
+        QVariant data(const QModelIndex &index, int role) const override {
+            if (role != Qt::DisplayRole) {
+                return {};
+            }
+            ++dataCalls;
+            return rows[index.row()][index.column()];
+        }
+
+        QVariant headerData(int section, Qt::Orientation orientation, int role) const override {
+            if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+                return {};
+            }
+            return headers[section];
+        }
+
+        void setCell(int row, int column, const QString &text) {
+            rows[row][column] = text;
+            emit dataChanged(index(row, column), index(row, column));
+        }
+
+        QStringList headers;
+        QVector<QStringList> rows;
+        mutable int dataCalls = 0;
+    };
+
+    TableModel *makeModel(int rowCount) {
+        auto *model = new TableModel();
+        model->headers = QStringList{"N", "Name", "Description"};
+        for (int i = 0; i < rowCount; i++) {
+            model->rows.append({QString::number(i), "x", "text"});
+        }
+        return model;
+    }
+
+    // Text of a line without the current row markers
+    QString lineText(Testhelper &t, int y) {
+        const Tui::ZImage image = t.terminal->grabCurrentImage();
+        QString result;
+        for (int x = 1; x < image.width() - 1; x++) {
+            result += image.peekText(x, y, nullptr, nullptr);
+        }
+        return result.trimmed();
+    }
+}
+
+TEST_CASE("tableview-base", "") {
+    bool parent = GENERATE(false, true);
+    CAPTURE(parent);
+
+    std::unique_ptr<Tui::ZWidget> w = parent ? std::make_unique<Tui::ZWidget>() : nullptr;
+
+    SECTION("constructor") {
+        // The initialisation must not break crash.
+        std::unique_ptr<Tui::ZTableView> tv = std::make_unique<Tui::ZTableView>(w.get());
+        CHECK(tv->sizePolicyH() == Tui::SizePolicy::Expanding);
+        CHECK(tv->sizePolicyV() == Tui::SizePolicy::Expanding);
+        CHECK(tv->focusPolicy() == Tui::StrongFocus);
+        FAIL_CHECK_VEC(checkWidgetsDefaultsExcept(tv.get(), DefaultException::SizePolicyV
+                                                          | DefaultException::SizePolicyH
+                                                          | DefaultException::FocusPolicy));
+        CHECK(tv->sizeHint() == QSize{20, 5});
+        CHECK(tv->model() == nullptr);
+        CHECK(tv->headerVisible() == true);
+        CHECK(tv->fixedRowCount() == 0);
+        CHECK(tv->firstVisibleColumn() == 0);
+    }
+
+    std::unique_ptr<Tui::ZTableView> tv = std::make_unique<Tui::ZTableView>(w.get());
+
+    SECTION("abi-vcheck") {
+        Tui::ZWidget base;
+        checkZWidgetOverrides(&base, tv.get());
+    }
+
+    SECTION("model") {
+        std::unique_ptr<TableModel> model{makeModel(3)};
+        tv->setModel(model.get());
+        CHECK(tv->model() == model.get());
+        CHECK(tv->currentIndex() == model->index(0, 0));
+        model.reset();
+        CHECK(tv->model() == nullptr);
+        CHECK(tv->currentIndex() == QModelIndex());
+    }
+
+    SECTION("other") {
+        // must not crash
+        tv->currentIndex();
+        tv->selectionModel();
+        tv->scrollTo(QModelIndex());
+        tv->setCurrentIndex(QModelIndex());
+        tv->setFirstVisibleColumn(3);
+        CHECK(tv->firstVisibleColumn() == 0);
+        CHECK(tv->columnWidth(2) == 0);
+        tv->setModel(nullptr);
+    }
+}
+
+TEST_CASE("tableview", "") {
+    Testhelper t("unused", "unused", 30, 6);
+
+    std::unique_ptr<TableModel> model{makeModel(100)};
+    Tui::ZTableView *tv = new Tui::ZTableView(t.root);
+    tv->setGeometry({0, 0, 30, 6});
+    tv->setFocus();
+    tv->setModel(model.get());
+
+    SECTION("columns") {
+        t.render();
+        CHECK(lineText(t, 0) == "N  Name Description");
+        CHECK(lineText(t, 1) == "0  x    text");
+        CHECK(lineText(t, 5) == "4  x    text");
+        CHECK(tv->columnWidth(0) == 2);
+        CHECK(tv->columnWidth(1) == 4);
+        CHECK(tv->columnWidth(2) == 11);
+    }
+
+    SECTION("header hidden") {
+        tv->setHeaderVisible(false);
+        t.render();
+        CHECK(lineText(t, 0) == "0  x text");
+        CHECK(lineText(t, 4) == "4  x text");
+    }
+
+    SECTION("explicit column width") {
+        tv->setColumnWidth(1, 2);
+        tv->setColumnWidth(2, 3);
+        t.render();
+        CHECK(lineText(t, 0) == "N  Na Des");
+        CHECK(tv->columnWidth(1) == 2);
+        tv->setColumnWidth(1, 0);
+        t.render();
+        CHECK(lineText(t, 0) == "N  Name Des");
+    }
+
+    SECTION("column grows when wider row is displayed") {
+        // Row 50 is not part of the rows sampled initially.
+        std::unique_ptr<TableModel> model200{makeModel(200)};
+        model200->rows[50][1] = "a wider value";
+        tv->setModel(model200.get());
+        t.render();
+        CHECK(tv->columnWidth(1) == 4);
+        tv->setCurrentIndex(model200->index(50, 0));
+        t.render();
+        CHECK(tv->columnWidth(1) == 13);
+        CHECK(lineText(t, 0) == "N   Name          Descriptio");
+        CHECK(lineText(t, 5) == "50  a wider value text");
+        tv->setCurrentIndex(model200->index(0, 0));
+        t.render();
+        CHECK(lineText(t, 1) == "0   x             text");
+    }
+
+    SECTION("clipped at right edge") {
+        model->rows[0][2] = "a very long description";
+        tv->setModel(nullptr);
+        tv->setModel(model.get());
+        t.render();
+        CHECK(lineText(t, 1) == "0  x    a very long descript");
+    }
+
+    SECTION("fixed rows") {
+        tv->setFixedRowCount(2);
+        tv->setCurrentIndex(model->index(60, 0));
+        t.render();
+        CHECK(lineText(t, 0) == "N  Name Description");
+        CHECK(lineText(t, 1) == "0  x    text");
+        CHECK(lineText(t, 2) == "1  x    text");
+        CHECK(lineText(t, 3) == "58 x    text");
+        CHECK(lineText(t, 5) == "60 x    text");
+        tv->setCurrentIndex(model->index(1, 0));
+        t.render();
+        CHECK(lineText(t, 3) == "58 x    text");
+        tv->setCurrentIndex(model->index(2, 0));
+        t.render();
+        CHECK(lineText(t, 3) == "2  x    text");
+    }
+
+    SECTION("keys") {
+        int enterRow = -1;
+        QObject::connect(tv, &Tui::ZTableView::enterPressed, [&](int row) {
+            enterRow = row;
+        });
+        t.sendKey(Tui::Key_Down);
+        CHECK(tv->currentIndex().row() == 1);
+        t.sendKey(Tui::Key_End);
+        CHECK(tv->currentIndex().row() == 99);
+        t.render();
+        CHECK(lineText(t, 5) == "99 x    text");
+        t.sendKey(Tui::Key_PageUp);
+        CHECK(tv->currentIndex().row() == 94);
+        t.sendKey(Tui::Key_Home);
+        CHECK(tv->currentIndex().row() == 0);
+        t.sendKey(Tui::Key_PageDown);
+        CHECK(tv->currentIndex().row() == 5);
+        t.sendKey(Tui::Key_Up);
+        CHECK(tv->currentIndex().row() == 4);
+        CHECK(tv->selectionModel()->isRowSelected(4, QModelIndex()));
+        t.sendKey(Tui::Key_Enter);
+        CHECK(enterRow == 4);
+
+        t.sendKey(Tui::Key_Right);
+        CHECK(tv->firstVisibleColumn() == 1);
+        t.render();
+        CHECK(lineText(t, 0) == "Name Description");
+        t.sendKey(Tui::Key_Right);
+        t.sendKey(Tui::Key_Right);
+        CHECK(tv->firstVisibleColumn() == 2);
+        t.sendKey(Tui::Key_Left);
+        t.sendKey(Tui::Key_Left);
+        t.sendKey(Tui::Key_Left);
+        CHECK(tv->firstVisibleColumn() == 0);
+    }
+
+    SECTION("scrollTo column") {
+        tv->setGeometry({0, 0, 14, 6});
+        t.render();
+        tv->scrollTo(model->index(0, 2));
+        CHECK(tv->firstVisibleColumn() == 2);
+        tv->scrollTo(model->index(0, 1));
+        CHECK(tv->firstVisibleColumn() == 1);
+        tv->scrollTo(model->index(0, 0));
+        CHECK(tv->firstVisibleColumn() == 0);
+    }
+
+    SECTION("only changed cells are queried") {
+        t.render();
+        model->dataCalls = 0;
+        t.render();
+        CHECK(model->dataCalls == 0);
+
+        model->setCell(2, 1, "y");
+        t.render();
+        CHECK(model->dataCalls == 1);
+        CHECK(lineText(t, 3) == "2  y    text");
+
+        // not visible
+        model->dataCalls = 0;
+        model->setCell(80, 1, "z");
+        t.render();
+        CHECK(model->dataCalls == 0);
+    }
+
+    SECTION("rows inserted and removed") {
+        t.render();
+        model->beginInsertRows(QModelIndex(), 1, 1);
+        model->rows.insert(1, {"new", "n", "inserted"});
+        model->endInsertRows();
+        t.render();
+        CHECK(lineText(t, 1) == "0   x    text");
+        CHECK(lineText(t, 2) == "new n    inserted");
+        CHECK(lineText(t, 3) == "1   x    text");
+
+        model->beginRemoveRows(QModelIndex(), 0, 1);
+        model->rows.remove(0, 2);
+        model->endRemoveRows();
+        t.render();
+        CHECK(lineText(t, 1) == "1   x    text");
+        CHECK(tv->currentIndex().row() == 0);
+    }
+}
+
+TEST_CASE("tableview-trackby", "") {
+    Testhelper t("unused", "unused", 30, 4);
+
+    using Model = Tui::Misc::AbstractTableModelTrackBy<int>;
+    auto row = [](int key, const QString &a, const QString &b) {
+        return Model::Row{key, {{{Qt::DisplayRole, a}}, {{Qt::DisplayRole, b}}}};
+    };
+
+    Model model(2);
+    model.setData({row(1, "a", "one"), row(2, "b", "two"), row(3, "c", "three")});
+
+    Tui::ZTableView *tv = new Tui::ZTableView(t.root);
+    tv->setGeometry({0, 0, 30, 4});
+    tv->setHeaderVisible(false);
+    tv->setModel(&model);
+    t.render();
+    CHECK(lineText(t, 0) == "a one");
+    CHECK(lineText(t, 1) == "b two");
+
+    model.setData({row(1, "a", "one"), row(2, "b", "changed"), row(3, "c", "three")});
+    t.render();
+    CHECK(lineText(t, 1) == "b changed");
+
+    model.setData({row(3, "c", "three"), row(1, "a", "one")});
+    t.render();
+    CHECK(lineText(t, 0) == "c three");
+    CHECK(lineText(t, 1) == "a one");
+    CHECK(lineText(t, 2) == "");
+}
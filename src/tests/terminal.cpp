@@ -6,14 +6,19 @@
 #include <QTimer>
 #include <QSet>
 #include <QDeadlineTimer>
+#include <QThread>
 
 #include <Tui/ZImage.h>
+#include <Tui/ZListView.h>
 #include <Tui/ZPainter.h>
+#include <Tui/ZPalette.h>
 #include <Tui/ZSymbol.h>
 #include <Tui/ZTest.h>
+#include <Tui/ZTextEdit.h>
 #include <Tui/ZTextMetrics.h>
 
 #include "catchwrapper.h"
+#include "termpaint.h"
 #include "Testhelper.h"
 #include "vcheck_qobject.h"
 
@@ -106,10 +111,11 @@ class PaintWidget : public Tui::ZWidget {
 
     void paintEvent(Tui::ZPaintEvent *event) override {
         Tui::ZPainter painter = *event->painter();
-        painter.clear(fg, Tui::Colors::brightWhite);
+        painter.clear(fg, bg);
     }
 
     Tui::ZColor fg = Tui::Colors::blue;
+    Tui::ZColor bg = Tui::Colors::brightWhite;
 };
 
 class MinimumSizeHintWidget : public Tui::ZWidget {
@@ -141,6 +147,382 @@ class PasteEventAcceptingWidget : public Tui::ZWidget {
     }
 };
 
+// Acts like a very basic terminal that only answers status requests. Answers are collected and fed back
+// by the test, as calling terminalInput from within write is not allowed.
+class BasicTerminal : public Tui::ZTerminal::TerminalConnectionDelegate {
+public:
+    void write(const char *data, int length) override {
+        output.append(data, length);
+        pending.append(data, length);
+        int pos;
+        while ((pos = pending.indexOf("\033[5n")) != -1) {
+            responses.append("\033[0n");
+            pending.remove(0, pos + 4);
+        }
+        // only keep a possibly incomplete request
+        if (pending.size() > 3) {
+            pending.remove(0, pending.size() - 3);
+        }
+    }
+    void flush() override {}
+    void restoreSequenceUpdated(const char *data, int len) override {
+        (void)data; (void)len;
+    }
+    void deinit(bool awaitingResponse) override {
+        (void)awaitingResponse;
+    }
+
+    QByteArray output;
+    QByteArray pending;
+    QByteArray responses;
+};
+
+bool waitForTerminalDetection(Tui::ZTerminal *terminal, Tui::ZTerminal::TerminalConnection *connection,
+                              BasicTerminal *delegate) {
+    QDeadlineTimer timer{5000};
+    while (terminal->terminalDetectionResultText().isEmpty() && !timer.hasExpired()) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+        if (delegate->responses.size()) {
+            const QByteArray responses = delegate->responses;
+            delegate->responses.clear();
+            connection->terminalInput(responses.constData(), responses.size());
+        }
+    }
+    return !terminal->terminalDetectionResultText().isEmpty();
+}
+
+// Interprets the subset of terminal output that termpaint and ZTerminal use for drawing, to check what a
+// terminal would display. Only single width characters are supported.
+class ScreenModel {
+public:
+    ScreenModel(int width, int height) : width(width), height(height), bottom(height - 1) {
+        cells.resize(width * height);
+        clear(0, 0, width, height);
+    }
+
+    void feed(const QByteArray &data) {
+        pending.append(data);
+        int pos = 0;
+        while (pos < pending.size()) {
+            const int used = parse(pos);
+            if (used == 0) {
+                break;
+            }
+            pos += used;
+        }
+        pending.remove(0, pos);
+    }
+
+    QString text(int x, int y) const {
+        return cells[y * width + x].text;
+    }
+
+    int foreground(int x, int y) const {
+        return cells[y * width + x].fg;
+    }
+
+    int background(int x, int y) const {
+        return cells[y * width + x].bg;
+    }
+
+    QPoint cursor() const {
+        return {std::min(cursorX, width - 1), cursorY};
+    }
+
+    // -1 is the default color, -2 a color not understood by the model
+    static int color(Tui::ZColor color) {
+        if (color.colorType() == Tui::ZColor::Default) {
+            return -1;
+        } else if (color.colorType() == Tui::ZColor::Terminal) {
+            return static_cast<int>(color.terminalColor());
+        } else if (color.colorType() == Tui::ZColor::TerminalIndexed) {
+            return color.terminalColorIndexed();
+        }
+        return -2;
+    }
+
+private:
+    struct Cell {
+        QString text;
+        int fg = -1;
+        int bg = -1;
+    };
+
+    // returns the number of bytes used or 0 if the sequence is incomplete
+    int parse(int pos) {
+        const unsigned char ch = static_cast<unsigned char>(pending[pos]);
+        if (ch == 0x1b) {
+            if (pos + 1 >= pending.size()) {
+                return 0;
+            }
+            const char type = pending[pos + 1];
+            if (type == '[') {
+                int end = pos + 2;
+                while (end < pending.size() && (pending[end] < 0x40 || pending[end] > 0x7e)) {
+                    end++;
+                }
+                if (end >= pending.size()) {
+                    return 0;
+                }
+                csi(pending.mid(pos + 2, end - pos - 2), pending[end]);
+                return end - pos + 1;
+            } else if (type == ']' || type == 'P' || type == '_' || type == '^') {
+                // string sequences, terminated by BEL or ST
+                for (int end = pos + 2; end < pending.size(); end++) {
+                    if (pending[end] == '\a') {
+                        return end - pos + 1;
+                    }
+                    if (pending[end] == '\033' && end + 1 < pending.size() && pending[end + 1] == '\\') {
+                        return end - pos + 2;
+                    }
+                }
+                return 0;
+            } else if (type == '(' || type == ')' || type == '#' || type == ' ') {
+                return pos + 2 < pending.size() ? 3 : 0;
+            }
+            return 2;
+        } else if (ch == '\r') {
+            cursorX = 0;
+            return 1;
+        } else if (ch == '\n') {
+            lineFeed();
+            return 1;
+        } else if (ch == '\b') {
+            cursorX = std::max(0, std::min(cursorX, width - 1) - 1);
+            return 1;
+        } else if (ch < 0x20 || ch == 0x7f) {
+            return 1;
+        }
+
+        int length = 1;
+        if (ch >= 0xf0) {
+            length = 4;
+        } else if (ch >= 0xe0) {
+            length = 3;
+        } else if (ch >= 0xc0) {
+            length = 2;
+        }
+        if (pos + length > pending.size()) {
+            return 0;
+        }
+        print(QString::fromUtf8(pending.constData() + pos, length));
+        return length;
+    }
+
+    void csi(const QByteArray &parameters, char final) {
+        if (parameters.size() && (parameters[0] == '?' || parameters[0] == '>' || parameters[0] == '='
+                                  || parameters[0] == '<')) {
+            if (parameters == "?7" && final == 'h') {
+                autoWrap = true;
+            } else if (parameters == "?7" && final == 'l') {
+                autoWrap = false;
+            }
+            return;
+        }
+        if (parameters.size() && parameters.back() >= 0x20 && parameters.back() <= 0x2f) {
+            // intermediate bytes, e.g. cursor style
+            return;
+        }
+        QList<int> args;
+        for (const QByteArray &arg : parameters.split(';')) {
+            args.append(arg.isEmpty() ? 0 : arg.toInt());
+        }
+        auto arg = [&](int index, int defaultValue) {
+            return index < args.size() && args[index] ? args[index] : defaultValue;
+        };
+
+        switch (final) {
+            case 'H':
+            case 'f':
+                cursorY = std::min(arg(0, 1), height) - 1;
+                cursorX = std::min(arg(1, 1), width) - 1;
+                break;
+            case 'A':
+                cursorY = std::max(0, cursorY - arg(0, 1));
+                break;
+            case 'B':
+                cursorY = std::min(height - 1, cursorY + arg(0, 1));
+                break;
+            case 'C':
+                cursorX = std::min(width - 1, cursorX + arg(0, 1));
+                break;
+            case 'D':
+                cursorX = std::max(0, std::min(cursorX, width - 1) - arg(0, 1));
+                break;
+            case 'G':
+                cursorX = std::min(arg(0, 1), width) - 1;
+                break;
+            case 'd':
+                cursorY = std::min(arg(0, 1), height) - 1;
+                break;
+            case 'J':
+                if (arg(0, 0) == 0) {
+                    clear(cursorX, cursorY, width, cursorY + 1);
+                    clear(0, cursorY + 1, width, height);
+                } else if (arg(0, 0) == 1) {
+                    clear(0, 0, width, cursorY);
+                    clear(0, cursorY, cursorX + 1, cursorY + 1);
+                } else {
+                    clear(0, 0, width, height);
+                }
+                break;
+            case 'K':
+                if (arg(0, 0) == 0) {
+                    clear(cursorX, cursorY, width, cursorY + 1);
+                } else if (arg(0, 0) == 1) {
+                    clear(0, cursorY, cursorX + 1, cursorY + 1);
+                } else {
+                    clear(0, cursorY, width, cursorY + 1);
+                }
+                break;
+            case 'X':
+                clear(cursorX, cursorY, std::min(width, cursorX + arg(0, 1)), cursorY + 1);
+                break;
+            case 'r':
+                top = arg(0, 1) - 1;
+                bottom = std::min(arg(1, height), height) - 1;
+                cursorX = 0;
+                cursorY = 0;
+                break;
+            case 'S':
+                scrollUp(arg(0, 1));
+                break;
+            case 'T':
+                scrollDown(arg(0, 1));
+                break;
+            case 'm':
+                sgr(args);
+                break;
+            default:
+                // queries and modes don't change the display
+                break;
+        }
+    }
+
+    void sgr(const QList<int> &args) {
+        for (int i = 0; i < args.size(); i++) {
+            const int code = args[i];
+            if (code == 0) {
+                fg = -1;
+                bg = -1;
+            } else if (code >= 30 && code <= 37) {
+                fg = code - 30;
+            } else if (code >= 90 && code <= 97) {
+                fg = code - 90 + 8;
+            } else if (code == 39) {
+                fg = -1;
+            } else if (code >= 40 && code <= 47) {
+                bg = code - 40;
+            } else if (code >= 100 && code <= 107) {
+                bg = code - 100 + 8;
+            } else if (code == 49) {
+                bg = -1;
+            } else if ((code == 38 || code == 48) && i + 1 < args.size()) {
+                int value = -2;
+                if (args[i + 1] == 5 && i + 2 < args.size()) {
+                    value = args[i + 2];
+                    i += 2;
+                } else if (args[i + 1] == 2) {
+                    i += 4;
+                }
+                (code == 38 ? fg : bg) = value;
+            }
+        }
+    }
+
+    void print(const QString &text) {
+        if (cursorX >= width) {
+            if (autoWrap) {
+                cursorX = 0;
+                lineFeed();
+            } else {
+                cursorX = width - 1;
+            }
+        }
+        Cell &cell = cells[cursorY * width + cursorX];
+        cell.text = text;
+        cell.fg = fg;
+        cell.bg = bg;
+        cursorX++;
+    }
+
+    void lineFeed() {
+        if (cursorY == bottom) {
+            scrollUp(1);
+        } else if (cursorY < height - 1) {
+            cursorY++;
+        }
+    }
+
+    void scrollUp(int lines) {
+        for (int y = top; y <= bottom; y++) {
+            for (int x = 0; x < width; x++) {
+                if (y + lines <= bottom) {
+                    cells[y * width + x] = cells[(y + lines) * width + x];
+                }
+            }
+        }
+        clear(0, std::max(top, bottom - lines + 1), width, bottom + 1);
+    }
+
+    void scrollDown(int lines) {
+        for (int y = bottom; y >= top; y--) {
+            for (int x = 0; x < width; x++) {
+                if (y - lines >= top) {
+                    cells[y * width + x] = cells[(y - lines) * width + x];
+                }
+            }
+        }
+        clear(0, top, width, std::min(bottom + 1, top + lines));
+    }
+
+    // clears the cells with x1 <= x < x2 and y1 <= y < y2 using the current background
+    void clear(int x1, int y1, int x2, int y2) {
+        for (int y = std::max(0, y1); y < std::min(y2, height); y++) {
+            for (int x = std::max(0, x1); x < std::min(x2, width); x++) {
+                cells[y * width + x] = Cell{QStringLiteral(" "), -1, bg};
+            }
+        }
+    }
+
+    const int width;
+    const int height;
+    QVector<Cell> cells;
+    QByteArray pending;
+    int cursorX = 0;
+    int cursorY = 0;
+    int top = 0;
+    int bottom;
+    int fg = -1;
+    int bg = -1;
+    bool autoWrap = true;
+};
+
+void checkScreenMatches(const ScreenModel &screen, const Tui::ZTerminal &terminal) {
+    const Tui::ZImage image = terminal.grabCurrentImage();
+    for (int y = 0; y < image.height(); y++) {
+        QString expectedText;
+        QString actualText;
+        QList<int> expectedColors;
+        QList<int> actualColors;
+        for (int x = 0; x < image.width(); x++) {
+            const QString text = image.peekText(x, y, nullptr, nullptr);
+            expectedText += text == QString::fromUtf8(TERMPAINT_ERASED) ? QStringLiteral(" ") : text;
+            actualText += screen.text(x, y);
+            expectedColors.append(ScreenModel::color(image.peekForground(x, y)));
+            expectedColors.append(ScreenModel::color(image.peekBackground(x, y)));
+            actualColors.append(screen.foreground(x, y));
+            actualColors.append(screen.background(x, y));
+        }
+        CAPTURE(y);
+        CHECK(actualText == expectedText);
+        CHECK(actualColors == expectedColors);
+    }
+    if (terminal.grabCursorVisibility()) {
+        CHECK(screen.cursor() == terminal.grabCursorPosition());
+    }
+}
+
 bool waitForRenderingCycle(Tui::ZTerminal *terminal, int timeout) {
     QDeadlineTimer timer{timeout};
 
@@ -1222,6 +1604,198 @@ TEST_CASE("terminal-paste-events", "") {
 
 }
 
+TEST_CASE("terminal-paste-TerminalConnection", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    EventRecorder recorder;
+
+    BasicTerminal delegate;
+    Tui::ZTerminal::TerminalConnection connection;
+    connection.setDelegate(&delegate);
+    connection.setSize(20, 10);
+    Tui::ZTerminal terminal{&connection, Tui::ZTerminal::ForceIncompatibleTerminals
+                                         | Tui::ZTerminal::DisableAutoDetectTimeoutMessage};
+    REQUIRE(waitForTerminalDetection(&terminal, &connection, &delegate));
+
+    Tui::ZWidget root;
+    terminal.setMainWidget(&root);
+    root.setFocus();
+    auto rootPasteEvent = recorder.watchPasteEvent(&root, "paste event on root");
+
+    auto input = [&](const QByteArray &data) {
+        connection.terminalInput(data.constData(), data.size());
+    };
+
+    SECTION("utf-8 sequences split between reads") {
+        input("\033[200~ab\xc3");
+        input("\xa4" "c\xe2\x82");
+        input("\xac");
+        input("\xf0\x9f");
+        input("\x98\x80" "d\033[201~");
+        CHECK(recorder.consumeFirst(rootPasteEvent, QString::fromUtf8("ab\xc3\xa4" "c\xe2\x82\xac\xf0\x9f\x98\x80" "d")));
+        CHECK(recorder.noMoreEvents());
+    }
+
+    SECTION("large paste in one read") {
+        QByteArray text;
+        while (text.size() < 2 * 1024 * 1024) {
+            text += "Some pasted text with a few words and the odd \xc3\xa4\xc3\xb6\xc3\xbc.\n";
+        }
+        input("\033[200~" + text + "\033[201~");
+        CHECK(recorder.consumeFirst(rootPasteEvent, QString::fromUtf8(text)));
+        CHECK(recorder.noMoreEvents());
+
+        // input after the paste is processed normally
+        input("\033[200~small\033[201~");
+        CHECK(recorder.consumeFirst(rootPasteEvent, QString("small")));
+        CHECK(recorder.noMoreEvents());
+    }
+}
+
+TEST_CASE("terminal-ScrollRegionOutput", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    BasicTerminal delegate;
+    Tui::ZTerminal::TerminalConnection connection;
+    connection.setDelegate(&delegate);
+    connection.setSize(40, 12);
+    Tui::ZTerminal terminal{&connection, Tui::ZTerminal::ForceIncompatibleTerminals
+                                         | Tui::ZTerminal::DisableAutoDetectTimeoutMessage
+                                         | Tui::ZTerminal::ScrollRegionOutput};
+    REQUIRE(waitForTerminalDetection(&terminal, &connection, &delegate));
+
+    // Terminal colors, so the screen model can check that attributes are right after scrolling
+    Tui::ZPalette palette;
+    palette.setColors({
+        {"dataview.fg", Tui::TerminalColor::black},
+        {"dataview.bg", Tui::TerminalColor::cyan},
+        {"dataview.selected.fg", Tui::TerminalColor::brightWhite},
+        {"dataview.selected.bg", Tui::TerminalColor::blue},
+        {"dataview.selected.focused.fg", Tui::TerminalColor::brightYellow},
+        {"dataview.selected.focused.bg", Tui::TerminalColor::red},
+        {"textedit.fg", Tui::TerminalColor::lightGray},
+        {"textedit.bg", Tui::TerminalColor::blue},
+        {"textedit.focused.fg", Tui::TerminalColor::brightWhite},
+        {"textedit.focused.bg", Tui::TerminalColor::blue},
+        {"textedit.selected.fg", Tui::TerminalColor::black},
+        {"textedit.selected.bg", Tui::TerminalColor::lightGray},
+        {"textedit.linenumber.fg", Tui::TerminalColor::darkGray},
+        {"textedit.linenumber.bg", Tui::TerminalColor::black},
+        {"textedit.focused.linenumber.fg", Tui::TerminalColor::brightGreen},
+        {"textedit.focused.linenumber.bg", Tui::TerminalColor::black},
+    });
+
+    PaintWidget root;
+    root.fg = Tui::TerminalColor::magenta;
+    root.bg = Tui::TerminalColor::black;
+    root.setPalette(palette);
+    terminal.setMainWidget(&root);
+
+    ScreenModel screen{40, 12};
+    auto render = [&] {
+        delegate.output.clear();
+        REQUIRE(waitForRenderingCycle(&terminal, 1000));
+        screen.feed(delegate.output);
+    };
+
+    SECTION("list view") {
+        Tui::ZListView view{&root};
+        view.setGeometry({0, 1, 40, 10});
+        QStringList items;
+        for (int i = 0; i < 100; i++) {
+            items.append(QStringLiteral("item %1").arg(i));
+        }
+        view.setItems(items);
+        view.setFocus();
+
+        terminal.forceRepaint();
+        screen.feed(delegate.output);
+        checkScreenMatches(screen, terminal);
+
+        view.scrollTo(view.model()->index(10, 0));
+        render();
+        CHECK(delegate.output.contains("\033[2;11r"));
+        checkScreenMatches(screen, terminal);
+
+        view.scrollTo(view.model()->index(13, 0));
+        render();
+        CHECK(delegate.output.contains("\033[2;11r"));
+        checkScreenMatches(screen, terminal);
+
+        view.scrollTo(view.model()->index(2, 0));
+        render();
+        CHECK(delegate.output.contains("\033[2;11r"));
+        checkScreenMatches(screen, terminal);
+
+        // the current item with its own colors comes into view again
+        view.scrollTo(view.model()->index(0, 0));
+        render();
+        CHECK(delegate.output.contains("\033[2;11r"));
+        checkScreenMatches(screen, terminal);
+    }
+
+    SECTION("text edit") {
+        Tui::ZTextEdit edit{terminal.textMetrics(), &root};
+        edit.setGeometry({0, 2, 40, 10});
+        edit.setShowLineNumbers(true);
+        QString text;
+        for (int i = 0; i < 100; i++) {
+            text += QStringLiteral("line %1 with some text\n").arg(i);
+        }
+        edit.setText(text);
+        edit.setFocus();
+
+        terminal.forceRepaint();
+        screen.feed(delegate.output);
+        checkScreenMatches(screen, terminal);
+
+        edit.setCursorPosition({3, 10});
+        render();
+        CHECK(delegate.output.contains("\033[3;12r"));
+        checkScreenMatches(screen, terminal);
+
+        edit.setCursorPosition({5, 12});
+        render();
+        CHECK(delegate.output.contains("\033[3;12r"));
+        checkScreenMatches(screen, terminal);
+
+        edit.setCursorPosition({0, 1});
+        render();
+        CHECK(delegate.output.contains("\033[3;12r"));
+        checkScreenMatches(screen, terminal);
+
+        // scrolling the whole height is sent as changed cells
+        edit.setCursorPosition({0, 50});
+        render();
+        CHECK(!delegate.output.contains("\033[3;12r"));
+        checkScreenMatches(screen, terminal);
+    }
+
+    SECTION("not full width") {
+        Tui::ZListView view{&root};
+        view.setGeometry({1, 1, 38, 10});
+        QStringList items;
+        for (int i = 0; i < 100; i++) {
+            items.append(QStringLiteral("item %1").arg(i));
+        }
+        view.setItems(items);
+
+        terminal.forceRepaint();
+        screen.feed(delegate.output);
+
+        view.scrollTo(view.model()->index(10, 0));
+        render();
+        CHECK(!delegate.output.contains("\033[2;11r"));
+        checkScreenMatches(screen, terminal);
+    }
+}
+
 TEST_CASE("termial-FileDescriptor", "") {
     Tui::ZTerminal::FileDescriptor fd{23};
     CHECK(fd.fd() == 23);
@@ -1235,6 +1809,179 @@ TEST_CASE("termial-OffScreen", "") {
     Tui::ZTerminal::OffScreen offscreen2 = offscreen;
 }
 
+TEST_CASE("terminal-outputStatistics", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(20, 10)};
+    PaintWidget widget;
+    terminal.setMainWidget(&widget);
+
+    // offscreen terminals have no output, so frames are never dropped.
+    terminal.forceRepaint();
+    terminal.forceRepaint();
+    const Tui::ZTerminal::OutputStatistics stats = terminal.outputStatistics();
+    CHECK(stats.bytesWritten == 0);
+    CHECK(stats.bytesQueued == 0);
+    CHECK(stats.maxBytesQueued == 0);
+    CHECK(stats.timeBlockedNs == 0);
+    CHECK(stats.framesDropped == 0);
+}
+
+TEST_CASE("terminal-frameStatistics", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(20, 10)};
+
+    CHECK(terminal.isFrameStatisticsEnabled() == false);
+    CHECK(terminal.frameStatisticsHistorySize() == 0);
+    CHECK(terminal.frameStatisticsHistory().isEmpty());
+
+    Tui::ZPainter painter = terminal.painter();
+
+    SECTION("disabled") {
+        painter.writeWithColors(0, 0, "ab", Tui::Colors::red, Tui::Colors::blue);
+        terminal.updateOutput();
+        CHECK(terminal.lastFrameStatistics().cellsChanged == 0);
+        CHECK(terminal.lastFrameStatistics().bytesWritten == 0);
+    }
+
+    SECTION("cells changed") {
+        terminal.setFrameStatisticsEnabled(true);
+        CHECK(terminal.isFrameStatisticsEnabled() == true);
+
+        // The first frame is always counted as completely changed
+        terminal.updateOutput();
+        CHECK(terminal.lastFrameStatistics().cellsChanged == 200);
+
+        terminal.updateOutput();
+        CHECK(terminal.lastFrameStatistics().cellsChanged == 0);
+
+        painter.writeWithColors(0, 0, "ab", Tui::Colors::red, Tui::Colors::blue);
+        painter.setForeground(19, 9, Tui::Colors::brightCyan);
+        terminal.updateOutput();
+        CHECK(terminal.lastFrameStatistics().cellsChanged == 3);
+
+        terminal.updateOutputForceFullRepaint();
+        CHECK(terminal.lastFrameStatistics().cellsChanged == 200);
+
+        terminal.resize(10, 5);
+        terminal.updateOutput();
+        CHECK(terminal.lastFrameStatistics().cellsChanged == 50);
+    }
+
+    SECTION("history") {
+        terminal.setFrameStatisticsEnabled(true);
+        terminal.setFrameStatisticsHistorySize(3);
+        CHECK(terminal.frameStatisticsHistorySize() == 3);
+
+        terminal.updateOutput();
+        painter.writeWithColors(0, 0, "a", Tui::Colors::red, Tui::Colors::blue);
+        terminal.updateOutput();
+        CHECK(terminal.frameStatisticsHistory().size() == 2);
+
+        painter.writeWithColors(0, 0, "bc", Tui::Colors::red, Tui::Colors::blue);
+        terminal.updateOutput();
+        painter.writeWithColors(0, 0, "def", Tui::Colors::red, Tui::Colors::blue);
+        terminal.updateOutput();
+
+        QVector<Tui::ZTerminal::FrameStatistics> history = terminal.frameStatisticsHistory();
+        REQUIRE(history.size() == 3);
+        CHECK(history[0].cellsChanged == 1);
+        CHECK(history[1].cellsChanged == 2);
+        CHECK(history[2].cellsChanged == 3);
+
+        terminal.setFrameStatisticsHistorySize(2);
+        history = terminal.frameStatisticsHistory();
+        REQUIRE(history.size() == 2);
+        CHECK(history[0].cellsChanged == 2);
+        CHECK(history[1].cellsChanged == 3);
+
+        terminal.setFrameStatisticsHistorySize(0);
+        CHECK(terminal.frameStatisticsHistory().isEmpty());
+    }
+
+    SECTION("rendering cycle") {
+        PaintWidget widget;
+        terminal.setMainWidget(&widget);
+        terminal.setFrameStatisticsEnabled(true);
+        terminal.forceRepaint();
+        const Tui::ZTerminal::FrameStatistics stats = terminal.lastFrameStatistics();
+        CHECK(stats.cellsChanged == 200);
+        CHECK(stats.paintNs > 0);
+    }
+}
+
+TEST_CASE("terminal-moveToThreadWithWidgets", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    SECTION("same thread") {
+        Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(20, 10)};
+        CHECK(terminal.moveToThreadWithWidgets(QThread::currentThread()) == true);
+        CHECK(terminal.moveToThreadWithWidgets(nullptr) == false);
+    }
+
+    SECTION("with parent") {
+        QObject parent;
+        Tui::ZTerminal *terminal = new Tui::ZTerminal(Tui::ZTerminal::OffScreen(20, 10), &parent);
+        QThread thread;
+        CHECK(terminal->moveToThreadWithWidgets(&thread) == false);
+        CHECK(terminal->thread() == QThread::currentThread());
+    }
+
+    SECTION("main widget with parent") {
+        QObject parent;
+        Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(20, 10)};
+        PaintWidget *widget = new PaintWidget();
+        widget->setParent(&parent);
+        terminal.setMainWidget(widget);
+        QThread thread;
+        CHECK(terminal.moveToThreadWithWidgets(&thread) == false);
+        CHECK(terminal.thread() == QThread::currentThread());
+    }
+
+    SECTION("worker thread") {
+        QThread thread;
+        thread.start();
+
+        Tui::ZTerminal *terminal = new Tui::ZTerminal(Tui::ZTerminal::OffScreen(20, 10));
+        PaintWidget *widget = new PaintWidget();
+        terminal->setMainWidget(widget);
+        terminal->setFrameStatisticsEnabled(true);
+
+        REQUIRE(terminal->moveToThreadWithWidgets(&thread) == true);
+        CHECK(terminal->thread() == &thread);
+        CHECK(widget->thread() == &thread);
+
+        // Only the thread of the terminal may move it
+        CHECK(terminal->moveToThreadWithWidgets(QThread::currentThread()) == false);
+
+        QAtomicInt rendered = 0;
+        QTimer::singleShot(0, terminal, [terminal, widget, &rendered] {
+            if (QThread::currentThread() == terminal->thread()
+                    && QThread::currentThread() == widget->thread()) {
+                terminal->forceRepaint();
+                if (terminal->lastFrameStatistics().cellsChanged == 200) {
+                    rendered = 1;
+                }
+            }
+            delete terminal;
+            delete widget;
+            QThread::currentThread()->quit();
+        });
+        REQUIRE(thread.wait(10000));
+        CHECK(rendered == 1);
+    }
+}
+
 TEST_CASE("termial-TerminalConnection", "") {
     Tui::ZTerminal::TerminalConnection connection;
     connection.setBackspaceIsX08(false);
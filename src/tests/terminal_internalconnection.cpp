@@ -0,0 +1,342 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTerminal.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include <Tui/ZEvent.h>
+#include <Tui/ZPainter.h>
+#include <Tui/ZWidget.h>
+
+#include "catchwrapper.h"
+
+// Tests of the connection to a terminal via a file descriptor, using a pseudo terminal as terminal.
+
+namespace {
+
+class Pty {
+public:
+    Pty() {
+        master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (master == -1) {
+            return;
+        }
+        if (grantpt(master) != 0 || unlockpt(master) != 0) {
+            return;
+        }
+        const char *name = ptsname(master);
+        if (!name) {
+            return;
+        }
+        slave = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (slave == -1) {
+            return;
+        }
+        struct winsize size = {};
+        size.ws_col = width;
+        size.ws_row = height;
+        ioctl(master, TIOCSWINSZ, &size);
+        fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    }
+
+    ~Pty() {
+        if (slave != -1) {
+            close(slave);
+        }
+        if (master != -1) {
+            close(master);
+        }
+    }
+
+    bool isValid() const {
+        return slave != -1;
+    }
+
+    // Read everything the terminal has written so far and answer the status report used to finish terminal
+    // detection.
+    int pump() {
+        int total = 0;
+        char buffer[65536];
+        while (true) {
+            const ssize_t ret = read(master, buffer, sizeof(buffer));
+            if (ret <= 0) {
+                break;
+            }
+            total += static_cast<int>(ret);
+            pending.append(buffer, static_cast<int>(ret));
+        }
+        int pos;
+        while ((pos = pending.indexOf("\033[5n")) != -1) {
+            pending.remove(0, pos + 4);
+            const char response[] = "\033[0n";
+            (void)!write(master, response, sizeof(response) - 1);
+        }
+        if (pending.size() > 3) {
+            pending.remove(0, pending.size() - 3);
+        }
+        return total;
+    }
+
+    static constexpr int width = 200;
+    static constexpr int height = 60;
+
+    int master = -1;
+    int slave = -1;
+    QByteArray pending;
+};
+
+// Fills the area with alternating colors, so each frame produces lots of output.
+void paintBusy(Tui::ZPainter &painter, int width, int height, int frame) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const bool odd = (x + y + frame) % 2;
+            const QChar ch = QChar('a' + (x + y + frame) % 26);
+            painter.writeWithColors(x, y, &ch, 1,
+                                    odd ? Tui::Colors::red : Tui::Colors::blue,
+                                    odd ? Tui::Colors::black : Tui::Colors::brightWhite);
+        }
+    }
+}
+
+class BusyWidget : public Tui::ZWidget {
+public:
+    using Tui::ZWidget::ZWidget;
+
+    void paintEvent(Tui::ZPaintEvent *event) override {
+        Tui::ZPainter painter = *event->painter();
+        paintBusy(painter, geometry().width(), geometry().height(), frame);
+    }
+
+    int frame = 0;
+};
+
+class PasteSink : public Tui::ZWidget {
+public:
+    using Tui::ZWidget::ZWidget;
+
+    void pasteEvent(Tui::ZPasteEvent *event) override {
+        pastes.append(event->text());
+    }
+
+    QStringList pastes;
+};
+
+bool waitForDetection(Tui::ZTerminal &terminal, Pty &pty) {
+    QElapsedTimer timer;
+    timer.start();
+    while (terminal.terminalDetectionResultText().isEmpty() && !timer.hasExpired(5000)) {
+        pty.pump();
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+    }
+    pty.pump();
+    return !terminal.terminalDetectionResultText().isEmpty();
+}
+
+bool isNonBlocking(int fd) {
+    return fcntl(fd, F_GETFL) & O_NONBLOCK;
+}
+
+}
+
+TEST_CASE("terminal-internalconnection-output-queue", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    Pty pty;
+    if (!pty.isValid()) {
+        WARN("No pseudo terminal available, skipping");
+        return;
+    }
+
+    const Tui::ZTerminal::Options options = Tui::ZTerminal::ForceIncompatibleTerminals
+            | Tui::ZTerminal::DisableAutoDetectTimeoutMessage;
+
+    SECTION("frames dropped while output is queued") {
+        Tui::ZTerminal terminal{Tui::ZTerminal::FileDescriptor(pty.slave), options};
+        REQUIRE(waitForDetection(terminal, pty));
+        REQUIRE(terminal.width() == Pty::width);
+        REQUIRE(terminal.height() == Pty::height);
+        // The file description is shared with other processes, it must never be switched to non blocking mode.
+        CHECK(!isNonBlocking(pty.slave));
+
+        BusyWidget widget;
+        terminal.setMainWidget(&widget);
+        terminal.setFrameStatisticsEnabled(true);
+        terminal.forceRepaint();
+        pty.pump();
+
+        // Stop reading, the pseudo terminal's buffer fills up and further output gets queued.
+        for (int i = 0; i < 200 && terminal.outputStatistics().bytesQueued == 0; i++) {
+            widget.frame++;
+            terminal.forceRepaint();
+        }
+        CHECK(!isNonBlocking(pty.slave));
+        REQUIRE(terminal.outputStatistics().bytesQueued > 0);
+        CHECK(terminal.outputStatistics().maxBytesQueued >= terminal.outputStatistics().bytesQueued);
+
+        // write() returned EAGAIN instead of blocking, rendering now drops the frame.
+        const int framesDroppedBefore = terminal.outputStatistics().framesDropped;
+        widget.frame++;
+        terminal.forceRepaint();
+        CHECK(terminal.outputStatistics().framesDropped == framesDroppedBefore + 1);
+
+        // Reading on the terminal's side drains the queue via the write notifier, the replacement frame
+        // is a full repaint because the dropped frame was one.
+        bool replaced = false;
+        QMetaObject::Connection connection = QObject::connect(&terminal, &Tui::ZTerminal::afterRendering,
+                                                              &terminal, [&] {
+            replaced = true;
+        });
+        QElapsedTimer timer;
+        timer.start();
+        while (!replaced && !timer.hasExpired(5000)) {
+            pty.pump();
+            QCoreApplication::processEvents(QEventLoop::AllEvents);
+        }
+        QObject::disconnect(connection);
+        REQUIRE(replaced);
+        CHECK(terminal.lastFrameStatistics().cellsChanged == Pty::width * Pty::height);
+        CHECK(!isNonBlocking(pty.slave));
+
+        timer.restart();
+        while (terminal.outputStatistics().bytesQueued != 0 && !timer.hasExpired(5000)) {
+            pty.pump();
+            QCoreApplication::processEvents(QEventLoop::AllEvents);
+        }
+        CHECK(terminal.outputStatistics().bytesQueued == 0);
+        CHECK(terminal.outputStatistics().timeBlockedNs == 0);
+        pty.pump();
+        terminal.setMainWidget(nullptr);
+    }
+
+    SECTION("blocking when the queue exceeds the limit") {
+        // The terminal starts to read only after a while. Until then output is queued and once the queue
+        // exceeds its limit writing falls back to waiting for the terminal.
+        std::atomic<bool> reading{false};
+        std::atomic<bool> stop{false};
+        std::thread reader([&pty, &reading, &stop] {
+            while (!reading.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            while (!stop.load()) {
+                struct pollfd info;
+                info.fd = pty.master;
+                info.events = POLLIN;
+                poll(&info, 1, 10);
+                char buffer[65536];
+                while (read(pty.master, buffer, sizeof(buffer)) > 0) {
+                }
+            }
+        });
+
+        Tui::ZTerminal::OutputStatistics stats;
+        {
+            Tui::ZTerminal terminal{Tui::ZTerminal::FileDescriptor(pty.slave), options};
+            const bool detected = waitForDetection(terminal, pty);
+            reading = true;
+            CHECK(detected);
+
+            Tui::ZPainter painter = terminal.painter();
+            for (int frame = 0; frame < 5000 && terminal.outputStatistics().timeBlockedNs == 0; frame++) {
+                paintBusy(painter, terminal.width(), terminal.height(), frame);
+                terminal.updateOutputForceFullRepaint();
+            }
+            stats = terminal.outputStatistics();
+            CHECK(!isNonBlocking(pty.slave));
+            // the reader is kept running until the terminal is destroyed, so restoring the terminal does not block
+        }
+        stop = true;
+        reader.join();
+
+        CHECK(stats.timeBlockedNs > 0);
+        CHECK(stats.maxBytesQueued > 4 * 1024 * 1024);
+        CHECK(stats.bytesQueued == 0);
+    }
+}
+
+TEST_CASE("terminal-internalconnection-input", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    Pty pty;
+    if (!pty.isValid()) {
+        WARN("No pseudo terminal available, skipping");
+        return;
+    }
+
+    Tui::ZTerminal terminal{Tui::ZTerminal::FileDescriptor(pty.slave), Tui::ZTerminal::ForceIncompatibleTerminals
+                                                                       | Tui::ZTerminal::DisableAutoDetectTimeoutMessage};
+    REQUIRE(waitForDetection(terminal, pty));
+
+    PasteSink sink;
+    terminal.setMainWidget(&sink);
+    sink.setFocus();
+
+    SECTION("large paste") {
+        QByteArray text;
+        while (text.size() < 512 * 1024) {
+            text += "Some pasted text with a few words and the odd \xc3\xa4\xc3\xb6\xc3\xbc.\n";
+        }
+        const QByteArray data = "\033[200~" + text + "\033[201~";
+
+        // The terminal accepts only part of the input at a time, keep writing while the application reads.
+        int written = 0;
+        QElapsedTimer timer;
+        timer.start();
+        while ((written < data.size() || sink.pastes.isEmpty()) && !timer.hasExpired(10000)) {
+            if (written < data.size()) {
+                const ssize_t ret = write(pty.master, data.constData() + written, data.size() - written);
+                if (ret > 0) {
+                    written += static_cast<int>(ret);
+                }
+            }
+            pty.pump();
+            QCoreApplication::processEvents(QEventLoop::AllEvents);
+        }
+        REQUIRE(sink.pastes.size() == 1);
+        CHECK(sink.pastes[0] == QString::fromUtf8(text));
+        // reading never switches the shared file description to non blocking mode
+        CHECK(!isNonBlocking(pty.slave));
+    }
+
+    SECTION("utf-8 sequence split between writes") {
+        const char part1[] = "\033[200~ab\xe2\x82";
+        const char part2[] = "\xac" "c\033[201~";
+        REQUIRE(write(pty.master, part1, sizeof(part1) - 1) == static_cast<ssize_t>(sizeof(part1) - 1));
+        QElapsedTimer timer;
+        timer.start();
+        while (!timer.hasExpired(100)) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents);
+        }
+        REQUIRE(write(pty.master, part2, sizeof(part2) - 1) == static_cast<ssize_t>(sizeof(part2) - 1));
+        timer.restart();
+        while (sink.pastes.isEmpty() && !timer.hasExpired(5000)) {
+            pty.pump();
+            QCoreApplication::processEvents(QEventLoop::AllEvents);
+        }
+        REQUIRE(sink.pastes.size() == 1);
+        CHECK(sink.pastes[0] == QString::fromUtf8("ab\xe2\x82\xac" "c"));
+    }
+
+    pty.pump();
+    terminal.setMainWidget(nullptr);
+}
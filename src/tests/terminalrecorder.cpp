@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTerminalRecorder.h>
+#include <Tui/ZTerminalReplay.h>
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+#include <Tui/ZImage.h>
+#include <Tui/ZPainter.h>
+#include <Tui/ZTerminal.h>
+#include <Tui/ZWidget.h>
+
+#include "catchwrapper.h"
+#include "vcheck_qobject.h"
+
+namespace {
+
+class FrameWidget : public Tui::ZWidget {
+public:
+    using Tui::ZWidget::ZWidget;
+
+    void paintEvent(Tui::ZPaintEvent *event) override {
+        Tui::ZPainter painter = *event->painter();
+        painter.clear(Tui::Colors::white, Tui::Colors::black);
+        painter.writeWithColors(frame % 5, 1, QStringLiteral("frame %1").arg(frame),
+                                Tui::Colors::brightWhite, Tui::Colors::blue);
+        painter.writeWithAttributes(2, 3, QStringLiteral("あいう"), Tui::Colors::red, Tui::Colors::black,
+                                    frame % 2 ? Tui::ZTextAttribute::Bold : Tui::ZTextAttribute::Underline);
+        painter.writeWithColors(frame % 3, 5, QStringLiteral("éx"), Tui::ZColor(0x12, 0x34, 0x56),
+                                Tui::Colors::black);
+        painter.setSoftwrapMarker(geometry().width() - 1, frame % geometry().height());
+        painter.setCursor(frame % geometry().width(), 0);
+    }
+
+    int frame = 0;
+};
+
+}
+
+TEST_CASE("terminalrecorder-base", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    Tui::ZTerminalRecorder recorder;
+
+    SECTION("abi-vcheck") {
+        QObject base;
+        checkQObjectOverrides(&base, &recorder);
+    }
+
+    SECTION("defaults") {
+        CHECK(recorder.isRecording() == false);
+        CHECK(recorder.terminal() == nullptr);
+        CHECK(recorder.errorString() == QString());
+        CHECK(recorder.framesRecorded() == 0);
+        CHECK(recorder.bytesWritten() == 0);
+    }
+
+    SECTION("invalid") {
+        Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(20, 10)};
+        QBuffer buffer;
+        CHECK(!recorder.start(nullptr, &buffer));
+        CHECK(recorder.errorString() != QString());
+        CHECK(!recorder.start(&terminal, &buffer));
+        CHECK(recorder.errorString() != QString());
+        CHECK(!recorder.start(&terminal, QStringLiteral("/nonexistent-directory/recording")));
+        CHECK(recorder.errorString() != QString());
+        CHECK(!recorder.isRecording());
+    }
+}
+
+TEST_CASE("terminalrecorder-replay", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    Tui::ZTerminal terminal{Tui::ZTerminal::OffScreen(30, 10)};
+    FrameWidget widget;
+    terminal.setMainWidget(&widget);
+    widget.setFocus();
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+
+    Tui::ZTerminalRecorder recorder;
+    REQUIRE(recorder.start(&terminal, &buffer));
+    CHECK(recorder.isRecording());
+    CHECK(recorder.terminal() == &terminal);
+
+    QVector<Tui::ZImage> images;
+    QVector<QPoint> cursorPositions;
+    for (int i = 0; i < 12; i++) {
+        widget.frame = i;
+        if (i == 6) {
+            terminal.resize(25, 8);
+        } else {
+            terminal.forceRepaint();
+        }
+        images.append(terminal.grabCurrentImage());
+        cursorPositions.append(terminal.grabCursorPosition());
+    }
+    // an unchanged frame
+    terminal.forceRepaint();
+    images.append(terminal.grabCurrentImage());
+    cursorPositions.append(terminal.grabCursorPosition());
+
+    CHECK(recorder.framesRecorded() == images.size());
+    CHECK(recorder.bytesWritten() == buffer.size());
+    recorder.stop();
+    CHECK(!recorder.isRecording());
+    CHECK(recorder.errorString() == QString());
+
+    SECTION("replay") {
+        buffer.seek(0);
+        Tui::ZTerminalReplay replay;
+        REQUIRE(replay.open(&buffer));
+        CHECK(replay.isOpen());
+        Tui::ZTerminal replayTerminal{Tui::ZTerminal::OffScreen(1, 1)};
+        qint64 lastTimestamp = 0;
+        for (int i = 0; i < images.size(); i++) {
+            CAPTURE(i);
+            REQUIRE(replay.readFrame(&replayTerminal));
+            CHECK(replay.frameNumber() == i + 1);
+            CHECK(replay.frameTimestamp() >= lastTimestamp);
+            lastTimestamp = replay.frameTimestamp();
+            CHECK(replay.frameSize() == images[i].size());
+            CHECK(replayTerminal.grabCurrentImage() == images[i]);
+            CHECK(replayTerminal.grabCursorPosition() == cursorPositions[i]);
+            if (i == 0 || i == 6) {
+                CHECK(replay.frameCellsChanged() > 0);
+            }
+        }
+        CHECK(replay.frameCellsChanged() == 0);
+        CHECK(!replay.readFrame(&replayTerminal));
+        CHECK(replay.errorString() == QString());
+    }
+
+    SECTION("truncated") {
+        QBuffer truncated;
+        truncated.setData(buffer.data().left(buffer.data().size() - 3));
+        truncated.open(QIODevice::ReadOnly);
+        Tui::ZTerminalReplay replay;
+        REQUIRE(replay.open(&truncated));
+        Tui::ZTerminal replayTerminal{Tui::ZTerminal::OffScreen(1, 1)};
+        int frames = 0;
+        while (replay.readFrame(&replayTerminal)) {
+            ++frames;
+        }
+        CHECK(frames == images.size() - 1);
+        CHECK(replay.errorString() != QString());
+    }
+
+    SECTION("corrupted") {
+        QByteArray data = buffer.data();
+        for (int i = 8; i < data.size(); i += 7) {
+            data[i] = static_cast<char>(data[i] ^ 0x5a);
+        }
+        QBuffer corrupted;
+        corrupted.setData(data);
+        corrupted.open(QIODevice::ReadOnly);
+        Tui::ZTerminalReplay replay;
+        REQUIRE(replay.open(&corrupted));
+        Tui::ZTerminal replayTerminal{Tui::ZTerminal::OffScreen(1, 1)};
+        int frames = 0;
+        while (replay.readFrame(&replayTerminal) && frames < images.size()) {
+            ++frames;
+        }
+        // corrupted data must not crash, it is either detected or decodes to some other content
+        CHECK(frames <= images.size());
+    }
+
+    SECTION("table limits") {
+        // A recording with one uncompressed 1x1 key frame with one cell "a", built by hand so the tables can
+        // have more entries than cells.
+        auto build = [](int texts, int attrs, int cells) {
+            QByteArray payload("\x00\x01\x01\x00\x00", 5);
+            payload.append(static_cast<char>(texts));
+            for (int i = 0; i < texts; i++) {
+                payload.append('\x01');
+                payload.append(static_cast<char>('a' + i));
+            }
+            payload.append(static_cast<char>(attrs));
+            for (int i = 0; i < attrs; i++) {
+                // fg and bg TERMPAINT_DEFAULT_COLOR (0x1000000), no deco, no style, no patch
+                payload.append("\x80\x80\x80\x08\x80\x80\x80\x08\x00\x00\x00", 11);
+            }
+            payload.append(static_cast<char>(cells));
+            for (int i = 0; i < cells; i++) {
+                payload.append("\x00\x00\x01\x00", 4);
+            }
+            // no cells skipped, one cell of entry 0
+            payload.append("\x00\x01\x00", 3);
+
+            QByteArray data("\x89TZR\x01\x02", 6);
+            data.append(static_cast<char>(payload.size()));
+            data.append(payload);
+            return data;
+        };
+
+        auto replayFirstFrame = [](const QByteArray &data) {
+            QBuffer recording;
+            recording.setData(data);
+            recording.open(QIODevice::ReadOnly);
+            Tui::ZTerminalReplay replay;
+            REQUIRE(replay.open(&recording));
+            Tui::ZTerminal replayTerminal{Tui::ZTerminal::OffScreen(1, 1)};
+            return replay.readFrame(&replayTerminal);
+        };
+
+        CHECK(replayFirstFrame(build(1, 1, 1)));
+        CHECK(!replayFirstFrame(build(2, 1, 1)));
+        CHECK(!replayFirstFrame(build(1, 2, 1)));
+        CHECK(!replayFirstFrame(build(1, 1, 2)));
+    }
+
+    SECTION("not a recording") {
+        QBuffer other;
+        other.setData(QByteArray("something else"));
+        other.open(QIODevice::ReadOnly);
+        Tui::ZTerminalReplay replay;
+        CHECK(!replay.open(&other));
+        CHECK(!replay.isOpen());
+        CHECK(replay.errorString() != QString());
+    }
+}
+
+TEST_CASE("terminalrecorder-file", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    QTemporaryDir dir;
+    const QString fileName = dir.filePath(QStringLiteral("recording"));
+
+    Tui::ZTerminalRecorder recorder;
+
+    auto *terminal = new Tui::ZTerminal(Tui::ZTerminal::OffScreen(20, 5));
+    FrameWidget widget;
+    terminal->setMainWidget(&widget);
+    REQUIRE(recorder.start(terminal, fileName));
+    terminal->forceRepaint();
+
+    // deleting the terminal stops the recording
+    delete terminal;
+    CHECK(!recorder.isRecording());
+    CHECK(recorder.terminal() == nullptr);
+    CHECK(recorder.framesRecorded() == 1);
+
+    Tui::ZTerminalReplay replay;
+    REQUIRE(replay.open(fileName));
+    Tui::ZTerminal replayTerminal{Tui::ZTerminal::OffScreen(20, 5)};
+    REQUIRE(replay.readFrame(&replayTerminal));
+    {
+        Tui::ZImage image = replayTerminal.grabCurrentImage();
+        CHECK(image.peekText(0, 1, nullptr, nullptr) == QStringLiteral("f"));
+        CHECK(image.peekForground(0, 1) == Tui::Colors::brightWhite);
+        CHECK(image.peekBackground(0, 1) == Tui::Colors::blue);
+        CHECK(image.peekText(2, 3, nullptr, nullptr) == QStringLiteral("あ"));
+        CHECK(image.peekAttributes(2, 3) == Tui::ZTextAttributes(Tui::ZTextAttribute::Underline));
+        CHECK(image.peekSoftwrapMarker(19, 0));
+    }
+    CHECK(!replay.readFrame(&replayTerminal));
+    CHECK(replay.errorString() == QString());
+    replay.close();
+    CHECK(!replay.isOpen());
+
+    CHECK(!replay.open(dir.filePath(QStringLiteral("missing"))));
+    CHECK(replay.errorString() != QString());
+}
@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: BSL-1.0
+
+#include <Tui/ZTerminalServer.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPointer>
+#include <QTemporaryDir>
+
+#include <Tui/ZPainter.h>
+
+#include "catchwrapper.h"
+#include "vcheck_qobject.h"
+
+namespace {
+    QByteArray readAvailable(int fd) {
+        QByteArray result;
+        char buffer[4096];
+        while (true) {
+            const ssize_t ret = read(fd, buffer, sizeof(buffer));
+            if (ret <= 0) {
+                break;
+            }
+            result.append(buffer, static_cast<int>(ret));
+        }
+        return result;
+    }
+
+    int connectTo(const QString &path) {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        const QByteArray encodedPath = QFile::encodeName(path);
+        memcpy(addr.sun_path, encodedPath.constData(), encodedPath.size());
+        if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+}
+
+TEST_CASE("terminalserver", "") {
+    static char prgname[] = "test";
+    static char *argv[] = {prgname, nullptr};
+    int argc = 1;
+    QCoreApplication app(argc, argv);
+
+    Tui::ZTerminalServer server;
+
+    SECTION("abi-vcheck") {
+        QObject base;
+        checkQObjectOverrides(&base, &server);
+    }
+
+    SECTION("defaults") {
+        CHECK(server.isListening() == false);
+        CHECK(server.serverPath() == QString());
+        CHECK(server.sessionCount() == 0);
+        CHECK(server.sessions().isEmpty());
+        CHECK(server.initialSessionSize() == QSize{80, 24});
+        CHECK(server.terminalOptions() == Tui::ZTerminal::Options());
+        CHECK(server.maxSessions() == 1000);
+        CHECK(server.sessionOutputLimit() == 4 * 1024 * 1024);
+        CHECK(server.addSession(-1) == nullptr);
+    }
+
+    SECTION("session") {
+        int fds[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        const int client = fds[1];
+        fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+
+        Tui::ZTerminal *newSessionTerminal = nullptr;
+        QObject::connect(&server, &Tui::ZTerminalServer::newSession, [&](Tui::ZTerminal *terminal) {
+            newSessionTerminal = terminal;
+        });
+        Tui::ZTerminal *closedTerminal = nullptr;
+        QObject::connect(&server, &Tui::ZTerminalServer::sessionClosed, [&](Tui::ZTerminal *terminal) {
+            closedTerminal = terminal;
+        });
+
+        server.setInitialSessionSize({60, 20});
+        QPointer<Tui::ZTerminal> terminal = server.addSession(fds[0]);
+        REQUIRE(terminal != nullptr);
+        CHECK(newSessionTerminal == terminal);
+        CHECK(server.sessionCount() == 1);
+        CHECK(server.sessions() == QList<Tui::ZTerminal*>{terminal.data()});
+        CHECK(terminal->width() == 60);
+        CHECK(terminal->height() == 20);
+
+        // terminal detection starts right away
+        const QByteArray output = readAvailable(client);
+        CHECK(output.size() > 0);
+        CHECK(server.sessionStatistics(terminal).bytesSent == output.size());
+        CHECK(server.sessionStatistics(terminal).bytesQueued == 0);
+
+        server.setSessionSize(terminal, 70, 30);
+        CHECK(terminal->width() == 70);
+        CHECK(terminal->height() == 30);
+
+        REQUIRE(write(client, "abc", 3) == 3);
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+        CHECK(server.sessionStatistics(terminal).bytesReceived == 3);
+
+        SECTION("client disconnects") {
+            ::close(client);
+            QCoreApplication::processEvents(QEventLoop::AllEvents);
+            CHECK(closedTerminal == terminal);
+            CHECK(server.sessionCount() == 0);
+            CHECK(server.sessions().isEmpty());
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+            CHECK(terminal == nullptr);
+        }
+
+        SECTION("closeSession") {
+            server.closeSession(terminal);
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+            CHECK(terminal == nullptr);
+            CHECK(closedTerminal == nullptr);
+            CHECK(server.sessionCount() == 0);
+            // the client got the terminal restore sequence and then end of file
+            readAvailable(client);
+            char buffer[1];
+            CHECK(read(client, buffer, 1) == 0);
+            ::close(client);
+        }
+
+        SECTION("application deletes terminal") {
+            delete terminal.data();
+            CHECK(server.sessionCount() == 0);
+            CHECK(server.sessions().isEmpty());
+            ::close(client);
+        }
+
+        SECTION("server deleted") {
+            // server destructor cleans up the sessions
+            ::close(client);
+        }
+    }
+
+    SECTION("slow client") {
+        server.setTerminalOptions(Tui::ZTerminal::ForceIncompatibleTerminals
+                                  | Tui::ZTerminal::DisableAutoDetectTimeoutMessage);
+        server.setSessionOutputLimit(16 * 1024);
+
+        int fds[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        const int client = fds[1];
+        fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+        // small socket buffers, so output gets queued soon once the client stops reading
+        const int bufferSize = 4096;
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+        setsockopt(client, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
+        Tui::ZTerminal *closedTerminal = nullptr;
+        QObject::connect(&server, &Tui::ZTerminalServer::sessionClosed, [&](Tui::ZTerminal *terminal) {
+            closedTerminal = terminal;
+        });
+
+        QPointer<Tui::ZTerminal> terminal = server.addSession(fds[0]);
+        REQUIRE(terminal != nullptr);
+
+        // Answer the status report that finishes terminal detection.
+        QByteArray pending;
+        QElapsedTimer timer;
+        timer.start();
+        while (terminal->terminalDetectionResultText().isEmpty() && !timer.hasExpired(5000)) {
+            pending += readAvailable(client);
+            const int pos = pending.indexOf("\033[5n");
+            if (pos != -1) {
+                pending.remove(0, pos + 4);
+                REQUIRE(write(client, "\033[0n", 4) == 4);
+            }
+            QCoreApplication::processEvents(QEventLoop::AllEvents);
+        }
+        REQUIRE(!terminal->terminalDetectionResultText().isEmpty());
+        readAvailable(client);
+
+        // The client stops reading, rendering queues output until the limit is exceeded.
+        {
+            Tui::ZPainter painter = terminal->painter();
+            for (int frame = 0; frame < 1000 && !closedTerminal; frame++) {
+                for (int y = 0; y < terminal->height(); y++) {
+                    for (int x = 0; x < terminal->width(); x++) {
+                        const QChar ch = QChar('a' + (x + y + frame) % 26);
+                        painter.writeWithColors(x, y, &ch, 1,
+                                                (x + y + frame) % 2 ? Tui::Colors::red : Tui::Colors::blue,
+                                                Tui::Colors::black);
+                    }
+                }
+                terminal->updateOutputForceFullRepaint();
+                // disconnecting is deferred from within rendering
+                QCoreApplication::processEvents(QEventLoop::AllEvents);
+            }
+        }
+        CHECK(closedTerminal == terminal);
+        CHECK(server.sessionCount() == 0);
+        CHECK(server.sessions().isEmpty());
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        CHECK(terminal == nullptr);
+
+        // The server closed its end, the client sees end of file after the data that was sent.
+        timer.restart();
+        ssize_t ret = -1;
+        while (ret != 0 && !timer.hasExpired(5000)) {
+            char buffer[4096];
+            ret = read(client, buffer, sizeof(buffer));
+        }
+        CHECK(ret == 0);
+        ::close(client);
+    }
+
+    SECTION("maxSessions") {
+        server.setMaxSessions(1);
+        int fds1[2];
+        int fds2[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds1) == 0);
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds2) == 0);
+        CHECK(server.addSession(fds1[0]) != nullptr);
+        CHECK(server.addSession(fds2[0]) == nullptr);
+        CHECK(server.sessionCount() == 1);
+        CHECK(server.errorString() != QString());
+        // the rejected connection is closed by the server
+        char buffer[1];
+        CHECK(read(fds2[1], buffer, 1) == 0);
+        ::close(fds1[1]);
+        ::close(fds2[1]);
+    }
+
+    SECTION("listen") {
+        QTemporaryDir dir;
+        const QString path = dir.filePath(QStringLiteral("socket"));
+        REQUIRE(server.listen(path));
+        CHECK(server.isListening());
+        CHECK(server.serverPath() == path);
+        CHECK(QFile::exists(path));
+        CHECK(!server.listen(path));
+
+        Tui::ZTerminal *newSessionTerminal = nullptr;
+        QObject::connect(&server, &Tui::ZTerminalServer::newSession, [&](Tui::ZTerminal *terminal) {
+            newSessionTerminal = terminal;
+        });
+
+        const int client = connectTo(path);
+        REQUIRE(client != -1);
+        QCoreApplication::processEvents(QEventLoop::AllEvents);
+        CHECK(server.sessionCount() == 1);
+        CHECK(newSessionTerminal != nullptr);
+
+        server.close();
+        CHECK(!server.isListening());
+        CHECK(!QFile::exists(path));
+        // existing sessions stay connected
+        CHECK(server.sessionCount() == 1);
+        ::close(client);
+    }
+
+    SECTION("listen invalid path") {
+        CHECK(!server.listen(QString()));
+        CHECK(server.errorString() != QString());
+        CHECK(!server.listen(QStringLiteral("/nonexistent-directory/socket")));
+        CHECK(server.errorString() != QString());
+        CHECK(!server.isListening());
+    }
+}
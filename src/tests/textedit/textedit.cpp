@@ -7,9 +7,13 @@
 #include "../vcheck_zwidget.h"
 #include "../eventrecorder.h"
 
+#include <functional>
+
 #include <QBuffer>
+#include <QCoreApplication>
 #include <QElapsedTimer>
 #include <QFutureWatcher>
+#include <QStringList>
 
 #include <Tui/ZClipboard.h>
 #include <Tui/ZCommandManager.h>
@@ -2904,3 +2908,446 @@ TEST_CASE("textedit-palette", "") {
         tests();
     }
 }
+
+TEST_CASE("textedit-multicursor", "") {
+
+    Testhelper t("textedit", "unused", 20, 10);
+
+    t.root->setGeometry({0, 0, 20, 10});
+    Tui::ZTextEdit *te = new Tui::ZTextEdit(t.terminal->textMetrics(), t.root);
+    te->setGeometry({0, 0, 20, 10});
+    te->setFocus();
+
+    loadText(te, "abc\nabc\nabc");
+    te->setCursorPosition({1, 0});
+    te->setAdditionalCursorPositions({{1, 1}, {1, 2}});
+    REQUIRE(te->hasAdditionalCursors());
+
+    using Pos = Tui::ZTextEdit::Position;
+
+    SECTION("positions") {
+        te->setAdditionalCursorPositions({{1, 2}, {1, 0}, {1, 1}, {1, 2}});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{1, 1}, {1, 2}});
+        te->clearAdditionalCursors();
+        CHECK(te->hasAdditionalCursors() == false);
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{});
+    }
+
+    SECTION("type") {
+        t.sendChar("X");
+        CHECK(docToVec(te->document()) == QVector<QString>{"aXbc", "aXbc", "aXbc"});
+        CHECK(te->cursorPosition() == Pos{2, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{2, 1}, {2, 2}});
+
+        t.sendChar("Y");
+        CHECK(docToVec(te->document()) == QVector<QString>{"aXYbc", "aXYbc", "aXYbc"});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{3, 1}, {3, 2}});
+
+        te->undo();
+        CHECK(docToVec(te->document()) == QVector<QString>{"abc", "abc", "abc"});
+        CHECK(te->cursorPosition() == Pos{1, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{1, 1}, {1, 2}});
+
+        te->redo();
+        CHECK(docToVec(te->document()) == QVector<QString>{"aXYbc", "aXYbc", "aXYbc"});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{3, 1}, {3, 2}});
+    }
+
+    SECTION("type same line") {
+        te->setAdditionalCursorPositions({{2, 0}, {3, 0}});
+        t.sendChar("-");
+        CHECK(docToVec(te->document()) == QVector<QString>{"a-b-c-", "abc", "abc"});
+        CHECK(te->cursorPosition() == Pos{2, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{4, 0}, {6, 0}});
+    }
+
+    SECTION("overwrite") {
+        te->setOverwriteMode(true);
+        te->setAdditionalCursorPositions({{1, 1}, {3, 2}});
+        t.sendChar("X");
+        CHECK(docToVec(te->document()) == QVector<QString>{"aXc", "aXc", "abcX"});
+        te->undo();
+        CHECK(docToVec(te->document()) == QVector<QString>{"abc", "abc", "abc"});
+    }
+
+    SECTION("insertText") {
+        te->insertText("12");
+        CHECK(docToVec(te->document()) == QVector<QString>{"a12bc", "a12bc", "a12bc"});
+        CHECK(te->hasAdditionalCursors());
+    }
+
+    SECTION("backspace") {
+        t.sendKey(Tui::Key_Backspace);
+        CHECK(docToVec(te->document()) == QVector<QString>{"bc", "bc", "bc"});
+        CHECK(te->cursorPosition() == Pos{0, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{0, 1}, {0, 2}});
+
+        // at line start, joins lines
+        t.sendKey(Tui::Key_Backspace);
+        CHECK(docToVec(te->document()) == QVector<QString>{"bcbcbc"});
+        CHECK(te->cursorPosition() == Pos{0, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{2, 0}, {4, 0}});
+
+        te->undo();
+        te->undo();
+        CHECK(docToVec(te->document()) == QVector<QString>{"abc", "abc", "abc"});
+    }
+
+    SECTION("delete") {
+        t.sendKey(Tui::Key_Delete);
+        CHECK(docToVec(te->document()) == QVector<QString>{"ac", "ac", "ac"});
+        CHECK(te->cursorPosition() == Pos{1, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{1, 1}, {1, 2}});
+    }
+
+    SECTION("merge") {
+        te->setAdditionalCursorPositions({{2, 0}});
+        t.sendKey(Tui::Key_Backspace);
+        CHECK(docToVec(te->document()) == QVector<QString>{"c", "abc", "abc"});
+        CHECK(te->cursorPosition() == Pos{0, 0});
+        CHECK(te->hasAdditionalCursors() == false);
+    }
+
+    SECTION("enter") {
+        t.sendKey(Tui::Key_Enter);
+        CHECK(docToVec(te->document()) == QVector<QString>{"a", "bc", "a", "bc", "a", "bc"});
+        CHECK(te->cursorPosition() == Pos{0, 1});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{0, 3}, {0, 5}});
+        te->undo();
+        CHECK(docToVec(te->document()) == QVector<QString>{"abc", "abc", "abc"});
+    }
+
+    SECTION("selection") {
+        te->setSelection({0, 0}, {2, 0});
+        te->setAdditionalCursorPositions({{1, 1}, {1, 2}});
+        t.sendChar("X");
+        CHECK(docToVec(te->document()) == QVector<QString>{"Xc", "aXbc", "aXbc"});
+    }
+
+    SECTION("move") {
+        t.sendKey(Tui::Key_Right);
+        CHECK(te->cursorPosition() == Pos{2, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{2, 1}, {2, 2}});
+        t.sendKey(Tui::Key_End);
+        CHECK(te->cursorPosition() == Pos{3, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{3, 1}, {3, 2}});
+        t.sendKey(Tui::Key_Up);
+        CHECK(te->cursorPosition() == Pos{0, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{3, 0}, {3, 1}});
+        t.sendKey(Tui::Key_Home);
+        // all cursors on the same position are merged
+        CHECK(te->cursorPosition() == Pos{0, 0});
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{0, 1}});
+    }
+
+    SECTION("escape") {
+        t.sendKey(Tui::Key_Escape);
+        CHECK(te->hasAdditionalCursors() == false);
+        t.sendChar("X");
+        CHECK(docToVec(te->document()) == QVector<QString>{"aXbc", "abc", "abc"});
+    }
+
+    SECTION("other keys end multi-cursor mode") {
+        t.sendKey(Tui::Key_Right, Tui::ShiftModifier);
+        CHECK(te->hasAdditionalCursors() == false);
+        CHECK(te->selectedText() == "b");
+    }
+
+    SECTION("edit elsewhere") {
+        Tui::ZDocumentCursor cur = te->makeCursor();
+        cur.setPosition({0, 1});
+        cur.insertText("123");
+        CHECK(te->additionalCursorPositions() == QVector<Pos>{{4, 1}, {1, 2}});
+    }
+}
+
+TEST_CASE("textedit-long-line", "") {
+
+    Testhelper t("textedit", "unused", 20, 10);
+
+    t.root->setGeometry({0, 0, 20, 10});
+    Tui::ZTextEdit *te = new Tui::ZTextEdit(t.terminal->textMetrics(), t.root);
+    te->setGeometry({0, 0, 20, 10});
+    te->setFocus();
+    te->setWordWrapMode(Tui::ZTextOption::NoWrap);
+
+    // Longer than the threshold for layouting only the visible part of the line.
+    QString line;
+    for (int i = 0; i < 2000; i++) {
+        line += QStringLiteral("abc\tdefgh ");
+    }
+    line += QStringLiteral("end");
+    const int lineLength = static_cast<int>(line.size());
+    loadText(te, line + "\nshort");
+
+    SECTION("cursor at end") {
+        te->setCursorPosition({lineLength, 0});
+        // each "abc\tdefgh " takes 8 + 6 columns
+        const int cursorColumn = 2000 * 14 + 3;
+        CHECK(te->scrollPositionColumn() == cursorColumn - 20 + 1);
+        t.render();
+        CHECK(t.terminal->grabCursorVisibility() == true);
+        CHECK(t.terminal->grabCursorPosition() == QPoint{19, 0});
+        Tui::ZImage image = t.terminal->grabCurrentImage();
+        CHECK(image.peekText(16, 0, nullptr, nullptr) == QStringLiteral("e"));
+        CHECK(image.peekText(17, 0, nullptr, nullptr) == QStringLiteral("n"));
+        CHECK(image.peekText(18, 0, nullptr, nullptr) == QStringLiteral("d"));
+    }
+
+    SECTION("cursor in the middle") {
+        te->setCursorPosition({1000 * 10 + 4, 0});
+        const int cursorColumn = 1000 * 14 + 8;
+        CHECK(te->scrollPositionColumn() == cursorColumn - 20 + 1);
+        t.render();
+        CHECK(t.terminal->grabCursorPosition() == QPoint{19, 0});
+        Tui::ZImage image = t.terminal->grabCurrentImage();
+        CHECK(image.peekText(19, 0, nullptr, nullptr) == QStringLiteral("d"));
+        CHECK(image.peekText(18, 0, nullptr, nullptr) == QStringLiteral(" "));
+    }
+
+    SECTION("two long lines") {
+        // A second long line with different columns, loaded together with the first one.
+        QString other;
+        for (int i = 0; i < 2000; i++) {
+            other += QStringLiteral("xxxxxxxxx\t");
+        }
+        loadText(te, line + "\n" + other);
+        // each "xxxxxxxxx\t" takes 16 columns
+        te->setCursorPosition({lineLength, 0});
+        CHECK(te->scrollPositionColumn() == 2000 * 14 + 3 - 20 + 1);
+        te->setCursorPosition({1500 * 10 + 9, 1});
+        CHECK(te->scrollPositionColumn() == 1500 * 16 + 9 - 20 + 1);
+        t.render();
+        CHECK(t.terminal->grabCursorPosition() == QPoint{19, 1});
+        Tui::ZImage image = t.terminal->grabCurrentImage();
+        CHECK(image.peekText(18, 1, nullptr, nullptr) == QStringLiteral("x"));
+        te->setCursorPosition({lineLength, 0});
+        CHECK(te->scrollPositionColumn() == 2000 * 14 + 3 - 20 + 1);
+    }
+
+    SECTION("cursor movement") {
+        // Cursors of the text edit only layout a part of long lines, results must match a full layout.
+        QString mixed;
+        for (int i = 0; i < 3000; i++) {
+            mixed += QStringLiteral("ab") + QString(QChar(0x3042)) + QStringLiteral("a") + QString(QChar(0x308))
+                    + QStringLiteral("\tw ");
+        }
+        QString other;
+        for (int i = 0; i < 2000; i++) {
+            other += QString(QChar(0x3042)) + QStringLiteral("xxxx\t");
+        }
+        loadText(te, mixed + "\n" + other);
+        const int mixedLength = static_cast<int>(mixed.size());
+
+        Tui::ZDocumentCursor reference{te->document(), [&](int line, bool /* wrappingAllowed */) {
+                Tui::ZTextLayout lay(t.terminal->textMetrics(), te->document()->line(line));
+                Tui::ZTextOption option;
+                option.setWrapMode(Tui::ZTextOption::NoWrap);
+                option.setTabStopDistance(8);
+                lay.setTextOption(option);
+                lay.doLayout(65000);
+                return lay;
+            }
+        };
+        Tui::ZDocumentCursor cursor = te->makeCursor();
+
+        using Movement = std::function<void(Tui::ZDocumentCursor&)>;
+        const QVector<Movement> movements = {
+            [](Tui::ZDocumentCursor &cur) { cur.moveCharacterLeft(); },
+            [](Tui::ZDocumentCursor &cur) { cur.moveCharacterRight(); },
+            [](Tui::ZDocumentCursor &cur) { cur.moveWordLeft(); },
+            [](Tui::ZDocumentCursor &cur) { cur.moveWordRight(); },
+            [](Tui::ZDocumentCursor &cur) { cur.moveUp(); },
+            [](Tui::ZDocumentCursor &cur) { cur.moveDown(); },
+        };
+
+        for (int line = 0; line < 2; line++) {
+            // around the column checkpoints and inside of clusters
+            for (int base: {0, 1024, 2048, 8192, mixedLength - 8}) {
+                for (int offset = -3; offset <= 3; offset++) {
+                    const Tui::ZDocumentCursor::Position start = {base + offset, line};
+                    for (int i = 0; i < movements.size(); i++) {
+                        CAPTURE(line);
+                        CAPTURE(base + offset);
+                        CAPTURE(i);
+                        cursor.setPosition(start);
+                        reference.setPosition(start);
+                        CHECK(cursor.position() == reference.position());
+                        CHECK(cursor.verticalMovementColumn() == reference.verticalMovementColumn());
+                        movements[i](cursor);
+                        movements[i](reference);
+                        CHECK(cursor.position() == reference.position());
+                        CHECK(cursor.verticalMovementColumn() == reference.verticalMovementColumn());
+                    }
+                }
+            }
+        }
+
+        cursor.setPosition({1000, 0});
+        cursor.setAnchorPosition({1004, 0});
+        reference.setPosition({1000, 0});
+        reference.setAnchorPosition({1004, 0});
+        CHECK(cursor.anchor() == reference.anchor());
+
+        cursor.setPosition({2046, 0});
+        cursor.overwriteText(QStringLiteral("XY"), 2);
+        CHECK(te->document()->line(0).mid(2040, 10) == mixed.mid(2040, 6) + QStringLiteral("XY")
+              + mixed.mid(2048, 2));
+    }
+
+    SECTION("typing") {
+        te->setCursorPosition({lineLength, 0});
+        t.sendChar("X");
+        CHECK(te->document()->line(0) == line + "X");
+        CHECK(te->cursorPosition() == Tui::ZTextEdit::Position{lineLength + 1, 0});
+        t.render();
+        Tui::ZImage image = t.terminal->grabCurrentImage();
+        CHECK(image.peekText(18, 0, nullptr, nullptr) == QStringLiteral("X"));
+    }
+}
+
+TEST_CASE("textedit-visual-lines", "") {
+
+    Testhelper t("textedit", "unused", 20, 10);
+    auto textMetrics = t.terminal->textMetrics();
+
+    t.root->setGeometry({0, 0, 20, 10});
+    Tui::ZTextEdit *te = new Tui::ZTextEdit(textMetrics, t.root);
+    te->setGeometry({0, 0, 20, 10});
+    te->setFocus();
+
+    // more than one chunk of lines for the background computation
+    const int lineCount = 3000;
+    QStringList lines;
+    for (int i = 0; i < lineCount; i++) {
+        lines.append(QStringLiteral("word ").repeated(i % 13) + QStringLiteral("\tend"));
+    }
+    loadText(te, lines.join(QStringLiteral("\n")));
+
+    int lastSignaled = -1;
+    QObject::connect(te, &Tui::ZTextEdit::visualLineCountChanged, [&](int count) {
+        lastSignaled = count;
+    });
+
+    auto waitForRewrap = [&] {
+        QElapsedTimer timer;
+        timer.start();
+        while (te->isRewrapInProgress()) {
+            QCoreApplication::instance()->processEvents(QEventLoop::AllEvents, 10);
+            if (timer.hasExpired(10000)) {
+                FAIL("Timeout in waiting for rewrap");
+            }
+        }
+    };
+
+    auto expectedVisualLines = [&](Tui::ZTextOption::WrapMode wrapMode, int width) {
+        Tui::ZTextOption option;
+        option.setWrapMode(wrapMode);
+        option.setTabStopDistance(8);
+        int result = 0;
+        for (int i = 0; i < te->document()->lineCount(); i++) {
+            Tui::ZTextLayout lay(textMetrics, te->document()->line(i));
+            lay.setTextOption(option);
+            lay.doLayout(width);
+            result += lay.lineCount();
+        }
+        return result;
+    };
+
+    SECTION("no wrap") {
+        waitForRewrap();
+        CHECK(te->visualLineCount() == lineCount);
+    }
+
+    SECTION("word wrap") {
+        te->setWordWrapMode(Tui::ZTextOption::WordWrap);
+        CHECK(te->isRewrapInProgress() == true);
+        waitForRewrap();
+        const int expected = expectedVisualLines(Tui::ZTextOption::WordWrap, 20);
+        CHECK(expected > lineCount);
+        CHECK(te->visualLineCount() == expected);
+        CHECK(lastSignaled == expected);
+
+        te->setWordWrapMode(Tui::ZTextOption::NoWrap);
+        waitForRewrap();
+        CHECK(te->visualLineCount() == lineCount);
+        CHECK(lastSignaled == lineCount);
+    }
+
+    SECTION("wrap anywhere") {
+        te->setWordWrapMode(Tui::ZTextOption::WrapAnywhere);
+        waitForRewrap();
+        CHECK(te->visualLineCount() == expectedVisualLines(Tui::ZTextOption::WrapAnywhere, 20));
+    }
+
+    SECTION("resize") {
+        te->setWordWrapMode(Tui::ZTextOption::WordWrap);
+        waitForRewrap();
+        te->setGeometry({0, 0, 15, 10});
+        waitForRewrap();
+        CHECK(te->visualLineCount() == expectedVisualLines(Tui::ZTextOption::WordWrap, 15));
+    }
+
+    SECTION("line numbers") {
+        te->setWordWrapMode(Tui::ZTextOption::WordWrap);
+        te->setShowLineNumbers(true);
+        waitForRewrap();
+        CHECK(te->visualLineCount() == expectedVisualLines(Tui::ZTextOption::WordWrap,
+                                                           20 - te->lineNumberBorderWidth()));
+    }
+
+    SECTION("edit") {
+        te->setWordWrapMode(Tui::ZTextOption::WordWrap);
+        waitForRewrap();
+        te->setCursorPosition({0, 1500});
+        te->insertText(QStringLiteral("a long line that is wrapped multiple times\n\n"));
+        waitForRewrap();
+        CHECK(te->visualLineCount() == expectedVisualLines(Tui::ZTextOption::WordWrap, 20));
+
+        te->undo();
+        waitForRewrap();
+        CHECK(te->visualLineCount() == expectedVisualLines(Tui::ZTextOption::WordWrap, 20));
+    }
+
+    SECTION("scroll position after inserting and splitting lines") {
+        te->setWordWrapMode(Tui::ZTextOption::WordWrap);
+        waitForRewrap();
+
+        // insert lines and split a wrapped line, the counts computed before must not be used for shifted lines
+        te->setCursorPosition({0, 3});
+        te->insertText(QStringLiteral("a long line that is wrapped multiple times\nand\n"));
+        te->setCursorPosition({7, 20});
+        te->insertText(QStringLiteral("\n"));
+        te->setCursorPosition({0, 1000});
+
+        // laying out all lines without a background computation
+        Tui::ZTextEdit *reference = new Tui::ZTextEdit(textMetrics, t.root);
+        reference->setGeometry({0, 0, 20, 10});
+        reference->setWordWrapMode(Tui::ZTextOption::WordWrap);
+        reference->setText(te->text());
+        reference->setCursorPosition({0, 1000});
+
+        CHECK(te->scrollPositionLine() == reference->scrollPositionLine());
+        CHECK(te->scrollPositionFineLine() == reference->scrollPositionFineLine());
+
+        waitForRewrap();
+        CHECK(te->visualLineCount() == expectedVisualLines(Tui::ZTextOption::WordWrap, 20));
+        te->setCursorPosition({0, 0});
+        te->setCursorPosition({0, 1000});
+        CHECK(te->scrollPositionLine() == reference->scrollPositionLine());
+        CHECK(te->scrollPositionFineLine() == reference->scrollPositionFineLine());
+    }
+
+    SECTION("scroll position uses visual lines") {
+        // Before the background computation is done, the scroll position is based on layouting the lines.
+        te->setWordWrapMode(Tui::ZTextOption::WordWrap);
+        te->setCursorPosition({0, lineCount - 1});
+        const int scrollLine = te->scrollPositionLine();
+        const int scrollFineLine = te->scrollPositionFineLine();
+        te->setCursorPosition({0, 0});
+        waitForRewrap();
+        te->setCursorPosition({0, lineCount - 1});
+        CHECK(te->scrollPositionLine() == scrollLine);
+        CHECK(te->scrollPositionFineLine() == scrollFineLine);
+    }
+}
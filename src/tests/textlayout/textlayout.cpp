@@ -4,6 +4,9 @@
 #include <Tui/ZTextOption.h>
 #include <Tui/ZFormatRange.h>
 
+#include <algorithm>
+#include <limits>
+
 #include <QTextBoundaryFinder>
 
 #include <Tui/ZWidget.h>
@@ -1994,3 +1997,313 @@ TEST_CASE("textlayout", "") {
     }
 
 }
+
+TEST_CASE("textlayout-window", "") {
+    Testhelper t("unused", "unused", 32, 5);
+    auto textMetrics = t.terminal->textMetrics();
+
+    QString text;
+    for (int i = 0; i < 50; i++) {
+        text += QStringLiteral("ab\tc") + QString(QChar(0x3042)) + QStringLiteral("ä x ")
+                + QString::fromUtf16(u"\U0001F60E") + QStringLiteral("  ");
+    }
+
+    const bool showSpaces = GENERATE(false, true);
+    Tui::ZTextOption option;
+    option.setWrapMode(Tui::ZTextOption::NoWrap);
+    option.setTabStopDistance(8);
+    if (showSpaces) {
+        option.setFlags(Tui::ZTextOption::ShowTabsAndSpaces);
+    }
+
+    Tui::ZTextLayout full(textMetrics, text);
+    full.setTextOption(option);
+    full.doLayout(65000);
+    Tui::ZTextLineRef fullLine = full.lineAt(0);
+
+    const int start = GENERATE(0, 1, 3, 4, 5, 7, 100, 301);
+    if (!full.isValidCursorPosition(start)) {
+        return;
+    }
+    const int startColumn = fullLine.cursorToX(start, Tui::ZTextLayout::Leading);
+
+    Tui::ZTextLayout window(textMetrics, text);
+    window.setTextOption(option);
+
+    SECTION("end column") {
+        window.doLayoutWindow(start, startColumn, std::numeric_limits<int>::max(), startColumn + 40);
+        REQUIRE(window.lineCount() == 1);
+        Tui::ZTextLineRef line = window.lineAt(0);
+        CHECK(line.textStart() == start);
+        const int end = start + line.textLength();
+        CHECK(full.isValidCursorPosition(end));
+        CHECK(line.width() >= startColumn + 40);
+        CHECK(line.width() == fullLine.cursorToX(end, Tui::ZTextLayout::Leading));
+
+        for (int i = start; i <= end; i++) {
+            CAPTURE(i);
+            CHECK(window.isValidCursorPosition(i) == full.isValidCursorPosition(i));
+            CHECK(line.cursorToX(i, Tui::ZTextLayout::Leading) == fullLine.cursorToX(i, Tui::ZTextLayout::Leading));
+            if (i < end) {
+                CHECK(line.cursorToX(i, Tui::ZTextLayout::Trailing) == fullLine.cursorToX(i, Tui::ZTextLayout::Trailing));
+            }
+        }
+        for (int x = startColumn; x < line.width(); x++) {
+            CAPTURE(x);
+            CHECK(line.xToCursor(x) == fullLine.xToCursor(x));
+        }
+    }
+
+    SECTION("end code unit") {
+        window.doLayoutWindow(start, startColumn, start + 20, std::numeric_limits<int>::max());
+        Tui::ZTextLineRef line = window.lineAt(0);
+        const int end = start + line.textLength();
+        CHECK(end >= start + 20);
+        CHECK(line.cursorToX(start + 20, Tui::ZTextLayout::Leading)
+              == fullLine.cursorToX(start + 20, Tui::ZTextLayout::Leading));
+        CHECK(line.cursorToX(end, Tui::ZTextLayout::Leading) == fullLine.cursorToX(end, Tui::ZTextLayout::Leading));
+    }
+
+    SECTION("until end of line") {
+        window.doLayoutWindow(start, startColumn, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+        Tui::ZTextLineRef line = window.lineAt(0);
+        CHECK(line.textStart() + line.textLength() == text.size());
+        CHECK(line.width() == fullLine.width());
+    }
+}
+
+TEST_CASE("textlayout-very-long-line", "") {
+    Testhelper t("unused", "unused", 32, 5);
+    auto textMetrics = t.terminal->textMetrics();
+
+    // wider than 65535 columns
+    const QString text = QString(70000, QLatin1Char('a')) + QString(QChar(0x3042)) + QStringLiteral("b");
+    Tui::ZTextLayout lay(textMetrics, text);
+    Tui::ZTextOption option;
+    option.setWrapMode(Tui::ZTextOption::NoWrap);
+    lay.setTextOption(option);
+    lay.doLayout(65000);
+    Tui::ZTextLineRef line = lay.lineAt(0);
+    CHECK(line.width() == 70003);
+    CHECK(line.cursorToX(70000, Tui::ZTextLayout::Leading) == 70000);
+    CHECK(line.cursorToX(70001, Tui::ZTextLayout::Leading) == 70002);
+    CHECK(line.xToCursor(69999) == 69999);
+    CHECK(line.xToCursor(70000) == 70000);
+    CHECK(line.xToCursor(70002) == 70001);
+}
+
+TEST_CASE("textlayout-very-long-line-double-width", "") {
+    Testhelper t("unused", "unused", 32, 5);
+    auto textMetrics = t.terminal->textMetrics();
+
+    // double width characters, more than 65535 columns but less than 65535 code units
+    const QString text = QString(40000, QChar(0x3042)) + QStringLiteral("b");
+    Tui::ZTextLayout lay(textMetrics, text);
+    Tui::ZTextOption option;
+    option.setWrapMode(Tui::ZTextOption::NoWrap);
+    lay.setTextOption(option);
+    lay.doLayout(65000);
+    Tui::ZTextLineRef line = lay.lineAt(0);
+    CHECK(line.width() == 80001);
+    CHECK(line.cursorToX(33000, Tui::ZTextLayout::Leading) == 66000);
+    CHECK(line.cursorToX(39999, Tui::ZTextLayout::Leading) == 79998);
+    CHECK(line.cursorToX(39999, Tui::ZTextLayout::Trailing) == 80000);
+    CHECK(line.cursorToX(40000, Tui::ZTextLayout::Leading) == 80000);
+    CHECK(line.xToCursor(66000) == 33000);
+    CHECK(line.xToCursor(79998) == 39999);
+    CHECK(line.xToCursor(80000) == 40000);
+}
+
+TEST_CASE("textlayout-columns", "") {
+    Testhelper t("unused", "unused", 32, 5);
+    auto textMetrics = t.terminal->textMetrics();
+
+    // Columns of all clusters compared to the sum of the cluster widths from the text metrics.
+
+    const bool wrap = GENERATE(false, true);
+    CAPTURE(wrap);
+
+    const QString wide = QString(QChar(0x3042));
+    const QString combining = QStringLiteral("a") + QString(QChar(0x308)); // 2 code units, 1 column
+    const QString astral = QString::fromUtf16(u"\U0001F60E"); // 2 code units
+
+    QString text;
+    SECTION("alternating widths") {
+        // many short runs of equal clusters, also exceeding 65535 columns
+        for (int i = 0; i < 25000; i++) {
+            text += QStringLiteral("a") + wide;
+        }
+    }
+    SECTION("mixed cluster sizes") {
+        for (int i = 0; i < 30; i++) {
+            text += QString(i, QLatin1Char('x')) + QString(i % 4, QChar(0x3042));
+            for (int j = 0; j < i % 5; j++) {
+                text += combining;
+            }
+            for (int j = 0; j < i % 3; j++) {
+                text += astral;
+            }
+            text += combining + wide + astral + QStringLiteral("y");
+        }
+    }
+    SECTION("segment boundaries") {
+        // long runs of equal clusters, lookups at the changes between them
+        text = QString(100, QLatin1Char('a')) + QString(100, QChar(0x3042));
+        for (int j = 0; j < 100; j++) {
+            text += combining;
+        }
+        for (int j = 0; j < 100; j++) {
+            text += astral;
+        }
+        text += QString(100, QLatin1Char('b'));
+    }
+
+    Tui::ZTextOption option;
+    option.setWrapMode(wrap ? Tui::ZTextOption::WrapAnywhere : Tui::ZTextOption::NoWrap);
+    Tui::ZTextLayout lay(textMetrics, text);
+    lay.setTextOption(option);
+    lay.doLayout(wrap ? 37 : 65000);
+
+    int expectedOffset = 0;
+    for (int lineNumber = 0; lineNumber < lay.lineCount(); lineNumber++) {
+        CAPTURE(lineNumber);
+        Tui::ZTextLineRef line = lay.lineAt(lineNumber);
+        REQUIRE(line.textStart() == expectedOffset);
+        const int end = line.textStart() + line.textLength();
+
+        QVector<int> expectedLeading, leading;
+        QVector<int> expectedTrailing, trailing;
+        QVector<int> expectedXToCursor, xToCursor;
+        QVector<int> expectedNext, next;
+        QVector<int> expectedPrevious, previous;
+        QVector<int> invalidPositions;
+        int column = 0;
+        int offset = line.textStart();
+        while (offset < end) {
+            const Tui::ZTextMetrics::ClusterSize cs = textMetrics.nextCluster(text, offset);
+            for (int i = 0; i < cs.codeUnits; i++) {
+                // positions inside a cluster are moved to its start
+                expectedLeading.append(column);
+                leading.append(line.cursorToX(offset + i, Tui::ZTextLayout::Leading));
+                expectedTrailing.append(column + cs.columns);
+                trailing.append(line.cursorToX(offset + i, Tui::ZTextLayout::Trailing));
+                if (i > 0 && lay.isValidCursorPosition(offset + i)) {
+                    invalidPositions.append(offset + i);
+                }
+            }
+            for (int x = column; x < column + cs.columns; x++) {
+                expectedXToCursor.append(x == column ? offset : offset + cs.codeUnits);
+                xToCursor.append(line.xToCursor(x));
+            }
+            expectedNext.append(offset + cs.codeUnits);
+            next.append(lay.nextCursorPosition(offset));
+            if (offset + cs.codeUnits < end || lineNumber + 1 == lay.lineCount()) {
+                expectedPrevious.append(offset);
+                previous.append(lay.previousCursorPosition(offset + cs.codeUnits));
+            }
+            column += cs.columns;
+            offset += cs.codeUnits;
+        }
+        REQUIRE(offset == end);
+        CHECK(line.width() == column);
+        CHECK(leading == expectedLeading);
+        CHECK(trailing == expectedTrailing);
+        CHECK(xToCursor == expectedXToCursor);
+        CHECK(next == expectedNext);
+        CHECK(previous == expectedPrevious);
+        CHECK(invalidPositions.isEmpty());
+        expectedOffset = end;
+    }
+    CHECK(expectedOffset == text.size());
+}
+
+TEST_CASE("textlayout-word-wrap-line-breaks", "") {
+    Testhelper t("unused", "unused", 32, 5);
+    auto textMetrics = t.terminal->textMetrics();
+
+    Tui::ZTextOption option;
+    option.setWrapMode(Tui::ZTextOption::WordWrap);
+
+    auto lineStarts = [&](const QString &text, int width) {
+        Tui::ZTextLayout lay(textMetrics, text);
+        lay.setTextOption(option);
+        lay.doLayout(width);
+        QVector<int> result;
+        for (int i = 0; i < lay.lineCount(); i++) {
+            result.append(lay.lineAt(i).textStart());
+        }
+        return result;
+    };
+
+    SECTION("same text at different widths") {
+        // Greedy wrapping of text with only single width clusters, at the last break opportunity found by
+        // QTextBoundaryFinder or at the space that does not fit anymore.
+        auto expectedLineStarts = [](const QString &text, int width) {
+            QVector<int> breaks;
+            QTextBoundaryFinder finder(QTextBoundaryFinder::Line, text);
+            for (int pos = finder.toNextBoundary(); pos != -1; pos = finder.toNextBoundary()) {
+                breaks.append(pos);
+            }
+            QVector<int> result = {0};
+            int start = 0;
+            while (start + width < text.size()) {
+                int end = start + width;
+                if (text[end] != QLatin1Char(' ')) {
+                    for (int pos: breaks) {
+                        if (pos > start && pos <= start + width) {
+                            end = pos;
+                        }
+                    }
+                }
+                result.append(end);
+                start = end;
+            }
+            return result;
+        };
+
+        QString text;
+        for (int i = 0; i < 40; i++) {
+            text += QStringLiteral("Lorem ipsum-dolor sit amet,  consetetur sadipscingelitr, sed diam ");
+        }
+
+        for (int width = 60; width >= 5; width--) {
+            // A deep copy gets the cached break opportunities of the text after the first width.
+            const QString copy = QString(text.constData(), text.size());
+            CAPTURE(width);
+            const QVector<int> expected = expectedLineStarts(text, width);
+            CHECK(lineStarts(text, width) == expected);
+            CHECK(lineStarts(copy, width) == expected);
+        }
+    }
+
+    SECTION("modified text") {
+        QString text = QStringLiteral("aaa bbb ccc");
+        CHECK(lineStarts(text, 5) == QVector<int>{0, 4, 8});
+        text[3] = QLatin1Char('x');
+        text[7] = QLatin1Char('x');
+        CHECK(lineStarts(text, 5) == QVector<int>{0, 5, 10});
+    }
+
+    SECTION("reused buffer") {
+        // Different text at the same address with the same size must not get the breaks of the old text.
+        QChar buffer[11];
+        const QString first = QStringLiteral("aaa bbb ccc");
+        std::copy(first.begin(), first.end(), buffer);
+        CHECK(lineStarts(QString::fromRawData(buffer, 11), 5) == QVector<int>{0, 4, 8});
+        const QString second = QStringLiteral("aaaxbbbxccc");
+        std::copy(second.begin(), second.end(), buffer);
+        CHECK(lineStarts(QString::fromRawData(buffer, 11), 5) == QVector<int>{0, 5, 10});
+    }
+
+    SECTION("setText") {
+        Tui::ZTextLayout lay(textMetrics, QStringLiteral("aaa bbb ccc"));
+        lay.setTextOption(option);
+        lay.doLayout(5);
+        CHECK(lay.lineCount() == 3);
+        lay.setText(QStringLiteral("aaaxbbbxccc"));
+        lay.doLayout(5);
+        REQUIRE(lay.lineCount() == 3);
+        CHECK(lay.lineAt(1).textStart() == 5);
+        CHECK(lay.lineAt(2).textStart() == 10);
+    }
+}